@@ -46,6 +46,7 @@
 #endif  // ESP32
 #include <IRremoteESP8266.h>
 #include <IRsend.h>
+#include <IRutils.h>
 #include <WiFiClient.h>
 #include <WiFiServer.h>
 
@@ -55,49 +56,41 @@ const char* kPassword = "...";  // Put your WIFI Password here.
 WiFiServer server(4998);  // Uses port 4998.
 WiFiClient client;
 
-uint16_t *code_array;
 #define IR_LED 4  // ESP8266 GPIO pin to use. Recommended: 4 (D2).
+// Max. nr. of values in a code we can send. Longer codes are rejected.
+const uint16_t kMaxCodeValues = 512;
 
 IRsend irsend(IR_LED);  // Set the GPIO to be used to sending the message.
 
-void sendGCString(String str) {
-  int16_t index;
-  uint16_t count;
+// The code is parsed straight off the network, into a fixed size buffer.
+// No heap allocations, so a long code can't exhaust the memory.
+uint16_t code_array[kMaxCodeValues];
+uint16_t code_len = 0;
+bool code_ok = true;
+IRvalueParser parser;
 
-  // Find out how many items there are in the string.
-  index = -1;
-  count = 1;
-  do {
-    index = str.indexOf(',', index + 1);
-    count++;
-  } while (index != -1);
-
-  // Now we know how many there are, allocate the memory to store them all.
-  code_array = reinterpret_cast<uint16_t*>(malloc(count * sizeof(uint16_t)));
-  // Check we malloc'ed successfully.
-  if (code_array == NULL) {  // malloc failed, so give up.
-    Serial.printf("\nCan't allocate %d bytes. (%d bytes free)\n",
-                  count * sizeof(uint16_t), ESP.getFreeHeap());
-    Serial.println("Giving up & forcing a reboot.");
-    ESP.restart();  // Reboot.
-    delay(500);  // Wait for the restart to happen.
-    return;  // Should never get here, but just in case.
-  }
-
-  // Now convert the strings to integers and place them in code_array.
-  count = 0;
-  uint16_t start_from = 0;
-  do {
-    index = str.indexOf(',', start_from);
-    code_array[count] = str.substring(start_from, index).toInt();
-    start_from = index + 1;
-    count++;
-  } while (index != -1);
+// Store the next value of the code being received.
+void addValue(const uint16_t value) {
+  if (code_len < kMaxCodeValues)
+    code_array[code_len++] = value;
+  else
+    code_ok = false;  // Too long.
+}
 
+// The end of a line has been reached, so send what we have (if it's valid).
+void sendGCCode(void) {
+  if (parser.end()) addValue(parser.value());
+  if (!code_ok || parser.error()) {
+    Serial.println("Ignoring a malformed or too long code.");
+  } else if (code_len) {
 #if SEND_GLOBALCACHE
-  irsend.sendGC(code_array, count);  // All done. Send it.
+    irsend.sendGC(code_array, code_len);  // All done. Send it.
 #endif  // SEND_GLOBALCACHE
-  free(code_array);  // Free up the memory allocated.
+  }
+  // Get ready for the next code.
+  code_len = 0;
+  code_ok = true;
+  parser.reset();
 }
 
 void setup() {
@@ -127,10 +120,11 @@ void loop() {
     client = server.available();
   }
 
-  if (client.available()) {
-    String ir_code_str = client.readStringUntil('\r');  // Exclusive of \r
-    client.readStringUntil('\n');  // Skip new line as well
-    client.flush();
-    sendGCString(ir_code_str);
+  while (client.available()) {
+    const char c = client.read();
+    if (c == '\r' || c == '\n')  // End of the code?
+      sendGCCode();
+    else if (parser.feed(c))
+      addValue(parser.value());
   }
 }
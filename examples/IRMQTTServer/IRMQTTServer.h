@@ -70,6 +70,12 @@ const int8_t kDefaultIrLed = 4;  // <=- CHANGE_ME (optional)
 //            easily destroy your IR LED if you are overdriving it.
 //            Unless you *REALLY* know what you are doing, don't change this.
 const bool kInvertTxOutput = false;
+// Max. bytes of (stack) memory used to send a raw code without allocating
+// memory for it. Enough for 512 entries using up to 16 distinct durations.
+const uint16_t kRawSymbolsMaxBytes = 256;
+// Percentage by which durations in a raw code may differ & still be sent as
+// one (averaged) duration. 0 means only exactly the same durations.
+const uint8_t kRawSymbolsTolerance = kTolerance;
 
 // Default GPIO the IR demodulator is connected to/controlled by. GPIO 14 = D5.
 // Note: GPIO 16 won't work on the ESP8266 as it does not have interrupts.
@@ -114,6 +120,17 @@ const IPAddress kSubnetMask = IPAddress(255, 255, 255, 0);
                                     //       passworded.
 // If you do not set a password, Firmware OTA & GPIO updates will be blocked.
 
+// Web pages are sent in chunks as they are generated. This is the size (bytes)
+// of the buffer used to collect the output into each chunk.
+const uint16_t kHtmlBufferSize = 512;
+
+// ----------------------- Main Loop Settings ----------------------------------
+// When a pass of the main loop finds nothing to do, it sleeps for this long
+// (ms) to let the WiFi stack (& power saving) run. When there is work, it only
+// yields, so incoming IR, MQTT & web requests are handled straight away.
+const uint8_t kLoopIdleDelayMs = 1;
+const uint32_t kLoopStatsPeriodMs = 1000;  // How often (ms) to update stats.
+
 // ----------------------- MQTT Related Settings -------------------------------
 #if MQTT_ENABLE
 #ifndef MQTT_BUFFER_SIZE
@@ -134,8 +151,16 @@ const uint32_t kMqttReconnectTime = 5000;  // Delay(ms) between reconnect tries.
 #define MQTT_CLIMATE_STAT "stat"  // Sub-topic for the climate stat topics.
 // Sub-topic for the temperature/humidity sensor stat topics.
 #define MQTT_SENSOR_STAT "sensor"
+#define MQTT_TX_STATS "txstats"  // Topic we send the transmit stats to.
 // Enable sending/receiving climate via JSON. `true` cost ~5k of program space.
 #define MQTT_CLIMATE_JSON false
+// Only publish the climate state as one JSON message, rather than a message
+// per setting. Less MQTT traffic & heap churn, but Home Assistant's MQTT
+// discovery needs the per-setting topics. Requires MQTT_CLIMATE_JSON.
+#define MQTT_CLIMATE_JSON_ONLY false
+#if MQTT_CLIMATE_JSON_ONLY && !MQTT_CLIMATE_JSON
+#error "MQTT_CLIMATE_JSON_ONLY requires MQTT_CLIMATE_JSON to be enabled."
+#endif  // MQTT_CLIMATE_JSON_ONLY && !MQTT_CLIMATE_JSON
 
 // Use Home Assistant-style operation modes.
 // TL;DR: Power and Mode are linked together. One changes the other.
@@ -178,6 +203,16 @@ const uint32_t kMqttReconnectTime = 5000;  // Delay(ms) between reconnect tries.
 #endif  // MQTT_SERVER_AUTODETECT_ENABLE
 #endif  // MQTT_ENABLE
 
+// Max. nr. of values in a GlobalCache, Pronto, or raw code we can send.
+// These are parsed into a fixed buffer (2 bytes per value) rather than the
+// heap, so an overly long code is rejected instead of forcing a reboot.
+#if MQTT_ENABLE
+// Every value takes at least two characters of a message. e.g. "1,"
+const uint16_t kCodeValuesMax = kMqttBufferSize / 2;
+#else  // MQTT_ENABLE
+const uint16_t kCodeValuesMax = 512;
+#endif  // MQTT_ENABLE
+
 // ------------------------ IR Capture Settings --------------------------------
 // Should we stop listening for IR messages when we send a message via IR?
 // Set this to `true` if your IR demodulator is picking up self transmissions.
@@ -253,6 +288,13 @@ const uint16_t kMinUnknownSize = 2 * 10;
 // Note: Turning on the feature costs ~250 bytes of prog space.
 #define REPORT_VCC false  // Do we report Vcc via html info page & MQTT?
 
+// Time every mark & space we send, and report how far off what was requested
+// they were, per protocol. e.g. To see if WiFi interrupts are disturbing the
+// transmit timings. (See IRsend::enableTxStats())
+// Note: Costs ~200 bytes of RAM, and a little time per mark & space.
+#define REPORT_TX_STATS false  // Report them via html info page & MQTT?
+const uint32_t kTxStatsPeriodMs = 60000;  // How often (ms) to publish them.
+
 // Keywords for MQTT topics, html arguments, or config file.
 #define KEY_PROTOCOL "protocol"
 #define KEY_MODEL "model"
@@ -308,7 +350,6 @@ const uint8_t kPasswordLength = 20;
 // -------------------------- Json Settings ------------------------------------
 
 const uint16_t kJsonConfigMaxSize = 512;    // Bytes
-const uint16_t kJsonAcStateMaxSize = 1024;  // Bytes
 
 // -------------------------- Debug Settings -----------------------------------
 // Debug output is disabled if any of the IR pins are on the TX (D1) pin.
@@ -419,7 +460,7 @@ void doBroadcast(TimerMs *timer, const uint32_t interval,
                  const bool force);
 #if MQTT_CLIMATE_JSON
 stdAc::state_t jsonToState(const stdAc::state_t current, const char *str);
-void sendJsonState(const stdAc::state_t state, const String topic,
+bool sendJsonState(const stdAc::state_t state, const String topic,
                    const bool retain = false,
                    const bool ha_mode = MQTT_CLIMATE_HA_MODE);
 #endif  // MQTT_CLIMATE_JSON
@@ -427,6 +468,12 @@ void sendJsonState(const stdAc::state_t state, const String topic,
 #if REPORT_VCC
 String vccToString(void);
 #endif  // REPORT_VCC
+#if REPORT_TX_STATS
+void txStatsHtml(void);
+#if MQTT_ENABLE
+String txStatsJson(void);
+#endif  // MQTT_ENABLE
+#endif  // REPORT_TX_STATS
 bool isSerialGpioUsedByIr(void);
 void debug(const char *str);
 void saveWifiConfigCallback(void);
@@ -434,6 +481,8 @@ void saveWifiConfig(void);
 void loadWifiConfigFile(void);
 void doRestart(const char* str, const bool serial_only = false);
 String msToHumanString(uint32_t const msecs);
+uint32_t workDone(void);
+void recordLoopTime(const uint32_t usecs);
 String timeElapsed(uint32_t const msec);
 String timeSince(uint32_t const start);
 String gpioToString(const int16_t gpio);
@@ -446,6 +495,14 @@ bool hasUnsafeHTMLChars(String input);
 String htmlHeader(const String title, const String h1_text = "",
                   const String headScriptsJS = "");
 String htmlEnd(void);
+void htmlStart(void);
+void htmlFlush(void);
+void htmlSend(const char *str, size_t len);
+void htmlSend(const char *str);
+void htmlSend(const String &str);
+void htmlSend(const char c);
+void htmlSend(const __FlashStringHelper *str);
+void htmlFinish(void);
 String htmlButton(const String url, const String button,
                   const String text = "");
 String htmlMenu(void);
@@ -454,19 +511,21 @@ String addJsReloadUrl(const String url, const uint16_t timeout_s,
                       const bool notify);
 String getJsToggleCheckbox(const String functionName = TOGGLE_JS_FN_NAME);
 void handleExamples(void);
-String htmlOptionItem(const String value, const String text, bool selected);
-String htmlSelectBool(const String name, const bool def);
-String htmlDisableCheckbox(const String name, const String targetControlId,
-                           const bool checked,
-                           const String toggleJsFnName = TOGGLE_JS_FN_NAME);
-String htmlSelectClimateProtocol(const String name, const decode_type_t def);
-String htmlSelectAcStateProtocol(const String name, const decode_type_t def,
-                                 const bool simple);
-String htmlSelectModel(const String name, const int16_t def);
-String htmlSelectMode(const String name, const stdAc::opmode_t def);
-String htmlSelectFanspeed(const String name, const stdAc::fanspeed_t def);
-String htmlSelectSwingv(const String name, const stdAc::swingv_t def);
-String htmlSelectSwingh(const String name, const stdAc::swingh_t def);
+void htmlSelectStart(const String &name);
+void htmlOptionItem(const String &value, const String &text,
+                    const bool selected);
+void htmlSelectBool(const String &name, const bool def);
+void htmlDisableCheckbox(const String &name, const String &targetControlId,
+                         const bool checked,
+                         const String &toggleJsFnName = TOGGLE_JS_FN_NAME);
+void htmlSelectClimateProtocol(const String &name, const decode_type_t def);
+void htmlSelectAcStateProtocol(const String &name, const decode_type_t def,
+                               const bool simple);
+void htmlSelectModel(const String &name, const int16_t def);
+void htmlSelectMode(const String &name, const stdAc::opmode_t def);
+void htmlSelectFanspeed(const String &name, const stdAc::fanspeed_t def);
+void htmlSelectSwingv(const String &name, const stdAc::swingv_t def);
+void htmlSelectSwingh(const String &name, const stdAc::swingh_t def);
 void handleAirCon(void);
 void handleAirConSet(void);
 void handleAdmin(void);
@@ -475,8 +534,6 @@ void handleReset(void);
 void handleReboot(void);
 bool parseStringAndSendAirCon(IRsend *irsend, const decode_type_t irType,
                               const String str);
-uint16_t countValuesInStr(const String str, char sep);
-uint16_t * newCodeArray(const uint16_t size);
 #if SEND_GLOBALCACHE
 bool parseStringAndSendGC(IRsend *irsend, const String str);
 #endif  // SEND_GLOBALCACHE
@@ -508,6 +508,10 @@ String MqttClientId;
 #if SHT3X_SUPPORT
 String MqttSensorStat;
 #endif  // SHT3X_SUPPORT
+#if REPORT_TX_STATS
+String MqttTxStats;  // Topic we send the transmit stats to.
+TimerMs lastTxStats = TimerMs();  // When we last sent the transmit stats.
+#endif  // REPORT_TX_STATS
 
 // Primative lock file for gating MQTT state broadcasts.
 bool lockMqttBroadcast = true;
@@ -547,6 +551,15 @@ bool isSerialGpioUsedByIr(void) {
   return false;  // Not in use as far as we can tell.
 }
 
+// Main loop performance. (See recordLoopTime())
+uint32_t loopCount = 0;  // Passes of the main loop in the current period.
+uint32_t loopTotalUs = 0;  // Time they took in total.
+uint32_t loopPeakUs = 0;  // The slowest of them.
+uint32_t loopRate = 0;  // Passes per second, in the last period.
+uint32_t loopAvgUs = 0;  // Avg. time of a pass, in the last period.
+uint32_t loopMaxUs = 0;  // The slowest pass, in the last period.
+TimerMs loopStatsTime = TimerMs();  // When the current period started.
+
 #if SHT3X_SUPPORT
 SHT3X TemperatureSensor(SHT3X_I2C_ADDRESS);
 TimerMs statSensorReadTime = TimerMs();
@@ -729,6 +742,71 @@ String listOfTxGpios(void) {
   return result;
 }
 
+// Chunked (streamed) html responses.
+// A page is sent in pieces as it is generated, via a small fixed size buffer,
+// rather than being built up in one big String first and then sent.
+char htmlBuffer[kHtmlBufferSize];  // Output not yet sent.
+uint16_t htmlBufferLen = 0;  // Nr. of bytes used in htmlBuffer.
+
+// Start a chunked html response. Follow it with htmlSend()s & htmlFinish().
+void htmlStart(void) {
+  htmlBufferLen = 0;
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/html", "");
+}
+
+// Send what has been buffered so far as a chunk.
+void htmlFlush(void) {
+  if (htmlBufferLen) server.sendContent(htmlBuffer, htmlBufferLen);
+  htmlBufferLen = 0;
+}
+
+// Add some text (in RAM) to the html response.
+// Args:
+//   str: The text to add.
+//   len: Nr. of bytes of `str` to add.
+void htmlSend(const char *str, size_t len) {
+  while (len) {
+    if (htmlBufferLen == kHtmlBufferSize) htmlFlush();
+    const size_t chunk = std::min(len,
+                                  (size_t)(kHtmlBufferSize - htmlBufferLen));
+    memcpy(htmlBuffer + htmlBufferLen, str, chunk);
+    htmlBufferLen += chunk;
+    str += chunk;
+    len -= chunk;
+  }
+}
+
+void htmlSend(const char *str) { htmlSend(str, strlen(str)); }
+
+void htmlSend(const String &str) { htmlSend(str.c_str(), str.length()); }
+
+void htmlSend(const char c) { htmlSend(&c, 1); }
+
+// Add some text (in flash/PROGMEM) to the html response. e.g. F("text")
+// Args:
+//   str: The text to add.
+void htmlSend(const __FlashStringHelper *str) {
+  PGM_P ptr = reinterpret_cast<PGM_P>(str);
+  size_t len = strlen_P(ptr);
+  while (len) {
+    if (htmlBufferLen == kHtmlBufferSize) htmlFlush();
+    const size_t chunk = std::min(len,
+                                  (size_t)(kHtmlBufferSize - htmlBufferLen));
+    memcpy_P(htmlBuffer + htmlBufferLen, ptr, chunk);
+    htmlBufferLen += chunk;
+    ptr += chunk;
+    len -= chunk;
+  }
+}
+
+// Send the rest of the html response, and end it.
+void htmlFinish(void) {
+  htmlSend(htmlEnd());
+  htmlFlush();
+  server.sendContent("");  // An empty chunk marks the end.
+}
+
 String htmlMenu(void) {
   String html = F("<center>");
   html += htmlButton(kUrlRoot, F("Home"));
@@ -742,17 +820,29 @@ String htmlMenu(void) {
   return html;
 }
 
-String htmlOptionItem(const String value, const String text, bool selected) {
-  String html = F("<option value='");
-  html += value + '\'';
-  if (selected) html += F(" selected='selected'");
-  html += '>' + text + F("</option>");
-  return html;
-}
-
-String htmlSelectAcStateProtocol(const String name, const decode_type_t def,
-                                 const bool simple) {
-  String html = "<select name='" + name + "'>";
+// Start a html <select> element.
+// Args:
+//   name: The name of the element.
+void htmlSelectStart(const String &name) {
+  htmlSend(F("<select name='"));
+  htmlSend(name);
+  htmlSend(F("'>"));
+}
+
+void htmlOptionItem(const String &value, const String &text,
+                    const bool selected) {
+  htmlSend(F("<option value='"));
+  htmlSend(value);
+  htmlSend('\'');
+  if (selected) htmlSend(F(" selected='selected'"));
+  htmlSend('>');
+  htmlSend(text);
+  htmlSend(F("</option>"));
+}
+
+void htmlSelectAcStateProtocol(const String &name, const decode_type_t def,
+                               const bool simple) {
+  htmlSelectStart(name);
   for (uint8_t i = 1; i <= decode_type_t::kLastDecodeType; i++) {
     if (simple ^ hasACState((decode_type_t)i)) {
       switch (i) {
@@ -761,13 +851,11 @@ String htmlSelectAcStateProtocol(const String name, const decode_type_t def,
         case decode_type_t::GLOBALCACHE:
           break;
         default:
-          html += htmlOptionItem(String(i), typeToString((decode_type_t)i),
-                                 i == def);
+          htmlOptionItem(String(i), typeToString((decode_type_t)i), i == def);
       }
     }
   }
-  html += F("</select>");
-  return html;
+  htmlSend(F("</select>"));
 }
 
 // Root web page with example usage etc.
@@ -778,29 +866,30 @@ void handleRoot(void) {
     return server.requestAuthentication();
   }
 #endif
-  String html = htmlHeader(F("ESP IR MQTT Server"));
-  html += F("<center><small><i>" _MY_VERSION_ "</i></small></center>");
-  html += htmlMenu();
-  html += F(
+  htmlStart();
+  htmlSend(htmlHeader(F("ESP IR MQTT Server")));
+  htmlSend(F("<center><small><i>" _MY_VERSION_ "</i></small></center>"));
+  htmlSend(htmlMenu());
+  htmlSend(F(
     "<h3>Send a simple IR message</h3><p>"
     "<form method='POST' action='/ir' enctype='multipart/form-data'>"
-      D_STR_PROTOCOL ": ");
-  html += htmlSelectAcStateProtocol(KEY_TYPE, decode_type_t::NEC, true);
-  html += F(
+      D_STR_PROTOCOL ": "));
+  htmlSelectAcStateProtocol(KEY_TYPE, decode_type_t::NEC, true);
+  htmlSend(F(
       " " D_STR_CODE ": 0x<input type='text' name='" KEY_CODE "' min='0' "
         "value='0' size='16' maxlength='16'> "
       D_STR_BITS ": "
       "<select name='" KEY_BITS "'>"
-        "<option selected='selected' value='0'>Default</option>");  // Default
+        "<option selected='selected' value='0'>Default</option>"));  // Default
   for (uint8_t i = 0; i < sizeof(kCommonBitSizes); i++) {
     String num = String(kCommonBitSizes[i]);
-    html += F("<option value='");
-    html += num;
-    html += F("'>");
-    html += num;
-    html += F("</option>");
+    htmlSend(F("<option value='"));
+    htmlSend(num);
+    htmlSend(F("'>"));
+    htmlSend(num);
+    htmlSend(F("</option>"));
   }
-  html += F(
+  htmlSend(F(
       "</select>"
       " " D_STR_REPEAT ": <input type='number' name='" KEY_REPEAT "' min='0' "
         "max='99' value='0' size='2' maxlength='2'>"
@@ -809,15 +898,15 @@ void handleRoot(void) {
     "<br><hr>"
     "<h3>Send a complex (Air Conditioner) IR message</h3><p>"
     "<form method='POST' action='/ir' enctype='multipart/form-data'>"
-      D_STR_PROTOCOL ": ");
-  html += htmlSelectAcStateProtocol(KEY_TYPE, decode_type_t::KELVINATOR, false);
-  html += F(
+      D_STR_PROTOCOL ": "));
+  htmlSelectAcStateProtocol(KEY_TYPE, decode_type_t::KELVINATOR, false);
+  htmlSend(F(
       " State " D_STR_CODE ": 0x"
-      "<input type='text' name='" KEY_CODE "' size='");
-  html += String(kStateSizeMax * 2);
-  html += F("' maxlength='");
-  html += String(kStateSizeMax * 2);
-  html += F("'"
+      "<input type='text' name='" KEY_CODE "' size='"));
+  htmlSend(String(kStateSizeMax * 2));
+  htmlSend(F("' maxlength='"));
+  htmlSend(String(kStateSizeMax * 2));
+  htmlSend(F("'"
           " value='"
 #if EXAMPLES_ENABLE
                 "190B8050000000E0190B8070000010F0"
@@ -875,9 +964,8 @@ void handleRoot(void) {
           "max='99' value='0' size='2' maxlength='2'>"
       " <input type='submit' value='Send Pronto'>"
     "</form>"
-    "<br>");
-  html += htmlEnd();
-  server.send(200, "text/html", html);
+    "<br>"));
+  htmlFinish();
 }
 
 String addJsReloadUrl(const String url, const uint16_t timeout_s,
@@ -961,41 +1049,41 @@ void handleExamples(void) {
 }
 #endif  // EXAMPLES_ENABLE
 
-String htmlSelectBool(const String name, const bool def) {
-  String html = String(F("<select name='")) + name + F("'>");
+void htmlSelectBool(const String &name, const bool def) {
+  htmlSelectStart(name);
   for (uint16_t i = 0; i < 2; i++)
-    html += htmlOptionItem(IRac::boolToString(i), IRac::boolToString(i),
-                           i == def);
-  html += F("</select>");
-  return html;
-}
-
-String htmlDisableCheckbox(const String name, const String targetControlId,
-                           const bool checked, const String toggleJsFnName) {
-  String html = String(F("<input type='checkbox' name='")) + name + F("' id='")
-    + name + F("' onclick=\"") + toggleJsFnName + F("(this, '") +
-    targetControlId + F("')\"");
-  if (checked) {
-    html += F(" checked");
-  }
-  html += "/><label for='" + name + F("'>Disabled</label>");
-  return html;
-}
-
-String htmlSelectClimateProtocol(const String name, const decode_type_t def) {
-  String html = String(F("<select name='")) + name + F("'>");
+    htmlOptionItem(IRac::boolToString(i), IRac::boolToString(i), i == def);
+  htmlSend(F("</select>"));
+}
+
+void htmlDisableCheckbox(const String &name, const String &targetControlId,
+                         const bool checked, const String &toggleJsFnName) {
+  htmlSend(F("<input type='checkbox' name='"));
+  htmlSend(name);
+  htmlSend(F("' id='"));
+  htmlSend(name);
+  htmlSend(F("' onclick=\""));
+  htmlSend(toggleJsFnName);
+  htmlSend(F("(this, '"));
+  htmlSend(targetControlId);
+  htmlSend(F("')\""));
+  if (checked) htmlSend(F(" checked"));
+  htmlSend(F("/><label for='"));
+  htmlSend(name);
+  htmlSend(F("'>Disabled</label>"));
+}
+
+void htmlSelectClimateProtocol(const String &name, const decode_type_t def) {
+  htmlSelectStart(name);
   for (uint8_t i = 1; i <= decode_type_t::kLastDecodeType; i++) {
-    if (IRac::isProtocolSupported((decode_type_t)i)) {
-      html += htmlOptionItem(String(i), typeToString((decode_type_t)i),
-                             i == def);
-    }
+    if (IRac::isProtocolSupported((decode_type_t)i))
+      htmlOptionItem(String(i), typeToString((decode_type_t)i), i == def);
   }
-  html += F("</select>");
-  return html;
+  htmlSend(F("</select>"));
 }
 
-String htmlSelectModel(const String name, const int16_t def) {
-  String html = String(F("<select name='")) + name + F("'>");
+void htmlSelectModel(const String &name, const int16_t def) {
+  htmlSelectStart(name);
   for (int16_t i = -1; i <= 6; i++) {
     String num = String(i);
     String text;
@@ -1005,86 +1093,79 @@ String htmlSelectModel(const String name, const int16_t def) {
       text = kUnknownStr;
     else
       text = num;
-    html += htmlOptionItem(num, text, i == def);
+    htmlOptionItem(num, text, i == def);
   }
-  html += F("</select>");
-  return html;
+  htmlSend(F("</select>"));
 }
 
-String htmlSelectCommandType(const String name, const stdAc::ac_command_t def) {
-  String html = String(F("<select name='")) + name + F("'>");
+void htmlSelectCommandType(const String &name,
+                           const stdAc::ac_command_t def) {
+  htmlSelectStart(name);
   for (uint8_t i = 0;
        i <= (int8_t)stdAc::ac_command_t::kLastAcCommandEnum;
        i++) {
     String mode = IRac::commandTypeToString((stdAc::ac_command_t)i);
-    html += htmlOptionItem(mode, mode, (stdAc::ac_command_t)i == def);
+    htmlOptionItem(mode, mode, (stdAc::ac_command_t)i == def);
   }
-  html += F("</select>");
-  return html;
+  htmlSend(F("</select>"));
 }
 
-String htmlSelectUint(const String name, const uint16_t max,
-                      const uint16_t def) {
-  String html = String(F("<select name='")) + name + F("'>");
+void htmlSelectUint(const String &name, const uint16_t max,
+                    const uint16_t def) {
+  htmlSelectStart(name);
   for (uint16_t i = 0; i < max; i++) {
     String num = String(i);
-    html += htmlOptionItem(num, num, i == def);
+    htmlOptionItem(num, num, i == def);
   }
-  html += F("</select>");
-  return html;
+  htmlSend(F("</select>"));
 }
 
-String htmlSelectGpio(const String name, const int16_t def,
-                      const int8_t list[], const int16_t length) {
-  String html = String(F(": <select name='")) + name + F("'>");
+void htmlSelectGpio(const String &name, const int16_t def,
+                    const int8_t list[], const int16_t length) {
+  htmlSend(F(": "));
+  htmlSelectStart(name);
   for (int16_t i = 0; i < length; i++) {
     String num = String(list[i]);
-    html += htmlOptionItem(num, list[i] == kGpioUnused ? F("Unused") : num,
-                           list[i] == def);
-    html += F("</option>");
+    htmlOptionItem(num, list[i] == kGpioUnused ? F("Unused") : num,
+                   list[i] == def);
   }
-  html += F("</select>");
-  return html;
+  htmlSend(F("</select>"));
 }
 
-String htmlSelectMode(const String name, const stdAc::opmode_t def) {
-  String html = String(F("<select name='")) + name + F("'>");
+void htmlSelectMode(const String &name, const stdAc::opmode_t def) {
+  htmlSelectStart(name);
   for (int8_t i = -1; i <= (int8_t)stdAc::opmode_t::kLastOpmodeEnum; i++) {
     String mode = IRac::opmodeToString((stdAc::opmode_t)i);
-    html += htmlOptionItem(mode, mode, (stdAc::opmode_t)i == def);
+    htmlOptionItem(mode, mode, (stdAc::opmode_t)i == def);
   }
-  html += F("</select>");
-  return html;
+  htmlSend(F("</select>"));
 }
 
-String htmlSelectFanspeed(const String name, const stdAc::fanspeed_t def) {
-  String html = String(F("<select name='")) + name + F("'>");
+void htmlSelectFanspeed(const String &name, const stdAc::fanspeed_t def) {
+  htmlSelectStart(name);
   for (int8_t i = 0; i <= (int8_t)stdAc::fanspeed_t::kLastFanspeedEnum; i++) {
     String speed = IRac::fanspeedToString((stdAc::fanspeed_t)i);
-    html += htmlOptionItem(speed, speed, (stdAc::fanspeed_t)i == def);
+    htmlOptionItem(speed, speed, (stdAc::fanspeed_t)i == def);
   }
-  html += F("</select>");
-  return html;
+  htmlSend(F("</select>"));
 }
 
-String htmlSelectSwingv(const String name, const stdAc::swingv_t def) {
-  String html = String(F("<select name='")) + name + F("'>");
+void htmlSelectSwingv(const String &name, const stdAc::swingv_t def) {
+  htmlSelectStart(name);
   for (int8_t i = -1; i <= (int8_t)stdAc::swingv_t::kLastSwingvEnum; i++) {
     String swing = IRac::swingvToString((stdAc::swingv_t)i);
-    html += htmlOptionItem(swing, swing, (stdAc::swingv_t)i == def);
+    htmlOptionItem(swing, swing, (stdAc::swingv_t)i == def);
   }
-  html += F("</select>");
-  return html;
+  htmlSend(F("</select>"));
 }
 
-String htmlSelectSwingh(const String name, const stdAc::swingh_t def) {
-  String html = String(F("<select name='")) + name + F("'>");
+void htmlSelectSwingh(const String &name, const stdAc::swingh_t def) {
+  htmlSelectStart(name);
   for (int8_t i = -1; i <= (int8_t)stdAc::swingh_t::kLastSwinghEnum; i++) {
     String swing = IRac::swinghToString((stdAc::swingh_t)i);
-    html += htmlOptionItem(swing, swing, (stdAc::swingh_t)i == def);
+    htmlOptionItem(swing, swing, (stdAc::swingh_t)i == def);
   }
-  html += F("</select>");
-  return html;
+  htmlSend(F("</select>"));
 }
 
 String htmlHeader(const String title, const String h1_text,
@@ -1135,109 +1216,111 @@ String getJsToggleCheckbox(const String functionName) {
 
 // Admin web page
 void handleAirCon(void) {
-  String html = htmlHeader(F("Air Conditioner Control"), "",
-                           getJsToggleCheckbox());
-  html += htmlMenu();
+  htmlStart();
+  htmlSend(htmlHeader(F("Air Conditioner Control"), "",
+                      getJsToggleCheckbox()));
+  htmlSend(htmlMenu());
   if (kNrOfIrTxGpios > 1) {
-    html += String(F("<form method='POST' action='/aircon/set'"
+    htmlSend(F("<form method='POST' action='/aircon/set'"
         " enctype='multipart/form-data'>"
         "<table>"
-        "<tr><td><b>Climate #</b></td><td>")) +
-        htmlSelectUint(KEY_CHANNEL, kNrOfIrTxGpios, chan) +
-        F("<input type='submit' value='Change'>"
+        "<tr><td><b>Climate #</b></td><td>"));
+    htmlSelectUint(KEY_CHANNEL, kNrOfIrTxGpios, chan);
+    htmlSend(F("<input type='submit' value='Change'>"
         "</td></tr>"
         "</table>"
         "</form>"
-        "<hr>");
+        "<hr>"));
   }
   if (climate[chan] != NULL) {
-    bool noSensorTemp = (climate[chan]->next.sensorTemperature == kNoTempValue);
-    html += String(F("<h3>Current Settings</h3>"
+    const stdAc::state_t &next = climate[chan]->next;
+    bool noSensorTemp = (next.sensorTemperature == kNoTempValue);
+    htmlSend(F("<h3>Current Settings</h3>"
         "<form method='POST' action='/aircon/set'"
         " enctype='multipart/form-data'>"
-        "<input type='hidden' name='" KEY_CHANNEL "' value='")) + String(chan)
-            + F("'>") +
-        F("<table style='width:33%'>"
-        "<tr><td>" D_STR_PROTOCOL "</td><td>") +
-            htmlSelectClimateProtocol(KEY_PROTOCOL,
-                                      climate[chan]->next.protocol) +
-            F("</td></tr>"
-        "<tr><td>" D_STR_MODEL "</td><td>") +
-            htmlSelectModel(KEY_MODEL, climate[chan]->next.model) +
-            F("</td></tr>"
-        "<tr><td>" D_STR_COMMAND "</td><td>") +
-            htmlSelectCommandType(KEY_COMMAND, climate[chan]->next.command) +
-            F("</td></tr>"
-        "<tr><td>" D_STR_POWER "</td><td>") +
-            htmlSelectBool(KEY_POWER, climate[chan]->next.power) +
-            F("</td></tr>"
-        "<tr><td>" D_STR_MODE "</td><td>") +
-            htmlSelectMode(KEY_MODE, climate[chan]->next.mode) +
-            F("</td></tr>"
+        "<input type='hidden' name='" KEY_CHANNEL "' value='"));
+    htmlSend(String(chan));
+    htmlSend(F("'>"
+        "<table style='width:33%'>"
+        "<tr><td>" D_STR_PROTOCOL "</td><td>"));
+    htmlSelectClimateProtocol(KEY_PROTOCOL, next.protocol);
+    htmlSend(F("</td></tr>"
+        "<tr><td>" D_STR_MODEL "</td><td>"));
+    htmlSelectModel(KEY_MODEL, next.model);
+    htmlSend(F("</td></tr>"
+        "<tr><td>" D_STR_COMMAND "</td><td>"));
+    htmlSelectCommandType(KEY_COMMAND, next.command);
+    htmlSend(F("</td></tr>"
+        "<tr><td>" D_STR_POWER "</td><td>"));
+    htmlSelectBool(KEY_POWER, next.power);
+    htmlSend(F("</td></tr>"
+        "<tr><td>" D_STR_MODE "</td><td>"));
+    htmlSelectMode(KEY_MODE, next.mode);
+    htmlSend(F("</td></tr>"
         "<tr><td>" D_STR_TEMP "</td><td>"
             "<input type='number' name='" KEY_TEMP "' min='16' max='90' "
-            "step='0.5' value='") + String(climate[chan]->next.degrees, 1) +
-            F("'>"
+            "step='0.5' value='"));
+    htmlSend(String(next.degrees, 1));
+    htmlSend(F("'>"
             "<select name='" KEY_CELSIUS "'>"
-                "<option value='on'") +
-                (climate[chan]->next.celsius ? " selected='selected'" : "") +
-                ">C</option>"
-                "<option value='off'" +
-                (!climate[chan]->next.celsius ? " selected='selected'" : "") +
-                F(">F</option>"
+                "<option value='on'"));
+    if (next.celsius) htmlSend(F(" selected='selected'"));
+    htmlSend(F(">C</option>"
+                "<option value='off'"));
+    if (!next.celsius) htmlSend(F(" selected='selected'"));
+    htmlSend(F(">F</option>"
             "</select></td></tr>"
         "<tr><td>" D_STR_SENSORTEMP "</td><td>"
             "<input type='number' name='" KEY_SENSORTEMP "' "
-            "id='" KEY_SENSORTEMP "' min='16' max='90' step='0.5' value='") +
-            (noSensorTemp ? String(climate[chan]->next.degrees, 1) :
-                            String(climate[chan]->next.sensorTemperature, 1)) +
-            F("'") +
-            (noSensorTemp ? " disabled" : "") + F(">") +
-            htmlDisableCheckbox(KEY_SENSORTEMP_DISABLED, KEY_SENSORTEMP,
-                                noSensorTemp) +
-            F("</td></tr>"
-        "<tr><td>" D_STR_FAN "</td><td>") +
-            htmlSelectFanspeed(KEY_FANSPEED, climate[chan]->next.fanspeed) +
-            F("</td></tr>"
-        "<tr><td>" D_STR_SWINGV "</td><td>") +
-            htmlSelectSwingv(KEY_SWINGV, climate[chan]->next.swingv) +
-            F("</td></tr>"
-        "<tr><td>" D_STR_SWINGH "</td><td>") +
-            htmlSelectSwingh(KEY_SWINGH, climate[chan]->next.swingh) +
-            F("</td></tr>"
-        "<tr><td>" D_STR_QUIET "</td><td>") +
-            htmlSelectBool(KEY_QUIET, climate[chan]->next.quiet) +
-            F("</td></tr>"
-        "<tr><td>" D_STR_IFEEL "</td><td>") +
-            htmlSelectBool(KEY_IFEEL, climate[chan]->next.iFeel) +
-            F("</td></tr>"
-        "<tr><td>" D_STR_TURBO "</td><td>") +
-            htmlSelectBool(KEY_TURBO, climate[chan]->next.turbo) +
-            F("</td></tr>"
-        "<tr><td>" D_STR_ECONO "</td><td>") +
-            htmlSelectBool(KEY_ECONO, climate[chan]->next.econo) +
-            F("</td></tr>"
-        "<tr><td>" D_STR_LIGHT "</td><td>") +
-            htmlSelectBool(KEY_LIGHT, climate[chan]->next.light) +
-            F("</td></tr>"
-        "<tr><td>" D_STR_FILTER "</td><td>") +
-            htmlSelectBool(KEY_FILTER, climate[chan]->next.filter) +
-            F("</td></tr>"
-        "<tr><td>" D_STR_CLEAN "</td><td>") +
-            htmlSelectBool(KEY_CLEAN, climate[chan]->next.clean) +
-            F("</td></tr>"
-        "<tr><td>" D_STR_BEEP "</td><td>") +
-            htmlSelectBool(KEY_BEEP, climate[chan]->next.beep) +
-            F("</td></tr>"
-        "<tr><td>Force resend</td><td>") +
-            htmlSelectBool(KEY_RESEND, false) +
-            F("</td></tr>"
+            "id='" KEY_SENSORTEMP "' min='16' max='90' step='0.5' value='"));
+    htmlSend(noSensorTemp ? String(next.degrees, 1) :
+                            String(next.sensorTemperature, 1));
+    htmlSend('\'');
+    if (noSensorTemp) htmlSend(F(" disabled"));
+    htmlSend('>');
+    htmlDisableCheckbox(KEY_SENSORTEMP_DISABLED, KEY_SENSORTEMP, noSensorTemp);
+    htmlSend(F("</td></tr>"
+        "<tr><td>" D_STR_FAN "</td><td>"));
+    htmlSelectFanspeed(KEY_FANSPEED, next.fanspeed);
+    htmlSend(F("</td></tr>"
+        "<tr><td>" D_STR_SWINGV "</td><td>"));
+    htmlSelectSwingv(KEY_SWINGV, next.swingv);
+    htmlSend(F("</td></tr>"
+        "<tr><td>" D_STR_SWINGH "</td><td>"));
+    htmlSelectSwingh(KEY_SWINGH, next.swingh);
+    htmlSend(F("</td></tr>"
+        "<tr><td>" D_STR_QUIET "</td><td>"));
+    htmlSelectBool(KEY_QUIET, next.quiet);
+    htmlSend(F("</td></tr>"
+        "<tr><td>" D_STR_IFEEL "</td><td>"));
+    htmlSelectBool(KEY_IFEEL, next.iFeel);
+    htmlSend(F("</td></tr>"
+        "<tr><td>" D_STR_TURBO "</td><td>"));
+    htmlSelectBool(KEY_TURBO, next.turbo);
+    htmlSend(F("</td></tr>"
+        "<tr><td>" D_STR_ECONO "</td><td>"));
+    htmlSelectBool(KEY_ECONO, next.econo);
+    htmlSend(F("</td></tr>"
+        "<tr><td>" D_STR_LIGHT "</td><td>"));
+    htmlSelectBool(KEY_LIGHT, next.light);
+    htmlSend(F("</td></tr>"
+        "<tr><td>" D_STR_FILTER "</td><td>"));
+    htmlSelectBool(KEY_FILTER, next.filter);
+    htmlSend(F("</td></tr>"
+        "<tr><td>" D_STR_CLEAN "</td><td>"));
+    htmlSelectBool(KEY_CLEAN, next.clean);
+    htmlSend(F("</td></tr>"
+        "<tr><td>" D_STR_BEEP "</td><td>"));
+    htmlSelectBool(KEY_BEEP, next.beep);
+    htmlSend(F("</td></tr>"
+        "<tr><td>Force resend</td><td>"));
+    htmlSelectBool(KEY_RESEND, false);
+    htmlSend(F("</td></tr>"
         "</table>"
         "<input type='submit' value='Update & Send'>"
-        "</form>");
+        "</form>"));
   }
-  html += htmlEnd();
-  server.send(200, "text/html", html);
+  htmlFinish();
 }
 
 // Parse the URL args to find the Common A/C arguments.
@@ -1360,135 +1443,267 @@ uint32_t maxSketchSpace(void) {
 String vccToString(void) { return String(ESP.getVcc() / 1000.0); }
 #endif  // REPORT_VCC
 
+#if REPORT_TX_STATS
+// Send the transmit timing stats, as a html table.
+void txStatsHtml(void) {
+  ir_tx_stats_t stats[kTxStatsMaxProtocols];
+  const uint8_t count = IRsend::getTxStats(stats, kTxStatsMaxProtocols);
+  htmlSend(F("<h4>Transmit Timing</h4>"
+             "<p>Errors are in uSeconds. Overruns are intervals that "
+             "ran over by more than "));
+  htmlSend(String(kTxStatsOverrunDefault));
+  htmlSend(F(
+      "us.</p>"
+      "<table border='1'><tr><th>Protocol</th><th>Sends</th>"
+      "<th>Intervals</th><th>Mean error</th><th>Max error</th>"
+      "<th>Overruns</th></tr>"));
+  for (uint8_t i = 0; i < count; i++) {
+    if (!stats[i].sends) continue;  // Nothing sent. (i.e. No intervals)
+    htmlSend(F("<tr><td>"));
+    htmlSend(typeToString(stats[i].protocol));
+    htmlSend(F("</td><td>"));
+    htmlSend(String(stats[i].sends));
+    htmlSend(F("</td><td>"));
+    htmlSend(String(stats[i].intervals));
+    htmlSend(F("</td><td>"));
+    htmlSend(String(stats[i].total_error / stats[i].intervals));
+    htmlSend(F("</td><td>"));
+    htmlSend(String(stats[i].max_error));
+    htmlSend(F("</td><td>"));
+    htmlSend(String(stats[i].overruns));
+    htmlSend(F("</td></tr>"));
+  }
+  htmlSend(F("</table>"));
+}
+
+#if MQTT_ENABLE
+// The transmit timing stats, as JSON. e.g.
+//   {"NEC":{"sends":2,"intervals":136,"mean":1,"max":100,"overruns":18}}
+String txStatsJson(void) {
+  ir_tx_stats_t stats[kTxStatsMaxProtocols];
+  const uint8_t count = IRsend::getTxStats(stats, kTxStatsMaxProtocols);
+  String json = "{";
+  for (uint8_t i = 0; i < count; i++) {
+    if (!stats[i].sends) continue;  // Nothing sent. (i.e. No intervals)
+    if (json.length() > 1) json += ',';
+    json += '"';
+    json += typeToString(stats[i].protocol) + F("\":{\"sends\":") +
+        String(stats[i].sends) + F(",\"intervals\":") +
+        String(stats[i].intervals) + F(",\"mean\":") +
+        String(stats[i].total_error / stats[i].intervals) +
+        F(",\"max\":") + String(stats[i].max_error) +
+        F(",\"overruns\":") + String(stats[i].overruns) + '}';
+  }
+  return json + '}';
+}
+#endif  // MQTT_ENABLE
+#endif  // REPORT_TX_STATS
+
 // Info web page
 void handleInfo(void) {
-  String html = htmlHeader(F("IR MQTT server info"));
-  html += htmlMenu();
-  html +=
-    String(F("<h3>General</h3>"
-    "<p>Hostname: ")) + String(Hostname) + F("<br>"
-    "IP address: ") + WiFi.localIP().toString() + F("<br>"
-    "MAC address: ") + WiFi.macAddress() + F("<br>"
-    "Booted: ") + timeSince(1) + F("<br>") +
-    F("Version: " _MY_VERSION_ "<br>"
-    "Built: " __DATE__
-      " " __TIME__ "<br>"
-    "Period Offset: ") + String(offset) + F("us<br>"
-    "IR Lib Version: " _IRREMOTEESP8266_VERSION_STR "<br>"
+  htmlStart();
+  htmlSend(htmlHeader(F("IR MQTT server info")));
+  htmlSend(htmlMenu());
+  htmlSend(F("<h3>General</h3>"
+             "<p>Hostname: "));
+  htmlSend(Hostname);
+  htmlSend(F("<br>IP address: "));
+  htmlSend(WiFi.localIP().toString());
+  htmlSend(F("<br>MAC address: "));
+  htmlSend(WiFi.macAddress());
+  htmlSend(F("<br>Booted: "));
+  htmlSend(timeSince(1));
+  htmlSend(F("<br>"
+             "Version: " _MY_VERSION_ "<br>"
+             "Built: " __DATE__ " " __TIME__ "<br>"
+             "Period Offset: "));
+  htmlSend(String(offset));
+  htmlSend(F("us<br>"
+             "IR Lib Version: " _IRREMOTEESP8266_VERSION_STR "<br>"));
 #if defined(ESP8266)
-    "ESP8266 Core Version: ") + ESP.getCoreVersion() + F("<br>"
-    "Free Sketch Space: ") + String(maxSketchSpace() >> 10) + F("k<br>"
+  htmlSend(F("ESP8266 Core Version: "));
+  htmlSend(ESP.getCoreVersion());
+  htmlSend(F("<br>Free Sketch Space: "));
+  htmlSend(String(maxSketchSpace() >> 10));
+  htmlSend(F("k<br>"));
 #endif  // ESP8266
 #if defined(ESP32)
-    "ESP32 SDK Version: ") + ESP.getSdkVersion() + F("<br>"
+  htmlSend(F("ESP32 SDK Version: "));
+  htmlSend(ESP.getSdkVersion());
+  htmlSend(F("<br>"));
 #endif  // ESP32
-    "Cpu Freq: ") + String(ESP.getCpuFreqMHz()) + F("MHz<br>"
-    "Sanity Check: ") + String((_sanity == 0) ? F("Ok") : F("FAILED")) +
-    F("<br>"
-    "IR Send GPIO(s): ") + listOfTxGpios() + F("<br>")
-    + irutils::addBoolToString(kInvertTxOutput,
-                               F("Inverting GPIO output"), false) + F("<br>"
-    "Total send requests: ") + String(sendReqCounter) + F("<br>"
-    "Last message sent: ") + String(lastSendSucceeded ? F("Ok") : F("FAILED")) +
-    F(" <i>(") + timeSince(lastSendTime) + F(")</i><br>"
+  htmlSend(F("Cpu Freq: "));
+  htmlSend(String(ESP.getCpuFreqMHz()));
+  htmlSend(F("MHz<br>Sanity Check: "));
+  htmlSend((_sanity == 0) ? F("Ok") : F("FAILED"));
+  htmlSend(F("<br>Main loop: "));
+  htmlSend(String(loopRate));
+  htmlSend(F(" passes/sec, pass time avg "));
+  htmlSend(String(loopAvgUs));
+  htmlSend(F("us, max "));
+  htmlSend(String(loopMaxUs));
+  htmlSend(F("us<br>IR Send GPIO(s): "));
+  htmlSend(listOfTxGpios());
+  htmlSend(F("<br>"));
+  htmlSend(irutils::addBoolToString(kInvertTxOutput,
+                                    F("Inverting GPIO output"), false));
+  htmlSend(F("<br>Total send requests: "));
+  htmlSend(String(sendReqCounter));
+  htmlSend(F("<br>Last message sent: "));
+  htmlSend(lastSendSucceeded ? F("Ok") : F("FAILED"));
+  htmlSend(F(" <i>("));
+  htmlSend(timeSince(lastSendTime));
+  htmlSend(F(")</i><br>"));
 #if IR_RX
-    "IR Recv GPIO: ") + gpioToString(rx_gpio) + F(
+  htmlSend(F("IR Recv GPIO: "));
+  htmlSend(gpioToString(rx_gpio));
+  htmlSend(F(
 #if IR_RX_PULLUP
-    " (pullup)"
+      " (pullup)"
 #endif  // IR_RX_PULLUP
-    "<br>"
-    "Total IR Received: ") + String(irRecvCounter) + F("<br>"
-    "Last IR Received: ") + lastIrReceived +
-    F(" <i>(") + timeSince(lastIrReceivedTime) + F(")</i><br>"
+      "<br>"
+      "Total IR Received: "));
+  htmlSend(String(irRecvCounter));
+  htmlSend(F("<br>Last IR Received: "));
+  htmlSend(lastIrReceived);
+  htmlSend(F(" <i>("));
+  htmlSend(timeSince(lastIrReceivedTime));
+  htmlSend(F(")</i><br>"));
 #endif  // IR_RX
-    "Duplicate " D_STR_WIFI " networks: ") +
-        String(HIDE_DUPLICATE_NETWORKS ? F("Hide") : F("Show")) + F("<br>"
-    "Min " D_STR_WIFI " signal required: "
+  htmlSend(F("Duplicate " D_STR_WIFI " networks: "));
+  htmlSend(HIDE_DUPLICATE_NETWORKS ? F("Hide") : F("Show"));
+  htmlSend(F("<br>Min " D_STR_WIFI " signal required: "));
 #ifdef MIN_SIGNAL_STRENGTH
-        ) +  // NOLINT(whitespace/parens)
-        String(static_cast<int>(MIN_SIGNAL_STRENGTH)) + F(
+  htmlSend(String(static_cast<int>(MIN_SIGNAL_STRENGTH)));
 #else  // MIN_SIGNAL_STRENGTH
-        "8"
+  htmlSend('8');
 #endif  // MIN_SIGNAL_STRENGTH
-        "%<br>"
-    "Serial debugging: "
+  htmlSend(F("%<br>Serial debugging: "));
 #if DEBUG
-        ) +  // NOLINT(whitespace/parens)
-        String(isSerialGpioUsedByIr() ? D_STR_OFF : D_STR_ON) + F(
+  htmlSend(isSerialGpioUsedByIr() ? D_STR_OFF : D_STR_ON);
 #else  // DEBUG
-        D_STR_OFF
+  htmlSend(D_STR_OFF);
 #endif  // DEBUG
-        "<br>"
+  htmlSend(F("<br>"));
 #if REPORT_VCC
-    "Vcc: ");
-    html += vccToString();
-    html += F("V<br>"
+  htmlSend(F("Vcc: "));
+  htmlSend(vccToString());
+  htmlSend(F("V<br>"));
 #endif  // REPORT_VCC
-    "</p>"
+  htmlSend(F("</p>"));
 #if MQTT_ENABLE
-    "<h4>MQTT Information</h4>"
-    "<p>Server: ") + String(MqttServer) + ":" + String(MqttPort) + F(" <i>(") +
-    (mqtt_client.connected() ? "Connected " + timeSince(lastDisconnectedTime)
-                             : "Disconnected " + timeSince(lastConnectedTime)) +
-    F(")</i><br>"
-    "Disconnections: ") + String(mqttDisconnectCounter - 1) + F("<br>"
-    "Buffer Size: ") + String(mqtt_client.getBufferSize()) + F(" bytes<br>"
-    "Client id: ") + MqttClientId + F("<br>"
-    "Command topic(s): ") + listOfCommandTopics() + F("<br>"
-    "Acknowledgements topic: ") + MqttAck + F("<br>"
+  htmlSend(F("<h4>MQTT Information</h4>"
+             "<p>Server: "));
+  htmlSend(MqttServer);
+  htmlSend(':');
+  htmlSend(MqttPort);
+  htmlSend(F(" <i>("));
+  if (mqtt_client.connected()) {
+    htmlSend(F("Connected "));
+    htmlSend(timeSince(lastDisconnectedTime));
+  } else {
+    htmlSend(F("Disconnected "));
+    htmlSend(timeSince(lastConnectedTime));
+  }
+  htmlSend(F(")</i><br>Disconnections: "));
+  htmlSend(String(mqttDisconnectCounter - 1));
+  htmlSend(F("<br>Buffer Size: "));
+  htmlSend(String(mqtt_client.getBufferSize()));
+  htmlSend(F(" bytes<br>Client id: "));
+  htmlSend(MqttClientId);
+  htmlSend(F("<br>Command topic(s): "));
+  htmlSend(listOfCommandTopics());
+  htmlSend(F("<br>Acknowledgements topic: "));
+  htmlSend(MqttAck);
+  htmlSend(F("<br>"));
 #if IR_RX
-    "IR Received topic: ") + MqttRecv + F("<br>"
+  htmlSend(F("IR Received topic: "));
+  htmlSend(MqttRecv);
+  htmlSend(F("<br>"));
 #endif  // IR_RX
-    "Log topic: ") + MqttLog + F("<br>"
-    "LWT topic: ") + MqttLwt + F("<br>"
-    "QoS: ") + String(QOS) + F("<br>"
-    // lastMqttCmd* is unescaped untrusted input.
-    // Avoid any possible HTML/XSS when displaying it.
-    "Last MQTT command seen: (topic) '") +
-        irutils::htmlEscape(lastMqttCmdTopic) +
-         F("' (payload) '") + irutils::htmlEscape(lastMqttCmd) + F("' <i>(") +
-         timeSince(lastMqttCmdTime) + F(")</i><br>"
-    "Total published: ") + String(mqttSentCounter) + F("<br>"
-    "Total received: ") + String(mqttRecvCounter) + F("<br>"
-    "</p>"
+  htmlSend(F("Log topic: "));
+  htmlSend(MqttLog);
+  htmlSend(F("<br>LWT topic: "));
+  htmlSend(MqttLwt);
+  htmlSend(F("<br>QoS: "));
+  htmlSend(String(QOS));
+  // lastMqttCmd* is unescaped untrusted input.
+  // Avoid any possible HTML/XSS when displaying it.
+  htmlSend(F("<br>Last MQTT command seen: (topic) '"));
+  htmlSend(irutils::htmlEscape(lastMqttCmdTopic));
+  htmlSend(F("' (payload) '"));
+  htmlSend(irutils::htmlEscape(lastMqttCmd));
+  htmlSend(F("' <i>("));
+  htmlSend(timeSince(lastMqttCmdTime));
+  htmlSend(F(")</i><br>Total published: "));
+  htmlSend(String(mqttSentCounter));
+  htmlSend(F("<br>Total received: "));
+  htmlSend(String(mqttRecvCounter));
+  htmlSend(F("<br></p>"));
 #endif  // MQTT_ENABLE
-    "<h4>Climate Information</h4>"
-    "<p>"
-    "IR Send GPIO: ") + String(txGpioTable[0]) + F("<br>"
-    "Last update source: ") + lastClimateSource + F("<br>"
-    "Total sent: ") + String(irClimateCounter) + F("<br>"
-    "Last send: ") + String(hasClimateBeenSent ?
-        (String(lastClimateSucceeded ? "Ok" : "FAILED") +
-         " <i>(" + timeElapsed(lastClimateIr.elapsed()) + ")</i>") :
-        "<i>Never</i>") + F("<br>"
+  htmlSend(F("<h4>Climate Information</h4>"
+             "<p>"
+             "IR Send GPIO: "));
+  htmlSend(String(txGpioTable[0]));
+  htmlSend(F("<br>Last update source: "));
+  htmlSend(lastClimateSource);
+  htmlSend(F("<br>Total sent: "));
+  htmlSend(String(irClimateCounter));
+  htmlSend(F("<br>Last send: "));
+  if (hasClimateBeenSent) {
+    htmlSend(lastClimateSucceeded ? F("Ok") : F("FAILED"));
+    htmlSend(F(" <i>("));
+    htmlSend(timeElapsed(lastClimateIr.elapsed()));
+    htmlSend(F(")</i>"));
+  } else {
+    htmlSend(F("<i>Never</i>"));
+  }
+  htmlSend(F("<br>"));
 #if MQTT_ENABLE
-    "State listen period: ") + msToString(kStatListenPeriodMs) + F("<br>"
-    "State broadcast period: ") + msToString(kBroadcastPeriodMs) + F("<br>"
-    "Last state broadcast: ") + (hasBroadcastBeenSent ?
-        timeElapsed(lastBroadcast.elapsed()) :
-        String(F("<i>Never</i>"))) + F("<br>"
+  htmlSend(F("State listen period: "));
+  htmlSend(msToString(kStatListenPeriodMs));
+  htmlSend(F("<br>State broadcast period: "));
+  htmlSend(msToString(kBroadcastPeriodMs));
+  htmlSend(F("<br>Last state broadcast: "));
+  if (hasBroadcastBeenSent)
+    htmlSend(timeElapsed(lastBroadcast.elapsed()));
+  else
+    htmlSend(F("<i>Never</i>"));
+  htmlSend(F("<br>"));
 #if MQTT_DISCOVERY_ENABLE
-    "Last discovery sent: ") + (lockMqttBroadcast ?
-        String(F("<b>Locked</b>")) :
-        (hasDiscoveryBeenSent ?
-            timeElapsed(lastDiscovery.elapsed()) :
-            String(F("<i>Never</i>")))) +
-        F("<br>"
-    "Discovery topic: ") + MqttDiscovery + F("<br>") + F(
+  htmlSend(F("Last discovery sent: "));
+  if (lockMqttBroadcast)
+    htmlSend(F("<b>Locked</b>"));
+  else if (hasDiscoveryBeenSent)
+    htmlSend(timeElapsed(lastDiscovery.elapsed()));
+  else
+    htmlSend(F("<i>Never</i>"));
+  htmlSend(F("<br>Discovery topic: "));
+  htmlSend(MqttDiscovery);
+  htmlSend(F("<br>"));
 #endif  // MQTT_DISCOVERY_ENABLE
-    "Command topics: ") + MqttClimate + channel_re +
-        F("/" MQTT_CLIMATE_CMND "/") + FPSTR(kClimateTopics) +
-    F("State topics: ") + MqttClimate + channel_re +
-        F("/" MQTT_CLIMATE_STAT "/") + FPSTR(kClimateTopics) + F(
+  htmlSend(F("Command topics: "));
+  htmlSend(MqttClimate);
+  htmlSend(channel_re);
+  htmlSend(F("/" MQTT_CLIMATE_CMND "/"));
+  htmlSend(FPSTR(kClimateTopics));
+  htmlSend(F("State topics: "));
+  htmlSend(MqttClimate);
+  htmlSend(channel_re);
+  htmlSend(F("/" MQTT_CLIMATE_STAT "/"));
+  htmlSend(FPSTR(kClimateTopics));
 #endif  // MQTT_ENABLE
-    "</p>"
+  htmlSend(F("</p>"));
+#if REPORT_TX_STATS
+  txStatsHtml();
+#endif  // REPORT_TX_STATS
+  htmlSend(F(
     // Page footer
     "<hr><p><small><center>"
       "<i>(Note: Page will refresh every 60 " D_STR_SECONDS ".)</i>"
-    "<centre></small></p>");
-  html += addJsReloadUrl(kUrlInfo, 60, false);
-  html += htmlEnd();
-  server.send(200, "text/html", html);
+    "<centre></small></p>"));
+  htmlSend(addJsReloadUrl(kUrlInfo, 60, false));
+  htmlFinish();
 }
 
 void doRestart(const char* str, const bool serial_only) {
@@ -1755,39 +1970,10 @@ bool parseStringAndSendAirCon(IRsend *irsend, const decode_type_t irType,
   return true;  // We were successful as far as we can tell.
 }
 
-// Count how many values are in the String.
-// Args:
-//   str:  String containing the values.
-//   sep:  Character that separates the values.
-// Returns:
-//   The number of values found in the String.
-uint16_t countValuesInStr(const String str, char sep) {
-  int16_t index = -1;
-  uint16_t count = 1;
-  do {
-    index = str.indexOf(sep, index + 1);
-    count++;
-  } while (index != -1);
-  return count;
-}
-
-// Dynamically allocate an array of uint16_t's.
-// Args:
-//   size:  Nr. of uint16_t's need to be in the new array.
-// Returns:
-//   A Ptr to the new array. Restarts the ESP if it fails.
-uint16_t * newCodeArray(const uint16_t size) {
-  uint16_t *result;
-
-  result = reinterpret_cast<uint16_t*>(malloc(size * sizeof(uint16_t)));
-  // Check we malloc'ed successfully.
-  if (result == NULL)  // malloc failed, so give up.
-    doRestart(
-        PSTR("FATAL: Can't allocate memory for an array for a new message! "
-             "Forcing a reboot!"),
-        true);  // Send to serial only as we are in low mem
-  return result;
-}
+#if (SEND_GLOBALCACHE || SEND_PRONTO || SEND_RAW)
+// Storage for the values of a GlobalCache, Pronto, or raw code being sent.
+uint16_t codeValues[kCodeValuesMax];
+#endif  // (SEND_GLOBALCACHE || SEND_PRONTO || SEND_RAW)
 
 #if SEND_GLOBALCACHE
 // Parse a GlobalCache String/code and send it.
@@ -1802,37 +1988,14 @@ uint16_t * newCodeArray(const uint16_t size) {
 // Returns:
 //   bool: Successfully sent or not.
 bool parseStringAndSendGC(IRsend *irsend, const String str) {
-  uint16_t count;
-  uint16_t *code_array;
-  String tmp_str;
-
-  // Remove the leading "1:1,1," if present.
-  if (str.startsWith(PSTR("1:1,1,")))
-    tmp_str = str.substring(6);
-  else
-    tmp_str = str;
-
-  // Find out how many items there are in the string.
-  count = countValuesInStr(tmp_str, ',');
-
-  // Now we know how many there are, allocate the memory to store them all.
-  code_array = newCodeArray(count);
-
-  // Now convert the strings to integers and place them in code_array.
-  count = 0;
-  uint16_t start_from = 0;
-  int16_t index = -1;
-  do {
-    index = tmp_str.indexOf(',', start_from);
-    code_array[count] = tmp_str.substring(start_from, index).toInt();
-    start_from = index + 1;
-    count++;
-  } while (index != -1);
-  irsend->sendGC(code_array, count);  // All done. Send it.
-  free(code_array);  // Free up the memory allocated.
-  if (count > 0)
-    return true;  // We sent something.
-  return false;  // We probably didn't.
+  const char *code = str.c_str();
+  // Skip the leading "1:1,1," if present.
+  if (str.startsWith(PSTR("1:1,1,"))) code += 6;
+  const uint16_t count = IRvalueParser::parse(code, codeValues,
+                                              kCodeValuesMax);
+  if (!count) return false;  // Malformed, or too long.
+  irsend->sendGC(codeValues, count);  // All done. Send it.
+  return true;
 }
 #endif  // SEND_GLOBALCACHE
 
@@ -1847,6 +2010,7 @@ bool parseStringAndSendGC(IRsend *irsend, const String str) {
 //              0030,0018,0018,0018,0018,0018,0030,0018,0018,03f6"
 //              or
 //              "0000,0067,0000,0015,0060,0018". i.e. without the Repeat value
+//              The values may have a "0x" prefix. e.g. "0x0000,0x0067,..."
 //        Requires at least kProntoMinLength comma-separated values.
 //        sendPronto() only supports raw pronto code types, thus so does this.
 //   repeats:  Nr. of times the message is to be repeated.
@@ -1855,46 +2019,22 @@ bool parseStringAndSendGC(IRsend *irsend, const String str) {
 //   bool: Successfully sent or not.
 bool parseStringAndSendPronto(IRsend *irsend, const String str,
                               uint16_t repeats) {
-  uint16_t count;
-  uint16_t *code_array;
-  int16_t index = -1;
-  uint16_t start_from = 0;
-
-  // Find out how many items there are in the string.
-  count = countValuesInStr(str, ',');
-
+  const char *code = str.c_str();
   // Check if we have the optional embedded repeats value in the code string.
-  if (str.startsWith("R") || str.startsWith("r")) {
+  if (code[0] == 'R' || code[0] == 'r') {
+    IRvalueParser parser;
+    code++;  // Skip the 'R'.
     // Grab the first value from the string, as it is the nr. of repeats.
-    index = str.indexOf(',', start_from);
-    repeats = str.substring(start_from + 1, index).toInt();  // Skip the 'R'.
-    start_from = index + 1;
-    count--;  // We don't count the repeats value as part of the code array.
+    if (!parser.next(&code)) return false;
+    repeats = parser.value();
   }
-
+  // Rest of the string are hexadecimal values for the code array.
+  const uint16_t count = IRvalueParser::parse(code, codeValues,
+                                              kCodeValuesMax, 16);
   // We need at least kProntoMinLength values for the code part.
   if (count < kProntoMinLength) return false;
-
-  // Now we know how many there are, allocate the memory to store them all.
-  code_array = newCodeArray(count);
-
-  // Rest of the string are values for the code array.
-  // Now convert the hex strings to integers and place them in code_array.
-  count = 0;
-  do {
-    index = str.indexOf(',', start_from);
-    // Convert the hexadecimal value string to an unsigned integer.
-    code_array[count] = strtoul(str.substring(start_from, index).c_str(),
-                                NULL, 16);
-    start_from = index + 1;
-    count++;
-  } while (index != -1);
-
-  irsend->sendPronto(code_array, count, repeats);  // All done. Send it.
-  free(code_array);  // Free up the memory allocated.
-  if (count > 0)
-    return true;  // We sent something.
-  return false;  // We probably didn't.
+  irsend->sendPronto(codeValues, count, repeats);  // All done. Send it.
+  return true;
 }
 #endif  // SEND_PRONTO
 
@@ -1909,40 +2049,46 @@ bool parseStringAndSendPronto(IRsend *irsend, const String str,
 // Returns:
 //   bool: Successfully sent or not.
 bool parseStringAndSendRaw(IRsend *irsend, const String str) {
-  uint16_t count;
-  uint16_t freq = 38000;  // Default to 38kHz.
-  uint16_t *raw_array;
-
-  // Find out how many items there are in the string.
-  count = countValuesInStr(str, ',');
-
-  // We expect the frequency as the first comma separated value, so we need at
-  // least two values. If not, bail out.
-  if (count < 2)  return false;
-  count--;  // We don't count the frequency value as part of the raw array.
-
-  // Now we know how many there are, allocate the memory to store them all.
-  raw_array = newCodeArray(count);
+  IRvalueParser parser;
+  const char *code = str.c_str();
 
   // Grab the first value from the string, as it is the frequency.
-  int16_t index = str.indexOf(',', 0);
-  freq = str.substring(0, index).toInt();
-  uint16_t start_from = index + 1;
+  if (!parser.next(&code)) return false;
+  const uint16_t freq = parser.value();
+  const char *data_start = code;
+
+  // Most codes only use a handful of distinct durations, so try to build a
+  // compact symbol encoded frame on the stack first. It is built as the text
+  // is parsed, so the whole code never needs to be stored as-is. Durations
+  // within kRawSymbolsTolerance of each other are sent as their average, as
+  // captured codes rarely repeat the same duration exactly.
+  uint16_t durations[kSymbolsMaxDurations];
+  ir_symbol_totals_t totals;
+  uint8_t symbols[kRawSymbolsMaxBytes];
+  ir_symbol_frame_t frame;
+  frame.hz = freq;
+  frame.length = 0;
+  frame.bits = 4;
+  frame.nr_durations = 0;
+  frame.durations = durations;
+  frame.symbols = symbols;
+  bool fits = true;
+  while (fits && parser.next(&code))
+    fits = IRsend::appendSymbol(&frame, durations, symbols, kRawSymbolsMaxBytes,
+                                parser.value(), kRawSymbolsTolerance, &totals);
+  if (parser.error()) return false;  // Malformed.
+  if (fits) {
+    if (!frame.length) return false;  // We expect at least one duration.
+    irsend->sendSymbols(&frame);  // All done. Send it.
+    return true;
+  }
+
   // Rest of the string are values for the raw array.
-  // Now convert the strings to integers and place them in raw_array.
-  count = 0;
-  do {
-    index = str.indexOf(',', start_from);
-    raw_array[count] = str.substring(start_from, index).toInt();
-    start_from = index + 1;
-    count++;
-  } while (index != -1);
-
-  irsend->sendRaw(raw_array, count, freq);  // All done. Send it.
-  free(raw_array);  // Free up the memory allocated.
-  if (count > 0)
-    return true;  // We sent something.
-  return false;  // We probably didn't.
+  const uint16_t count = IRvalueParser::parse(data_start, codeValues,
+                                              kCodeValuesMax);
+  if (!count) return false;  // Malformed, or too long.
+  irsend->sendRaw(codeValues, count, freq);  // All done. Send it.
+  return true;
 }
 #endif  // SEND_RAW
 
@@ -2006,34 +2152,33 @@ void handleGpio(void) {
     return server.requestAuthentication();
   }
 #endif
-  String html = htmlHeader(F("GPIO config"));
-  html += F(
-      "<form method='POST' action='/gpio/set' enctype='multipart/form-data'>");
-  html += htmlMenu();
-  html += F("<h2><mark>WARNING: Choose carefully! You can cause damage to your "
-            "hardware or make the device unresponsive.</mark></h2>");
-  html += F("<h3>Send</h3>IR LED");
+  htmlStart();
+  htmlSend(htmlHeader(F("GPIO config")));
+  htmlSend(F(
+      "<form method='POST' action='/gpio/set' enctype='multipart/form-data'>"));
+  htmlSend(htmlMenu());
+  htmlSend(F("<h2><mark>WARNING: Choose carefully! You can cause damage to "
+             "your hardware or make the device unresponsive.</mark></h2>"));
+  htmlSend(F("<h3>Send</h3>IR LED"));
   for (uint16_t i = 0; i < kNrOfIrTxGpios; i++) {
     if (kNrOfIrTxGpios > 1) {
-      html += F(" #");
-      html += String(i);
+      htmlSend(F(" #"));
+      htmlSend(String(i));
     }
-    html += htmlSelectGpio(KEY_TX_GPIO + String(i), txGpioTable[i], kTxGpios,
-                           sizeof(kTxGpios));
+    htmlSelectGpio(KEY_TX_GPIO + String(i), txGpioTable[i], kTxGpios,
+                   sizeof(kTxGpios));
   }
 #if IR_RX
-  html += F("<h3>Receive</h3>IR RX Module");
-  html += htmlSelectGpio(KEY_RX_GPIO, rx_gpio, kRxGpios,
-                         sizeof(kRxGpios));
+  htmlSend(F("<h3>Receive</h3>IR RX Module"));
+  htmlSelectGpio(KEY_RX_GPIO, rx_gpio, kRxGpios, sizeof(kRxGpios));
 #endif  // IR_RX
-  html += F("<br><br><hr>");
+  htmlSend(F("<br><br><hr>"));
   if (strlen(HttpPassword))  // Allow if password set
-    html += F("<input type='submit' value='Save & Reboot'>");
+    htmlSend(F("<input type='submit' value='Save & Reboot'>"));
   else
-    html += htmlDisabled();
-  html += F("</form>");
-  html += htmlEnd();
-  server.send(200, "text/html", html);
+    htmlSend(htmlDisabled());
+  htmlSend(F("</form>"));
+  htmlFinish();
 }
 
 // GPIO setting page
@@ -2245,6 +2390,10 @@ void init_vars(void) {
   // Sub-topic for the climate stat topics.
   MqttSensorStat = String(MqttPrefix) + '/' + MQTT_SENSOR_STAT + '/';
 #endif  // SHT3X_SUPPORT
+#if REPORT_TX_STATS
+  // Topic we send the transmit stats to.
+  MqttTxStats = String(MqttPrefix) + '/' + MQTT_TX_STATS;
+#endif  // REPORT_TX_STATS
 #endif  // MQTT_ENABLE
 }
 
@@ -2290,6 +2439,10 @@ void setup(void) {
       if (climate[i] != NULL && i > 0) channel_re += '_' + String(i) + '|';
     }
   }
+#if REPORT_TX_STATS
+  // Start timing what we send. Done after calibrate(), so it isn't counted.
+  IRsend::enableTxStats(true);
+#endif  // REPORT_TX_STATS
   lastClimateSource = F("None");
   if (channel_re.length() == 1) {
     channel_re = "";
@@ -2583,9 +2736,9 @@ void doBroadcast(TimerMs *timer, const uint32_t interval,
 #if REPORT_VCC
       sendString(stat_topic + KEY_VCC, vccToString(), false);
 #endif  // REPORT_VCC
-#if MQTT_CLIMATE_JSON
+#if MQTT_CLIMATE_JSON && !MQTT_CLIMATE_JSON_ONLY
       sendJsonState(climate[i]->next, stat_topic + KEY_JSON);
-#endif  // MQTT_CLIMATE_JSON
+#endif  // MQTT_CLIMATE_JSON && !MQTT_CLIMATE_JSON_ONLY
     }
     timer->reset();  // It's been sent, so reset the timer.
     hasBroadcastBeenSent = true;
@@ -2838,7 +2991,47 @@ void sendMQTTDiscoverySensor(const char *topic, String type) {
 #endif  // MQTT_DISCOVERY_ENABLE
 #endif  // MQTT_ENABLE
 
+// A running total of the work the main loop has done. If it changes during a
+// pass of the loop, that pass wasn't idle.
+// Returns:
+//   The sum of the work counters.
+uint32_t workDone(void) {
+  return sendReqCounter + irClimateCounter
+#if IR_RX
+      + irRecvCounter
+#endif  // IR_RX
+#if MQTT_ENABLE
+      + mqttSentCounter + mqttRecvCounter
+#endif  // MQTT_ENABLE
+      + 0;
+}
+
+// Record how long a pass of the main loop took. This is the time of the whole
+// pass, not how long any event waited. Something (e.g. a received IR message,
+// or an MQTT command) that becomes ready during a pass isn't looked at until
+// the next one, so the max. pass time is only an upper bound on that wait.
+// Args:
+//   usecs: Nr. of micro-seconds the pass took.
+void recordLoopTime(const uint32_t usecs) {
+  loopCount++;
+  loopTotalUs += usecs;
+  loopPeakUs = std::max(loopPeakUs, usecs);
+  const uint32_t elapsed = loopStatsTime.elapsed();
+  if (elapsed >= kLoopStatsPeriodMs) {
+    loopRate = (uint64_t)loopCount * 1000 / elapsed;
+    loopAvgUs = loopTotalUs / loopCount;
+    loopMaxUs = loopPeakUs;
+    loopCount = 0;
+    loopTotalUs = 0;
+    loopPeakUs = 0;
+    loopStatsTime.reset();
+  }
+}
+
 void loop(void) {
+  const uint32_t loopStart = micros();
+  const uint32_t workBefore = workDone();
+  bool busy = false;  // Was there anything to do this time around?
 #if MDNS_ENABLE && defined(ESP8266)
   mdns.update();
 #endif  // MDNS_ENABLE and ESP8266
@@ -2903,6 +3096,14 @@ void loop(void) {
     }
     // Periodically send all of the climate state via MQTT.
     doBroadcast(&lastBroadcast, kBroadcastPeriodMs, climate, false, false);
+#if REPORT_TX_STATS
+    // Periodically send the transmit timing stats.
+    if (lastTxStats.elapsed() > kTxStatsPeriodMs) {
+      if (mqtt_client.publish(MqttTxStats.c_str(), txStatsJson().c_str()))
+        mqttSentCounter++;
+      lastTxStats.reset();
+    }
+#endif  // REPORT_TX_STATS
 #if SHT3X_SUPPORT
     // Check if it's time to read the SHT3x sensor.
     if (statSensorReadTime.elapsed() > SHT3X_CHECK_FREQ * 1000) {
@@ -2930,10 +3131,11 @@ void loop(void) {
 #endif  // MQTT_ENABLE
 #if IR_RX
   // Check if an IR code has been received via the IR RX module.
+  if (irrecv != NULL && irrecv->available()) busy = true;
 #if REPORT_UNKNOWNS
-  if (irrecv != NULL && irrecv->decode(&capture)) {
+  if (busy && irrecv->decode(&capture)) {
 #else  // REPORT_UNKNOWNS
-  if (irrecv != NULL && irrecv->decode(&capture) &&
+  if (busy && irrecv->decode(&capture) &&
       capture.decode_type != UNKNOWN) {
 #endif  // REPORT_UNKNOWNS
     lastIrReceivedTime = millis();
@@ -2970,7 +3172,11 @@ void loop(void) {
 #endif  // USE_DECODED_AC_SETTINGS
   }
 #endif  // IR_RX
-  delay(100);
+  if (busy || workDone() != workBefore)
+    yield();  // Let the system have a look in, but come straight back.
+  else
+    delay(kLoopIdleDelayMs);  // Nothing to do, so give the CPU a rest.
+  recordLoopTime(micros() - loopStart);
 }
 
 // Arduino framework doesn't support strtoull(), so make our own one.
@@ -3140,102 +3346,40 @@ bool sendFloat(const String topic, const float_t temp, const bool retain) {
 }
 
 #if MQTT_CLIMATE_JSON
-void sendJsonState(const stdAc::state_t state, const String topic,
+// Publish a climate state as a single JSON message.
+// The JSON is built in a fixed size buffer. i.e. No heap is used.
+// Args:
+//   state: The climate state to send.
+//   topic: The MQTT topic to publish it to.
+//   retain: Should the message be retained by the MQTT broker?
+//   ha_mode: Use Home Assistant-style power & operation modes?
+// Returns:
+//   A boolean indicating success or failure.
+bool sendJsonState(const stdAc::state_t state, const String topic,
                    const bool retain, const bool ha_mode) {
-  DynamicJsonDocument json(kJsonAcStateMaxSize);
-  json[KEY_PROTOCOL] = typeToString(state.protocol);
-  json[KEY_MODEL] = state.model;
-  json[KEY_COMMAND] = IRac::commandToString(state.command);
-  json[KEY_POWER] = IRac::boolToString(state.power);
-  json[KEY_MODE] = IRac::opmodeToString(state.mode, ha_mode);
-  // Home Assistant wants mode to be off if power is also off & vice-versa.
-  if (ha_mode && (state.mode == stdAc::opmode_t::kOff || !state.power)) {
-    json[KEY_MODE] = IRac::opmodeToString(stdAc::opmode_t::kOff, ha_mode);
-    json[KEY_POWER] = IRac::boolToString(false);
-  }
-  json[KEY_CELSIUS] = IRac::boolToString(state.celsius);
-  json[KEY_TEMP] = state.degrees;
-  json[KEY_SENSORTEMP] = state.sensorTemperature;
-  json[KEY_FANSPEED] = IRac::fanspeedToString(state.fanspeed);
-  json[KEY_SWINGV] = IRac::swingvToString(state.swingv);
-  json[KEY_SWINGH] = IRac::swinghToString(state.swingh);
-  json[KEY_QUIET] = IRac::boolToString(state.quiet);
-  json[KEY_IFEEL] = IRac::boolToString(state.iFeel);
-  json[KEY_TURBO] = IRac::boolToString(state.turbo);
-  json[KEY_ECONO] = IRac::boolToString(state.econo);
-  json[KEY_LIGHT] = IRac::boolToString(state.light);
-  json[KEY_FILTER] = IRac::boolToString(state.filter);
-  json[KEY_CLEAN] = IRac::boolToString(state.clean);
-  json[KEY_BEEP] = IRac::boolToString(state.beep);
-  json[KEY_SLEEP] = state.sleep;
-
-  String payload = "";
-  payload.reserve(200);
-  serializeJson(json, payload);
-  sendString(topic, payload, retain);
-}
-
-bool validJsonStr(DynamicJsonDocument doc, const char* key) {
-  return doc.containsKey(key) && doc[key].is<char*>();
-}
-
-bool validJsonInt(DynamicJsonDocument doc, const char* key) {
-  return doc.containsKey(key) && doc[key].is<signed int>();
+  char payload[kStateJsonMaxSize];
+  if (!IRac::stateToJson(state, payload, sizeof(payload), ha_mode)) {
+    debug("Climate state didn't fit in the json buffer. Skipping!");
+    return false;
+  }
+#if MQTT_ENABLE
+  mqttSentCounter++;
+  return mqtt_client.publish(topic.c_str(), payload, retain);
+#else  // MQTT_ENABLE
+  return true;
+#endif  // MQTT_ENABLE
 }
 
+// Update a climate state from a JSON message. Missing fields are unchanged.
+// Args:
+//   current: The existing climate state.
+//   str: The JSON message.
+// Returns:
+//   The new climate state, or `current` if the JSON was invalid.
 stdAc::state_t jsonToState(const stdAc::state_t current, const char *str) {
-  DynamicJsonDocument json(kJsonAcStateMaxSize);
-  if (deserializeJson(json, str, kJsonAcStateMaxSize)) {
-    debug("json MQTT message did not parse. Skipping!");
-    return current;
-  }
   stdAc::state_t result = current;
-  if (validJsonStr(json, KEY_PROTOCOL))
-    result.protocol = strToDecodeType(json[KEY_PROTOCOL]);
-  else if (validJsonInt(json, KEY_PROTOCOL))
-    result.protocol = (decode_type_t)json[KEY_PROTOCOL].as<signed int>();
-  if (validJsonStr(json, KEY_MODEL))
-    result.model = IRac::strToModel(json[KEY_MODEL].as<char*>());
-  else if (validJsonInt(json, KEY_MODEL))
-    result.model = json[KEY_MODEL];
-  if (validJsonStr(json, KEY_COMMAND))
-    result.command = IRac::strToCommand(json[KEY_COMMAND].as<char*>());
-  else if (validJsonInt(json, KEY_COMMAND))
-    result.command = json[KEY_COMMAND];
-  if (validJsonStr(json, KEY_MODE))
-    result.mode = IRac::strToOpmode(json[KEY_MODE]);
-  if (validJsonStr(json, KEY_FANSPEED))
-    result.fanspeed = IRac::strToFanspeed(json[KEY_FANSPEED]);
-  if (validJsonStr(json, KEY_SWINGV))
-    result.swingv = IRac::strToSwingV(json[KEY_SWINGV]);
-  if (validJsonStr(json, KEY_SWINGH))
-    result.swingh = IRac::strToSwingH(json[KEY_SWINGH]);
-  if (json.containsKey(KEY_TEMP))
-    result.degrees = json[KEY_TEMP];
-  if (json.containsKey(KEY_SENSORTEMP))
-    result.sensorTemperature = json[KEY_SENSORTEMP];
-  if (validJsonInt(json, KEY_SLEEP))
-    result.sleep = json[KEY_SLEEP];
-  if (validJsonStr(json, KEY_POWER))
-    result.power = IRac::strToBool(json[KEY_POWER]);
-  if (validJsonStr(json, KEY_IFEEL))
-    result.iFeel = IRac::strToBool(json[KEY_IFEEL]);
-  if (validJsonStr(json, KEY_QUIET))
-    result.quiet = IRac::strToBool(json[KEY_QUIET]);
-  if (validJsonStr(json, KEY_TURBO))
-    result.turbo = IRac::strToBool(json[KEY_TURBO]);
-  if (validJsonStr(json, KEY_ECONO))
-    result.econo = IRac::strToBool(json[KEY_ECONO]);
-  if (validJsonStr(json, KEY_LIGHT))
-    result.light = IRac::strToBool(json[KEY_LIGHT]);
-  if (validJsonStr(json, KEY_CLEAN))
-    result.clean = IRac::strToBool(json[KEY_CLEAN]);
-  if (validJsonStr(json, KEY_FILTER))
-    result.filter = IRac::strToBool(json[KEY_FILTER]);
-  if (validJsonStr(json, KEY_BEEP))
-    result.beep = IRac::strToBool(json[KEY_BEEP]);
-  if (validJsonStr(json, KEY_CELSIUS))
-    result.celsius = IRac::strToBool(json[KEY_CELSIUS]);
+  if (!IRac::jsonToState(str, &result))
+    debug("json MQTT message did not parse. Skipping!");
   return result;
 }
 #endif  // MQTT_CLIMATE_JSON
@@ -3317,6 +3461,12 @@ bool sendClimate(const String topic_prefix, const bool retain,
   bool success = true;
   const stdAc::state_t next = ac->getState();
   const stdAc::state_t prev = ac->getStatePrev();
+#if MQTT_CLIMATE_JSON_ONLY
+  // The whole state goes in one message, so it's either all sent or none of it.
+  diff = IRac::cmpStates(next, prev);
+  if (diff || forceMQTT)
+    success &= sendJsonState(next, topic_prefix + KEY_JSON, retain);
+#else  // MQTT_CLIMATE_JSON_ONLY
   if (prev.protocol != next.protocol || forceMQTT) {
     diff = true;
     success &= sendString(topic_prefix + KEY_PROTOCOL,
@@ -3420,11 +3570,12 @@ bool sendClimate(const String topic_prefix, const bool retain,
     diff = true;
     success &= sendInt(topic_prefix + KEY_SLEEP, next.sleep, retain);
   }
+#endif  // MQTT_CLIMATE_JSON_ONLY
   if (diff && !forceMQTT) {
     debug("Difference in common A/C state detected.");
-#if MQTT_CLIMATE_JSON
+#if MQTT_CLIMATE_JSON && !MQTT_CLIMATE_JSON_ONLY
     sendJsonState(next, topic_prefix + KEY_JSON);
-#endif  // MQTT_CLIMATE_JSON
+#endif  // MQTT_CLIMATE_JSON && !MQTT_CLIMATE_JSON_ONLY
   } else {
     debug("NO difference in common A/C state detected.");
   }
@@ -44,8 +44,13 @@
  *       receiving with this library.
  *   * ESP-01 modules are tricky. We suggest you use a module with more GPIOs
  *     for your first time. e.g. ESP-12 etc.
+ *   * In cut-through mode (kCutThrough), make sure the IR detector can't see
+ *     the IR LED. It stops a message if it sees its own output, but that
+ *     still means the message is cut short.
  *
  * Changes:
+ *   Version 1.1: Oct, 2026
+ *     - Optional low latency cut-through mode. (kCutThrough)
  *   Version 1.0: June, 2019
  *     - Initial version.
  */
@@ -85,6 +90,13 @@ const uint8_t kTimeout = 50;  // Milli-Seconds
 // kFrequency is the modulation frequency all UNKNOWN messages will be sent at.
 const uint16_t kFrequency = 38000;  // in Hz. e.g. 38kHz.
 
+// kCutThrough retransmits what is received as it arrives, only kRepeatDelay
+// micro-Seconds behind, rather than after the whole message has been received
+// and decoded. It keeps the timing of repeats, but every message is sent at
+// kFrequency. Messages are still decoded, but only for display.
+const bool kCutThrough = false;
+const uint16_t kRepeatDelay = kRepeaterDelayUs;  // Micro-Seconds
+
 // ==================== end of TUNEABLE PARAMETERS ====================
 
 // The IR transmitter.
@@ -98,6 +110,8 @@ decode_results results;
 void setup() {
   irrecv.enableIRIn();  // Start up the IR receiver.
   irsend.begin();       // Start up the IR sender.
+  if (kCutThrough)
+    irrecv.enableRepeater(kRepeatDelay, kRepeaterMinPulseUs, kFrequency);
 
   Serial.begin(kBaudRate, SERIAL_8N1);
   while (!Serial)  // Wait for the serial connection to be establised.
@@ -113,6 +127,21 @@ void setup() {
 
 // The repeating section of the code
 void loop() {
+  if (kCutThrough) {
+    // Retransmit anything that is due. It returns straight away, & says if it
+    // is part way through a message, in which case, come back for more ASAP.
+    if (irrecv.repeat(&irsend)) return;
+    // The message was captured in parallel, so we can still say what it was.
+    if (irrecv.decode(&results)) {
+      uint32_t now = millis();
+      Serial.printf("%06u.%03u: A %d-bit %s message was repeated.\n",
+                    now / 1000, now % 1000, results.bits,
+                    typeToString(results.decode_type).c_str());
+      irrecv.resume();
+    }
+    yield();
+    return;
+  }
   // Check if an IR message has been received.
   if (irrecv.decode(&results)) {  // We have captured something.
     // The capture has stopped at this point.
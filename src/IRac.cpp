@@ -100,6 +100,56 @@
   }
 #endif  // UNIT_TEST
 
+#ifndef PROGMEM
+#define PROGMEM  // Pretend we have the PROGMEM macro even if we really don't.
+#endif  // PROGMEM
+#if defined(ESP8266)
+#define MEMCPY_P(DST, SRC, SIZE) memcpy_P(DST, SRC, SIZE)
+#define STRCMP_P(LHS, RHS) strcmp_P(LHS, RHS)
+#else  // ESP8266
+#define MEMCPY_P(DST, SRC, SIZE) memcpy(DST, SRC, SIZE)
+#define STRCMP_P(LHS, RHS) strcmp(LHS, RHS)
+#endif  // ESP8266
+#ifndef pgm_read_byte
+#define pgm_read_byte(ADDR) (*(ADDR))
+#endif  // pgm_read_byte
+#ifndef pgm_read_word
+#define pgm_read_word(ADDR) (*(ADDR))
+#endif  // pgm_read_word
+
+#if defined(ESP8266)
+typedef const __FlashStringHelper* IRTextPtr;  ///< A ptr to some IRtext.
+#else  // ESP8266
+typedef const char* IRTextPtr;  ///< A ptr to some IRtext.
+#endif  // ESP8266
+
+/// Make an IRTextMatch entry for an IRtext string.
+/// @param[in] NAME The name of the IRtext string. e.g. kAutoStr
+/// @param[in] TEXT The macro the IRtext string is defined with. e.g. D_STR_AUTO
+/// @param[in] VALUE The value the text converts to.
+/// @note The hash is calculated at compile time.
+#define IRTEXT_MATCH(NAME, TEXT, VALUE) \
+    { irutils::textHashConst(TEXT), static_cast<int16_t>(VALUE), &NAME }
+
+/// Find the value of some text in a table of IRTextMatch entries.
+/// Only the entries with a matching hash have their text compared.
+/// @param[in] str A Ptr to a C-style string to be converted.
+/// @param[in] table The table of entries (in flash) to search.
+/// @param[in] size The nr. of entries in the table.
+/// @param[in] def The value to return if no conversion was possible.
+/// @return The value of the first entry matching the string, or `def`.
+static int16_t matchText(const char *str, const IRTextMatch table[],
+                         const uint16_t size, const int16_t def) {
+  const uint16_t hash = irutils::textHash(str);
+  for (uint16_t i = 0; i < size; i++) {
+    IRTextMatch entry;
+    MEMCPY_P(&entry, &table[i], sizeof(entry));
+    if (entry.hash == hash && !STRCASECMP(str, *entry.text))
+      return entry.value;
+  }
+  return def;
+}
+
 /// Class constructor
 /// @param[in] pin Gpio pin to use when transmitting IR messages.
 /// @param[in] inverted true, gpio output defaults to high. false, to low.
@@ -3016,6 +3066,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
           : fahrenheitToCelsius(desired.sensorTemperature);
   // special `state_t` that is required to be sent based on that.
   stdAc::state_t send = this->handleToggles(this->cleanState(desired), prev);
+  IRsend::txStatsBegin(send.protocol);  // Time what we send against it.
   // Some protocols expect a previous state for power.
   // Construct a pointer-safe previous power state incase prev is NULL/NULLPTR.
 #if (SEND_HITACHI_AC1 || SEND_SAMSUNG_AC || SEND_SHARP_AC)
@@ -3638,8 +3689,10 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
     }
 #endif  // SEND_TRANSCOLD_AC
     default:
+      IRsend::txStatsEnd();
       return false;  // Fail, didn't match anything.
   }
+  IRsend::txStatsEnd();
   return true;  // Success.
 }  // NOLINT(readability/fn_size)
 
@@ -3697,157 +3750,248 @@ stdAc::ac_command_t IRac::strToCommandType(const char *str,
     return def;
 }
 
+/// Text that IRac::strToOpmode() understands, in order of precedence.
+static const IRTextMatch kOpmodeNames[] PROGMEM = {
+    IRTEXT_MATCH(kAutoStr, D_STR_AUTO, stdAc::opmode_t::kAuto),
+    IRTEXT_MATCH(kAutomaticStr, D_STR_AUTOMATIC, stdAc::opmode_t::kAuto),
+    IRTEXT_MATCH(kOffStr, D_STR_OFF, stdAc::opmode_t::kOff),
+    IRTEXT_MATCH(kStopStr, D_STR_STOP, stdAc::opmode_t::kOff),
+    IRTEXT_MATCH(kCoolStr, D_STR_COOL, stdAc::opmode_t::kCool),
+    IRTEXT_MATCH(kCoolingStr, D_STR_COOLING, stdAc::opmode_t::kCool),
+    IRTEXT_MATCH(kHeatStr, D_STR_HEAT, stdAc::opmode_t::kHeat),
+    IRTEXT_MATCH(kHeatingStr, D_STR_HEATING, stdAc::opmode_t::kHeat),
+    IRTEXT_MATCH(kDryStr, D_STR_DRY, stdAc::opmode_t::kDry),
+    IRTEXT_MATCH(kDryingStr, D_STR_DRYING, stdAc::opmode_t::kDry),
+    IRTEXT_MATCH(kDehumidifyStr, D_STR_DEHUMIDIFY, stdAc::opmode_t::kDry),
+    IRTEXT_MATCH(kFanStr, D_STR_FAN, stdAc::opmode_t::kFan),
+    // The following Fans strings with "only" are required to help with
+    // HomeAssistant & Google Home Climate integration.
+    // For compatibility only.
+    // Ref: https://www.home-assistant.io/integrations/google_assistant/#climate-operation-modes
+    IRTEXT_MATCH(kFanOnlyStr, D_STR_FANONLY, stdAc::opmode_t::kFan),
+    IRTEXT_MATCH(kFan_OnlyStr, D_STR_FAN_ONLY, stdAc::opmode_t::kFan),
+    IRTEXT_MATCH(kFanOnlyWithSpaceStr, D_STR_FANSPACEONLY,
+                 stdAc::opmode_t::kFan),
+    IRTEXT_MATCH(kFanOnlyNoSpaceStr, D_STR_FANONLYNOSPACE,
+                 stdAc::opmode_t::kFan)
+};
+
 /// Convert the supplied str into the appropriate enum.
 /// @param[in] str A Ptr to a C-style string to be converted.
 /// @param[in] def The enum to return if no conversion was possible.
 /// @return The equivalent enum.
 stdAc::opmode_t IRac::strToOpmode(const char *str,
                                   const stdAc::opmode_t def) {
-  if (!STRCASECMP(str, kAutoStr) ||
-      !STRCASECMP(str, kAutomaticStr))
-    return stdAc::opmode_t::kAuto;
-  else if (!STRCASECMP(str, kOffStr) ||
-           !STRCASECMP(str, kStopStr))
-    return stdAc::opmode_t::kOff;
-  else if (!STRCASECMP(str, kCoolStr) ||
-           !STRCASECMP(str, kCoolingStr))
-    return stdAc::opmode_t::kCool;
-  else if (!STRCASECMP(str, kHeatStr) ||
-           !STRCASECMP(str, kHeatingStr))
-    return stdAc::opmode_t::kHeat;
-  else if (!STRCASECMP(str, kDryStr) ||
-           !STRCASECMP(str, kDryingStr) ||
-           !STRCASECMP(str, kDehumidifyStr))
-    return stdAc::opmode_t::kDry;
-  else if (!STRCASECMP(str, kFanStr) ||
-          // The following Fans strings with "only" are required to help with
-          // HomeAssistant & Google Home Climate integration.
-          // For compatibility only.
-          // Ref: https://www.home-assistant.io/integrations/google_assistant/#climate-operation-modes
-           !STRCASECMP(str, kFanOnlyStr) ||
-           !STRCASECMP(str, kFan_OnlyStr) ||
-           !STRCASECMP(str, kFanOnlyWithSpaceStr) ||
-           !STRCASECMP(str, kFanOnlyNoSpaceStr))
-    return stdAc::opmode_t::kFan;
-  else
-    return def;
+  return static_cast<stdAc::opmode_t>(matchText(
+      str, kOpmodeNames, sizeof(kOpmodeNames) / sizeof(kOpmodeNames[0]),
+      static_cast<int16_t>(def)));
 }
 
+/// Text that IRac::strToFanspeed() understands, in order of precedence.
+static const IRTextMatch kFanspeedNames[] PROGMEM = {
+    IRTEXT_MATCH(kAutoStr, D_STR_AUTO, stdAc::fanspeed_t::kAuto),
+    IRTEXT_MATCH(kAutomaticStr, D_STR_AUTOMATIC, stdAc::fanspeed_t::kAuto),
+    IRTEXT_MATCH(kMinStr, D_STR_MIN, stdAc::fanspeed_t::kMin),
+    IRTEXT_MATCH(kMinimumStr, D_STR_MINIMUM, stdAc::fanspeed_t::kMin),
+    IRTEXT_MATCH(kLowestStr, D_STR_LOWEST, stdAc::fanspeed_t::kMin),
+    IRTEXT_MATCH(kLowStr, D_STR_LOW, stdAc::fanspeed_t::kLow),
+    IRTEXT_MATCH(kLoStr, D_STR_LO, stdAc::fanspeed_t::kLow),
+    IRTEXT_MATCH(kMedStr, D_STR_MED, stdAc::fanspeed_t::kMedium),
+    IRTEXT_MATCH(kMediumStr, D_STR_MEDIUM, stdAc::fanspeed_t::kMedium),
+    IRTEXT_MATCH(kMidStr, D_STR_MID, stdAc::fanspeed_t::kMedium),
+    IRTEXT_MATCH(kHighStr, D_STR_HIGH, stdAc::fanspeed_t::kHigh),
+    IRTEXT_MATCH(kHiStr, D_STR_HI, stdAc::fanspeed_t::kHigh),
+    IRTEXT_MATCH(kMaxStr, D_STR_MAX, stdAc::fanspeed_t::kMax),
+    IRTEXT_MATCH(kMaximumStr, D_STR_MAXIMUM, stdAc::fanspeed_t::kMax),
+    IRTEXT_MATCH(kHighestStr, D_STR_HIGHEST, stdAc::fanspeed_t::kMax),
+    IRTEXT_MATCH(kMedHighStr, D_STR_MED_HIGH, stdAc::fanspeed_t::kMediumHigh)
+};
+
 /// Convert the supplied str into the appropriate enum.
 /// @param[in] str A Ptr to a C-style string to be converted.
 /// @param[in] def The enum to return if no conversion was possible.
 /// @return The equivalent enum.
 stdAc::fanspeed_t IRac::strToFanspeed(const char *str,
                                       const stdAc::fanspeed_t def) {
-  if (!STRCASECMP(str, kAutoStr) ||
-      !STRCASECMP(str, kAutomaticStr))
-    return stdAc::fanspeed_t::kAuto;
-  else if (!STRCASECMP(str, kMinStr) ||
-           !STRCASECMP(str, kMinimumStr) ||
-           !STRCASECMP(str, kLowestStr))
-    return stdAc::fanspeed_t::kMin;
-  else if (!STRCASECMP(str, kLowStr) ||
-           !STRCASECMP(str, kLoStr))
-    return stdAc::fanspeed_t::kLow;
-  else if (!STRCASECMP(str, kMedStr) ||
-           !STRCASECMP(str, kMediumStr) ||
-           !STRCASECMP(str, kMidStr))
-    return stdAc::fanspeed_t::kMedium;
-  else if (!STRCASECMP(str, kHighStr) ||
-           !STRCASECMP(str, kHiStr))
-    return stdAc::fanspeed_t::kHigh;
-  else if (!STRCASECMP(str, kMaxStr) ||
-           !STRCASECMP(str, kMaximumStr) ||
-           !STRCASECMP(str, kHighestStr))
-    return stdAc::fanspeed_t::kMax;
-  else if (!STRCASECMP(str, kMedHighStr))
-    return stdAc::fanspeed_t::kMediumHigh;
-  else
-    return def;
+  return static_cast<stdAc::fanspeed_t>(matchText(
+      str, kFanspeedNames, sizeof(kFanspeedNames) / sizeof(kFanspeedNames[0]),
+      static_cast<int16_t>(def)));
 }
 
+/// Text that IRac::strToSwingV() understands, in order of precedence.
+static const IRTextMatch kSwingVNames[] PROGMEM = {
+    IRTEXT_MATCH(kAutoStr, D_STR_AUTO, stdAc::swingv_t::kAuto),
+    IRTEXT_MATCH(kAutomaticStr, D_STR_AUTOMATIC, stdAc::swingv_t::kAuto),
+    IRTEXT_MATCH(kOnStr, D_STR_ON, stdAc::swingv_t::kAuto),
+    IRTEXT_MATCH(kSwingStr, D_STR_SWING, stdAc::swingv_t::kAuto),
+    IRTEXT_MATCH(kOffStr, D_STR_OFF, stdAc::swingv_t::kOff),
+    IRTEXT_MATCH(kStopStr, D_STR_STOP, stdAc::swingv_t::kOff),
+    IRTEXT_MATCH(kMinStr, D_STR_MIN, stdAc::swingv_t::kLowest),
+    IRTEXT_MATCH(kMinimumStr, D_STR_MINIMUM, stdAc::swingv_t::kLowest),
+    IRTEXT_MATCH(kLowestStr, D_STR_LOWEST, stdAc::swingv_t::kLowest),
+    IRTEXT_MATCH(kBottomStr, D_STR_BOTTOM, stdAc::swingv_t::kLowest),
+    IRTEXT_MATCH(kDownStr, D_STR_DOWN, stdAc::swingv_t::kLowest),
+    IRTEXT_MATCH(kLowStr, D_STR_LOW, stdAc::swingv_t::kLow),
+    IRTEXT_MATCH(kMidStr, D_STR_MID, stdAc::swingv_t::kMiddle),
+    IRTEXT_MATCH(kMiddleStr, D_STR_MIDDLE, stdAc::swingv_t::kMiddle),
+    IRTEXT_MATCH(kMedStr, D_STR_MED, stdAc::swingv_t::kMiddle),
+    IRTEXT_MATCH(kMediumStr, D_STR_MEDIUM, stdAc::swingv_t::kMiddle),
+    IRTEXT_MATCH(kCentreStr, D_STR_CENTRE, stdAc::swingv_t::kMiddle),
+    IRTEXT_MATCH(kUpperMiddleStr, D_STR_UPPER_MIDDLE,
+                 stdAc::swingv_t::kUpperMiddle),
+    IRTEXT_MATCH(kHighStr, D_STR_HIGH, stdAc::swingv_t::kHigh),
+    IRTEXT_MATCH(kHiStr, D_STR_HI, stdAc::swingv_t::kHigh),
+    IRTEXT_MATCH(kHighestStr, D_STR_HIGHEST, stdAc::swingv_t::kHighest),
+    IRTEXT_MATCH(kMaxStr, D_STR_MAX, stdAc::swingv_t::kHighest),
+    IRTEXT_MATCH(kMaximumStr, D_STR_MAXIMUM, stdAc::swingv_t::kHighest),
+    IRTEXT_MATCH(kTopStr, D_STR_TOP, stdAc::swingv_t::kHighest),
+    IRTEXT_MATCH(kUpStr, D_STR_UP, stdAc::swingv_t::kHighest)
+};
+
 /// Convert the supplied str into the appropriate enum.
 /// @param[in] str A Ptr to a C-style string to be converted.
 /// @param[in] def The enum to return if no conversion was possible.
 /// @return The equivalent enum.
 stdAc::swingv_t IRac::strToSwingV(const char *str,
                                   const stdAc::swingv_t def) {
-  if (!STRCASECMP(str, kAutoStr) ||
-      !STRCASECMP(str, kAutomaticStr) ||
-      !STRCASECMP(str, kOnStr) ||
-      !STRCASECMP(str, kSwingStr))
-    return stdAc::swingv_t::kAuto;
-  else if (!STRCASECMP(str, kOffStr) ||
-           !STRCASECMP(str, kStopStr))
-    return stdAc::swingv_t::kOff;
-  else if (!STRCASECMP(str, kMinStr) ||
-           !STRCASECMP(str, kMinimumStr) ||
-           !STRCASECMP(str, kLowestStr) ||
-           !STRCASECMP(str, kBottomStr) ||
-           !STRCASECMP(str, kDownStr))
-    return stdAc::swingv_t::kLowest;
-  else if (!STRCASECMP(str, kLowStr))
-    return stdAc::swingv_t::kLow;
-  else if (!STRCASECMP(str, kMidStr) ||
-           !STRCASECMP(str, kMiddleStr) ||
-           !STRCASECMP(str, kMedStr) ||
-           !STRCASECMP(str, kMediumStr) ||
-           !STRCASECMP(str, kCentreStr))
-    return stdAc::swingv_t::kMiddle;
-  else if (!STRCASECMP(str, kUpperMiddleStr))
-    return stdAc::swingv_t::kUpperMiddle;
-  else if (!STRCASECMP(str, kHighStr) ||
-           !STRCASECMP(str, kHiStr))
-    return stdAc::swingv_t::kHigh;
-  else if (!STRCASECMP(str, kHighestStr) ||
-           !STRCASECMP(str, kMaxStr) ||
-           !STRCASECMP(str, kMaximumStr) ||
-           !STRCASECMP(str, kTopStr) ||
-           !STRCASECMP(str, kUpStr))
-    return stdAc::swingv_t::kHighest;
-  else
-    return def;
+  return static_cast<stdAc::swingv_t>(matchText(
+      str, kSwingVNames, sizeof(kSwingVNames) / sizeof(kSwingVNames[0]),
+      static_cast<int16_t>(def)));
 }
 
+/// Text that IRac::strToSwingH() understands, in order of precedence.
+static const IRTextMatch kSwingHNames[] PROGMEM = {
+    IRTEXT_MATCH(kAutoStr, D_STR_AUTO, stdAc::swingh_t::kAuto),
+    IRTEXT_MATCH(kAutomaticStr, D_STR_AUTOMATIC, stdAc::swingh_t::kAuto),
+    IRTEXT_MATCH(kOnStr, D_STR_ON, stdAc::swingh_t::kAuto),
+    IRTEXT_MATCH(kSwingStr, D_STR_SWING, stdAc::swingh_t::kAuto),
+    IRTEXT_MATCH(kOffStr, D_STR_OFF, stdAc::swingh_t::kOff),
+    IRTEXT_MATCH(kStopStr, D_STR_STOP, stdAc::swingh_t::kOff),
+    IRTEXT_MATCH(kLeftMaxNoSpaceStr, D_STR_LEFTMAX_NOSPACE,
+                 stdAc::swingh_t::kLeftMax),
+    IRTEXT_MATCH(kLeftMaxStr, D_STR_LEFTMAX, stdAc::swingh_t::kLeftMax),
+    IRTEXT_MATCH(kMaxLeftNoSpaceStr, D_STR_MAXLEFT_NOSPACE,
+                 stdAc::swingh_t::kLeftMax),
+    IRTEXT_MATCH(kMaxLeftStr, D_STR_MAXLEFT, stdAc::swingh_t::kLeftMax),
+    IRTEXT_MATCH(kLeftStr, D_STR_LEFT, stdAc::swingh_t::kLeft),
+    IRTEXT_MATCH(kMidStr, D_STR_MID, stdAc::swingh_t::kMiddle),
+    IRTEXT_MATCH(kMiddleStr, D_STR_MIDDLE, stdAc::swingh_t::kMiddle),
+    IRTEXT_MATCH(kMedStr, D_STR_MED, stdAc::swingh_t::kMiddle),
+    IRTEXT_MATCH(kMediumStr, D_STR_MEDIUM, stdAc::swingh_t::kMiddle),
+    IRTEXT_MATCH(kCentreStr, D_STR_CENTRE, stdAc::swingh_t::kMiddle),
+    IRTEXT_MATCH(kRightStr, D_STR_RIGHT, stdAc::swingh_t::kRight),
+    IRTEXT_MATCH(kRightMaxNoSpaceStr, D_STR_RIGHTMAX_NOSPACE,
+                 stdAc::swingh_t::kRightMax),
+    IRTEXT_MATCH(kRightMaxStr, D_STR_RIGHTMAX, stdAc::swingh_t::kRightMax),
+    IRTEXT_MATCH(kMaxRightNoSpaceStr, D_STR_MAXRIGHT_NOSPACE,
+                 stdAc::swingh_t::kRightMax),
+    IRTEXT_MATCH(kMaxRightStr, D_STR_MAXRIGHT, stdAc::swingh_t::kRightMax),
+    IRTEXT_MATCH(kWideStr, D_STR_WIDE, stdAc::swingh_t::kWide)
+};
+
 /// Convert the supplied str into the appropriate enum.
 /// @param[in] str A Ptr to a C-style string to be converted.
 /// @param[in] def The enum to return if no conversion was possible.
 /// @return The equivalent enum.
 stdAc::swingh_t IRac::strToSwingH(const char *str,
                                   const stdAc::swingh_t def) {
-  if (!STRCASECMP(str, kAutoStr) ||
-      !STRCASECMP(str, kAutomaticStr) ||
-      !STRCASECMP(str, kOnStr) || !STRCASECMP(str, kSwingStr))
-    return stdAc::swingh_t::kAuto;
-  else if (!STRCASECMP(str, kOffStr) ||
-           !STRCASECMP(str, kStopStr))
-    return stdAc::swingh_t::kOff;
-  else if (!STRCASECMP(str, kLeftMaxNoSpaceStr) ||              // "LeftMax"
-           !STRCASECMP(str, kLeftMaxStr) ||                     // "Left Max"
-           !STRCASECMP(str, kMaxLeftNoSpaceStr) ||              // "MaxLeft"
-           !STRCASECMP(str, kMaxLeftStr))                       // "Max Left"
-    return stdAc::swingh_t::kLeftMax;
-  else if (!STRCASECMP(str, kLeftStr))
-    return stdAc::swingh_t::kLeft;
-  else if (!STRCASECMP(str, kMidStr) ||
-           !STRCASECMP(str, kMiddleStr) ||
-           !STRCASECMP(str, kMedStr) ||
-           !STRCASECMP(str, kMediumStr) ||
-           !STRCASECMP(str, kCentreStr))
-    return stdAc::swingh_t::kMiddle;
-  else if (!STRCASECMP(str, kRightStr))
-    return stdAc::swingh_t::kRight;
-  else if (!STRCASECMP(str, kRightMaxNoSpaceStr) ||              // "RightMax"
-           !STRCASECMP(str, kRightMaxStr) ||                     // "Right Max"
-           !STRCASECMP(str, kMaxRightNoSpaceStr) ||              // "MaxRight"
-           !STRCASECMP(str, kMaxRightStr))                       // "Max Right"
-    return stdAc::swingh_t::kRightMax;
-  else if (!STRCASECMP(str, kWideStr))
-    return stdAc::swingh_t::kWide;
-  else
-    return def;
+  return static_cast<stdAc::swingh_t>(matchText(
+      str, kSwingHNames, sizeof(kSwingHNames) / sizeof(kSwingHNames[0]),
+      static_cast<int16_t>(def)));
 }
 
+/// Model names that IRac::strToModel() understands.
+/// @note After adding a new model you should update modelToStr() too.
+static const IRTextMatch kModelNames[] PROGMEM = {
+    // Gree
+    IRTEXT_MATCH(kYaw1fStr, D_STR_YAW1F, gree_ac_remote_model_t::YAW1F),
+    IRTEXT_MATCH(kYbofbStr, D_STR_YBOFB, gree_ac_remote_model_t::YBOFB),
+    IRTEXT_MATCH(kYx1fsfStr, D_STR_YX1FSF, gree_ac_remote_model_t::YX1FSF),
+    // Haier models
+    IRTEXT_MATCH(kV9014557AStr, D_STR_V9014557_A,
+                 haier_ac176_remote_model_t::V9014557_A),
+    IRTEXT_MATCH(kV9014557BStr, D_STR_V9014557_B,
+                 haier_ac176_remote_model_t::V9014557_B),
+    // HitachiAc1 models
+    IRTEXT_MATCH(kRlt0541htaaStr, D_STR_RLT0541HTA_A,
+                 hitachi_ac1_remote_model_t::R_LT0541_HTA_A),
+    IRTEXT_MATCH(kRlt0541htabStr, D_STR_RLT0541HTA_B,
+                 hitachi_ac1_remote_model_t::R_LT0541_HTA_B),
+    // Fujitsu A/C models
+    IRTEXT_MATCH(kArrah2eStr, D_STR_ARRAH2E,
+                 fujitsu_ac_remote_model_t::ARRAH2E),
+    IRTEXT_MATCH(kArdb1Str, D_STR_ARDB1, fujitsu_ac_remote_model_t::ARDB1),
+    IRTEXT_MATCH(kArreb1eStr, D_STR_ARREB1E,
+                 fujitsu_ac_remote_model_t::ARREB1E),
+    IRTEXT_MATCH(kArjw2Str, D_STR_ARJW2, fujitsu_ac_remote_model_t::ARJW2),
+    IRTEXT_MATCH(kArry4Str, D_STR_ARRY4, fujitsu_ac_remote_model_t::ARRY4),
+    IRTEXT_MATCH(kArrew4eStr, D_STR_ARREW4E,
+                 fujitsu_ac_remote_model_t::ARREW4E),
+    // LG A/C models
+    IRTEXT_MATCH(kGe6711ar2853mStr, D_STR_GE6711AR2853M,
+                 lg_ac_remote_model_t::GE6711AR2853M),
+    IRTEXT_MATCH(kAkb75215403Str, D_STR_AKB75215403,
+                 lg_ac_remote_model_t::AKB75215403),
+    IRTEXT_MATCH(kAkb74955603Str, D_STR_AKB74955603,
+                 lg_ac_remote_model_t::AKB74955603),
+    IRTEXT_MATCH(kAkb73757604Str, D_STR_AKB73757604,
+                 lg_ac_remote_model_t::AKB73757604),
+    IRTEXT_MATCH(kLg6711a20083vStr, D_STR_LG6711A20083V,
+                 lg_ac_remote_model_t::LG6711A20083V),
+    // Panasonic A/C families
+    IRTEXT_MATCH(kLkeStr, D_STR_LKE,
+                 panasonic_ac_remote_model_t::kPanasonicLke),
+    IRTEXT_MATCH(kPanasonicLkeStr, D_STR_PANASONICLKE,
+                 panasonic_ac_remote_model_t::kPanasonicLke),
+    IRTEXT_MATCH(kNkeStr, D_STR_NKE,
+                 panasonic_ac_remote_model_t::kPanasonicNke),
+    IRTEXT_MATCH(kPanasonicNkeStr, D_STR_PANASONICNKE,
+                 panasonic_ac_remote_model_t::kPanasonicNke),
+    IRTEXT_MATCH(kDkeStr, D_STR_DKE,
+                 panasonic_ac_remote_model_t::kPanasonicDke),
+    IRTEXT_MATCH(kPanasonicDkeStr, D_STR_PANASONICDKE,
+                 panasonic_ac_remote_model_t::kPanasonicDke),
+    IRTEXT_MATCH(kPkrStr, D_STR_PKR,
+                 panasonic_ac_remote_model_t::kPanasonicDke),
+    IRTEXT_MATCH(kPanasonicPkrStr, D_STR_PANASONICPKR,
+                 panasonic_ac_remote_model_t::kPanasonicDke),
+    IRTEXT_MATCH(kJkeStr, D_STR_JKE,
+                 panasonic_ac_remote_model_t::kPanasonicJke),
+    IRTEXT_MATCH(kPanasonicJkeStr, D_STR_PANASONICJKE,
+                 panasonic_ac_remote_model_t::kPanasonicJke),
+    IRTEXT_MATCH(kCkpStr, D_STR_CKP,
+                 panasonic_ac_remote_model_t::kPanasonicCkp),
+    IRTEXT_MATCH(kPanasonicCkpStr, D_STR_PANASONICCKP,
+                 panasonic_ac_remote_model_t::kPanasonicCkp),
+    IRTEXT_MATCH(kRkrStr, D_STR_RKR,
+                 panasonic_ac_remote_model_t::kPanasonicRkr),
+    IRTEXT_MATCH(kPanasonicRkrStr, D_STR_PANASONICRKR,
+                 panasonic_ac_remote_model_t::kPanasonicRkr),
+    // Sharp A/C Models
+    IRTEXT_MATCH(kA907Str, D_STR_A907, sharp_ac_remote_model_t::A907),
+    IRTEXT_MATCH(kA705Str, D_STR_A705, sharp_ac_remote_model_t::A705),
+    IRTEXT_MATCH(kA903Str, D_STR_A903, sharp_ac_remote_model_t::A903),
+    // TCL A/C Models
+    IRTEXT_MATCH(kTac09chsdStr, D_STR_TAC09CHSD,
+                 tcl_ac_remote_model_t::TAC09CHSD),
+    IRTEXT_MATCH(kGz055be1Str, D_STR_GZ055BE1, tcl_ac_remote_model_t::GZ055BE1),
+    // Voltas A/C models
+    IRTEXT_MATCH(k122lzfStr, D_STR_122LZF,
+                 voltas_ac_remote_model_t::kVoltas122LZF),
+    // Whirlpool A/C models
+    IRTEXT_MATCH(kDg11j13aStr, D_STR_DG11J13A,
+                 whirlpool_ac_remote_model_t::DG11J13A),
+    IRTEXT_MATCH(kDg11j104Str, D_STR_DG11J104,
+                 whirlpool_ac_remote_model_t::DG11J13A),
+    IRTEXT_MATCH(kDg11j191Str, D_STR_DG11J191,
+                 whirlpool_ac_remote_model_t::DG11J191),
+    // Argo A/C models
+    IRTEXT_MATCH(kArgoWrem2Str, D_STR_ARGO_WREM2,
+                 argo_ac_remote_model_t::SAC_WREM2),
+    IRTEXT_MATCH(kArgoWrem3Str, D_STR_ARGO_WREM3,
+                 argo_ac_remote_model_t::SAC_WREM3)
+};
+
 /// Convert the supplied str into the appropriate enum.
 /// @note Assumes str is the model code or an integer >= 1.
 /// @param[in] str A Ptr to a C-style string to be converted.
@@ -3855,102 +3999,45 @@ stdAc::swingh_t IRac::strToSwingH(const char *str,
 /// @return The equivalent enum.
 /// @note After adding a new model you should update modelToStr() too.
 int16_t IRac::strToModel(const char *str, const int16_t def) {
-  // Gree
-  if (!STRCASECMP(str, kYaw1fStr)) {
-    return gree_ac_remote_model_t::YAW1F;
-  } else if (!STRCASECMP(str, kYbofbStr)) {
-    return gree_ac_remote_model_t::YBOFB;
-  } else if (!STRCASECMP(str, kYx1fsfStr)) {
-    return gree_ac_remote_model_t::YX1FSF;
-  // Haier models
-  } else if (!STRCASECMP(str, kV9014557AStr)) {
-    return haier_ac176_remote_model_t::V9014557_A;
-  } else if (!STRCASECMP(str, kV9014557BStr)) {
-    return haier_ac176_remote_model_t::V9014557_B;
-  // HitachiAc1 models
-  } else if (!STRCASECMP(str, kRlt0541htaaStr)) {
-    return hitachi_ac1_remote_model_t::R_LT0541_HTA_A;
-  } else if (!STRCASECMP(str, kRlt0541htabStr)) {
-    return hitachi_ac1_remote_model_t::R_LT0541_HTA_B;
-  // Fujitsu A/C models
-  } else if (!STRCASECMP(str, kArrah2eStr)) {
-    return fujitsu_ac_remote_model_t::ARRAH2E;
-  } else if (!STRCASECMP(str, kArdb1Str)) {
-    return fujitsu_ac_remote_model_t::ARDB1;
-  } else if (!STRCASECMP(str, kArreb1eStr)) {
-    return fujitsu_ac_remote_model_t::ARREB1E;
-  } else if (!STRCASECMP(str, kArjw2Str)) {
-    return fujitsu_ac_remote_model_t::ARJW2;
-  } else if (!STRCASECMP(str, kArry4Str)) {
-    return fujitsu_ac_remote_model_t::ARRY4;
-  } else if (!STRCASECMP(str, kArrew4eStr)) {
-    return fujitsu_ac_remote_model_t::ARREW4E;
-  // LG A/C models
-  } else if (!STRCASECMP(str, kGe6711ar2853mStr)) {
-    return lg_ac_remote_model_t::GE6711AR2853M;
-  } else if (!STRCASECMP(str, kAkb75215403Str)) {
-    return lg_ac_remote_model_t::AKB75215403;
-  } else if (!STRCASECMP(str, kAkb74955603Str)) {
-    return lg_ac_remote_model_t::AKB74955603;
-  } else if (!STRCASECMP(str, kAkb73757604Str)) {
-    return lg_ac_remote_model_t::AKB73757604;
-  } else if (!STRCASECMP(str, kLg6711a20083vStr)) {
-    return lg_ac_remote_model_t::LG6711A20083V;
-  // Panasonic A/C families
-  } else if (!STRCASECMP(str, kLkeStr) ||
-             !STRCASECMP(str, kPanasonicLkeStr)) {
-    return panasonic_ac_remote_model_t::kPanasonicLke;
-  } else if (!STRCASECMP(str, kNkeStr) ||
-             !STRCASECMP(str, kPanasonicNkeStr)) {
-    return panasonic_ac_remote_model_t::kPanasonicNke;
-  } else if (!STRCASECMP(str, kDkeStr) ||
-             !STRCASECMP(str, kPanasonicDkeStr) ||
-             !STRCASECMP(str, kPkrStr) ||
-             !STRCASECMP(str, kPanasonicPkrStr)) {
-    return panasonic_ac_remote_model_t::kPanasonicDke;
-  } else if (!STRCASECMP(str, kJkeStr) ||
-             !STRCASECMP(str, kPanasonicJkeStr)) {
-    return panasonic_ac_remote_model_t::kPanasonicJke;
-  } else if (!STRCASECMP(str, kCkpStr) ||
-             !STRCASECMP(str, kPanasonicCkpStr)) {
-    return panasonic_ac_remote_model_t::kPanasonicCkp;
-  } else if (!STRCASECMP(str, kRkrStr) ||
-             !STRCASECMP(str, kPanasonicRkrStr)) {
-    return panasonic_ac_remote_model_t::kPanasonicRkr;
-  // Sharp A/C Models
-  } else if (!STRCASECMP(str, kA907Str)) {
-    return sharp_ac_remote_model_t::A907;
-  } else if (!STRCASECMP(str, kA705Str)) {
-    return sharp_ac_remote_model_t::A705;
-  } else if (!STRCASECMP(str, kA903Str)) {
-    return sharp_ac_remote_model_t::A903;
-  // TCL A/C Models
-  } else if (!STRCASECMP(str, kTac09chsdStr)) {
-    return tcl_ac_remote_model_t::TAC09CHSD;
-  } else if (!STRCASECMP(str, kGz055be1Str)) {
-    return tcl_ac_remote_model_t::GZ055BE1;
-  // Voltas A/C models
-  } else if (!STRCASECMP(str, k122lzfStr)) {
-    return voltas_ac_remote_model_t::kVoltas122LZF;
-  // Whirlpool A/C models
-  } else if (!STRCASECMP(str, kDg11j13aStr) ||
-             !STRCASECMP(str, kDg11j104Str)) {
-    return whirlpool_ac_remote_model_t::DG11J13A;
-  } else if (!STRCASECMP(str, kDg11j191Str)) {
-    return whirlpool_ac_remote_model_t::DG11J191;
-  // Argo A/C models
-  } else if (!STRCASECMP(str, kArgoWrem2Str)) {
-    return argo_ac_remote_model_t::SAC_WREM2;
-  } else if (!STRCASECMP(str, kArgoWrem3Str)) {
-    return argo_ac_remote_model_t::SAC_WREM3;
-  } else {
-    int16_t number = atoi(str);
-    if (number > 0)
-      return number;
-    else
-      return def;
+  // All the named models are > 0, so 0 means no match.
+  const int16_t model = matchText(
+      str, kModelNames, sizeof(kModelNames) / sizeof(kModelNames[0]), 0);
+  if (model) return model;
+  const int16_t number = atoi(str);
+  if (number > 0)
+    return number;
+  else
+    return def;
+}
+
+#ifdef UNIT_TEST
+/// Access the text conversion tables so they can be checked by the tests.
+/// @param[in] index Which table. i.e. opmode, fanspeed, swingv, swingh, model.
+/// @param[out] size The nr. of entries in the table.
+/// @return A ptr to the table, or nullptr if there is no such table.
+const IRTextMatch *IRac::textMatchTable(const uint8_t index, uint16_t *size) {
+  switch (index) {
+    case 0:
+      *size = sizeof(kOpmodeNames) / sizeof(kOpmodeNames[0]);
+      return kOpmodeNames;
+    case 1:
+      *size = sizeof(kFanspeedNames) / sizeof(kFanspeedNames[0]);
+      return kFanspeedNames;
+    case 2:
+      *size = sizeof(kSwingVNames) / sizeof(kSwingVNames[0]);
+      return kSwingVNames;
+    case 3:
+      *size = sizeof(kSwingHNames) / sizeof(kSwingHNames[0]);
+      return kSwingHNames;
+    case 4:
+      *size = sizeof(kModelNames) / sizeof(kModelNames[0]);
+      return kModelNames;
+    default:
+      *size = 0;
+      return nullptr;
   }
 }
+#endif  // UNIT_TEST
 
 /// Convert the supplied str into the appropriate boolean value.
 /// @param[in] str A Ptr to a C-style string to be converted.
@@ -3971,17 +4058,17 @@ bool IRac::strToBool(const char *str, const bool def) {
     return def;
 }
 
-/// Convert the supplied boolean into the appropriate String.
+/// Get the IRtext for the supplied boolean. @see boolToString()
 /// @param[in] value The boolean value to be converted.
-/// @return The equivalent String for the locale.
-String IRac::boolToString(const bool value) {
+/// @return A ptr to the equivalent text for the locale.
+static IRTextPtr boolText(const bool value) {
   return value ? kOnStr : kOffStr;
 }
 
-/// Convert the supplied operation mode into the appropriate String.
+/// Get the IRtext for the supplied command type. @see commandTypeToString()
 /// @param[in] cmdType The enum to be converted.
-/// @return The equivalent String for the locale.
-String IRac::commandTypeToString(const stdAc::ac_command_t cmdType) {
+/// @return A ptr to the equivalent text for the locale.
+static IRTextPtr commandTypeText(const stdAc::ac_command_t cmdType) {
   switch (cmdType) {
     case stdAc::ac_command_t::kControlCommand:    return kControlCommandStr;
     case stdAc::ac_command_t::kSensorTempReport: return kIFeelReportStr;
@@ -3991,11 +4078,11 @@ String IRac::commandTypeToString(const stdAc::ac_command_t cmdType) {
   }
 }
 
-/// Convert the supplied operation mode into the appropriate String.
+/// Get the IRtext for the supplied operation mode. @see opmodeToString()
 /// @param[in] mode The enum to be converted.
 /// @param[in] ha A flag to indicate we want GoogleHome/HomeAssistant output.
-/// @return The equivalent String for the locale.
-String IRac::opmodeToString(const stdAc::opmode_t mode, const bool ha) {
+/// @return A ptr to the equivalent text for the locale.
+static IRTextPtr opmodeText(const stdAc::opmode_t mode, const bool ha) {
   switch (mode) {
     case stdAc::opmode_t::kOff:  return kOffStr;
     case stdAc::opmode_t::kAuto: return kAutoStr;
@@ -4007,10 +4094,10 @@ String IRac::opmodeToString(const stdAc::opmode_t mode, const bool ha) {
   }
 }
 
-/// Convert the supplied fan speed enum into the appropriate String.
+/// Get the IRtext for the supplied fan speed. @see fanspeedToString()
 /// @param[in] speed The enum to be converted.
-/// @return The equivalent String for the locale.
-String IRac::fanspeedToString(const stdAc::fanspeed_t speed) {
+/// @return A ptr to the equivalent text for the locale.
+static IRTextPtr fanspeedText(const stdAc::fanspeed_t speed) {
   switch (speed) {
     case stdAc::fanspeed_t::kAuto:       return kAutoStr;
     case stdAc::fanspeed_t::kMax:        return kMaxStr;
@@ -4023,10 +4110,10 @@ String IRac::fanspeedToString(const stdAc::fanspeed_t speed) {
   }
 }
 
-/// Convert the supplied enum into the appropriate String.
+/// Get the IRtext for the supplied vertical swing. @see swingvToString()
 /// @param[in] swingv The enum to be converted.
-/// @return The equivalent String for the locale.
-String IRac::swingvToString(const stdAc::swingv_t swingv) {
+/// @return A ptr to the equivalent text for the locale.
+static IRTextPtr swingvText(const stdAc::swingv_t swingv) {
   switch (swingv) {
     case stdAc::swingv_t::kOff:          return kOffStr;
     case stdAc::swingv_t::kAuto:         return kAutoStr;
@@ -4040,10 +4127,10 @@ String IRac::swingvToString(const stdAc::swingv_t swingv) {
   }
 }
 
-/// Convert the supplied enum into the appropriate String.
+/// Get the IRtext for the supplied horizontal swing. @see swinghToString()
 /// @param[in] swingh The enum to be converted.
-/// @return The equivalent String for the locale.
-String IRac::swinghToString(const stdAc::swingh_t swingh) {
+/// @return A ptr to the equivalent text for the locale.
+static IRTextPtr swinghText(const stdAc::swingh_t swingh) {
   switch (swingh) {
     case stdAc::swingh_t::kOff:      return kOffStr;
     case stdAc::swingh_t::kAuto:     return kAutoStr;
@@ -4057,8 +4144,420 @@ String IRac::swinghToString(const stdAc::swingh_t swingh) {
   }
 }
 
+/// Get the IRtext for the name of the supplied protocol. @see typeToString()
+/// @param[in] protocol The decode_type_t protocol to be converted.
+/// @return A ptr to the name of the protocol.
+static IRTextPtr protocolText(const decode_type_t protocol) {
+  if (protocol > kLastDecodeType || protocol < 0) return kUnknownStr;
+  auto *ptr = reinterpret_cast<const char*>(kAllProtocolNamesStr);
+  return IRTEXT_CONST_PTR_CAST(ptr + pgm_read_word(kAllProtocolNamesOffsets +
+                                                   protocol));
+}
+
+/// Convert the supplied boolean into the appropriate String.
+/// @param[in] value The boolean value to be converted.
+/// @return The equivalent String for the locale.
+String IRac::boolToString(const bool value) { return boolText(value); }
+
+/// Convert the supplied operation mode into the appropriate String.
+/// @param[in] cmdType The enum to be converted.
+/// @return The equivalent String for the locale.
+String IRac::commandTypeToString(const stdAc::ac_command_t cmdType) {
+  return commandTypeText(cmdType);
+}
+
+/// Convert the supplied operation mode into the appropriate String.
+/// @param[in] mode The enum to be converted.
+/// @param[in] ha A flag to indicate we want GoogleHome/HomeAssistant output.
+/// @return The equivalent String for the locale.
+String IRac::opmodeToString(const stdAc::opmode_t mode, const bool ha) {
+  return opmodeText(mode, ha);
+}
+
+/// Convert the supplied fan speed enum into the appropriate String.
+/// @param[in] speed The enum to be converted.
+/// @return The equivalent String for the locale.
+String IRac::fanspeedToString(const stdAc::fanspeed_t speed) {
+  return fanspeedText(speed);
+}
+
+/// Convert the supplied enum into the appropriate String.
+/// @param[in] swingv The enum to be converted.
+/// @return The equivalent String for the locale.
+String IRac::swingvToString(const stdAc::swingv_t swingv) {
+  return swingvText(swingv);
+}
+
+/// Convert the supplied enum into the appropriate String.
+/// @param[in] swingh The enum to be converted.
+/// @return The equivalent String for the locale.
+String IRac::swinghToString(const stdAc::swingh_t swingh) {
+  return swinghText(swingh);
+}
+
+/// The fields of a stdAc::state_t that are in its JSON form.
+/// @see kJsonKeys
+enum IRacJsonField {
+  kJsonProtocol = 0,
+  kJsonModel,
+  kJsonCommand,
+  kJsonPower,
+  kJsonMode,
+  kJsonCelsius,
+  kJsonTemp,
+  kJsonSensorTemp,
+  kJsonFanspeed,
+  kJsonSwingV,
+  kJsonSwingH,
+  kJsonQuiet,
+  kJsonIFeel,
+  kJsonTurbo,
+  kJsonEcono,
+  kJsonLight,
+  kJsonFilter,
+  kJsonClean,
+  kJsonBeep,
+  kJsonSleep,
+  kJsonFields  // Not a field. The nr. of fields.
+};
+
+/// The JSON keys of a stdAc::state_t, in IRacJsonField order.
+/// @note These are the same as IRMQTTServer's MQTT topic names.
+static const char kJsonKeys[kJsonFields][12] PROGMEM = {
+    "protocol", "model", "command", "power", "mode", "use_celsius", "temp",
+    "sensortemp", "fanspeed", "swingv", "swingh", "quiet", "ifeel", "turbo",
+    "econo", "light", "filter", "clean", "beep", "sleep"};
+
+/// A fixed size buffer that some JSON is being written into.
+struct IRacJsonOut {
+  char *buf;  ///< Where to write the JSON.
+  uint16_t size;  ///< The size of `buf`, including room for a NUL.
+  uint16_t len;  ///< The nr. of chars written so far.
+  bool ok;  ///< Has everything fitted in `buf` so far?
+};
+
+/// Add a char to some JSON output, if it will fit.
+/// @param[in,out] out The JSON output.
+/// @param[in] c The char to add.
+static void jsonChar(IRacJsonOut *out, const char c) {
+  if (out->len + 1U < out->size)  // Always leave room for the NUL.
+    out->buf[out->len++] = c;
+  else
+    out->ok = false;
+}
+
+/// Add some text to some JSON output as a JSON string.
+/// @param[in,out] out The JSON output.
+/// @param[in] str A Ptr to a C-style string. It may be in flash (PROGMEM).
+static void jsonQuoted(IRacJsonOut *out, const char *str) {
+  jsonChar(out, '"');
+  for (char c = pgm_read_byte(str); c; c = pgm_read_byte(++str)) {
+    if (c == '"' || c == '\\') jsonChar(out, '\\');
+    jsonChar(out, c);
+  }
+  jsonChar(out, '"');
+}
+
+/// Add the key of a field (and any separator needed) to some JSON output.
+/// @param[in,out] out The JSON output.
+/// @param[in] field The field the key is for.
+static void jsonKey(IRacJsonOut *out, const IRacJsonField field) {
+  if (out->len > 1) jsonChar(out, ',');  // Not the first field.
+  jsonQuoted(out, kJsonKeys[field]);
+  jsonChar(out, ':');
+}
+
+/// Add a field with a text value to some JSON output.
+/// @param[in,out] out The JSON output.
+/// @param[in] field The field being added.
+/// @param[in] text The IRtext value of the field.
+static void jsonText(IRacJsonOut *out, const IRacJsonField field,
+                     IRTextPtr text) {
+  jsonKey(out, field);
+  jsonQuoted(out, reinterpret_cast<const char*>(text));
+}
+
+/// Add a field with an integer value to some JSON output.
+/// @param[in,out] out The JSON output.
+/// @param[in] field The field being added.
+/// @param[in] value The value of the field.
+static void jsonInt(IRacJsonOut *out, const IRacJsonField field,
+                    const int32_t value) {
+  char num[12];  // Big enough for any int32_t.
+  snprintf(num, sizeof(num), "%d", static_cast<int>(value));
+  jsonKey(out, field);
+  for (const char *ptr = num; *ptr; ptr++) jsonChar(out, *ptr);
+}
+
+/// Add a field with a (one decimal place) temperature value to some JSON
+/// output.
+/// @param[in,out] out The JSON output.
+/// @param[in] field The field being added.
+/// @param[in] value The value of the field. A NaN, or a value beyond
+///   +/- kJsonTempLimit, is written as null.
+static void jsonFloat(IRacJsonOut *out, const IRacJsonField field,
+                      const float value) {
+  char num[16] = "null";
+  // NaN fails both comparisons. Converting it, or a huge value, is undefined.
+  if (value >= -kJsonTempLimit && value <= kJsonTempLimit) {
+    const int32_t tenths = value * 10 + ((value < 0) ? -0.5 : 0.5);
+    const int32_t whole = (tenths < 0) ? -tenths : tenths;
+    if (whole % 10)
+      snprintf(num, sizeof(num), "%s%d.%d", (tenths < 0) ? "-" : "",
+               static_cast<int>(whole / 10), static_cast<int>(whole % 10));
+    else
+      snprintf(num, sizeof(num), "%d", static_cast<int>(tenths / 10));
+  }
+  jsonKey(out, field);
+  for (const char *ptr = num; *ptr; ptr++) jsonChar(out, *ptr);
+}
+
+/// Convert a state into a JSON object, without using the heap.
+/// e.g. {"protocol":"DAIKIN","model":-1,"command":"Control",...,"sleep":-1}
+/// @param[in] state The state to convert.
+/// @param[out] buf Where to write the NUL terminated JSON.
+/// @param[in] size The size of `buf`. kStateJsonMaxSize is always big enough.
+/// @param[in] ha A flag to indicate we want GoogleHome/HomeAssistant output.
+///   i.e. The mode is "off" if the power is off, and vice-versa.
+/// @return The length of the JSON written, or 0 if it didn't fit in `buf`.
+/// @note The keys are the same as IRMQTTServer's MQTT topic names.
+uint16_t IRac::stateToJson(const stdAc::state_t &state, char *buf,
+                           const uint16_t size, const bool ha) {
+  if (buf == NULL) return 0;
+  IRacJsonOut out = {buf, size, 0, true};
+  const bool off = ha && (state.mode == stdAc::opmode_t::kOff || !state.power);
+  jsonChar(&out, '{');
+  jsonText(&out, kJsonProtocol, protocolText(state.protocol));
+  jsonInt(&out, kJsonModel, state.model);
+  jsonText(&out, kJsonCommand, commandTypeText(state.command));
+  jsonText(&out, kJsonPower, boolText(state.power && !off));
+  jsonText(&out, kJsonMode,
+           opmodeText(off ? stdAc::opmode_t::kOff : state.mode, ha));
+  jsonText(&out, kJsonCelsius, boolText(state.celsius));
+  jsonFloat(&out, kJsonTemp, state.degrees);
+  jsonFloat(&out, kJsonSensorTemp, state.sensorTemperature);
+  jsonText(&out, kJsonFanspeed, fanspeedText(state.fanspeed));
+  jsonText(&out, kJsonSwingV, swingvText(state.swingv));
+  jsonText(&out, kJsonSwingH, swinghText(state.swingh));
+  jsonText(&out, kJsonQuiet, boolText(state.quiet));
+  jsonText(&out, kJsonIFeel, boolText(state.iFeel));
+  jsonText(&out, kJsonTurbo, boolText(state.turbo));
+  jsonText(&out, kJsonEcono, boolText(state.econo));
+  jsonText(&out, kJsonLight, boolText(state.light));
+  jsonText(&out, kJsonFilter, boolText(state.filter));
+  jsonText(&out, kJsonClean, boolText(state.clean));
+  jsonText(&out, kJsonBeep, boolText(state.beep));
+  jsonInt(&out, kJsonSleep, state.sleep);
+  jsonChar(&out, '}');
+  if (!out.ok) out.len = 0;
+  if (size) buf[out.len] = '\0';
+  return out.len;
+}
+
+/// The type of a JSON value found by jsonToState().
+enum IRacJsonType { kJsonString, kJsonNumber, kJsonBool, kJsonNull };
+
+/// Skip over any JSON whitespace.
+/// @param[in] ptr A Ptr into a C-style string.
+/// @return A Ptr to the first non-whitespace char.
+static const char *jsonSkipSpace(const char *ptr) {
+  while (*ptr == ' ' || *ptr == '\t' || *ptr == '\r' || *ptr == '\n') ptr++;
+  return ptr;
+}
+
+/// Copy a JSON string out of some JSON text.
+/// @param[in] ptr A Ptr to the opening quote of the string.
+/// @param[out] str Where to copy the (unescaped) string to.
+/// @param[in] size The size of `str`, including room for a NUL.
+/// @param[out] fits Set to whether the string fitted in `str`. If it didn't,
+///   `str` is left empty.
+/// @return A Ptr to just after the closing quote, or NULL if the string is
+///   malformed.
+static const char *jsonString(const char *ptr, char *str,
+                              const uint16_t size, bool *fits) {
+  if (*ptr++ != '"') return NULL;
+  uint16_t len = 0;
+  *fits = true;
+  while (*ptr != '"') {
+    char c = *ptr++;
+    if (c == '\0') return NULL;  // Unterminated.
+    if (c == '\\') {
+      c = *ptr++;
+      switch (c) {
+        case '"': case '\\': case '/': break;
+        case 'b': c = '\b'; break;
+        case 'f': c = '\f'; break;
+        case 'n': c = '\n'; break;
+        case 'r': c = '\r'; break;
+        case 't': c = '\t'; break;
+        default: return NULL;  // e.g. A unicode escape, which we don't use.
+      }
+    }
+    if (len + 1U >= size)  // Too big. Skip over the rest of it.
+      *fits = false;
+    else
+      str[len++] = c;
+  }
+  str[*fits ? len : 0] = '\0';
+  return ptr + 1;
+}
+
+/// Get the address of a boolean field in a state.
+/// @param[in] state A Ptr to the state.
+/// @param[in] field The field we want.
+/// @return A Ptr to the field, or NULL if it isn't a boolean field.
+static bool *jsonBoolField(stdAc::state_t *state, const IRacJsonField field) {
+  switch (field) {
+    case kJsonPower:   return &state->power;
+    case kJsonCelsius: return &state->celsius;
+    case kJsonQuiet:   return &state->quiet;
+    case kJsonIFeel:   return &state->iFeel;
+    case kJsonTurbo:   return &state->turbo;
+    case kJsonEcono:   return &state->econo;
+    case kJsonLight:   return &state->light;
+    case kJsonFilter:  return &state->filter;
+    case kJsonClean:   return &state->clean;
+    case kJsonBeep:    return &state->beep;
+    default:           return NULL;
+  }
+}
+
+/// Update a field of a state with a value from some JSON.
+/// Values of the wrong type for the field are ignored.
+/// @param[in,out] state A Ptr to the state to update.
+/// @param[in] field The field to update.
+/// @param[in] type The type of the JSON value.
+/// @param[in] str The value, if it is a string.
+/// @param[in] number The value, if it is a number or a boolean.
+static void jsonSetField(stdAc::state_t *state, const IRacJsonField field,
+                         const IRacJsonType type, const char *str,
+                         const double number) {
+  bool *flag = jsonBoolField(state, field);
+  if (flag != NULL) {
+    if (type == kJsonString)
+      *flag = IRac::strToBool(str);
+    else if (type == kJsonBool)
+      *flag = number;
+    return;
+  }
+  if (type == kJsonString) {
+    switch (field) {
+      case kJsonProtocol: state->protocol = strToDecodeType(str); break;
+      case kJsonModel:    state->model = IRac::strToModel(str); break;
+      case kJsonCommand:  state->command = IRac::strToCommandType(str); break;
+      case kJsonMode:     state->mode = IRac::strToOpmode(str); break;
+      case kJsonFanspeed: state->fanspeed = IRac::strToFanspeed(str); break;
+      case kJsonSwingV:   state->swingv = IRac::strToSwingV(str); break;
+      case kJsonSwingH:   state->swingh = IRac::strToSwingH(str); break;
+      default: break;
+    }
+  } else if (type == kJsonNumber) {
+    // Out of range numbers are ignored, as converting them is undefined.
+    const bool isInt16 = number >= INT16_MIN && number <= INT16_MAX;
+    const bool isTemp = number >= -kJsonTempLimit && number <= kJsonTempLimit;
+    switch (field) {
+      case kJsonProtocol:
+        if (number >= decode_type_t::UNKNOWN &&
+            number <= decode_type_t::kLastDecodeType)
+          state->protocol = (decode_type_t)static_cast<int16_t>(number);
+        break;
+      case kJsonModel: if (isInt16) state->model = number; break;
+      case kJsonCommand:
+        if (number >= 0 &&
+            number <= (int8_t)stdAc::ac_command_t::kLastAcCommandEnum)
+          state->command = (stdAc::ac_command_t)static_cast<int8_t>(number);
+        break;
+      case kJsonTemp: if (isTemp) state->degrees = number; break;
+      case kJsonSensorTemp:
+        if (isTemp) state->sensorTemperature = number;
+        break;
+      case kJsonSleep: if (isInt16) state->sleep = number; break;
+      default: break;
+    }
+  }
+}
+
+/// Update a state from a JSON object, without using the heap.
+/// e.g. {"mode":"cool","temp":23.5,"power":"on"}
+/// Only the fields present are changed. Unknown keys are ignored, as are keys
+/// longer than kJsonKeyMaxLength & their values.
+/// @param[in] str A Ptr to a C-style string containing the JSON object.
+///   e.g. As made by stateToJson().
+/// @param[in,out] state A Ptr to the state to update.
+/// @return true, if the JSON was a valid flat JSON object, otherwise false and
+///   the state is left unchanged. A string value for a known key that is
+///   longer than kJsonValueMaxLength also counts as invalid. Valid numbers
+///   that are out of range for their field are ignored. e.g. 1e30 for "temp".
+/// @note The keys are the same as IRMQTTServer's MQTT topic names.
+bool IRac::jsonToState(const char *str, stdAc::state_t *state) {
+  if (str == NULL || state == NULL) return false;
+  stdAc::state_t result = *state;
+  char key[kJsonKeyMaxLength + 1];
+  char text[kJsonValueMaxLength + 1];
+  bool fits;
+  const char *ptr = jsonSkipSpace(str);
+  if (*ptr++ != '{') return false;
+  ptr = jsonSkipSpace(ptr);
+  bool more = (*ptr != '}');
+  if (!more) ptr++;  // An empty object.
+  while (more) {
+    ptr = jsonString(jsonSkipSpace(ptr), key, sizeof(key), &fits);
+    if (ptr == NULL) return false;
+    uint8_t field = kJsonFields;  // i.e. A key we don't use.
+    if (fits)  // An over-long key can't be one of ours.
+      for (field = 0; field < kJsonFields; field++)
+        if (!STRCMP_P(key, kJsonKeys[field])) break;
+    ptr = jsonSkipSpace(ptr);
+    if (*ptr++ != ':') return false;
+    ptr = jsonSkipSpace(ptr);
+    IRacJsonType type;
+    double number = 0;
+    text[0] = '\0';
+    if (*ptr == '"') {
+      type = kJsonString;
+      ptr = jsonString(ptr, text, sizeof(text), &fits);
+      if (ptr == NULL) return false;
+      // We can't use an over-long value, but only care if it is for our key.
+      if (!fits && field < kJsonFields) return false;
+    } else if (!strncmp(ptr, "true", 4)) {
+      type = kJsonBool;
+      number = true;
+      ptr += 4;
+    } else if (!strncmp(ptr, "false", 5)) {
+      type = kJsonBool;
+      ptr += 5;
+    } else if (!strncmp(ptr, "null", 4)) {
+      type = kJsonNull;
+      ptr += 4;
+    } else {  // It must be a number. (Nested objects & arrays aren't allowed.)
+      // strtod() also takes things JSON doesn't. e.g. "nan", "inf" & "0x1F"
+      if (*ptr != '-' && (*ptr < '0' || *ptr > '9')) return false;
+      char *end;
+      type = kJsonNumber;
+      number = strtod(ptr, &end);
+      if (end == ptr) return false;
+      for (; ptr < end; ptr++)
+        if (!strchr("0123456789+-.eE", *ptr)) return false;
+    }
+    if (field < kJsonFields)
+      jsonSetField(&result, static_cast<IRacJsonField>(field), type, text,
+                   number);
+    ptr = jsonSkipSpace(ptr);
+    more = (*ptr == ',');
+    if (!more && *ptr != '}') return false;
+    ptr++;
+  }
+  if (*jsonSkipSpace(ptr)) return false;  // Trailing junk.
+  *state = result;
+  return true;
+}
+
 namespace IRAcUtils {
   /// Display the human readable state of an A/C message if we can.
+  /// @note Protocols with a read-only view class (e.g. IRAmcorAcView) use it
+  ///   to avoid making a full A/C object. Currently only AIRTON, AMCOR, &
+  ///   DAIKIN have one. The rest still use their A/C class. (Same for
+  ///   decodeToState())
   /// @param[in] result A Ptr to the captured `decode_results` that contains an
   ///   A/C mesg.
   /// @return A string with the human description of the A/C message.
@@ -4066,11 +4565,9 @@ namespace IRAcUtils {
   String resultAcToString(const decode_results * const result) {
     switch (result->decode_type) {
 #if DECODE_AIRTON
-      case decode_type_t::AIRTON: {
-        IRAirtonAc ac(kGpioUnused);
-        ac.setRaw(result->value);  // AIRTON uses value instead of state.
-        return ac.toString();
-      }
+      case decode_type_t::AIRTON:
+        // AIRTON uses value instead of state.
+        return IRAirtonAcView(result->value).toString();
 #endif  // DECODE_AIRTON
 #if DECODE_AIRWELL
       case decode_type_t::AIRWELL: {
@@ -4080,11 +4577,8 @@ namespace IRAcUtils {
       }
 #endif  // DECODE_AIRWELL
 #if DECODE_AMCOR
-      case decode_type_t::AMCOR: {
-        IRAmcorAc ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
+      case decode_type_t::AMCOR:
+        return IRAmcorAcView(result->state).toString();
 #endif  // DECODE_AMCOR
 #if DECODE_ARGO
       case decode_type_t::ARGO: {
@@ -4129,11 +4623,8 @@ namespace IRAcUtils {
       }
 #endif  // DECODE_CORONA_AC
 #if DECODE_DAIKIN
-      case decode_type_t::DAIKIN: {
-        IRDaikinESP ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
+      case decode_type_t::DAIKIN:
+        return IRDaikinESPView(result->state).toString();
 #endif  // DECODE_DAIKIN
 #if DECODE_DAIKIN128
       case decode_type_t::DAIKIN128: {
@@ -4538,12 +5029,10 @@ namespace IRAcUtils {
     if (decode == NULL || result == NULL) return false;  // Safety check.
     switch (decode->decode_type) {
 #if DECODE_AIRTON
-      case decode_type_t::AIRTON: {
-        IRAirtonAc ac(kGpioUnused);
-        ac.setRaw(decode->value);  // Uses value instead of state.
-        *result = ac.toCommon();
+      case decode_type_t::AIRTON:
+        // Uses value instead of state.
+        *result = IRAirtonAcView(decode->value).toCommon();
         break;
-      }
 #endif  // DECODE_AIRTON
 #if DECODE_AIRWELL
       case decode_type_t::AIRWELL: {
@@ -4554,12 +5043,9 @@ namespace IRAcUtils {
       }
 #endif  // DECODE_AIRWELL
 #if DECODE_AMCOR
-      case decode_type_t::AMCOR: {
-        IRAmcorAc ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
+      case decode_type_t::AMCOR:
+        *result = IRAmcorAcView(decode->state).toCommon();
         break;
-      }
 #endif  // DECODE_AMCOR
 #if DECODE_ARGO
       case decode_type_t::ARGO: {
@@ -4617,12 +5103,9 @@ namespace IRAcUtils {
       }
 #endif  // DECODE_CARRIER_AC64
 #if DECODE_DAIKIN
-      case decode_type_t::DAIKIN: {
-        IRDaikinESP ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
+      case decode_type_t::DAIKIN:
+        *result = IRDaikinESPView(decode->state).toCommon();
         break;
-      }
 #endif  // DECODE_DAIKIN
 #if DECODE_DAIKIN128
       case decode_type_t::DAIKIN128: {
@@ -9,6 +9,7 @@
 #include <memory>
 #endif
 #include "IRremoteESP8266.h"
+#include "IRtext.h"
 #include "ir_Airton.h"
 #include "ir_Airwell.h"
 #include "ir_Amcor.h"
@@ -53,6 +54,21 @@
 
 // Constants
 const int8_t kGpioUnused = -1;  ///< A placeholder for not using an actual GPIO.
+/// Size of a buffer big enough for any IRac::stateToJson() output.
+const uint16_t kStateJsonMaxSize = 512;
+/// Longest key or string value that IRac::jsonToState() will read.
+const uint8_t kJsonKeyMaxLength = 16;
+const uint8_t kJsonValueMaxLength = 40;  ///< @see kJsonKeyMaxLength
+/// Temperatures (C or F) beyond +/- this are ignored by IRac::jsonToState(),
+/// and written as null by IRac::stateToJson().
+const float kJsonTempLimit = 1000;
+
+/// An entry in a table used to convert text into a value. e.g. A mode name.
+struct IRTextMatch {
+  uint16_t hash;  ///< The irutils::textHash() of the text.
+  int16_t value;  ///< The value the text converts to.
+  IRTEXT_CONST_PTR(*text);  ///< A ptr to the (IRtext) text to match.
+};
 
 // Class
 /// A universal/common/generic interface for controling supported A/Cs.
@@ -105,6 +121,9 @@ class IRac {
   static String fanspeedToString(const stdAc::fanspeed_t speed);
   static String swingvToString(const stdAc::swingv_t swingv);
   static String swinghToString(const stdAc::swingh_t swingh);
+  static uint16_t stateToJson(const stdAc::state_t &state, char *buf,
+                              const uint16_t size, const bool ha = false);
+  static bool jsonToState(const char *str, stdAc::state_t *state);
   stdAc::state_t getState(void);
   stdAc::state_t getStatePrev(void);
   bool hasStateChanged(void);
@@ -115,6 +134,8 @@ class IRac {
   /// See @c OUTPUT_DECODE_RESULTS_FOR_UT macro description in IRac.cpp
   std::shared_ptr<IRrecv> _utReceiver = nullptr;
   std::unique_ptr<decode_results> _lastDecodeResults = nullptr;
+  static const IRTextMatch *textMatchTable(const uint8_t index,
+                                           uint16_t *size);
   /// @endcond
 #else
 
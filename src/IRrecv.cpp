@@ -5,6 +5,7 @@
 
 #include "IRrecv.h"
 #include <stddef.h>
+#include <string.h>
 #ifndef UNIT_TEST
 #if defined(ESP8266)
 extern "C" {
@@ -19,8 +20,22 @@ extern "C" {
 #include <cassert>
 #endif  // UNIT_TEST
 #include "IRremoteESP8266.h"
+#include "IRsend.h"
 #include "IRutils.h"
 
+// Are we capturing via the ESP32's RMT peripheral? (See ENABLE_ESP32_RMT_RECV)
+#if defined(ESP32) && ENABLE_ESP32_RMT_RECV && !defined(UNIT_TEST)
+// The legacy RMT driver we use was replaced in ESP-IDF v5 (Arduino core v3.x),
+// & can't be used alongside the core's own (new) RMT driver there.
+#if !defined(ESP_ARDUINO_VERSION_MAJOR) || (ESP_ARDUINO_VERSION_MAJOR != 2)
+#error "ENABLE_ESP32_RMT_RECV needs a v2.x ESP32 Arduino core. Disable it."
+#endif  // !defined(ESP_ARDUINO_VERSION_MAJOR) || ...
+#define _IRRECV_USE_RMT true
+#include <driver/rmt.h>
+#else  // defined(ESP32) && ENABLE_ESP32_RMT_RECV && !defined(UNIT_TEST)
+#define _IRRECV_USE_RMT false
+#endif  // defined(ESP32) && ENABLE_ESP32_RMT_RECV && !defined(UNIT_TEST)
+
 #ifdef UNIT_TEST
 #undef ICACHE_RAM_ATTR
 #define ICACHE_RAM_ATTR
@@ -38,6 +53,9 @@ extern "C" {
 #define USE_IRAM_ATTR IRAM_ATTR
 #endif  // ESP32
 #endif  // USE_IRAM_ATTR
+#ifndef USE_IRAM_ATTR  // e.g. Unit tests.
+#define USE_IRAM_ATTR
+#endif  // USE_IRAM_ATTR
 
 #define ONCE 0
 
@@ -145,16 +163,271 @@ namespace _IRrecv {  // Namespace extension
 portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
 #endif  // ESP32
 volatile irparams_t params;
-irparams_t *params_save;  // A copy of the interrupt state while decoding.
 }  // namespace _IRrecv
 
+#if defined(ESP32) && !defined(UNIT_TEST)
+namespace _IRrecv {  // Namespace extension
+/// The optional decode task, if running. (See IRrecv::startDecodeTask())
+/// Only set once the task has been created, so the interrupt handler never
+/// sees a half made task.
+static TaskHandle_t volatile decode_task = NULL;
+static volatile uint8_t decode_task_state = kDecodeTaskStopped;
+}  // namespace _IRrecv
+using _IRrecv::decode_task;
+using _IRrecv::decode_task_state;
+#endif  // defined(ESP32) && !defined(UNIT_TEST)
 #if defined(ESP32)
 using _IRrecv::mux;
 #endif  // ESP32
 using _IRrecv::params;
-using _IRrecv::params_save;
 
-#ifndef UNIT_TEST
+namespace _IRrecv {  // Namespace extension
+/// Back-to-back capture buffers for the game receive profile.
+/// (See IRrecv::enableGameMode())
+static uint16_t *game_rawbufs = NULL;  // `game_frames` * kGameFrameSize.
+static uint16_t *game_rawlens = NULL;  // Length of each completed frame.
+static uint32_t *game_timestamps = NULL;  // When each frame ended.
+static uint8_t game_frames = 0;  // Nr. of buffers. 0 means not in game mode.
+static volatile uint8_t game_head = 0;  // The buffer being captured into.
+static volatile uint8_t game_tail = 0;  // The oldest completed frame.
+static volatile uint32_t game_lost = 0;  // Frames dropped for lack of room.
+// The normal capture settings, to restore when we leave game mode.
+static uint16_t *game_saved_rawbuf = NULL;
+static uint16_t game_saved_bufsize = 0;
+static uint8_t game_saved_timeout = 0;
+
+/// Finish the frame just captured in game mode, and start capturing into the
+/// next free buffer straight away. i.e. The next shot isn't missed while this
+/// one waits to be decoded. The frame is dropped if there is no free buffer.
+/// @param[in] now The time (micros()) the frame ended.
+static void USE_IRAM_ATTR game_frame_end(const uint32_t now) {
+  uint8_t next = game_head + 1;
+  if (next >= game_frames) next = 0;
+  if (params.overflow || next == game_tail) {
+    game_lost = game_lost + 1;
+  } else {
+    game_rawlens[game_head] = params.rawlen;
+    game_timestamps[game_head] = now;
+    game_head = next;
+    params.rawbuf = game_rawbufs + next * kGameFrameSize;
+  }
+  params.rawlen = 0;
+  params.overflow = false;
+  params.rcvstate = kIdleState;
+}
+}  // namespace _IRrecv
+using _IRrecv::game_frame_end;
+using _IRrecv::game_frames;
+using _IRrecv::game_head;
+using _IRrecv::game_lost;
+using _IRrecv::game_rawbufs;
+using _IRrecv::game_rawlens;
+using _IRrecv::game_saved_bufsize;
+using _IRrecv::game_saved_rawbuf;
+using _IRrecv::game_saved_timeout;
+using _IRrecv::game_tail;
+using _IRrecv::game_timestamps;
+
+#ifdef UNIT_TEST
+extern uint32_t _IRtimer_unittest_now;
+#endif  // UNIT_TEST
+
+namespace _IRrecv {  // Namespace extension
+/// The delay line of received edges for the cut-through repeater.
+/// (See IRrecv::enableRepeater())
+static uint32_t *repeater_times = NULL;  // When each edge was received.
+static bool *repeater_marks = NULL;  // Did the edge start a mark?
+static uint8_t repeater_size = 0;  // Nr. of edges. 0 means not repeating.
+static volatile uint8_t repeater_head = 0;  // Where the next edge goes.
+static volatile uint8_t repeater_tail = 0;  // The oldest edge not yet sent.
+static volatile uint32_t repeater_last = 0;  // When the last edge was seen.
+static volatile bool repeater_mark = false;  // Is the receiver seeing a mark?
+static volatile bool repeater_holdoff = false;  // Ignoring a feedback loop?
+static uint32_t repeater_min_pulse = 0;  // In uSeconds.
+static uint32_t repeater_quiet = 0;  // uSeconds of silence that end a frame.
+static uint16_t repeater_delay = 0;  // In uSeconds.
+static uint16_t repeater_hz = 0;  // Carrier frequency to retransmit with.
+static ir_repeater_stats_t repeater_stats;
+/// Where repeat() is up to in retransmitting a frame, between calls.
+static bool repeater_busy = false;  // Part way through a frame?
+static bool repeater_on = false;  // Is the LED sending a mark?
+static uint32_t repeater_on_since = 0;  // When the LED started the mark.
+static uint32_t repeater_shift = 0;  // How late (in uSeconds) the frame is.
+/// The last few edges we sent, so echoes of them can be spotted.
+static uint32_t repeater_sent_times[kRepeaterEchoEdges * 2];
+static bool repeater_sent_marks[kRepeaterEchoEdges * 2];
+static uint8_t repeater_sent = 0;  // Where the next sent edge goes.
+static uint8_t repeater_echoes = 0;  // Nr. of echoes received in a row.
+
+/// The current time, as the repeater's interrupt handler would see it.
+/// @return The time in uSeconds. i.e. micros(), or the unit test clock.
+static uint32_t repeater_now(void) {
+#ifdef UNIT_TEST
+  return _IRtimer_unittest_now;
+#else  // UNIT_TEST
+  return micros();
+#endif  // UNIT_TEST
+}
+
+/// Add an edge just seen by the interrupt handler to the repeater's delay
+/// line. A pulse shorter than `repeater_min_pulse` is a glitch, so it is
+/// removed along with its leading edge, which hasn't been retransmitted yet.
+/// @param[in] now The time (micros()) of the edge.
+static void USE_IRAM_ATTR repeater_edge(const uint32_t now) {
+  if (!repeater_size) return;  // Not repeating.
+  const uint32_t gap = now - repeater_last;
+  repeater_last = now;
+  if (repeater_holdoff) {  // Ignore everything until it has gone quiet.
+    if (gap < repeater_quiet) return;
+    repeater_holdoff = false;
+  }
+  uint8_t head = repeater_head;
+  if (head != repeater_tail && gap < repeater_min_pulse) {  // A glitch.
+    head = (head ? head : repeater_size) - 1;
+    repeater_head = head;
+    repeater_mark = !repeater_mark;
+    if (head != repeater_tail)  // Measure from the edge before the glitch.
+      repeater_last = repeater_times[(head ? head : repeater_size) - 1];
+    repeater_stats.glitches++;
+    return;
+  }
+  // After a silence, the receiver can only be seeing the start of a mark.
+  const bool mark = (gap >= repeater_quiet) || !repeater_mark;
+  const uint8_t next = (head + 1 >= repeater_size) ? 0 : head + 1;
+  if (next == repeater_tail) {  // The delay line is full.
+    repeater_stats.overflows++;
+    return;
+  }
+  repeater_times[head] = now;
+  repeater_marks[head] = mark;
+  repeater_mark = mark;
+  __sync_synchronize();  // Store the edge before handing it over.
+  repeater_head = next;
+}
+}  // namespace _IRrecv
+using _IRrecv::repeater_busy;
+using _IRrecv::repeater_delay;
+using _IRrecv::repeater_echoes;
+using _IRrecv::repeater_edge;
+using _IRrecv::repeater_head;
+using _IRrecv::repeater_holdoff;
+using _IRrecv::repeater_hz;
+using _IRrecv::repeater_last;
+using _IRrecv::repeater_mark;
+using _IRrecv::repeater_marks;
+using _IRrecv::repeater_min_pulse;
+using _IRrecv::repeater_now;
+using _IRrecv::repeater_on;
+using _IRrecv::repeater_on_since;
+using _IRrecv::repeater_quiet;
+using _IRrecv::repeater_sent;
+using _IRrecv::repeater_sent_marks;
+using _IRrecv::repeater_sent_times;
+using _IRrecv::repeater_shift;
+using _IRrecv::repeater_size;
+using _IRrecv::repeater_stats;
+using _IRrecv::repeater_tail;
+using _IRrecv::repeater_times;
+
+#if _IRRECV_USE_RMT
+// The RMT receive channel & memory we use. i.e. The first channel capable of
+// receiving, plus the memory blocks of the channels after it. The more blocks,
+// the longer the message we can capture.
+// Note: A message longer than the RMT memory is lost by the RMT driver.
+const rmt_channel_t kRmtChannel = (rmt_channel_t)(
+    SOC_RMT_CHANNELS_PER_GROUP - SOC_RMT_RX_CANDIDATES_PER_GROUP);
+const uint8_t kRmtMemBlocks = std::min(SOC_RMT_RX_CANDIDATES_PER_GROUP, 4);
+// Nr. of messages the driver can queue up for decode() before losing any.
+const uint8_t kRmtQueuedMessages = 4;
+
+namespace _IRrecv {  // Namespace extension
+static RingbufHandle_t rmt_ringbuf = NULL;
+static bool rmt_running = false;
+
+/// Fetch the next message (if any) captured by the RMT peripheral, and convert
+/// it into the capture buffer. Does nothing if the buffer is still in use.
+/// @param[in] wait How long to wait (in RTOS ticks) for a message to arrive.
+static void rmt_poll(const TickType_t wait = 0) {
+  if (params.rcvstate == kStopState || rmt_ringbuf == NULL) return;
+  size_t length = 0;
+  rmt_item32_t *items = reinterpret_cast<rmt_item32_t *>(
+      xRingbufferReceive(rmt_ringbuf, &length, wait));
+  if (items == NULL) return;  // Nothing captured yet.
+  bool overflow = false;
+  const uint16_t rawlen = IRrecv::rmtToRawbuf(
+      reinterpret_cast<const uint32_t *>(items),
+      length / sizeof(rmt_item32_t), params.rawbuf, params.bufsize, &overflow);
+  vRingbufferReturnItem(rmt_ringbuf, items);
+  if (rawlen <= kStartOffset) return;  // No marks. i.e. Nothing of use.
+  params.rawlen = rawlen;
+  params.overflow = overflow;
+  if (game_frames)
+    game_frame_end(micros());  // Queue it, and carry on capturing.
+  else
+    params.rcvstate = kStopState;
+}
+}  // namespace _IRrecv
+using _IRrecv::rmt_poll;
+using _IRrecv::rmt_ringbuf;
+using _IRrecv::rmt_running;
+#endif  // _IRRECV_USE_RMT
+
+#if defined(UNIT_TEST) || !_IRRECV_USE_RMT
+namespace _IRrecv {  // Namespace extension
+static uint32_t capture_start = 0;  // When the previous edge was captured.
+
+/// Capture an edge (a change on the GPIO pin) into the capture buffer.
+/// The body of the GPIO interrupt handler.
+/// @param[in] now The time (micros()) of the edge.
+/// @return True, if capturing carries on. i.e. The timeout needs restarting.
+static bool USE_IRAM_ATTR capture_edge(const uint32_t now) {
+  // Grab a local copy of rawlen to reduce instructions used in IRAM.
+  // This is an ugly premature optimisation code-wise, but we do everything we
+  // can to save IRAM.
+  // It seems referencing the value via the structure uses more instructions.
+  // Less instructions means faster and less IRAM used.
+  // N.B. It saves about 13 bytes of IRAM.
+  uint16_t rawlen = params.rawlen;
+
+  if (rawlen >= params.bufsize) {
+    params.overflow = true;
+    params.rcvstate = kStopState;
+  }
+
+  if (params.rcvstate == kStopState) return false;
+
+  if (params.rcvstate == kIdleState) {
+    params.rcvstate = kMarkState;
+    params.rawbuf[rawlen] = 1;
+  } else {
+    if (now < capture_start)
+      params.rawbuf[rawlen] = (UINT32_MAX - capture_start + now) / kRawTick;
+    else
+      params.rawbuf[rawlen] = (now - capture_start) / kRawTick;
+  }
+  params.rawlen++;
+
+  capture_start = now;
+  return true;
+}
+
+/// End the capture of a message, as there have been no edges for a while.
+/// The body of the timeout interrupt handler.
+/// @param[in] now The time (micros()) the timeout happened.
+static void USE_IRAM_ATTR capture_timeout(const uint32_t now) {
+  if (params.rawlen) {
+    if (game_frames)
+      game_frame_end(now);  // Queue it, and carry on capturing.
+    else
+      params.rcvstate = kStopState;
+  }
+}
+}  // namespace _IRrecv
+using _IRrecv::capture_edge;
+using _IRrecv::capture_timeout;
+#endif  // defined(UNIT_TEST) || !_IRRECV_USE_RMT
+
+#if !defined(UNIT_TEST) && !_IRRECV_USE_RMT
 #if defined(ESP8266)
 /// Interrupt handler for when the timer runs out.
 /// It signals to the library that capturing of IR data has stopped.
@@ -171,53 +444,33 @@ static void USE_IRAM_ATTR read_timeout(void) {
 /// @endcond
   portENTER_CRITICAL(&mux);
 #endif  // ESP32
-  if (params.rawlen) params.rcvstate = kStopState;
+  capture_timeout(micros());
 #if defined(ESP8266)
   os_intr_unlock();
 #endif  // ESP8266
 #if defined(ESP32)
   portEXIT_CRITICAL(&mux);
+  // Wake the decode task (if any) as there is a message ready for it.
+  if (decode_task != NULL && params.rcvstate == kStopState) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(decode_task, &woken);
+    if (woken == pdTRUE) portYIELD_FROM_ISR();
+  }
 #endif  // ESP32
 }
 
 /// Interrupt handler for changes on the GPIO pin handling incoming IR messages.
 static void USE_IRAM_ATTR gpio_intr() {
   uint32_t now = micros();
-  static uint32_t start = 0;
 
 #if defined(ESP8266)
   uint32_t gpio_status = GPIO_REG_READ(GPIO_STATUS_ADDRESS);
   os_timer_disarm(&timer);
   GPIO_REG_WRITE(GPIO_STATUS_W1TC_ADDRESS, gpio_status);
 #endif  // ESP8266
+  repeater_edge(now);  // Does nothing unless the repeater is in use.
 
-  // Grab a local copy of rawlen to reduce instructions used in IRAM.
-  // This is an ugly premature optimisation code-wise, but we do everything we
-  // can to save IRAM.
-  // It seems referencing the value via the structure uses more instructions.
-  // Less instructions means faster and less IRAM used.
-  // N.B. It saves about 13 bytes of IRAM.
-  uint16_t rawlen = params.rawlen;
-
-  if (rawlen >= params.bufsize) {
-    params.overflow = true;
-    params.rcvstate = kStopState;
-  }
-
-  if (params.rcvstate == kStopState) return;
-
-  if (params.rcvstate == kIdleState) {
-    params.rcvstate = kMarkState;
-    params.rawbuf[rawlen] = 1;
-  } else {
-    if (now < start)
-      params.rawbuf[rawlen] = (UINT32_MAX - start + now) / kRawTick;
-    else
-      params.rawbuf[rawlen] = (now - start) / kRawTick;
-  }
-  params.rawlen++;
-
-  start = now;
+  if (!capture_edge(now)) return;
 
 #if defined(ESP8266)
   os_timer_arm(&timer, params.timeout, ONCE);
@@ -247,7 +500,7 @@ static void USE_IRAM_ATTR gpio_intr() {
 #endif  // _ESP32_IRRECV_TIMER_HACK
 #endif  // ESP32
 }
-#endif  // UNIT_TEST
+#endif  // !defined(UNIT_TEST) && !_IRRECV_USE_RMT
 
 // Start of IRrecv class -------------------
 
@@ -275,6 +528,11 @@ IRrecv::IRrecv(const uint16_t recvpin, const uint16_t bufsize,
 #else  // SOC_TIMER_GROUP_TOTAL_TIMERS
                                   3));
 #endif  // SOC_TIMER_GROUP_TOTAL_TIMERS
+#ifndef UNIT_TEST
+  _decode_callback = NULL;
+  _decode_arg = NULL;
+  _decode_queue = NULL;
+#endif  // UNIT_TEST
 #else  // ESP32
 /// @cond IGNORE
 /// Class constructor
@@ -296,7 +554,8 @@ IRrecv::IRrecv(const uint16_t recvpin, const uint16_t bufsize,
   // Ensure we are going to be able to store all possible values in the
   // capture buffer.
   params.timeout = std::min(timeout, (uint8_t)kMaxTimeoutMs);
-  params.rawbuf = new uint16_t[bufsize];
+  _rawbuf = new uint16_t[bufsize];
+  params.rawbuf = _rawbuf;
   if (params.rawbuf == NULL) {
     DPRINTLN(
         "Could not allocate memory for the primary IR buffer.\n"
@@ -307,10 +566,10 @@ IRrecv::IRrecv(const uint16_t recvpin, const uint16_t bufsize,
   }
   // If we have been asked to use a save buffer (for decoding), then create one.
   if (save_buffer) {
-    params_save = new irparams_t;
-    params_save->rawbuf = new uint16_t[bufsize];
+    irparams_save = new irparams_t;
+    irparams_save->rawbuf = new uint16_t[bufsize];
     // Check we allocated the memory successfully.
-    if (params_save->rawbuf == NULL) {
+    if (irparams_save->rawbuf == NULL) {
       DPRINTLN(
           "Could not allocate memory for the second IR buffer.\n"
           "Try a smaller size for CAPTURE_BUFFER_SIZE.\nRebooting!");
@@ -319,12 +578,25 @@ IRrecv::IRrecv(const uint16_t recvpin, const uint16_t bufsize,
 #endif
     }
   } else {
-    params_save = NULL;
+    irparams_save = NULL;
   }
 #if DECODE_HASH
   _unknown_threshold = kUnknownThreshold;
+  _unknown_clusters = NULL;
+  _unknown_cluster_timings = NULL;
+  _unknown_clusters_size = 0;
 #endif  // DECODE_HASH
   _tolerance = kTolerance;
+  _calibrating = false;
+  _calibration_hold = false;
+  _calibration.mark_excess = kMarkExcess;
+  _calibration.space_excess = kMarkExcess;
+  _calibration.jitter = 0;
+  _calibration.samples = 0;
+  _calibrationReset();
+  _decode_cache = NULL;
+  _decode_cache_size = 0;
+  clearDecodeCache();
 }
 
 /// Class destructor
@@ -332,14 +604,24 @@ IRrecv::IRrecv(const uint16_t recvpin, const uint16_t bufsize,
 /// e.g. Frees up all memory used by the various buffers, and disables any
 /// timers or interrupts used.
 IRrecv::~IRrecv(void) {
+#if defined(ESP32) && !defined(UNIT_TEST)
+  stopDecodeTask();
+#endif  // defined(ESP32) && !defined(UNIT_TEST)
   disableIRIn();
 #if defined(ESP32)
   if (timer != NULL) timerEnd(timer);  // Cleanup the ESP32 timeout timer.
 #endif  // ESP32
-  delete[] params.rawbuf;
-  if (params_save != NULL) {
-    delete[] params_save->rawbuf;
-    delete params_save;
+  disableDecodeCache();
+#if DECODE_HASH
+  disableUnknownClustering();
+#endif  // DECODE_HASH
+  disableGameMode();
+  // A later object may have taken over the capture buffer. If so, it's theirs.
+  if (params.rawbuf == _rawbuf) params.rawbuf = NULL;
+  delete[] _rawbuf;
+  if (irparams_save != NULL) {
+    delete[] irparams_save->rawbuf;
+    delete irparams_save;
   }
 }
 
@@ -356,6 +638,26 @@ void IRrecv::enableIRIn(const bool pullup) {
     pinMode(params.recvpin, INPUT);
 #endif  // UNIT_TEST
   }
+#if _IRRECV_USE_RMT
+  // The RMT peripheral does all the capturing & timing for us.
+  rmt_config_t config = RMT_DEFAULT_CONFIG_RX((gpio_num_t)params.recvpin,
+                                             kRmtChannel);
+  // 80MHz APB clock / (80 * kRawTick) = 1 RMT tick per capture buffer tick.
+  config.clk_div = 80 * kRawTick;
+  config.mem_block_num = kRmtMemBlocks;
+  // Ignore glitches shorter than ~1uSec. (Units are APB clock ticks.)
+  config.rx_config.filter_en = true;
+  config.rx_config.filter_ticks_thresh = 80;
+  // No edges for this long (in RMT ticks) marks the end of a message.
+  config.rx_config.idle_threshold = rmtIdleThreshold(params.timeout);
+  rmt_config(&config);
+  rmt_driver_install(kRmtChannel, kRmtQueuedMessages * sizeof(rmt_item32_t) *
+                     (params.bufsize / 2 + 2), 0);
+  rmt_get_ringbuf_handle(kRmtChannel, &rmt_ringbuf);
+  // Initialise state machine variables & start the RMT receiving.
+  rmt_running = false;
+  resume();
+#else  // _IRRECV_USE_RMT
 #if defined(ESP32)
   // Initialise the ESP32 timer.
   // 80MHz / 80 = 1 uSec granularity.
@@ -388,12 +690,19 @@ void IRrecv::enableIRIn(const bool pullup) {
   // Attach Interrupt
   attachInterrupt(params.recvpin, gpio_intr, CHANGE);
 #endif  // UNIT_TEST
+#endif  // _IRRECV_USE_RMT
 }
 
 /// Stop collection of any received IR data.
 /// Disable any timers and interrupts.
 void IRrecv::disableIRIn(void) {
-#ifndef UNIT_TEST
+#if _IRRECV_USE_RMT
+  if (rmt_ringbuf == NULL) return;  // Not running.
+  rmt_rx_stop(kRmtChannel);
+  rmt_driver_uninstall(kRmtChannel);
+  rmt_ringbuf = NULL;
+  rmt_running = false;
+#elif !defined(UNIT_TEST)
 #if defined(ESP8266)
   os_timer_disarm(&timer);
 #endif  // ESP8266
@@ -403,7 +712,7 @@ void IRrecv::disableIRIn(void) {
   timerEnd(timer);
 #endif  // ESP32
   detachInterrupt(params.recvpin);
-#endif  // UNIT_TEST
+#endif  // _IRRECV_USE_RMT
 }
 
 /// Pause collection of received IR data.
@@ -412,9 +721,12 @@ void IRrecv::pause(void) {
   params.rcvstate = kStopState;
   params.rawlen = 0;
   params.overflow = false;
-#if defined(ESP32)
+#if _IRRECV_USE_RMT
+  if (rmt_running) rmt_rx_stop(kRmtChannel);
+  rmt_running = false;
+#elif defined(ESP32)
   gpio_intr_disable((gpio_num_t)params.recvpin);
-#endif  // ESP32
+#endif  // _IRRECV_USE_RMT
 }
 
 /// Resume collection of received IR data.
@@ -425,14 +737,179 @@ void IRrecv::resume(void) {
   params.rcvstate = kIdleState;
   params.rawlen = 0;
   params.overflow = false;
-#if defined(ESP32)
+#if _IRRECV_USE_RMT
+  // The RMT keeps capturing (into its queue) while we decode, so only (re)start
+  // it if it was stopped.
+  if (!rmt_running && rmt_ringbuf != NULL)
+    rmt_running = (rmt_rx_start(kRmtChannel, true) == ESP_OK);
+#elif defined(ESP32)
   timerAlarmDisable(timer);
   gpio_intr_enable((gpio_num_t)params.recvpin);
-#endif  // ESP32
+#endif  // _IRRECV_USE_RMT
+}
+
+/// Is a captured message waiting to be decoded?
+/// A cheap way for a main loop to tell if there is any receiving work to do,
+/// without calling `decode()`.
+/// @return True, if `decode()` has a message to work on. Otherwise, false.
+bool IRrecv::available(void) {
+#if _IRRECV_USE_RMT
+  rmt_poll();  // Collect any message the RMT peripheral has captured for us.
+#endif  // _IRRECV_USE_RMT
+  return params.rcvstate == kStopState;
+}
+
+/// Claim the right to start the decode task. i.e. It isn't already running,
+/// starting, or stopping. (The host testable part of `startDecodeTask()`)
+/// @param[in,out] state The decode task's state. (A decode_task_state_t)
+/// @return True, if the caller can start the task, & `state` is now
+///   kDecodeTaskStarting. Otherwise, false.
+bool IRrecv::_decodeTaskStarting(volatile uint8_t *state) {
+  return __sync_bool_compare_and_swap(state, kDecodeTaskStopped,
+                                      kDecodeTaskStarting);
+}
+
+/// Ask the decode task to stop, if it is running.
+/// (The host testable part of `stopDecodeTask()`)
+/// @param[in,out] state The decode task's state. (A decode_task_state_t)
+/// @param[in] task The decode task's handle.
+/// @param[in] caller The handle of the task wanting to stop it.
+/// @return False, if the caller is the decode task itself. e.g. From a decode
+///   callback. It would wait for itself to stop forever. Otherwise true, &
+///   the task (if any) is stopping. i.e. Wait for `state` to be
+///   kDecodeTaskStopped.
+bool IRrecv::_decodeTaskStopping(volatile uint8_t *state, const void *task,
+                                 const void *caller) {
+  if (task != NULL && task == caller) return false;
+  __sync_bool_compare_and_swap(state, kDecodeTaskRunning, kDecodeTaskStopping);
+  return true;
+}
+
+#if defined(ESP32) && !defined(UNIT_TEST)
+/// Start a FreeRTOS task that decodes each captured message as soon as the
+/// capture completes, and passes the result to a callback function.
+/// i.e. There is no need to poll `decode()` from `loop()`.
+/// @param[in] callback The function to call with each decoded message.
+///   It is called from the decode task, so keep it short & thread-safe.
+/// @param[in] arg An opaque pointer passed on to `callback`.
+/// @param[in] core Which CPU core to pin the task to.
+/// @param[in] priority The FreeRTOS priority of the task.
+/// @param[in] stack_size The task's stack size in bytes.
+/// @return True, if the task was started. Otherwise, false.
+/// @note Call `enableIRIn()` first, and don't call `decode()` yourself while
+///   the task is running.
+bool IRrecv::startDecodeTask(decode_callback_t callback, void *arg,
+                             const BaseType_t core, const UBaseType_t priority,
+                             const uint32_t stack_size) {
+  if (callback == NULL || !_decodeTaskStarting(&decode_task_state))
+    return false;
+  _decode_callback = callback;
+  _decode_arg = arg;
+  _decode_queue = NULL;
+  return _startDecodeTask(core, priority, stack_size);
+}
+
+/// Start a FreeRTOS task that decodes each captured message as soon as the
+/// capture completes, and sends a copy of the result to a queue.
+/// @param[in] output A queue with items of `sizeof(decode_results)`.
+///   Messages are dropped if it is full.
+/// @param[in] core Which CPU core to pin the task to.
+/// @param[in] priority The FreeRTOS priority of the task.
+/// @param[in] stack_size The task's stack size in bytes.
+/// @return True, if the task was started. Otherwise, false.
+/// @note The queued copies have `rawbuf` set to `NULL`, as the capture buffer
+///   is reused for the next message.
+bool IRrecv::startDecodeTask(QueueHandle_t output, const BaseType_t core,
+                             const UBaseType_t priority,
+                             const uint32_t stack_size) {
+  if (output == NULL || !_decodeTaskStarting(&decode_task_state))
+    return false;
+  _decode_callback = NULL;
+  _decode_arg = NULL;
+  _decode_queue = output;
+  return _startDecodeTask(core, priority, stack_size);
+}
+
+/// Stop the decode task started by `startDecodeTask()`, if it is running.
+/// Waits for it to finish any message it is currently handling.
+/// @return True, if the task isn't running now. False, if called from the
+///   decode task itself (e.g. the callback), as it can't wait for itself.
+bool IRrecv::stopDecodeTask(void) {
+  // Let a concurrent startDecodeTask() finish first.
+  while (decode_task_state == kDecodeTaskStarting) vTaskDelay(1);
+  if (!_decodeTaskStopping(&decode_task_state, decode_task,
+                           xTaskGetCurrentTaskHandle()))
+    return false;
+  if (decode_task_state == kDecodeTaskStopped) return true;
+  TaskHandle_t task = decode_task;
+  if (task != NULL) xTaskNotifyGive(task);
+  while (decode_task_state != kDecodeTaskStopped) vTaskDelay(1);
+  return true;
+}
+
+/// Create the decode task. (Common code for `startDecodeTask()`)
+/// The task waits until it has been fully set up before it decodes anything.
+/// @param[in] core Which CPU core to pin the task to.
+/// @param[in] priority The FreeRTOS priority of the task.
+/// @param[in] stack_size The task's stack size in bytes.
+/// @return True, if the task was started. Otherwise, false.
+bool IRrecv::_startDecodeTask(const BaseType_t core,
+                              const UBaseType_t priority,
+                              const uint32_t stack_size) {
+  TaskHandle_t handle = NULL;
+  if (xTaskCreatePinnedToCore(_decodeTask, "IRrecv", stack_size, this,
+                              priority, &handle, core) != pdPASS) {
+    decode_task_state = kDecodeTaskStopped;
+    return false;
+  }
+  decode_task = handle;
+  decode_task_state = kDecodeTaskRunning;
+  xTaskNotifyGive(handle);  // Let it run.
+  return true;
+}
+
+/// The body of the decode task.
+/// Decodes & delivers any completed capture, then sleeps until the interrupt
+/// handler signals the next one (or, when using the RMT, until the RMT driver
+/// queues one).
+/// @param[in] self The IRrecv object that started the task.
+void IRrecv::_decodeTask(void *self) {
+  IRrecv *irrecv = reinterpret_cast<IRrecv *>(self);
+  decode_results results;
+  // Wait for _startDecodeTask() to finish setting us up.
+  while (decode_task_state == kDecodeTaskStarting)
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  while (decode_task_state == kDecodeTaskRunning) {
+    // A capture may have completed before we slept, so check first.
+    while (decode_task_state == kDecodeTaskRunning &&
+           irrecv->decode(&results)) {
+      if (irrecv->_decode_callback != NULL) {
+        irrecv->_decode_callback(&results, irrecv->_decode_arg);
+      } else {
+        decode_results copy = results;
+        copy.rawbuf = NULL;
+        xQueueSend(irrecv->_decode_queue, &copy, 0);
+      }
+      // decode() has already resumed capturing if it used a save buffer.
+      if (irrecv->irparams_save == NULL) irrecv->resume();
+    }
+#if _IRRECV_USE_RMT
+    ulTaskNotifyTake(pdTRUE, 0);
+    // Check every so often if we've been asked to stop.
+    rmt_poll(pdMS_TO_TICKS(100));
+#else  // _IRRECV_USE_RMT
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#endif  // _IRRECV_USE_RMT
+  }
+  decode_task = NULL;
+  decode_task_state = kDecodeTaskStopped;  // `irrecv` may be gone after this.
+  vTaskDelete(NULL);
 }
+#endif  // defined(ESP32) && !defined(UNIT_TEST)
 
 /// Make a copy of the interrupt state & buffer data.
-/// Needed because irparams is marked as volatile, thus memcpy() isn't allowed.
+/// Needed because irparams is marked as volatile, thus memcpy() isn't allowed
+/// for the structure itself.
 /// Only call this when you know the interrupt handlers won't modify anything.
 /// i.e. In kStopState.
 /// @param[in] src Pointer to an irparams_t structure to copy from.
@@ -454,8 +931,9 @@ void IRrecv::copyIrParams(volatile irparams_t *src, irparams_t *dst) {
   // Restore the buffer pointer
   dst->rawbuf = dst_rawbuf_ptr;
 
-  // Copy the rawbuf
-  for (uint16_t i = 0; i < dst->bufsize; i++) dst->rawbuf[i] = src->rawbuf[i];
+  // Copy the rawbuf. The interrupt handler is stopped, so it's safe to treat
+  // the buffer itself as normal memory.
+  memcpy(dst->rawbuf, src->rawbuf, dst->bufsize * sizeof(dst->rawbuf[0]));
 }
 
 /// Obtain the maximum number of entries possible in the capture buffer.
@@ -463,14 +941,817 @@ void IRrecv::copyIrParams(volatile irparams_t *src, irparams_t *dst) {
 /// @return The size of the buffer that is in use by the object.
 uint16_t IRrecv::getBufSize(void) { return params.bufsize; }
 
+/// Calculate the ESP32 RMT peripheral's idle threshold for a capture timeout.
+/// i.e. How many RMT ticks (one per capture buffer tick) without an edge end a
+/// message. The hardware's field is only 15 bits wide, so longer timeouts are
+/// limited to what fits, rather than silently wrapping to a tiny one.
+/// @note This is a pure function so it can be tested on any platform.
+/// @param[in] timeout Nr. of milli-Seconds.
+/// @return The nr. of RMT ticks.
+uint16_t IRrecv::rmtIdleThreshold(const uint8_t timeout) {
+  return std::min(MS_TO_USEC(timeout) / kRawTick, (uint32_t)kRmtMaxIdleTicks);
+}
+
+/// Convert symbols captured by an ESP32's RMT peripheral into the capture
+/// buffer format. i.e. As if the GPIO interrupt handler had captured them.
+/// Each 32-bit symbol holds two level/duration pairs, laid out as per the
+/// ESP-IDF's `rmt_item32_t`. i.e. Bits 0-14: duration0, 15: level0,
+/// 16-30: duration1, 31: level1.
+/// @note This is a pure function so it can be tested on any platform.
+/// @param[in] symbols A ptr to the RMT symbols.
+/// @param[in] nsymbols Nr. of symbols in the array.
+/// @param[out] rawbuf A ptr to the capture buffer to fill.
+/// @param[in] bufsize Nr. of entries the capture buffer can hold.
+/// @param[out] overflow Set to true if the message didn't fit in the buffer.
+/// @param[in] tick_ns Nr. of nanoseconds in an RMT tick.
+/// @param[in] mark_level The signal level of a mark. IR demodulators are
+///   typically active low. i.e. A mark is low/false.
+/// @return The nr. of entries used in the capture buffer. i.e. `rawlen`
+/// @note Like the interrupt handler, the first entry is a placeholder for the
+///   gap before the message, consecutive periods of the same level are merged
+///   (the RMT splits long periods over several symbols), and the trailing
+///   space (i.e. the timeout) is not recorded. A zero duration marks the end
+///   of the message.
+uint16_t IRrecv::rmtToRawbuf(const uint32_t *symbols, const uint16_t nsymbols,
+                             uint16_t *rawbuf, const uint16_t bufsize,
+                             bool *overflow, const uint32_t tick_ns,
+                             const bool mark_level) {
+  const uint32_t kNsPerRawTick = kRawTick * 1000;
+  uint16_t rawlen = 0;
+  bool started = false;
+  bool level = mark_level;
+  uint64_t ticks = 0;  // Length of the current period.
+  *overflow = false;
+  for (uint16_t i = 0; i < nsymbols * 2 && !*overflow; i++) {
+    const uint16_t half = symbols[i / 2] >> (16 * (i % 2));
+    const uint16_t duration = half & 0x7FFF;
+    const bool half_level = half >> 15;
+    if (duration == 0) break;  // End of the message.
+    if (!started) {
+      if (half_level != mark_level) continue;  // Skip leading idle/spaces.
+      started = true;
+      if (rawlen < bufsize) rawbuf[rawlen++] = 1;  // Leading gap placeholder.
+    } else if (half_level != level) {  // An edge, so record the last period.
+      if (rawlen < bufsize)
+        rawbuf[rawlen++] = std::min(ticks * tick_ns / kNsPerRawTick,
+                                    (uint64_t)UINT16_MAX);
+      else
+        *overflow = true;
+      ticks = 0;
+    }
+    level = half_level;
+    ticks += duration;
+  }
+  // Record the final mark. Any trailing space is the timeout, so is dropped.
+  if (started && !*overflow && level == mark_level) {
+    if (rawlen < bufsize)
+      rawbuf[rawlen++] = std::min(ticks * tick_ns / kNsPerRawTick,
+                                  (uint64_t)UINT16_MAX);
+    else
+      *overflow = true;
+  }
+  return rawlen;
+}
+
 #if DECODE_HASH
 /// Set the minimum length we will consider for reporting UNKNOWN message types.
 /// @param[in] length Min nr. of mark/space pulses required to be considered.
 void IRrecv::setUnknownThreshold(const uint16_t length) {
   _unknown_threshold = length;
 }
+
+/// Group similar UNKNOWN messages together, and report the same `value` for
+/// every message in a group. e.g. Each press of the same button on a remote
+/// we have no decoder for gives the same code, despite timing differences
+/// that would normally give a different hash value.
+/// @param[in] clusters The max. nr. of different messages to remember.
+///   The least recently seen one is forgotten when more are needed.
+///   0 disables it.
+/// @param[in] max_length The longest message (in capture entries) to group.
+/// @return True, if it is in use. Otherwise, false.
+/// @note Messages are grouped if each of their durations, relative to the
+///   total length of the message, is within the current tolerance.
+bool IRrecv::enableUnknownClustering(const uint8_t clusters,
+                                     const uint16_t max_length) {
+  disableUnknownClustering();
+  if (clusters == 0 || max_length == 0) return false;
+  _unknown_clusters = new unknown_cluster_t[clusters];
+  _unknown_cluster_timings = new uint16_t[clusters * max_length];
+  if (_unknown_clusters == NULL || _unknown_cluster_timings == NULL) {
+    disableUnknownClustering();
+    return false;
+  }
+  for (uint8_t i = 0; i < clusters; i++) {
+    _unknown_clusters[i].last_used = 0;
+    _unknown_clusters[i].timings = _unknown_cluster_timings + i * max_length;
+  }
+  _unknown_clusters_size = clusters;
+  _unknown_cluster_max_length = max_length;
+  _unknown_cluster_clock = 0;
+  return true;
+}
+
+/// Stop grouping UNKNOWN messages, and free the memory it used.
+void IRrecv::disableUnknownClustering(void) {
+  delete[] _unknown_clusters;
+  delete[] _unknown_cluster_timings;
+  _unknown_clusters = NULL;
+  _unknown_cluster_timings = NULL;
+  _unknown_clusters_size = 0;
+}
+
+/// Find the group of UNKNOWN messages with a given code.
+/// @param[in] id The `value` reported for the messages in the group.
+/// @return A pointer to the group, or NULL if there isn't one.
+const unknown_cluster_t *IRrecv::getUnknownCluster(const uint32_t id) {
+  for (uint8_t i = 0; i < _unknown_clusters_size; i++)
+    if (_unknown_clusters[i].last_used && _unknown_clusters[i].id == id)
+      return &_unknown_clusters[i];
+  return NULL;
+}
+
+/// Calculate the locality-sensitive hashes of some mark & space durations.
+/// Similar messages are very likely to have the same value for at least one of
+/// them, so they are used to find the group to check first.
+/// @param[in] timings The durations. (Any units)
+/// @param[in] length The nr. of entries in `timings`.
+/// @param[out] lsh Where to store the hashes.
+void IRrecv::_unknownClusterHashes(const uint16_t *timings,
+                                   const uint16_t length, uint32_t lsh[2]) {
+  uint32_t total = 1;
+  for (uint16_t i = 0; i < length; i++) total += timings[i];
+  lsh[0] = kFnvBasis32;
+  lsh[1] = kFnvBasis32;
+  for (uint16_t i = 0; i < length; i++) {
+    // Relative to the length of the message, so a remote that is uniformly
+    // fast or slow still gets the same hashes.
+    const uint32_t norm = (((uint64_t)timings[i]) << 12) / total + 1;
+    for (uint8_t t = 0; t < 2; t++) {
+      // The 2nd hash's buckets are offset by about half a bucket, so a
+      // duration close to the edge of a bucket in one is safely inside a
+      // bucket in the other.
+      const uint32_t value = t ? norm + norm / 8 : norm;
+      // Four logarithmic buckets per power of two.
+      uint8_t exponent = 0;
+      while (value >> (exponent + 1)) exponent++;
+      const uint8_t mantissa = (exponent >= 2) ? (value >> (exponent - 2)) & 3
+                                               : (value << (2 - exponent)) & 3;
+      lsh[t] = (lsh[t] * kFnvPrime32) ^ (exponent * 4 + mantissa);
+    }
+  }
+}
+
+/// Does a message belong to a group of UNKNOWN messages?
+/// @param[in] cluster The group.
+/// @param[in] results The message.
+/// @param[in] total The sum of all the durations in the message.
+/// @return True, if it does. Otherwise, false.
+bool IRrecv::_unknownClusterMatch(const unknown_cluster_t *cluster,
+                                  const decode_results *results,
+                                  const uint32_t total) {
+  if (cluster->last_used == 0 || cluster->length != results->rawlen - 1)
+    return false;
+  uint32_t cluster_total = 0;
+  for (uint16_t i = 0; i < cluster->length; i++)
+    cluster_total += cluster->timings[i];
+  // Compare each duration as a fraction of the total length of its message.
+  for (uint16_t i = 0; i < cluster->length; i++) {
+    const uint64_t measured = (uint64_t)results->rawbuf[i + 1] * cluster_total;
+    const uint64_t desired = (uint64_t)cluster->timings[i] * total;
+    const uint64_t diff = (measured > desired) ? measured - desired
+                                               : desired - measured;
+    if (diff * 100 > desired * _tolerance) return false;
+  }
+  return true;
+}
+
+/// Find (or create) the group an UNKNOWN message belongs to, and update the
+/// group's average durations with it.
+/// @param[in] results The UNKNOWN message.
+/// @return The code to report for the message.
+uint32_t IRrecv::_clusterUnknown(const decode_results *results) {
+  const uint16_t length = results->rawlen - 1;
+  if (length > _unknown_cluster_max_length) return results->value;
+  const uint16_t *timings = results->rawbuf + 1;
+  uint32_t total = 0;
+  for (uint16_t i = 0; i < length; i++) total += timings[i];
+  if (total == 0) return results->value;
+  uint32_t lsh[2];
+  _unknownClusterHashes(timings, length, lsh);
+
+  // Check the groups with a matching hash first, then all the others.
+  unknown_cluster_t *found = NULL;
+  for (uint8_t pass = 0; pass < 2 && found == NULL; pass++)
+    for (uint8_t i = 0; i < _unknown_clusters_size && found == NULL; i++) {
+      unknown_cluster_t *cluster = &_unknown_clusters[i];
+      const bool hashed = cluster->lsh[0] == lsh[0] ||
+          cluster->lsh[1] == lsh[1];
+      if (hashed == (pass == 0) &&
+          _unknownClusterMatch(cluster, results, total))
+        found = cluster;
+    }
+
+  if (found != NULL) {
+    // Move the group's average towards this message.
+    if (found->count < UINT16_MAX) found->count++;
+    const int32_t weight = std::min(found->count, (uint16_t)16);
+    for (uint16_t i = 0; i < length; i++) {
+      const int32_t usecs = std::min((uint32_t)timings[i] * kRawTick,
+                                     (uint32_t)UINT16_MAX);
+      found->timings[i] += (usecs - found->timings[i]) / weight;
+    }
+  } else {
+    // A new group. Replace the least recently used one.
+    found = &_unknown_clusters[0];
+    for (uint8_t i = 1; i < _unknown_clusters_size; i++)
+      if (_unknown_clusters[i].last_used < found->last_used)
+        found = &_unknown_clusters[i];
+    found->last_used = 0;
+    // Start with the usual hash value, but it must be unique.
+    found->id = results->value;
+    while (getUnknownCluster(found->id) != NULL) found->id++;
+    found->count = 1;
+    found->length = length;
+    for (uint16_t i = 0; i < length; i++)
+      found->timings[i] = std::min((uint32_t)timings[i] * kRawTick,
+                                   (uint32_t)UINT16_MAX);
+  }
+  _unknownClusterHashes(found->timings, length, found->lsh);
+  found->last_used = ++_unknown_cluster_clock;
+  return found->id;
+}
 #endif  // DECODE_HASH
 
+/// Learn how this receiver's timings differ from what was sent, and allow for
+/// it when matching marks & spaces. e.g. The sensor lag of the IR module.
+/// Each successfully decoded message is compared to the timings of its
+/// protocol, and the mark & space excesses used by `matchMark()` &
+/// `matchSpace()` (when called with the default `kUseDefExcess`, or the
+/// library's usual `kMarkExcess`) are moved towards what was seen. The default
+/// tolerance (& any a decoder has widened from it) is also widened (up to
+/// `kCalibrationMaxTolerance` more) if the timings are very noisy.
+/// @param[in] enable Whether to learn & use the calibration or not.
+/// @see getCalibration() & setCalibration() for saving it over reboots.
+void IRrecv::enableCalibration(const bool enable) {
+  _calibrating = enable;
+  _calibrationReset();
+}
+
+/// Get what the receiver has learnt about its timings so far.
+/// @return The calibration values.
+ir_calibration_t IRrecv::getCalibration(void) { return _calibration; }
+
+/// Set what the receiver knows about its timings. e.g. A previously saved
+/// result from `getCalibration()`.
+/// @param[in] calibration The calibration values to use.
+void IRrecv::setCalibration(const ir_calibration_t calibration) {
+  _calibration = calibration;
+}
+
+/// Forget the timings collected from the current decode attempt.
+void IRrecv::_calibrationReset(void) {
+  _calibration_mark_sum = 0;
+  _calibration_space_sum = 0;
+  _calibration_error_sum = 0;
+  _calibration_marks = 0;
+  _calibration_spaces = 0;
+}
+
+/// Collect the timing of a mark or space matched by a decoder.
+/// A failed match may just be a decoder trying an alternative (e.g. a '1' vs a
+/// '0' bit), so only whole failed decode attempts discard what was collected.
+/// @param[in] mark Is it a mark (true) or a space (false)?
+/// @param[in] measured The recorded period of the signal pulse.
+/// @param[in] desired The expected period (in usecs) from the protocol.
+/// @param[in] excess The excess used when matching.
+void IRrecv::_calibrationSample(const bool mark, const uint32_t measured,
+                                const uint32_t desired, const int16_t excess) {
+  if (desired == 0) return;
+  const int32_t usecs = measured * kRawTick;
+  const int32_t bias = mark ? usecs - (int32_t)desired
+                            : (int32_t)desired - usecs;
+  if (mark) {
+    _calibration_mark_sum += bias;
+    _calibration_marks++;
+  } else {
+    _calibration_space_sum += bias;
+    _calibration_spaces++;
+  }
+  const int32_t error = bias - excess;
+  _calibration_error_sum += (uint32_t)(error < 0 ? -error : error) * 1000 /
+      desired;
+}
+
+/// Learn from the timings collected for a successfully decoded message.
+void IRrecv::_calibrationUpdate(void) {
+  const uint16_t samples = _calibration_marks + _calibration_spaces;
+  if (samples >= kCalibrationMinSamples) {
+    if (_calibration.samples < UINT16_MAX) _calibration.samples++;
+    // A moving average, that starts off moving faster.
+    const int32_t weight = std::min(_calibration.samples + 1, 16);
+    if (_calibration_marks)
+      _calibration.mark_excess += (_calibration_mark_sum / _calibration_marks -
+                                   _calibration.mark_excess) / weight;
+    if (_calibration_spaces)
+      _calibration.space_excess += (_calibration_space_sum /
+                                    _calibration_spaces -
+                                    _calibration.space_excess) / weight;
+    _calibration.jitter += ((int32_t)(_calibration_error_sum / samples) -
+                            _calibration.jitter) / weight;
+  }
+  _calibrationReset();
+}
+
+/// Get the tolerance & excess to match a mark or space with, when calibrating.
+/// Decoders either use the defaults, or pass the library's usual values
+/// explicitly. e.g. `kMarkExcess`, or `_tolerance` plus a bit extra for a
+/// sloppy protocol. Those are all replaced by the calibrated equivalents.
+/// Any other explicit excess (or a tighter tolerance) is left alone.
+/// @param[in] mark Is it a mark (true) or a space (false)?
+/// @param[in,out] tolerance The tolerance (%) asked for.
+/// @param[in,out] excess The excess asked for.
+void IRrecv::_calibrated(const bool mark, uint8_t *tolerance,
+                         int16_t *excess) {
+  if (*excess == kUseDefExcess || *excess == kMarkExcess)
+    *excess = mark ? _calibration.mark_excess : _calibration.space_excess;
+  if (*tolerance == kUseDefTol)
+    *tolerance = _calibratedTolerance();
+  else if (*tolerance >= _tolerance)  // Widen it as much as the default.
+    *tolerance = std::min(*tolerance + _calibratedTolerance() - _tolerance,
+                          100);
+}
+
+/// Note the outcome of a protocol decoder's attempt at a message.
+/// The timings collected by a failed attempt aren't from the right protocol,
+/// so forget them before the next decoder is tried.
+/// @param[in] success Did the decoder decode the message?
+/// @return The value of `success`.
+bool IRrecv::_decoded(const bool success) {
+  if (_calibrating && !success) _calibrationReset();
+  return success;
+}
+
+/// The default tolerance to use when calibrating.
+/// @return A percentage. Wide enough for ~3 times the average timing error.
+uint8_t IRrecv::_calibratedTolerance(void) {
+  return std::max(_tolerance,
+                  (uint8_t)std::min(_calibration.jitter * 3 / 10,
+                                    (int)kCalibrationMaxTolerance));
+}
+
+/// Switch to the laser-tag game receive profile. For receiving many short
+/// shots per second, from many players, without losing any. i.e.
+///  - A short end-of-frame timeout (kGameTimeoutMs), so back-to-back shots are
+///    captured separately.
+///  - Capturing carries on into a ring of small buffers while earlier frames
+///    wait to be decoded.
+///  - Only the laser-tag decoders (MilesTag2 & Lasertag) are tried.
+///  - Hits are collected in bulk, with a timestamp, via `readHits()`.
+/// @param[in] frames Nr. of back-to-back capture buffers to use. (Min. 2)
+/// @return True, if game mode is in use. Otherwise, false.
+/// @note Use `readHits()` instead of `decode()` while in game mode.
+///   `disableGameMode()` restores the normal capture buffer & timeout.
+bool IRrecv::enableGameMode(const uint8_t frames) {
+  disableGameMode();
+  if (frames < 2) return false;
+  uint16_t *rawbufs = new uint16_t[frames * kGameFrameSize];
+  uint16_t *rawlens = new uint16_t[frames];
+  uint32_t *timestamps = new uint32_t[frames];
+  if (rawbufs == NULL || rawlens == NULL || timestamps == NULL) {
+    delete[] rawbufs;
+    delete[] rawlens;
+    delete[] timestamps;
+    return false;
+  }
+  // Keep the interrupt handler away from the buffers while we swap them.
+  params.rcvstate = kStopState;
+  game_saved_rawbuf = params.rawbuf;
+  game_saved_bufsize = params.bufsize;
+  game_saved_timeout = params.timeout;
+  game_rawbufs = rawbufs;
+  game_rawlens = rawlens;
+  game_timestamps = timestamps;
+  game_head = 0;
+  game_tail = 0;
+  game_lost = 0;
+  params.rawbuf = game_rawbufs;
+  // Leave room to terminate the longest frame. (See readHits())
+  params.bufsize = kGameFrameSize - 1;
+  _setTimeout(kGameTimeoutMs);
+  game_frames = frames;
+  params.rawlen = 0;
+  params.overflow = false;
+  params.rcvstate = kIdleState;
+  return true;
+}
+
+/// Leave the laser-tag game receive profile, and free the memory it used.
+/// Any hits not yet collected via `readHits()` are lost.
+void IRrecv::disableGameMode(void) {
+  if (!game_frames) return;  // Not in game mode.
+  params.rcvstate = kStopState;
+  game_frames = 0;
+  params.rawbuf = game_saved_rawbuf;
+  params.bufsize = game_saved_bufsize;
+  _setTimeout(game_saved_timeout);
+  delete[] game_rawbufs;
+  delete[] game_rawlens;
+  delete[] game_timestamps;
+  game_rawbufs = NULL;
+  game_rawlens = NULL;
+  game_timestamps = NULL;
+  params.rawlen = 0;
+  params.overflow = false;
+  params.rcvstate = kIdleState;
+}
+
+/// Collect the hits received in game mode, oldest first.
+/// Each frame is only tried against the laser-tag decoders. Frames that aren't
+/// a valid shot or message are discarded.
+/// @param[out] hits Where to store the hits.
+/// @param[in] max_hits The max. nr. of hits to collect. i.e. Size of `hits`.
+/// @return The nr. of hits stored in `hits`.
+/// @note Call it often enough that the buffers don't fill up.
+///   (See `getGameFramesLost()`)
+uint16_t IRrecv::readHits(ir_hit_t *hits, const uint16_t max_hits) {
+  uint16_t count = 0;
+  if (!game_frames) return count;  // Not in game mode.
+#if _IRRECV_USE_RMT
+  // Collect what the RMT peripheral has captured for us.
+  for (uint8_t i = 0; i < game_frames; i++) rmt_poll();
+#endif  // _IRRECV_USE_RMT
+  decode_results results;
+  while (count < max_hits && game_tail != game_head) {
+    // Only read the frame after seeing the interrupt handler has finished it.
+    __sync_synchronize();
+    const uint8_t frame = game_tail;
+    results.rawbuf = game_rawbufs + frame * kGameFrameSize;
+    results.rawlen = game_rawlens[frame];
+    // Terminate it like decode() does. There is always room to.
+    results.rawbuf[results.rawlen] = 0;
+    results.overflow = false;
+    results.decode_type = UNKNOWN;
+    results.bits = 0;
+    results.value = 0;
+    results.address = 0;
+    results.command = 0;
+    results.repeat = false;
+    if (
+#if DECODE_MILESTAG2
+        decodeMilestag2(&results, kStartOffset, kMilesTag2MsgBits) ||
+        decodeMilestag2(&results, kStartOffset, kMilesTag2ShotBits) ||
+#endif  // DECODE_MILESTAG2
+#if DECODE_LASERTAG
+        decodeLasertag(&results) ||
+#endif  // DECODE_LASERTAG
+        false) {
+      hits[count].timestamp = game_timestamps[frame];
+      hits[count].data = results.value;
+      hits[count].protocol = results.decode_type;
+      hits[count].bits = results.bits;
+      count++;
+    }
+    // We are done with the buffer, so hand it back to the interrupt handler.
+    game_tail = (frame + 1 >= game_frames) ? 0 : frame + 1;
+  }
+  return count;
+}
+
+/// Get the nr. of frames dropped in game mode because all the buffers were
+/// full, or the frame was too long to be a laser-tag one.
+/// @return The nr. of frames lost since `enableGameMode()`.
+uint32_t IRrecv::getGameFramesLost(void) { return game_lost; }
+
+/// Start retransmitting what is received with minimal latency. i.e. A
+/// cut-through repeater. Rather than waiting for a whole frame plus the
+/// capture timeout, then decoding & re-encoding it, each edge the receiver sees
+/// goes into a short delay line and is retransmitted (by `repeat()`) `delay`
+/// uSeconds after it arrived. The delay line lets glitches (pulses shorter than
+/// `min_pulse`) be filtered out before they are sent.
+/// Normal capturing carries on in parallel, so `decode()` still works. e.g. For
+/// logging, or to decide to stop repeating some messages.
+/// @param[in] delay Nr. of uSeconds between receiving & retransmitting an edge.
+///   Must be more than `min_pulse`.
+/// @param[in] min_pulse The shortest mark or space (in uSeconds) to pass on.
+/// @param[in] hz The carrier frequency to retransmit with.
+/// @return True, if the repeater is in use. Otherwise, false.
+/// @note The IR LED shouldn't be visible to the receiver. If it is, the
+///   receiver sees (echoes of) the retransmission, and the frame never ends.
+///   Received edges that closely follow the same kind of edge we just sent
+///   are echoes. kRepeaterEchoEdges of them in a row, or a mark longer than
+///   kRepeaterMaxMarkMs, means a feedback loop. The frame is then abandoned,
+///   and input is ignored until the receiver has gone quiet again.
+///   (See `ir_repeater_stats_t.feedback`)
+/// @note Not available when using the ESP32's RMT peripheral to receive, as it
+///   only reports edges in batches.
+bool IRrecv::enableRepeater(const uint16_t delay, const uint16_t min_pulse,
+                            const uint16_t hz) {
+  disableRepeater();
+#if _IRRECV_USE_RMT
+  return false;
+#endif  // _IRRECV_USE_RMT
+  if (delay <= min_pulse) return false;
+  // Enough room for the most edges that can be waiting to be sent, and more.
+  const uint16_t size = std::min(delay / std::max(min_pulse, (uint16_t)1) + 4,
+                                 (int)UINT8_MAX);
+  uint32_t *times = new uint32_t[size];
+  bool *marks = new bool[size];
+  if (times == NULL || marks == NULL) {
+    delete[] times;
+    delete[] marks;
+    return false;
+  }
+  repeater_times = times;
+  repeater_marks = marks;
+  repeater_head = 0;
+  repeater_tail = 0;
+  repeater_mark = false;
+  repeater_holdoff = false;
+  repeater_min_pulse = min_pulse;
+  repeater_quiet = MS_TO_USEC(params.timeout);
+  repeater_delay = delay;
+  repeater_hz = hz;
+  repeater_stats = {0, 0, 0, 0, 0};
+  repeater_busy = false;
+  __sync_synchronize();
+  repeater_size = size;  // Start collecting edges.
+  return true;
+}
+
+/// Stop the cut-through repeater, and free the memory it used.
+void IRrecv::disableRepeater(void) {
+  if (!repeater_size) return;  // Not repeating.
+  repeater_size = 0;
+  __sync_synchronize();
+  delete[] repeater_times;
+  delete[] repeater_marks;
+  repeater_times = NULL;
+  repeater_marks = NULL;
+}
+
+/// Abandon the frame being retransmitted, as it is a feedback loop, and
+/// ignore the receiver until it has gone quiet.
+/// @param[in] irsend The IRsend object we are retransmitting via.
+static void repeater_feedback(IRsend *irsend) {
+  irsend->space(0);
+  repeater_on = false;
+  repeater_busy = false;
+  repeater_last = repeater_now();  // Wait for quiet from now on.
+  repeater_holdoff = true;
+  repeater_tail = repeater_head;
+  repeater_stats.feedback++;
+}
+
+/// Is a received edge an echo of one we sent? i.e. The same kind of edge,
+/// received soon after we sent it.
+/// @param[in] when When the edge was received.
+/// @param[in] mark Did it start a mark?
+/// @return True, if it looks like an echo. Otherwise, false.
+static bool repeater_echo(const uint32_t when, const bool mark) {
+  for (uint8_t i = 0; i < kRepeaterEchoEdges * 2; i++)
+    if (repeater_sent_marks[i] == mark &&
+        when - repeater_sent_times[i] <= kRepeaterEchoUs) return true;
+  return false;
+}
+
+/// Retransmit what the receiver is seeing, via the repeater's delay line.
+/// Each edge is sent `delay` uSeconds after it was received. If we get to an
+/// edge late (e.g. `loop()` was busy), the rest of the frame is shifted so its
+/// timing is kept.
+/// It only sends what is due, so it doesn't wait for anything while the LED is
+/// off. i.e. Call it as often as possible, e.g. every `loop()`, and it carries
+/// on from where it was. While the LED is on, it has to keep sending the mark
+/// until it is due to end.
+/// @param[in] irsend The IRsend object to retransmit via.
+/// @return True, if part way through a frame. i.e. Call it again soon.
+///   False, if there is nothing being sent.
+/// @note It relies on `mark()` & `space()` blocking, so it can't be used with
+///   `IRsend::enableTimerEngine()`.
+bool IRrecv::repeat(IRsend *irsend) {
+  if (!repeater_size) return false;
+  if (!repeater_busy) {
+    if (repeater_tail == repeater_head) return false;  // Nothing to send.
+    irsend->enableIROut(repeater_hz);
+    repeater_busy = true;
+    repeater_on = false;
+    repeater_shift = 0;
+    repeater_echoes = 0;
+    for (uint8_t i = 0; i < kRepeaterEchoEdges * 2; i++)
+      repeater_sent_times[i] = repeater_now() - kRepeaterEchoUs - 1;
+  }
+  while (true) {
+    const uint32_t now = repeater_now();
+    if (repeater_tail == repeater_head) {  // Nothing waiting to be sent.
+      if (repeater_on) {
+        if (now - repeater_on_since > MS_TO_USEC(kRepeaterMaxMarkMs)) {
+          repeater_feedback(irsend);
+          return false;
+        }
+        // Anything received from now on isn't due for at least `delay`.
+        irsend->mark(repeater_delay);
+        continue;
+      }
+      if (now - repeater_last < repeater_quiet) return true;
+      repeater_stats.frames++;  // The receiver has gone quiet.
+      repeater_busy = false;
+      return false;
+    }
+    __sync_synchronize();  // Only read the edge once it has been handed over.
+    const uint8_t edge = repeater_tail;
+    const bool mark = repeater_marks[edge];
+    const int32_t wait = repeater_times[edge] + repeater_delay +
+        repeater_shift - now;
+    if (wait > 0) {  // Not due yet.
+      if (!repeater_on) return true;  // Come back later.
+      irsend->mark(std::min(wait, (int32_t)repeater_delay));
+      continue;
+    }
+    if (repeater_echo(repeater_times[edge], mark)) {
+      if (++repeater_echoes >= kRepeaterEchoEdges) {
+        repeater_feedback(irsend);
+        return false;
+      }
+    } else {
+      repeater_echoes = 0;
+    }
+    if (mark && !repeater_on && wait < 0) {  // Late, so shift what's left.
+      if (!repeater_shift) repeater_stats.late++;
+      repeater_shift -= wait;
+    }
+    repeater_on = mark;
+    if (mark)
+      repeater_on_since = now;
+    else
+      irsend->space(0);  // Turn the LED off now.
+    repeater_sent_times[repeater_sent] = repeater_now();
+    repeater_sent_marks[repeater_sent] = mark;
+    repeater_sent = (repeater_sent + 1) % (kRepeaterEchoEdges * 2);
+    repeater_tail = (edge + 1 >= repeater_size) ? 0 : edge + 1;
+  }
+}
+
+/// Get the cut-through repeater's counters.
+/// @return The counters since `enableRepeater()`.
+ir_repeater_stats_t IRrecv::getRepeaterStats(void) { return repeater_stats; }
+
+/// Change how long a silence ends the capture of a message.
+/// @param[in] timeout Nr. of milli-Seconds.
+void IRrecv::_setTimeout(const uint8_t timeout) {
+  params.timeout = timeout;
+#if _IRRECV_USE_RMT
+  if (rmt_ringbuf != NULL)
+    rmt_set_rx_idle_thresh(kRmtChannel, rmtIdleThreshold(timeout));
+#elif defined(ESP32) && !defined(UNIT_TEST)
+  if (timer != NULL) timerAlarmWrite(timer, MS_TO_USEC(timeout), ONCE);
+#endif  // _IRRECV_USE_RMT
+}
+
+/// Remember recently decoded messages, so repeats of them (e.g. a held
+/// button, or an A/C remote sending each message twice) can be recognised by
+/// `decode()` without trying every protocol decoder again.
+/// @param[in] entries The nr. of different messages to remember.
+///   0 disables the cache.
+/// @return True, if the cache is in use. Otherwise, false.
+/// @note Captures are matched using the current tolerance, & only match a
+///   message decoded with the same tolerance & `max_skip`. Captures longer than
+///   kDecodeCacheMaxLength, & UNKNOWN (hashed) messages, are never cached.
+bool IRrecv::enableDecodeCache(const uint8_t entries) {
+  disableDecodeCache();
+  if (entries == 0) return false;
+  _decode_cache = new decode_cache_entry_t[entries];
+  if (_decode_cache == NULL) return false;
+  _decode_cache_size = entries;
+  clearDecodeCache();
+  return true;
+}
+
+/// Stop using the decode cache, and free the memory it used.
+void IRrecv::disableDecodeCache(void) {
+  delete[] _decode_cache;
+  _decode_cache = NULL;
+  _decode_cache_size = 0;
+}
+
+/// Forget all the messages in the decode cache, and reset its counters.
+void IRrecv::clearDecodeCache(void) {
+  for (uint8_t i = 0; i < _decode_cache_size; i++)
+    _decode_cache[i].last_used = 0;
+  _decode_cache_clock = 0;
+  _decode_cache_stats.hits = 0;
+  _decode_cache_stats.misses = 0;
+  _decode_cache_stats.rejected = 0;
+  _decode_cache_stats.uncacheable = 0;
+}
+
+/// Get the decode cache's hit-rate counters.
+/// @return A copy of the counters.
+decode_cache_stats_t IRrecv::getDecodeCacheStats(void) {
+  return _decode_cache_stats;
+}
+
+/// Calculate the decode cache signature of a capture.
+/// Each mark (and space) is classified as one of the distinct durations seen
+/// so far, within the tolerance. The signature is a hash of that sequence.
+/// @param[in] results The capture.
+/// @param[in] max_skip The `max_skip` it is being decoded with.
+/// @param[out] key Where to store the signature, the distinct durations, & the
+///   sequence of them.
+/// @return True, if the capture can be cached. Otherwise, false.
+bool IRrecv::_decodeCacheSignature(const decode_results *results,
+                                   const uint16_t max_skip,
+                                   decode_cache_entry_t *key) {
+  static_assert(kDecodeCacheMaxTimings <= 16,
+                "Each entry in the decode cache sequence is only 4 bits.");
+  if (results->overflow || results->rawlen <= kStartOffset ||
+      results->rawlen - kStartOffset > kDecodeCacheMaxLength) return false;
+  key->rawlen = results->rawlen;
+  key->max_skip = max_skip;
+  // The tolerance the decoders will use. (See matchMark())
+  key->tolerance = _calibrating ? _calibratedTolerance() : _tolerance;
+  uint32_t timings[2][kDecodeCacheMaxTimings];
+  uint16_t nr_timings[2] = {0, 0};
+  uint32_t hash = kFnvBasis32;
+  for (uint16_t i = kStartOffset; i < results->rawlen; i++) {
+    const uint8_t kind = (i - kStartOffset) & 1;  // 0 = mark, 1 = space.
+    const int32_t j = irutils::timingClass(
+        results->rawbuf[i], timings[kind], &nr_timings[kind],
+        kDecodeCacheMaxTimings, key->tolerance);
+    if (j < 0) return false;  // Too many distinct durations.
+    const uint16_t pos = i - kStartOffset;
+    if (pos & 1)
+      key->sequence[pos / 2] |= j << 4;
+    else
+      key->sequence[pos / 2] = j;
+    hash = (hash * kFnvPrime32) ^ j;
+  }
+  for (uint8_t kind = 0; kind < 2; kind++) {
+    key->nr_timings[kind] = nr_timings[kind];
+    for (uint8_t j = 0; j < nr_timings[kind]; j++)
+      key->timings[kind][j] = timings[kind][j];
+  }
+  key->signature = hash;
+  return true;
+}
+
+/// Look for a capture in the decode cache, and if found, copy the result.
+/// @param[in,out] results The capture, and where to put the cached result.
+/// @param[in] key The signature of the capture.
+/// @return True, if it was found. Otherwise, false.
+bool IRrecv::_decodeCacheLookup(decode_results *results,
+                                const decode_cache_entry_t *key) {
+  for (uint8_t i = 0; i < _decode_cache_size; i++) {
+    decode_cache_entry_t *entry = &_decode_cache[i];
+    if (entry->last_used == 0 || entry->signature != key->signature ||
+        entry->rawlen != key->rawlen || entry->max_skip != key->max_skip ||
+        entry->tolerance != key->tolerance) continue;
+    // Check the durations themselves are close enough to the cached ones.
+    bool same = true;
+    for (uint8_t kind = 0; kind < 2 && same; kind++) {
+      same = entry->nr_timings[kind] == key->nr_timings[kind];
+      for (uint8_t j = 0; j < key->nr_timings[kind] && same; j++)
+        same = match(key->timings[kind][j],
+                     entry->timings[kind][j] * kRawTick, key->tolerance, 0);
+    }
+    // The signature is only a hash, so check the sequence really is the same.
+    same = same && !memcmp(entry->sequence, key->sequence,
+                           (key->rawlen - kStartOffset + 1) / 2);
+    if (!same) {
+      _decode_cache_stats.rejected++;
+      continue;
+    }
+    // Keep the capture details, but use the rest of the cached result.
+    uint16_t *rawbuf = results->rawbuf;
+    const uint16_t rawlen = results->rawlen;
+    const bool overflow = results->overflow;
+    *results = entry->results;
+    results->rawbuf = rawbuf;
+    results->rawlen = rawlen;
+    results->overflow = overflow;
+    entry->last_used = ++_decode_cache_clock;
+    _decode_cache_stats.hits++;
+    return true;
+  }
+  _decode_cache_stats.misses++;
+  return false;
+}
+
+/// Add a decoded capture to the decode cache, replacing the least recently
+/// used entry if it is full.
+/// @param[in] results The successfully decoded capture.
+/// @param[in] key The signature of the capture.
+void IRrecv::_decodeCacheStore(const decode_results *results,
+                               const decode_cache_entry_t *key) {
+  if (results->decode_type == UNKNOWN) return;
+  decode_cache_entry_t *oldest = &_decode_cache[0];
+  for (uint8_t i = 1; i < _decode_cache_size; i++)
+    if (_decode_cache[i].last_used < oldest->last_used)
+      oldest = &_decode_cache[i];
+  *oldest = *key;
+  oldest->results = *results;
+  oldest->results.rawbuf = NULL;  // Never valid after this capture.
+  oldest->last_used = ++_decode_cache_clock;
+}
+
 
 /// Set the base tolerance percentage for matching incoming IR messages.
 /// @param[in] percent An integer percentage. (0-100)
@@ -498,9 +1779,10 @@ void IRrecv::crudeNoiseFilter(decode_results *results, const uint16_t floor) {
     uint16_t addition = curr + next;
     if (curr < kTickFloor) {  // Is it too short?
       // Shuffle the buffer down. i.e. Remove the mark & space pair.
-      // Note: `memcpy()` can't be used as rawbuf is `volatile`.
-      for (uint16_t i = offset + 2; i <= results->rawlen && i < kBufSize; i++)
-        results->rawbuf[i - 2] = results->rawbuf[i];
+      const uint16_t end = std::min((uint16_t)(results->rawlen + 1), kBufSize);
+      if (end > offset + 2)
+        memmove(results->rawbuf + offset, results->rawbuf + offset + 2,
+                (end - offset - 2) * sizeof(results->rawbuf[0]));
       if (offset > 1) {  // There is a previous pair we can add to.
         // Merge this pair into into the previous space.
         results->rawbuf[offset - 1] += addition;
@@ -555,8 +1837,15 @@ bool IRrecv::decode(decode_results *results, irparams_t *save,
                     uint8_t max_skip, uint16_t noise_floor) {
   // Proceed only if an IR message been received.
 #ifndef UNIT_TEST
+#if _IRRECV_USE_RMT
+  rmt_poll();  // Collect any message the RMT peripheral has captured for us.
+#endif  // _IRRECV_USE_RMT
   if (params.rcvstate != kStopState) return false;
 #endif
+  // The interrupt handler doesn't touch the buffer once it is stopped, so from
+  // here on it can be read as ordinary (non-volatile) memory by the decoders.
+  // Make sure none of those reads get reordered before the check above.
+  __sync_synchronize();
 
   // Clear the entry we are currently pointing to when we got the timeout.
   // i.e. Stopped collecting IR data.
@@ -573,7 +1862,7 @@ bool IRrecv::decode(decode_results *results, irparams_t *save,
   bool resumed = false;  // Flag indicating if we have resumed.
 
   // If we were requested to use a save buffer previously, do so.
-  if (save == NULL) save = params_save;
+  if (save == NULL) save = irparams_save;
 
   if (save == NULL) {
     // We haven't been asked to copy it so use the existing memory.
@@ -592,6 +1881,25 @@ bool IRrecv::decode(decode_results *results, irparams_t *save,
     results->overflow = save->overflow;
   }
 
+  if (decodeCapture(results, max_skip, noise_floor)) return true;
+  // Throw away and start over
+  if (!resumed)  // Check if we have already resumed.
+    resume();
+  return false;
+}
+
+/// Decode the contents of a capture we've been given, rather than the one the
+/// receiver made. e.g. One from a log file, or made by another IRrecv object.
+/// Unlike decode(), it never touches the receiver's capture buffer or state,
+/// so each thread can safely use its own IRrecv object to decode with.
+/// @param[in,out] results The capture (`rawbuf`, `rawlen` & `overflow`) to
+///   decode, and where to store the result.
+/// @param[in] max_skip Maximum Nr. of unexpected entries to skip over.
+/// @param[in] noise_floor Pulses below this size (in usecs) will be removed or
+///   merged prior to any decoding. (See decode())
+/// @return A boolean indicating if an IR message was decoded or not.
+bool IRrecv::decodeCapture(decode_results *results, const uint8_t max_skip,
+                           const uint16_t noise_floor) {
   // Reset any previously partially processed results.
   results->decode_type = UNKNOWN;
   results->bits = 0;
@@ -603,41 +1911,172 @@ bool IRrecv::decode(decode_results *results, irparams_t *save,
 #if ENABLE_NOISE_FILTER_OPTION
   crudeNoiseFilter(results, noise_floor);
 #endif  // ENABLE_NOISE_FILTER_OPTION
+
+  if (_decode_cache == NULL)  // No cache, so just decode it.
+    return _decodeAny(results, max_skip);
+  decode_cache_entry_t key;
+  if (!_decodeCacheSignature(results, max_skip, &key)) {
+    _decode_cache_stats.uncacheable++;
+    return _decodeAny(results, max_skip);
+  }
+  if (_decodeCacheLookup(results, &key)) return true;
+  if (!_decodeAny(results, max_skip)) return false;
+  _decodeCacheStore(results, &key);
+  return true;
+}
+
+/// Are two decode results the same message?
+/// @param[in] a A decode result.
+/// @param[in] b Another decode result.
+/// @return True, if they are. Otherwise, false.
+static bool sameMessage(const decode_results *a, const decode_results *b) {
+  if (a->decode_type != b->decode_type || a->bits != b->bits ||
+      a->repeat != b->repeat) return false;
+  if (hasACState(a->decode_type))
+    return memcmp(a->state, b->state, std::min(a->bits / 8 + (a->bits % 8 != 0),
+                                               (int)kStateSizeMax)) == 0;
+  return a->value == b->value && a->address == b->address &&
+      a->command == b->command;
+}
+
+/// Decode every message in a capture, rather than just the first one.
+/// e.g. When a long timeout & a large capture buffer have captured a message
+/// and its repeats, or several messages in a row.
+/// @param[in,out] results A pointer to where the first decoded message & the
+///   capture will be stored. (As per `decode()`)
+/// @param[out] messages Where to store each of the decoded messages, with
+///   where it is in the capture & the gap that follows it.
+/// @param[in] max_messages The max. nr. of entries in `messages`.
+/// @param[in] save A ptr to an irparams_t instance in which to save
+///   the data from the ISR. (As per `decode()`)
+/// @param[in] noise_floor Pulses below this size (in usecs) will be removed or
+///   merged prior to any decoding. (As per `decode()`)
+/// @param[in] min_gap Shortest space (in usecs) that may separate two messages.
+/// @return The nr. of messages stored in `messages`.
+/// @note Parts of the capture that can't be decoded as a known protocol are
+///   skipped. i.e. There are no UNKNOWN messages.
+uint16_t IRrecv::decodeAll(decode_results *results, decoded_message_t *messages,
+                           const uint16_t max_messages, irparams_t *save,
+                           const uint16_t noise_floor, const uint32_t min_gap) {
+  // Let decode() collect the capture, and decode the first message if it can.
+  if (!decode(results, save, 0, noise_floor)) return 0;
+  const uint16_t rawlen = results->rawlen;
+  const uint16_t min_gap_ticks = std::min(min_gap / kRawTick,
+                                          (uint32_t)UINT16_MAX);
+  uint16_t count = 0;
+  uint16_t start = kStartOffset;
+  decode_results window;
+  while (start + 1 < rawlen && count < max_messages) {
+    // Try to decode a message starting here, then find where it ends. i.e. The
+    // first possible gap after which the rest isn't needed to decode it.
+    decode_results *found = &messages[count].results;
+    if (start == kStartOffset && results->decode_type != UNKNOWN) {
+      *found = *results;  // decode() already did this one for us.
+    } else {
+      *found = *results;
+      found->decode_type = UNKNOWN;
+      found->bits = 0;
+      found->value = 0;
+      found->address = 0;
+      found->command = 0;
+      found->repeat = false;
+      if (!_decodeAt(found, start)) found->decode_type = UNKNOWN;
+    }
+    const bool decoded = found->decode_type != UNKNOWN;
+    uint16_t end = rawlen - 1;
+    for (uint16_t i = start + 1; i < rawlen - 1; i += 2) {
+      if (results->rawbuf[i] < min_gap_ticks) continue;
+      if (!decoded) {  // Nothing here, so skip to after the next gap.
+        end = i;
+        break;
+      }
+      window = *found;
+      window.rawlen = i + 1;
+      window.decode_type = UNKNOWN;
+      window.value = 0;
+      window.address = 0;
+      window.command = 0;
+      window.repeat = false;
+      if (_decodeAt(&window, start) && sameMessage(&window, found)) {
+        end = i;
+        break;
+      }
+    }
+    if (decoded) {
+      messages[count].start = start;
+      messages[count].end = end;
+      messages[count].gap = (end < rawlen - 1) ? results->rawbuf[end] * kRawTick
+                                               : 0;
+      count++;
+    }
+    start = end + 1;
+  }
+  return count;
+}
+
+/// Try all the enabled protocol decoders on a capture.
+/// @param[in,out] results The capture to decode, and where to put the result.
+/// @param[in] max_skip Maximum Nr. of pulses at the begining of a capture we
+///   can skip when attempting to find a protocol we can successfully decode.
+/// @return True if it can decode it, false if it can't.
+bool IRrecv::_decodeAny(decode_results *results, const uint8_t max_skip) {
+  if (_calibrating) _calibrationReset();
   // Keep looking for protocols until we've run out of entries to skip or we
   // find a valid protocol message.
   for (uint16_t offset = kStartOffset;
        offset <= (max_skip * 2) + kStartOffset;
-       offset += 2) {
+       offset += 2)
+    if (_decodeAt(results, offset)) {
+      if (_calibrating) _calibrationUpdate();
+      return true;
+    }
+#if DECODE_HASH
+  // decodeHash returns a hash on any input.
+  // Thus, it needs to be last in the list.
+  // If you add any decodes, add them before this.
+  if (decodeHash(results)) {
+    return true;
+  }
+#endif  // DECODE_HASH
+  return false;
+}
+
+/// Try all the enabled protocol decoders (except `decodeHash()`) on a capture
+/// at a given offset.
+/// @param[in,out] results The capture to decode, and where to put the result.
+/// @param[in] offset The index of the capture to start decoding from.
+/// @return True if it can decode it, false if it can't.
+bool IRrecv::_decodeAt(decode_results *results, const uint16_t offset) {
 #if DECODE_AIWA_RC_T501
-    DPRINTLN("Attempting Aiwa RC T501 decode");
-    // Try decodeAiwaRCT501() before decodeSanyoLC7461() & decodeNEC()
-    // because the protocols are similar. This protocol is more specific than
-    // those ones, so should go before them.
-    if (decodeAiwaRCT501(results, offset)) return true;
+  DPRINTLN("Attempting Aiwa RC T501 decode");
+  // Try decodeAiwaRCT501() before decodeSanyoLC7461() & decodeNEC()
+  // because the protocols are similar. This protocol is more specific than
+  // those ones, so should go before them.
+  if (_decoded(decodeAiwaRCT501(results, offset))) return true;
 #endif
 #if DECODE_SANYO
-    DPRINTLN("Attempting Sanyo LC7461 decode");
-    // Try decodeSanyoLC7461() before decodeNEC() because the protocols are
-    // similar in timings & structure, but the Sanyo one is much longer than the
-    // NEC protocol (42 vs 32 bits) so this one should be tried first to try to
-    // reduce false detection as a NEC packet.
-    if (decodeSanyoLC7461(results, offset)) return true;
+  DPRINTLN("Attempting Sanyo LC7461 decode");
+  // Try decodeSanyoLC7461() before decodeNEC() because the protocols are
+  // similar in timings & structure, but the Sanyo one is much longer than the
+  // NEC protocol (42 vs 32 bits) so this one should be tried first to try to
+  // reduce false detection as a NEC packet.
+  if (_decoded(decodeSanyoLC7461(results, offset))) return true;
 #endif
 #if DECODE_CARRIER_AC
-    DPRINTLN("Attempting Carrier AC decode");
-    // Try decodeCarrierAC() before decodeNEC() because the protocols are
-    // similar in timings & structure, but the Carrier one is much longer than
-    // the NEC protocol (3x32 bits vs 1x32 bits) so this one should be tried
-    // first to try to reduce false detection as a NEC packet.
-    if (decodeCarrierAC(results, offset)) return true;
+  DPRINTLN("Attempting Carrier AC decode");
+  // Try decodeCarrierAC() before decodeNEC() because the protocols are
+  // similar in timings & structure, but the Carrier one is much longer than
+  // the NEC protocol (3x32 bits vs 1x32 bits) so this one should be tried
+  // first to try to reduce false detection as a NEC packet.
+  if (_decoded(decodeCarrierAC(results, offset))) return true;
 #endif
 #if DECODE_PIONEER
-    DPRINTLN("Attempting Pioneer decode");
-    // Try decodePioneer() before decodeNEC() because the protocols are
-    // similar in timings & structure, but the Pioneer one is much longer than
-    // the NEC protocol (2x32 bits vs 1x32 bits) so this one should be tried
-    // first to try to reduce false detection as a NEC packet.
-    if (decodePioneer(results, offset)) return true;
+  DPRINTLN("Attempting Pioneer decode");
+  // Try decodePioneer() before decodeNEC() because the protocols are
+  // similar in timings & structure, but the Pioneer one is much longer than
+  // the NEC protocol (2x32 bits vs 1x32 bits) so this one should be tried
+  // first to try to reduce false detection as a NEC packet.
+  if (_decoded(decodePioneer(results, offset))) return true;
 #endif
 #if DECODE_EPSON
   DPRINTLN("Attempting Epson decode");
@@ -645,563 +2084,566 @@ bool IRrecv::decode(decode_results *results, irparams_t *save,
   // similar in timings & structure, but the Epson one is much longer than the
   // NEC protocol (3x32 identical bits vs 1x32 bits) so this one should be tried
   // first to try to reduce false detection as a NEC packet.
-  if (decodeEpson(results, offset)) return true;
+  if (_decoded(decodeEpson(results, offset))) return true;
 #endif
 #if DECODE_NEC
-    DPRINTLN("Attempting NEC decode");
-    if (decodeNEC(results, offset)) return true;
+  DPRINTLN("Attempting NEC decode");
+  if (_decoded(decodeNEC(results, offset))) return true;
 #endif
 #if DECODE_MILESTAG2
-    DPRINTLN("Attempting MilesTag2 decode");
+  DPRINTLN("Attempting MilesTag2 decode");
   // Try decodeMilestag2() before decodeSony() because the protocols are
   // similar in timings & structure, but the Miles one differs in nbits
   // so this one should be tried first to try to reduce false detection
-    if (decodeMilestag2(results, offset, kMilesTag2MsgBits) ||
-        decodeMilestag2(results, offset, kMilesTag2ShotBits)) return true;
+  if (_decoded(decodeMilestag2(results, offset, kMilesTag2MsgBits)) ||
+      _decoded(decodeMilestag2(results, offset, kMilesTag2ShotBits)))
+    return true;
 #endif
 #if DECODE_SONY
-    DPRINTLN("Attempting Sony decode");
-    if (decodeSony(results, offset)) return true;
+  DPRINTLN("Attempting Sony decode");
+  if (_decoded(decodeSony(results, offset))) return true;
 #endif
 #if DECODE_MITSUBISHI
-    DPRINTLN("Attempting Mitsubishi decode");
-    if (decodeMitsubishi(results, offset)) return true;
+  DPRINTLN("Attempting Mitsubishi decode");
+  if (_decoded(decodeMitsubishi(results, offset))) return true;
 #endif
 #if DECODE_MITSUBISHI_AC
-    DPRINTLN("Attempting Mitsubishi AC decode");
-    if (decodeMitsubishiAC(results, offset)) return true;
+  DPRINTLN("Attempting Mitsubishi AC decode");
+  if (_decoded(decodeMitsubishiAC(results, offset))) return true;
 #endif
 #if DECODE_MITSUBISHI2
-    DPRINTLN("Attempting Mitsubishi2 decode");
-    if (decodeMitsubishi2(results, offset)) return true;
+  DPRINTLN("Attempting Mitsubishi2 decode");
+  if (_decoded(decodeMitsubishi2(results, offset))) return true;
 #endif
 #if DECODE_RC5
-    DPRINTLN("Attempting RC5 decode");
-    if (decodeRC5(results, offset)) return true;
+  DPRINTLN("Attempting RC5 decode");
+  if (_decoded(decodeRC5(results, offset))) return true;
 #endif
 #if DECODE_RC6
-    DPRINTLN("Attempting RC6 decode");
-    if (decodeRC6(results, offset)) return true;
+  DPRINTLN("Attempting RC6 decode");
+  if (_decoded(decodeRC6(results, offset))) return true;
 #endif
 #if DECODE_RCMM
-    DPRINTLN("Attempting RC-MM decode");
-    if (decodeRCMM(results, offset)) return true;
+  DPRINTLN("Attempting RC-MM decode");
+  if (_decoded(decodeRCMM(results, offset))) return true;
 #endif
 #if DECODE_FUJITSU_AC
-    // Fujitsu A/C needs to precede Panasonic and Denon as it has a short
-    // message which looks exactly the same as a Panasonic/Denon message.
-    DPRINTLN("Attempting Fujitsu A/C decode");
-    if (decodeFujitsuAC(results, offset)) return true;
+  // Fujitsu A/C needs to precede Panasonic and Denon as it has a short
+  // message which looks exactly the same as a Panasonic/Denon message.
+  DPRINTLN("Attempting Fujitsu A/C decode");
+  if (_decoded(decodeFujitsuAC(results, offset))) return true;
 #endif
 #if DECODE_DENON
-    // Denon needs to precede Panasonic as it is a special case of Panasonic.
-    DPRINTLN("Attempting Denon decode");
-    if (decodeDenon(results, offset, kDenon48Bits) ||
-        decodeDenon(results, offset, kDenonBits) ||
-        decodeDenon(results, offset, kDenonLegacyBits))
-      return true;
+  // Denon needs to precede Panasonic as it is a special case of Panasonic.
+  DPRINTLN("Attempting Denon decode");
+  if (_decoded(decodeDenon(results, offset, kDenon48Bits)) ||
+      _decoded(decodeDenon(results, offset, kDenonBits)) ||
+      _decoded(decodeDenon(results, offset, kDenonLegacyBits)))
+    return true;
 #endif
 #if DECODE_PANASONIC
-    DPRINTLN("Attempting Panasonic (48-bit) decode");
-    if (decodePanasonic(results, offset)) return true;
-    DPRINTLN("Attempting Panasonic (40-bit) decode");
-    if (decodePanasonic(results, offset, kPanasonic40Bits, true,
-                        kPanasonic40Manufacturer)) return true;
+  DPRINTLN("Attempting Panasonic (48-bit) decode");
+  if (_decoded(decodePanasonic(results, offset))) return true;
+  DPRINTLN("Attempting Panasonic (40-bit) decode");
+  if (_decoded(decodePanasonic(results, offset, kPanasonic40Bits, true,
+                      kPanasonic40Manufacturer))) return true;
 #endif  // DECODE_PANASONIC
 #if DECODE_LG
-    DPRINTLN("Attempting LG (28-bit) decode");
-    if (decodeLG(results, offset, kLgBits, true)) return true;
-    DPRINTLN("Attempting LG (32-bit) decode");
-    // LG32 should be tried before Samsung
-    if (decodeLG(results, offset, kLg32Bits, true)) return true;
+  DPRINTLN("Attempting LG (28-bit) decode");
+  if (_decoded(decodeLG(results, offset, kLgBits, true))) return true;
+  DPRINTLN("Attempting LG (32-bit) decode");
+  // LG32 should be tried before Samsung
+  if (_decoded(decodeLG(results, offset, kLg32Bits, true))) return true;
 #endif
 #if DECODE_GICABLE
-    // Note: Needs to happen before JVC decode, because it looks similar except
-    //       with a required NEC-like repeat code.
-    DPRINTLN("Attempting GICable decode");
-    if (decodeGICable(results, offset)) return true;
+  // Note: Needs to happen before JVC decode, because it looks similar except
+  //       with a required NEC-like repeat code.
+  DPRINTLN("Attempting GICable decode");
+  if (_decoded(decodeGICable(results, offset))) return true;
 #endif
 #if DECODE_JVC
-    DPRINTLN("Attempting JVC decode");
-    if (decodeJVC(results, offset)) return true;
+  DPRINTLN("Attempting JVC decode");
+  if (_decoded(decodeJVC(results, offset))) return true;
 #endif
 #if DECODE_SAMSUNG
-    DPRINTLN("Attempting SAMSUNG decode");
-    if (decodeSAMSUNG(results, offset)) return true;
+  DPRINTLN("Attempting SAMSUNG decode");
+  if (_decoded(decodeSAMSUNG(results, offset))) return true;
 #endif
 #if DECODE_SAMSUNG36
-    DPRINTLN("Attempting Samsung36 decode");
-    if (decodeSamsung36(results, offset)) return true;
+  DPRINTLN("Attempting Samsung36 decode");
+  if (_decoded(decodeSamsung36(results, offset))) return true;
 #endif
 #if DECODE_WHYNTER
-    DPRINTLN("Attempting Whynter decode");
-    if (decodeWhynter(results, offset)) return true;
+  DPRINTLN("Attempting Whynter decode");
+  if (_decoded(decodeWhynter(results, offset))) return true;
 #endif
 #if DECODE_DISH
-    DPRINTLN("Attempting DISH decode");
-    if (decodeDISH(results, offset)) return true;
+  DPRINTLN("Attempting DISH decode");
+  if (_decoded(decodeDISH(results, offset))) return true;
 #endif
 #if DECODE_SHARP
-    DPRINTLN("Attempting Sharp decode");
-    if (decodeSharp(results, offset)) return true;
+  DPRINTLN("Attempting Sharp decode");
+  if (_decoded(decodeSharp(results, offset))) return true;
 #endif
 #if DECODE_BOSCH144
-    DPRINTLN("Attempting Bosch 144-bit decode");
-    // Bosch is similar to Coolix, so it must be attempted before decodeCOOLIX.
-    if (decodeBosch144(results, offset)) return true;
+  DPRINTLN("Attempting Bosch 144-bit decode");
+  // Bosch is similar to Coolix, so it must be attempted before decodeCOOLIX.
+  if (_decoded(decodeBosch144(results, offset))) return true;
 #endif  // DECODE_BOSCH144
 #if DECODE_COOLIX
-    DPRINTLN("Attempting Coolix 24-bit decode");
-    if (decodeCOOLIX(results, offset)) return true;
+  DPRINTLN("Attempting Coolix 24-bit decode");
+  if (_decoded(decodeCOOLIX(results, offset))) return true;
 #endif  // DECODE_COOLIX
 #if DECODE_NIKAI
-    DPRINTLN("Attempting Nikai decode");
-    if (decodeNikai(results, offset)) return true;
+  DPRINTLN("Attempting Nikai decode");
+  if (_decoded(decodeNikai(results, offset))) return true;
 #endif
 #if DECODE_KELVINATOR
-    // Kelvinator based-devices use a similar code to Gree ones, to avoid false
-    // matches this needs to happen before decodeGree().
-    DPRINTLN("Attempting Kelvinator decode");
-    if (decodeKelvinator(results, offset)) return true;
+  // Kelvinator based-devices use a similar code to Gree ones, to avoid false
+  // matches this needs to happen before decodeGree().
+  DPRINTLN("Attempting Kelvinator decode");
+  if (_decoded(decodeKelvinator(results, offset))) return true;
 #endif
 #if DECODE_DAIKIN
-    DPRINTLN("Attempting Daikin decode");
-    if (decodeDaikin(results, offset)) return true;
+  DPRINTLN("Attempting Daikin decode");
+  if (_decoded(decodeDaikin(results, offset))) return true;
 #endif
 #if DECODE_DAIKIN2
-    DPRINTLN("Attempting Daikin2 decode");
-    if (decodeDaikin2(results, offset)) return true;
+  DPRINTLN("Attempting Daikin2 decode");
+  if (_decoded(decodeDaikin2(results, offset))) return true;
 #endif
 #if DECODE_DAIKIN216
-    DPRINTLN("Attempting Daikin216 decode");
-    if (decodeDaikin216(results, offset)) return true;
+  DPRINTLN("Attempting Daikin216 decode");
+  if (_decoded(decodeDaikin216(results, offset))) return true;
 #endif
 #if DECODE_TOSHIBA_AC
-    DPRINTLN("Attempting Toshiba AC 72bit decode");
-    if (decodeToshibaAC(results, offset)) return true;
-    DPRINTLN("Attempting Toshiba AC 80bit decode");
-    if (decodeToshibaAC(results, offset, kToshibaACBitsLong)) return true;
-    DPRINTLN("Attempting Toshiba AC 56bit decode");
-    if (decodeToshibaAC(results, offset, kToshibaACBitsShort)) return true;
+  DPRINTLN("Attempting Toshiba AC 72bit decode");
+  if (_decoded(decodeToshibaAC(results, offset))) return true;
+  DPRINTLN("Attempting Toshiba AC 80bit decode");
+  if (_decoded(decodeToshibaAC(results, offset, kToshibaACBitsLong)))
+    return true;
+  DPRINTLN("Attempting Toshiba AC 56bit decode");
+  if (_decoded(decodeToshibaAC(results, offset, kToshibaACBitsShort)))
+    return true;
 #endif
 #if DECODE_MIDEA
-    DPRINTLN("Attempting Midea decode");
-    if (decodeMidea(results, offset)) return true;
+  DPRINTLN("Attempting Midea decode");
+  if (_decoded(decodeMidea(results, offset))) return true;
 #endif
 #if DECODE_MAGIQUEST
-    DPRINTLN("Attempting Magiquest decode");
-    if (decodeMagiQuest(results, offset)) return true;
+  DPRINTLN("Attempting Magiquest decode");
+  if (_decoded(decodeMagiQuest(results, offset))) return true;
 #endif
   /* NOTE: Disabled due to poor quality.
 #if DECODE_SANYO
-    // The Sanyo S866500B decoder is very poor quality & depricated.
-    // *IF* you are going to enable it, do it near last to avoid false positive
-    // matches.
-    DPRINTLN("Attempting Sanyo SA8650B decode");
-    if (decodeSanyo(results, offset))
-      return true;
+  // The Sanyo S866500B decoder is very poor quality & depricated.
+  // *IF* you are going to enable it, do it near last to avoid false positive
+  // matches.
+  DPRINTLN("Attempting Sanyo SA8650B decode");
+  if (_decoded(decodeSanyo(results, offset)))
+    return true;
 #endif
   */
 #if DECODE_NEC
-    // Some devices send NEC-like codes that don't follow the true NEC spec.
-    // This should detect those. e.g. Apple TV remote etc.
-    // This needs to be done after all other codes that use strict and some
-    // other protocols that are NEC-like as well, as turning off strict may
-    // cause this to match other valid protocols.
-    DPRINTLN("Attempting NEC (non-strict) decode");
-    if (decodeNEC(results, offset, kNECBits, false)) {
-      results->decode_type = NEC_LIKE;
-      return true;
-    }
+  // Some devices send NEC-like codes that don't follow the true NEC spec.
+  // This should detect those. e.g. Apple TV remote etc.
+  // This needs to be done after all other codes that use strict and some
+  // other protocols that are NEC-like as well, as turning off strict may
+  // cause this to match other valid protocols.
+  DPRINTLN("Attempting NEC (non-strict) decode");
+  if (_decoded(decodeNEC(results, offset, kNECBits, false))) {
+    results->decode_type = NEC_LIKE;
+    return true;
+  }
 #endif
 #if DECODE_LASERTAG
-    DPRINTLN("Attempting Lasertag decode");
-    if (decodeLasertag(results, offset)) return true;
+  DPRINTLN("Attempting Lasertag decode");
+  if (_decoded(decodeLasertag(results, offset))) return true;
 #endif
 #if DECODE_GREE
-    // Gree based-devices use a similar code to Kelvinator ones, to avoid false
-    // matches this needs to happen after decodeKelvinator().
-    DPRINTLN("Attempting Gree decode");
-    if (decodeGree(results, offset)) return true;
+  // Gree based-devices use a similar code to Kelvinator ones, to avoid false
+  // matches this needs to happen after decodeKelvinator().
+  DPRINTLN("Attempting Gree decode");
+  if (_decoded(decodeGree(results, offset))) return true;
 #endif
 #if DECODE_HAIER_AC
-    DPRINTLN("Attempting Haier AC decode");
-    if (decodeHaierAC(results, offset)) return true;
+  DPRINTLN("Attempting Haier AC decode");
+  if (_decoded(decodeHaierAC(results, offset))) return true;
 #endif
 #if DECODE_HAIER_AC_YRW02
-    DPRINTLN("Attempting Haier AC YR-W02 decode");
-    if (decodeHaierACYRW02(results, offset)) return true;
+  DPRINTLN("Attempting Haier AC YR-W02 decode");
+  if (_decoded(decodeHaierACYRW02(results, offset))) return true;
 #endif
 #if DECODE_HAIER_AC176
-    DPRINTLN("Attempting Haier AC 176 bit decode");
-    if (decodeHaierAC176(results, offset)) return true;
+  DPRINTLN("Attempting Haier AC 176 bit decode");
+  if (_decoded(decodeHaierAC176(results, offset))) return true;
 #endif  // DECODE_HAIER_AC176
 #if DECODE_HITACHI_AC424
-    // HitachiAc424 should be checked before HitachiAC, HitachiAC2,
-    // & HitachiAC184
-    DPRINTLN("Attempting Hitachi AC 424 decode");
-    if (decodeHitachiAc424(results, offset, kHitachiAc424Bits)) return true;
+  // HitachiAc424 should be checked before HitachiAC, HitachiAC2,
+  // & HitachiAC184
+  DPRINTLN("Attempting Hitachi AC 424 decode");
+  if (_decoded(decodeHitachiAc424(results, offset, kHitachiAc424Bits)))
+    return true;
 #endif  // DECODE_HITACHI_AC424
 #if DECODE_MITSUBISHI136
-    // Needs to happen before HitachiAc3 decode.
-    DPRINTLN("Attempting Mitsubishi136 decode");
-    if (decodeMitsubishi136(results, offset)) return true;
+  // Needs to happen before HitachiAc3 decode.
+  DPRINTLN("Attempting Mitsubishi136 decode");
+  if (_decoded(decodeMitsubishi136(results, offset))) return true;
 #endif  // DECODE_MITSUBISHI136
 #if DECODE_HITACHI_AC3
-    // HitachiAc3 should be checked before HitachiAC & HitachiAC2
-    // Attempt normal before the short version.
-    DPRINTLN("Attempting Hitachi AC3 decode");
-    // Order these in decreasing bit size, as it is more optimal.
-    if (decodeHitachiAc3(results, offset, kHitachiAc3Bits) ||
-        decodeHitachiAc3(results, offset, kHitachiAc3Bits - 4 * 8) ||
-        decodeHitachiAc3(results, offset, kHitachiAc3Bits - 6 * 8) ||
-        decodeHitachiAc3(results, offset, kHitachiAc3MinBits + 2 * 8) ||
-        decodeHitachiAc3(results, offset, kHitachiAc3MinBits))
-      return true;
+  // HitachiAc3 should be checked before HitachiAC & HitachiAC2
+  // Attempt normal before the short version.
+  DPRINTLN("Attempting Hitachi AC3 decode");
+  // Order these in decreasing bit size, as it is more optimal.
+  if (_decoded(decodeHitachiAc3(results, offset, kHitachiAc3Bits)) ||
+      _decoded(decodeHitachiAc3(results, offset, kHitachiAc3Bits - 4 * 8)) ||
+      _decoded(decodeHitachiAc3(results, offset, kHitachiAc3Bits - 6 * 8)) ||
+      _decoded(decodeHitachiAc3(results, offset, kHitachiAc3MinBits + 2 * 8)) ||
+      _decoded(decodeHitachiAc3(results, offset, kHitachiAc3MinBits)))
+    return true;
 #endif  // DECODE_HITACHI_AC3
 #if DECODE_HITACHI_AC344
-    // HitachiAC344 should be checked before HitachiAC
-    DPRINTLN("Attempting Hitachi AC344 decode");
-    if (decodeHitachiAC(results, offset, kHitachiAc344Bits, true, false))
-      return true;
+  // HitachiAC344 should be checked before HitachiAC
+  DPRINTLN("Attempting Hitachi AC344 decode");
+  if (_decoded(decodeHitachiAC(results, offset, kHitachiAc344Bits, true,
+                               false)))
+    return true;
 #endif  // DECODE_HITACHI_AC344
 #if DECODE_HITACHI_AC264
-    // HitachiAC264 should be checked before HitachiAC
-    DPRINTLN("Attempting Hitachi AC264 decode");
-    if (decodeHitachiAC(results, offset, kHitachiAc264Bits, true, false))
-      return true;
+  // HitachiAC264 should be checked before HitachiAC
+  DPRINTLN("Attempting Hitachi AC264 decode");
+  if (_decoded(decodeHitachiAC(results, offset, kHitachiAc264Bits, true,
+                               false)))
+    return true;
 #endif  // DECODE_HITACHI_AC264
 #if DECODE_HITACHI_AC296
-    // HitachiAC296 should be checked before HitachiAC
-    DPRINTLN("Attempting Hitachi AC296 decode");
-    if (decodeHitachiAc296(results, offset, kHitachiAc296Bits, true))
-      return true;
+  // HitachiAC296 should be checked before HitachiAC
+  DPRINTLN("Attempting Hitachi AC296 decode");
+  if (_decoded(decodeHitachiAc296(results, offset, kHitachiAc296Bits, true)))
+    return true;
 #endif  // DECODE_HITACHI_AC296
 #if DECODE_HITACHI_AC2
-    // HitachiAC2 should be checked before HitachiAC
-    DPRINTLN("Attempting Hitachi AC2 decode");
-    if (decodeHitachiAC(results, offset, kHitachiAc2Bits)) return true;
+  // HitachiAC2 should be checked before HitachiAC
+  DPRINTLN("Attempting Hitachi AC2 decode");
+  if (_decoded(decodeHitachiAC(results, offset, kHitachiAc2Bits))) return true;
 #endif  // DECODE_HITACHI_AC2
 #if DECODE_HITACHI_AC
-    DPRINTLN("Attempting Hitachi AC decode");
-    if (decodeHitachiAC(results, offset, kHitachiAcBits)) return true;
+  DPRINTLN("Attempting Hitachi AC decode");
+  if (_decoded(decodeHitachiAC(results, offset, kHitachiAcBits))) return true;
 #endif
 #if DECODE_HITACHI_AC1
-    DPRINTLN("Attempting Hitachi AC1 decode");
-    if (decodeHitachiAC(results, offset, kHitachiAc1Bits)) return true;
+  DPRINTLN("Attempting Hitachi AC1 decode");
+  if (_decoded(decodeHitachiAC(results, offset, kHitachiAc1Bits))) return true;
 #endif
 #if DECODE_WHIRLPOOL_AC
-    DPRINTLN("Attempting Whirlpool AC decode");
-    if (decodeWhirlpoolAC(results, offset)) return true;
+  DPRINTLN("Attempting Whirlpool AC decode");
+  if (_decoded(decodeWhirlpoolAC(results, offset))) return true;
 #endif
 #if DECODE_SAMSUNG_AC
-    DPRINTLN("Attempting Samsung AC (extended) decode");
-    // Check the extended size first, as it should fail fast due to longer
-    // length.
-    if (decodeSamsungAC(results, offset, kSamsungAcExtendedBits)) return true;
-    // Now check for the more common length.
-    DPRINTLN("Attempting Samsung AC decode");
-    if (decodeSamsungAC(results, offset, kSamsungAcBits)) return true;
+  DPRINTLN("Attempting Samsung AC (extended) decode");
+  // Check the extended size first, as it should fail fast due to longer
+  // length.
+  if (_decoded(decodeSamsungAC(results, offset, kSamsungAcExtendedBits)))
+    return true;
+  // Now check for the more common length.
+  DPRINTLN("Attempting Samsung AC decode");
+  if (_decoded(decodeSamsungAC(results, offset, kSamsungAcBits))) return true;
 #endif
 #if DECODE_ELECTRA_AC
-    DPRINTLN("Attempting Electra AC decode");
-    if (decodeElectraAC(results, offset)) return true;
+  DPRINTLN("Attempting Electra AC decode");
+  if (_decoded(decodeElectraAC(results, offset))) return true;
 #endif
 #if DECODE_PANASONIC_AC
-    DPRINTLN("Attempting Panasonic AC decode");
-    if (decodePanasonicAC(results, offset)) return true;
-    DPRINTLN("Attempting Panasonic AC short decode");
-    if (decodePanasonicAC(results, offset, kPanasonicAcShortBits)) return true;
+  DPRINTLN("Attempting Panasonic AC decode");
+  if (_decoded(decodePanasonicAC(results, offset))) return true;
+  DPRINTLN("Attempting Panasonic AC short decode");
+  if (_decoded(decodePanasonicAC(results, offset, kPanasonicAcShortBits)))
+    return true;
 #endif
 #if DECODE_LUTRON
-    DPRINTLN("Attempting Lutron decode");
-    if (decodeLutron(results, offset)) return true;
+  DPRINTLN("Attempting Lutron decode");
+  if (_decoded(decodeLutron(results, offset))) return true;
 #endif
 #if DECODE_MWM
-    DPRINTLN("Attempting MWM decode");
-    if (decodeMWM(results, offset)) return true;
+  DPRINTLN("Attempting MWM decode");
+  if (_decoded(decodeMWM(results, offset))) return true;
 #endif
 #if DECODE_VESTEL_AC
-    DPRINTLN("Attempting Vestel AC decode");
-    if (decodeVestelAc(results, offset)) return true;
+  DPRINTLN("Attempting Vestel AC decode");
+  if (_decoded(decodeVestelAc(results, offset))) return true;
 #endif
 #if DECODE_MITSUBISHI112 || DECODE_TCL112AC
-    // Mitsubish112 and Tcl112 share the same decoder.
-    DPRINTLN("Attempting Mitsubishi112/TCL112AC decode");
-    if (decodeMitsubishi112(results, offset)) return true;
+  // Mitsubish112 and Tcl112 share the same decoder.
+  DPRINTLN("Attempting Mitsubishi112/TCL112AC decode");
+  if (_decoded(decodeMitsubishi112(results, offset))) return true;
 #endif  // DECODE_MITSUBISHI112 || DECODE_TCL112AC
 #if DECODE_TECO
-    DPRINTLN("Attempting Teco decode");
-    if (decodeTeco(results, offset)) return true;
+  DPRINTLN("Attempting Teco decode");
+  if (_decoded(decodeTeco(results, offset))) return true;
 #endif
 #if DECODE_LEGOPF
-    DPRINTLN("Attempting LEGOPF decode");
-    if (decodeLegoPf(results, offset)) return true;
+  DPRINTLN("Attempting LEGOPF decode");
+  if (_decoded(decodeLegoPf(results, offset))) return true;
 #endif
 #if DECODE_MITSUBISHIHEAVY
-    DPRINTLN("Attempting MITSUBISHIHEAVY (152 bit) decode");
-    if (decodeMitsubishiHeavy(results, offset, kMitsubishiHeavy152Bits))
-      return true;
-    DPRINTLN("Attempting MITSUBISHIHEAVY (88 bit) decode");
-    if (decodeMitsubishiHeavy(results, offset, kMitsubishiHeavy88Bits))
-      return true;
+  DPRINTLN("Attempting MITSUBISHIHEAVY (152 bit) decode");
+  if (_decoded(decodeMitsubishiHeavy(results, offset, kMitsubishiHeavy152Bits)))
+    return true;
+  DPRINTLN("Attempting MITSUBISHIHEAVY (88 bit) decode");
+  if (_decoded(decodeMitsubishiHeavy(results, offset, kMitsubishiHeavy88Bits)))
+    return true;
 #endif
 #if DECODE_ARGO
   DPRINTLN("Attempting Argo WREM3 decode (AC Control)");
-  if (decodeArgoWREM3(results, offset, kArgo3AcControlStateLength * 8, true))
+  if (_decoded(decodeArgoWREM3(results, offset, kArgo3AcControlStateLength * 8,
+                               true)))
     return true;
   DPRINTLN("Attempting Argo WREM3 decode (iFeel report)");
-  if (decodeArgoWREM3(results, offset, kArgo3iFeelReportStateLength * 8, true))
+  if (_decoded(decodeArgoWREM3(results, offset,
+                               kArgo3iFeelReportStateLength * 8, true)))
     return true;
   DPRINTLN("Attempting Argo WREM3 decode (Config)");
-  if (decodeArgoWREM3(results, offset, kArgo3ConfigStateLength * 8, true))
+  if (_decoded(decodeArgoWREM3(results, offset, kArgo3ConfigStateLength * 8,
+                               true)))
     return true;
   DPRINTLN("Attempting Argo WREM3 decode (Timer)");
-  if (decodeArgoWREM3(results, offset, kArgo3TimerStateLength * 8, true))
+  if (_decoded(decodeArgoWREM3(results, offset, kArgo3TimerStateLength * 8,
+                               true)))
     return true;
   DPRINTLN("Attempting Argo WREM2 decode");
-    if (decodeArgo(results, offset, kArgoBits) ||
-        decodeArgo(results, offset, kArgoShortBits, false)) return true;
+  if (_decoded(decodeArgo(results, offset, kArgoBits)) ||
+      _decoded(decodeArgo(results, offset, kArgoShortBits, false))) return true;
 #endif  // DECODE_ARGO
 #if DECODE_SHARP_AC
-    DPRINTLN("Attempting SHARP_AC decode");
-    if (decodeSharpAc(results, offset)) return true;
+  DPRINTLN("Attempting SHARP_AC decode");
+  if (_decoded(decodeSharpAc(results, offset))) return true;
 #endif
 #if DECODE_GOODWEATHER
-    DPRINTLN("Attempting GOODWEATHER decode");
-    if (decodeGoodweather(results, offset)) return true;
+  DPRINTLN("Attempting GOODWEATHER decode");
+  if (_decoded(decodeGoodweather(results, offset))) return true;
 #endif  // DECODE_GOODWEATHER
 #if DECODE_INAX
-    DPRINTLN("Attempting Inax decode");
-    if (decodeInax(results, offset)) return true;
+  DPRINTLN("Attempting Inax decode");
+  if (_decoded(decodeInax(results, offset))) return true;
 #endif  // DECODE_INAX
 #if DECODE_TROTEC
-    DPRINTLN("Attempting Trotec decode");
-    if (decodeTrotec(results, offset)) return true;
+  DPRINTLN("Attempting Trotec decode");
+  if (_decoded(decodeTrotec(results, offset))) return true;
 #endif  // DECODE_TROTEC
 #if DECODE_TROTEC_3550
-    DPRINTLN("Attempting Trotec 3550 decode");
-    if (decodeTrotec3550(results, offset)) return true;
+  DPRINTLN("Attempting Trotec 3550 decode");
+  if (_decoded(decodeTrotec3550(results, offset))) return true;
 #endif  // DECODE_TROTEC_3550
 #if DECODE_DAIKIN160
-    DPRINTLN("Attempting Daikin160 decode");
-    if (decodeDaikin160(results, offset)) return true;
+  DPRINTLN("Attempting Daikin160 decode");
+  if (_decoded(decodeDaikin160(results, offset))) return true;
 #endif  // DECODE_DAIKIN160
 #if DECODE_NEOCLIMA
-    DPRINTLN("Attempting Neoclima decode");
-    if (decodeNeoclima(results, offset)) return true;
+  DPRINTLN("Attempting Neoclima decode");
+  if (_decoded(decodeNeoclima(results, offset))) return true;
 #endif  // DECODE_NEOCLIMA
 #if DECODE_DAIKIN176
-    DPRINTLN("Attempting Daikin176 decode");
-    if (decodeDaikin176(results, offset)) return true;
+  DPRINTLN("Attempting Daikin176 decode");
+  if (_decoded(decodeDaikin176(results, offset))) return true;
 #endif  // DECODE_DAIKIN176
 #if DECODE_DAIKIN128
-    DPRINTLN("Attempting Daikin128 decode");
-    if (decodeDaikin128(results, offset)) return true;
+  DPRINTLN("Attempting Daikin128 decode");
+  if (_decoded(decodeDaikin128(results, offset))) return true;
 #endif  // DECODE_DAIKIN128
 #if DECODE_AMCOR
-    DPRINTLN("Attempting Amcor decode");
-    if (decodeAmcor(results, offset)) return true;
+  DPRINTLN("Attempting Amcor decode");
+  if (_decoded(decodeAmcor(results, offset))) return true;
 #endif  // DECODE_AMCOR
 #if DECODE_DAIKIN152
-    DPRINTLN("Attempting Daikin152 decode");
-    if (decodeDaikin152(results, offset)) return true;
+  DPRINTLN("Attempting Daikin152 decode");
+  if (_decoded(decodeDaikin152(results, offset))) return true;
 #endif  // DECODE_DAIKIN152
 #if DECODE_SYMPHONY
-    DPRINTLN("Attempting Symphony decode");
-    if (decodeSymphony(results, offset)) return true;
+  DPRINTLN("Attempting Symphony decode");
+  if (_decoded(decodeSymphony(results, offset))) return true;
 #endif  // DECODE_SYMPHONY
 #if DECODE_DAIKIN64
-    DPRINTLN("Attempting Daikin64 decode");
-    if (decodeDaikin64(results, offset)) return true;
+  DPRINTLN("Attempting Daikin64 decode");
+  if (_decoded(decodeDaikin64(results, offset))) return true;
 #endif  // DECODE_DAIKIN64
 #if DECODE_AIRWELL
-    DPRINTLN("Attempting Airwell decode");
-    if (decodeAirwell(results, offset)) return true;
+  DPRINTLN("Attempting Airwell decode");
+  if (_decoded(decodeAirwell(results, offset))) return true;
 #endif  // DECODE_AIRWELL
 #if DECODE_DELONGHI_AC
-    DPRINTLN("Attempting Delonghi AC decode");
-    if (decodeDelonghiAc(results, offset)) return true;
+  DPRINTLN("Attempting Delonghi AC decode");
+  if (_decoded(decodeDelonghiAc(results, offset))) return true;
 #endif  // DECODE_DELONGHI_AC
 #if DECODE_DOSHISHA
-    DPRINTLN("Attempting Doshisha decode");
-    if (decodeDoshisha(results, offset)) return true;
+  DPRINTLN("Attempting Doshisha decode");
+  if (_decoded(decodeDoshisha(results, offset))) return true;
 #endif  // DECODE_DOSHISHA
 #if DECODE_TRUMA
-    // Needs to happen before decodeMultibrackets() as they can appear similar.
-    DPRINTLN("Attempting Truma decode");
-    if (decodeTruma(results, offset)) return true;
+  // Needs to happen before decodeMultibrackets() as they can appear similar.
+  DPRINTLN("Attempting Truma decode");
+  if (_decoded(decodeTruma(results, offset))) return true;
 #endif  // DECODE_TRUMA
 #if DECODE_MULTIBRACKETS
-    DPRINTLN("Attempting Multibrackets decode");
-    if (decodeMultibrackets(results, offset)) return true;
+  DPRINTLN("Attempting Multibrackets decode");
+  if (_decoded(decodeMultibrackets(results, offset))) return true;
 #endif  // DECODE_MULTIBRACKETS
 #if DECODE_CARRIER_AC40
-    DPRINTLN("Attempting Carrier 40bit decode");
-    if (decodeCarrierAC40(results, offset)) return true;
+  DPRINTLN("Attempting Carrier 40bit decode");
+  if (_decoded(decodeCarrierAC40(results, offset))) return true;
 #endif  // DECODE_CARRIER_AC40
 #if DECODE_CARRIER_AC64
-    DPRINTLN("Attempting Carrier 64bit decode");
-    if (decodeCarrierAC64(results, offset)) return true;
+  DPRINTLN("Attempting Carrier 64bit decode");
+  if (_decoded(decodeCarrierAC64(results, offset))) return true;
 #endif  // DECODE_CARRIER_AC64
 #if DECODE_TECHNIBEL_AC
-    DPRINTLN("Attempting Technibel AC decode");
-    if (decodeTechnibelAc(results, offset)) return true;
+  DPRINTLN("Attempting Technibel AC decode");
+  if (_decoded(decodeTechnibelAc(results, offset))) return true;
 #endif  // DECODE_TECHNIBEL_AC
 #if DECODE_CORONA_AC
-    DPRINTLN("Attempting CoronaAc decode");
-    if (decodeCoronaAc(results, offset)) return true;
+  DPRINTLN("Attempting CoronaAc decode");
+  if (_decoded(decodeCoronaAc(results, offset))) return true;
 #endif  // DECODE_CORONA_AC
 #if DECODE_MIDEA24
-    DPRINTLN("Attempting Midea-Nec decode");
-    if (decodeMidea24(results, offset)) return true;
+  DPRINTLN("Attempting Midea-Nec decode");
+  if (_decoded(decodeMidea24(results, offset))) return true;
 #endif  // DECODE_MIDEA24
 #if DECODE_ZEPEAL
-    DPRINTLN("Attempting Zepeal decode");
-    if (decodeZepeal(results, offset)) return true;
+  DPRINTLN("Attempting Zepeal decode");
+  if (_decoded(decodeZepeal(results, offset))) return true;
 #endif  // DECODE_ZEPEAL
 #if DECODE_SANYO_AC
-    DPRINTLN("Attempting Sanyo AC decode");
-    if (decodeSanyoAc(results, offset)) return true;
+  DPRINTLN("Attempting Sanyo AC decode");
+  if (_decoded(decodeSanyoAc(results, offset))) return true;
 #endif  // DECODE_SANYO_AC
 #if DECODE_VOLTAS
   DPRINTLN("Attempting Voltas decode");
-  if (decodeVoltas(results)) return true;
+  if (_decoded(decodeVoltas(results))) return true;
 #endif  // DECODE_VOLTAS
 #if DECODE_METZ
-    DPRINTLN("Attempting Metz decode");
-    if (decodeMetz(results, offset)) return true;
+  DPRINTLN("Attempting Metz decode");
+  if (_decoded(decodeMetz(results, offset))) return true;
 #endif  // DECODE_METZ
 #if DECODE_TRANSCOLD
-    DPRINTLN("Attempting Transcold decode");
-    if (decodeTranscold(results, offset)) return true;
+  DPRINTLN("Attempting Transcold decode");
+  if (_decoded(decodeTranscold(results, offset))) return true;
 #endif  // DECODE_TRANSCOLD
 #if DECODE_MIRAGE
-    DPRINTLN("Attempting Mirage decode");
-    if (decodeMirage(results, offset)) return true;
+  DPRINTLN("Attempting Mirage decode");
+  if (_decoded(decodeMirage(results, offset))) return true;
 #endif  // DECODE_MIRAGE
 #if DECODE_ELITESCREENS
-    DPRINTLN("Attempting EliteScreens decode");
-    if (decodeElitescreens(results, offset)) return true;
+  DPRINTLN("Attempting EliteScreens decode");
+  if (_decoded(decodeElitescreens(results, offset))) return true;
 #endif  // DECODE_ELITESCREENS
 #if DECODE_PANASONIC_AC32
-    DPRINTLN("Attempting Panasonic AC (32bit) long decode");
-    if (decodePanasonicAC32(results, offset, kPanasonicAc32Bits)) return true;
-    DPRINTLN("Attempting Panasonic AC (32bit) short decode");
-    if (decodePanasonicAC32(results, offset, kPanasonicAc32Bits / 2))
-      return true;
+  DPRINTLN("Attempting Panasonic AC (32bit) long decode");
+  if (_decoded(decodePanasonicAC32(results, offset, kPanasonicAc32Bits)))
+    return true;
+  DPRINTLN("Attempting Panasonic AC (32bit) short decode");
+  if (_decoded(decodePanasonicAC32(results, offset, kPanasonicAc32Bits / 2)))
+    return true;
 #endif  // DECODE_PANASONIC_AC32
 #if DECODE_ECOCLIM
-    DPRINTLN("Attempting Ecoclim decode");
-    if (decodeEcoclim(results, offset, kEcoclimBits) ||
-        decodeEcoclim(results, offset, kEcoclimShortBits)) return true;
+  DPRINTLN("Attempting Ecoclim decode");
+  if (_decoded(decodeEcoclim(results, offset, kEcoclimBits)) ||
+      _decoded(decodeEcoclim(results, offset, kEcoclimShortBits))) return true;
 #endif  // DECODE_ECOCLIM
 #if DECODE_XMP
-    DPRINTLN("Attempting XMP decode");
-    if (decodeXmp(results, offset, kXmpBits)) return true;
+  DPRINTLN("Attempting XMP decode");
+  if (_decoded(decodeXmp(results, offset, kXmpBits))) return true;
 #endif  // DECODE_XMP
 #if DECODE_TEKNOPOINT
-    DPRINTLN("Attempting Teknopoint decode");
-    if (decodeTeknopoint(results, offset)) return true;
+  DPRINTLN("Attempting Teknopoint decode");
+  if (_decoded(decodeTeknopoint(results, offset))) return true;
 #endif  // DECODE_TEKNOPOINT
 #if DECODE_KELON168
-    DPRINTLN("Attempting Kelon 168-bit decode");
-    if (decodeKelon168(results, offset)) return true;
+  DPRINTLN("Attempting Kelon 168-bit decode");
+  if (_decoded(decodeKelon168(results, offset))) return true;
 #endif  // DECODE_KELON168
 #if DECODE_KELON
-    DPRINTLN("Attempting Kelon 48-bit decode");
-    if (decodeKelon(results, offset)) return true;
+  DPRINTLN("Attempting Kelon 48-bit decode");
+  if (_decoded(decodeKelon(results, offset))) return true;
 #endif  // DECODE_KELON
 #if DECODE_SANYO_AC88
-    DPRINTLN("Attempting SanyoAc88 decode");
-    if (decodeSanyoAc88(results, offset)) return true;
+  DPRINTLN("Attempting SanyoAc88 decode");
+  if (_decoded(decodeSanyoAc88(results, offset))) return true;
 #endif  // DECODE_SANYO_AC88
 #if DECODE_BOSE
-    DPRINTLN("Attempting Bose decode");
-    if (decodeBose(results, offset)) return true;
+  DPRINTLN("Attempting Bose decode");
+  if (_decoded(decodeBose(results, offset))) return true;
 #endif  // DECODE_BOSE
 #if DECODE_ARRIS
-    DPRINTLN("Attempting Arris decode");
-    if (decodeArris(results, offset)) return true;
+  DPRINTLN("Attempting Arris decode");
+  if (_decoded(decodeArris(results, offset))) return true;
 #endif  // DECODE_ARRIS
 #if DECODE_RHOSS
-    DPRINTLN("Attempting Rhoss decode");
-    if (decodeRhoss(results, offset)) return true;
+  DPRINTLN("Attempting Rhoss decode");
+  if (_decoded(decodeRhoss(results, offset))) return true;
 #endif  // DECODE_RHOSS
 #if DECODE_AIRTON
-    DPRINTLN("Attempting Airton decode");
-    if (decodeAirton(results, offset)) return true;
+  DPRINTLN("Attempting Airton decode");
+  if (_decoded(decodeAirton(results, offset))) return true;
 #endif  // DECODE_AIRTON
 #if DECODE_COOLIX48
-    DPRINTLN("Attempting Coolix 48-bit decode");
-    if (decodeCoolix48(results, offset)) return true;
+  DPRINTLN("Attempting Coolix 48-bit decode");
+  if (_decoded(decodeCoolix48(results, offset))) return true;
 #endif  // DECODE_COOLIX48
 #if DECODE_DAIKIN200
-    DPRINTLN("Attempting Daikin 200-bit decode");
-    if (decodeDaikin200(results, offset)) return true;
+  DPRINTLN("Attempting Daikin 200-bit decode");
+  if (_decoded(decodeDaikin200(results, offset))) return true;
 #endif  // DECODE_DAIKIN200
 #if DECODE_HAIER_AC160
-    DPRINTLN("Attempting Haier AC 160 bit decode");
-    if (decodeHaierAC160(results, offset)) return true;
+  DPRINTLN("Attempting Haier AC 160 bit decode");
+  if (_decoded(decodeHaierAC160(results, offset))) return true;
 #endif  // DECODE_HAIER_AC160
 #if DECODE_CARRIER_AC128
-    DPRINTLN("Attempting Carrier AC 128-bit decode");
-    if (decodeCarrierAC128(results, offset)) return true;
+  DPRINTLN("Attempting Carrier AC 128-bit decode");
+  if (_decoded(decodeCarrierAC128(results, offset))) return true;
 #endif  // DECODE_CARRIER_AC128
 #if DECODE_TOTO
-    DPRINTLN("Attempting Toto 48/24-bit decode");
-    if (decodeToto(results, offset, kTotoLongBits) ||  // Long needs to be first
-        decodeToto(results, offset, kTotoShortBits)) return true;
+  DPRINTLN("Attempting Toto 48/24-bit decode");
+  // Long needs to be first.
+  if (_decoded(decodeToto(results, offset, kTotoLongBits)) ||
+      _decoded(decodeToto(results, offset, kTotoShortBits))) return true;
 #endif  // DECODE_TOTO
 #if DECODE_CLIMABUTLER
-    DPRINTLN("Attempting ClimaButler decode");
-    if (decodeClimaButler(results)) return true;
+  DPRINTLN("Attempting ClimaButler decode");
+  if (_decoded(decodeClimaButler(results))) return true;
 #endif  // DECODE_CLIMABUTLER
 #if DECODE_TCL96AC
-    DPRINTLN("Attempting TCL AC 96-bit decode");
-    if (decodeTcl96Ac(results, offset)) return true;
+  DPRINTLN("Attempting TCL AC 96-bit decode");
+  if (_decoded(decodeTcl96Ac(results, offset))) return true;
 #endif  // DECODE_TCL96AC
 #if DECODE_SANYO_AC152
-    DPRINTLN("Attempting Sanyo AC 152-bit decode");
-    if (decodeSanyoAc152(results, offset)) return true;
+  DPRINTLN("Attempting Sanyo AC 152-bit decode");
+  if (_decoded(decodeSanyoAc152(results, offset))) return true;
 #endif  // DECODE_SANYO_AC152
 #if DECODE_DAIKIN312
-    DPRINTLN("Attempting Daikin 312-bit decode");
-    if (decodeDaikin312(results, offset)) return true;
+  DPRINTLN("Attempting Daikin 312-bit decode");
+  if (_decoded(decodeDaikin312(results, offset))) return true;
 #endif  // DECODE_DAIKIN312
 #if DECODE_GORENJE
-    DPRINTLN("Attempting GORENJE decode");
-    if (decodeGorenje(results, offset)) return true;
+  DPRINTLN("Attempting GORENJE decode");
+  if (_decoded(decodeGorenje(results, offset))) return true;
 #endif  // DECODE_GORENJE
 #if DECODE_WOWWEE
-    DPRINTLN("Attempting WOWWEE decode");
-    if (decodeWowwee(results, offset)) return true;
+  DPRINTLN("Attempting WOWWEE decode");
+  if (_decoded(decodeWowwee(results, offset))) return true;
 #endif  // DECODE_WOWWEE
 #if DECODE_CARRIER_AC84
-    DPRINTLN("Attempting Carrier A/C 84-bit decode");
-    if (decodeCarrierAC84(results, offset)) return true;
+  DPRINTLN("Attempting Carrier A/C 84-bit decode");
+  if (_decoded(decodeCarrierAC84(results, offset))) return true;
 #endif  // DECODE_CARRIER_AC84
 #if DECODE_YORK
-    DPRINTLN("Attempting York decode");
-    if (decodeYork(results, offset, kYorkBits)) return true;
+  DPRINTLN("Attempting York decode");
+  if (_decoded(decodeYork(results, offset, kYorkBits))) return true;
 #endif  // DECODE_YORK
 #if DECODE_BLUESTARHEAVY
-    DPRINTLN("Attempting BluestarHeavy decode");
-    if (decodeBluestarHeavy(results, offset, kBluestarHeavyBits)) return true;
+  DPRINTLN("Attempting BluestarHeavy decode");
+  if (_decoded(decodeBluestarHeavy(results, offset, kBluestarHeavyBits)))
+    return true;
 #endif  // DECODE_BLUESTARHEAVY
   // Typically new protocols are added above this line.
-  }
-#if DECODE_HASH
-  // decodeHash returns a hash on any input.
-  // Thus, it needs to be last in the list.
-  // If you add any decodes, add them before this.
-  if (decodeHash(results)) {
-    return true;
-  }
-#endif  // DECODE_HASH
-  // Throw away and start over
-  if (!resumed)  // Check if we have already resumed.
-    resume();
   return false;
 }  // NOLINT(readability/fn_size)
 
@@ -1315,9 +2757,12 @@ bool IRrecv::matchAtLeast(uint32_t measured, uint32_t desired,
 /// @param[in] desired The expected period (in usecs) we are matching against.
 /// @param[in] tolerance A percentage expressed as an integer. e.g. 10 is 10%.
 /// @param[in] excess A non-scaling amount to reduce usecs by.
+///   (Def: kUseDefExcess, i.e. kMarkExcess or the calibrated amount.)
 /// @return A Boolean. true if it matches, false if it doesn't.
 bool IRrecv::matchMark(uint32_t measured, uint32_t desired, uint8_t tolerance,
                        int16_t excess) {
+  if (_calibrating) _calibrated(true, &tolerance, &excess);
+  if (excess == kUseDefExcess) excess = kMarkExcess;
   DPRINT("Matching MARK ");
   DPRINT(measured * kRawTick);
   DPRINT(" vs ");
@@ -1325,7 +2770,10 @@ bool IRrecv::matchMark(uint32_t measured, uint32_t desired, uint8_t tolerance,
   DPRINT(" + ");
   DPRINT(excess);
   DPRINT(". ");
-  return match(measured, desired + excess, tolerance);
+  const bool result = match(measured, desired + excess, tolerance);
+  if (_calibrating && !_calibration_hold && result)
+    _calibrationSample(true, measured, desired, excess);
+  return result;
 }
 
 /// Check if we match a mark signal(measured) with the desired within a
@@ -1354,9 +2802,12 @@ bool IRrecv::matchMarkRange(const uint32_t measured, const uint32_t desired,
 /// @param[in] desired The expected period (in usecs) we are matching against.
 /// @param[in] tolerance A percentage expressed as an integer. e.g. 10 is 10%.
 /// @param[in] excess A non-scaling amount to reduce usecs by.
+///   (Def: kUseDefExcess, i.e. kMarkExcess or the calibrated amount.)
 /// @return A Boolean. true if it matches, false if it doesn't.
 bool IRrecv::matchSpace(uint32_t measured, uint32_t desired, uint8_t tolerance,
                         int16_t excess) {
+  if (_calibrating) _calibrated(false, &tolerance, &excess);
+  if (excess == kUseDefExcess) excess = kMarkExcess;
   DPRINT("Matching SPACE ");
   DPRINT(measured * kRawTick);
   DPRINT(" vs ");
@@ -1364,7 +2815,10 @@ bool IRrecv::matchSpace(uint32_t measured, uint32_t desired, uint8_t tolerance,
   DPRINT(" - ");
   DPRINT(excess);
   DPRINT(". ");
-  return match(measured, desired - excess, tolerance);
+  const bool result = match(measured, desired - excess, tolerance);
+  if (_calibrating && !_calibration_hold && result)
+    _calibrationSample(false, measured, desired, excess);
+  return result;
 }
 
 /// Check if we match a space signal(measured) with the desired within a
@@ -1432,6 +2886,8 @@ bool IRrecv::decodeHash(decode_results *results) {
   results->address = 0;
   results->command = 0;
   results->decode_type = UNKNOWN;
+  // Report the same value for similar messages, if asked to.
+  if (_unknown_clusters != NULL) results->value = _clusterUnknown(results);
   return true;
 }
 #endif  // DECODE_HASH
@@ -1446,34 +2902,77 @@ bool IRrecv::decodeHash(decode_results *results) {
 /// @param[in] zeromark Nr. of uSecs in an expected mark signal for a '0' bit.
 /// @param[in] zerospace Nr. of uSecs in an expected space signal for a '0' bit.
 /// @param[in] tolerance Percentage error margin to allow. (Default: kUseDefTol)
-/// @param[in] excess Nr. of uSeconds. (Def: kMarkExcess)
+/// @param[in] excess Nr. of uSeconds. (Def: kUseDefExcess)
 /// @param[in] MSBfirst Bit order to save the data in. (Def: true)
 ///   true is Most Significant Bit First Order, false is Least Significant First
 /// @param[in] expectlastspace Do we expect a space at the end of the message?
 /// @return A match_result_t structure containing the success (or not), the
 ///   data value, and how many buffer entries were used.
 match_result_t IRrecv::matchData(
-    volatile uint16_t *data_ptr, const uint16_t nbits, const uint16_t onemark,
+    const uint16_t *data_ptr, const uint16_t nbits, const uint16_t onemark,
     const uint32_t onespace, const uint16_t zeromark, const uint32_t zerospace,
     const uint8_t tolerance, const int16_t excess, const bool MSBfirst,
     const bool expectlastspace) {
   match_result_t result;
   result.success = false;  // Fail by default.
   result.data = 0;
-  if (expectlastspace) {  // We are expecting data with a final space.
+  if (expectlastspace && !_calibrating) {  // The usual case.
+    // The capture can't change under us, so work out the range each mark &
+    // space must be in once, rather than twice per entry via match(), which
+    // needs floating point maths. (The same bounds matchMark() &
+    // matchSpace() use.)
+    const int16_t extra = (excess == kUseDefExcess) ? kMarkExcess : excess;
+    const uint32_t one_mark_low = ticksLow((uint32_t)onemark + extra,
+                                           tolerance);
+    const uint32_t one_mark_high = ticksHigh((uint32_t)onemark + extra,
+                                             tolerance);
+    const uint32_t one_space_low = ticksLow(onespace - extra, tolerance);
+    const uint32_t one_space_high = ticksHigh(onespace - extra, tolerance);
+    const uint32_t zero_mark_low = ticksLow((uint32_t)zeromark + extra,
+                                            tolerance);
+    const uint32_t zero_mark_high = ticksHigh((uint32_t)zeromark + extra,
+                                              tolerance);
+    const uint32_t zero_space_low = ticksLow(zerospace - extra, tolerance);
+    const uint32_t zero_space_high = ticksHigh(zerospace - extra, tolerance);
     for (result.used = 0; result.used < nbits * 2;
          result.used += 2, data_ptr += 2) {
-      // Is the bit a '1'?
-      if (matchMark(*data_ptr, onemark, tolerance, excess) &&
-          matchSpace(*(data_ptr + 1), onespace, tolerance, excess)) {
-        result.data = (result.data << 1) | 1;
-      } else if (matchMark(*data_ptr, zeromark, tolerance, excess) &&
-                 matchSpace(*(data_ptr + 1), zerospace, tolerance, excess)) {
+      const uint32_t mark = *data_ptr * kRawTick;
+      const uint32_t space = *(data_ptr + 1) * kRawTick;
+      if (mark >= one_mark_low && mark <= one_mark_high &&
+          space >= one_space_low && space <= one_space_high) {
+        result.data = (result.data << 1) | 1;  // The bit is a '1'.
+      } else if (mark >= zero_mark_low && mark <= zero_mark_high &&
+                 space >= zero_space_low && space <= zero_space_high) {
         result.data <<= 1;  // The bit is a '0'.
-      } else {
+      } else {  // It's neither, so fail.
+        if (!MSBfirst) result.data = reverseBits(result.data, result.used / 2);
+        return result;
+      }
+    }
+    result.success = true;
+  } else if (expectlastspace) {  // We are expecting data with a final space.
+    for (result.used = 0; result.used < nbits * 2;
+         result.used += 2, data_ptr += 2) {
+      // Don't let calibration see the mark twice if it is tried as both bits.
+      _calibration_hold = _calibrating;
+      // Is the bit a '1'?
+      const bool one = matchMark(*data_ptr, onemark, tolerance, excess) &&
+          matchSpace(*(data_ptr + 1), onespace, tolerance, excess);
+      // Is the bit a '0'?
+      const bool zero = !one &&
+          matchMark(*data_ptr, zeromark, tolerance, excess) &&
+          matchSpace(*(data_ptr + 1), zerospace, tolerance, excess);
+      _calibration_hold = false;
+      if (!one && !zero) {
         if (!MSBfirst) result.data = reverseBits(result.data, result.used / 2);
         return result;  // It's neither, so fail.
       }
+      result.data = (result.data << 1) | one;
+      if (_calibrating) {  // Let calibration see the bit's mark & space once.
+        matchMark(*data_ptr, one ? onemark : zeromark, tolerance, excess);
+        matchSpace(*(data_ptr + 1), one ? onespace : zerospace, tolerance,
+                   excess);
+      }
     }
     result.success = true;
   } else {  // We are expecting data without a final space.
@@ -1508,12 +3007,12 @@ match_result_t IRrecv::matchData(
 /// @param[in] zeromark Nr. of uSecs in an expected mark signal for a '0' bit.
 /// @param[in] zerospace Nr. of uSecs in an expected space signal for a '0' bit.
 /// @param[in] tolerance Percentage error margin to allow. (Default: kUseDefTol)
-/// @param[in] excess Nr. of uSeconds. (Def: kMarkExcess)
+/// @param[in] excess Nr. of uSeconds. (Def: kUseDefExcess)
 /// @param[in] MSBfirst Bit order to save the data in. (Def: true)
 ///   true is Most Significant Bit First Order, false is Least Significant First
 /// @param[in] expectlastspace Do we expect a space at the end of the message?
 /// @return If successful, how many buffer entries were used. Otherwise 0.
-uint16_t IRrecv::matchBytes(volatile uint16_t *data_ptr, uint8_t *result_ptr,
+uint16_t IRrecv::matchBytes(const uint16_t *data_ptr, uint8_t *result_ptr,
                             const uint16_t remaining, const uint16_t nbytes,
                             const uint16_t onemark, const uint32_t onespace,
                             const uint16_t zeromark, const uint32_t zerospace,
@@ -1561,11 +3060,11 @@ uint16_t IRrecv::matchBytes(volatile uint16_t *data_ptr, uint8_t *result_ptr,
 /// @param[in] atleast Is the match on the footerspace a matchAtLeast or
 ///   matchSpace?
 /// @param[in] tolerance Percentage error margin to allow. (Default: kUseDefTol)
-/// @param[in] excess Nr. of uSeconds. (Def: kMarkExcess)
+/// @param[in] excess Nr. of uSeconds. (Def: kUseDefExcess)
 /// @param[in] MSBfirst Bit order to save the data in. (Def: true)
 ///   true is Most Significant Bit First Order, false is Least Significant First
 /// @return If successful, how many buffer entries were used. Otherwise 0.
-uint16_t IRrecv::_matchGeneric(volatile uint16_t *data_ptr,
+uint16_t IRrecv::_matchGeneric(const uint16_t *data_ptr,
                               uint64_t *result_bits_ptr,
                               uint8_t *result_bytes_ptr,
                               const bool use_bits,
@@ -1631,7 +3130,8 @@ uint16_t IRrecv::_matchGeneric(volatile uint16_t *data_ptr,
   // If we have something still to match & haven't reached the end of the buffer
   if (footerspace && offset < remaining) {
       if (atleast) {
-        if (!matchAtLeast(*(data_ptr + offset), footerspace, tolerance, excess))
+        if (!matchAtLeast(*(data_ptr + offset), footerspace, tolerance,
+                          excess == kUseDefExcess ? kMarkExcess : excess))
           return 0;
       } else {
         if (!matchSpace(*(data_ptr + offset), footerspace, tolerance, excess))
@@ -1663,11 +3163,11 @@ uint16_t IRrecv::_matchGeneric(volatile uint16_t *data_ptr,
 /// @param[in] atleast Is the match on the footerspace a matchAtLeast or
 ///   matchSpace?
 /// @param[in] tolerance Percentage error margin to allow. (Default: kUseDefTol)
-/// @param[in] excess Nr. of uSeconds. (Def: kMarkExcess)
+/// @param[in] excess Nr. of uSeconds. (Def: kUseDefExcess)
 /// @param[in] MSBfirst Bit order to save the data in. (Def: true)
 ///   true is Most Significant Bit First Order, false is Least Significant First
 /// @return If successful, how many buffer entries were used. Otherwise 0.
-uint16_t IRrecv::matchGeneric(volatile uint16_t *data_ptr,
+uint16_t IRrecv::matchGeneric(const uint16_t *data_ptr,
                               uint64_t *result_ptr,
                               const uint16_t remaining,
                               const uint16_t nbits,
@@ -1710,11 +3210,13 @@ uint16_t IRrecv::matchGeneric(volatile uint16_t *data_ptr,
 /// @param[in] atleast Is the match on the footerspace a matchAtLeast or
 ///   matchSpace?
 /// @param[in] tolerance Percentage error margin to allow. (Default: kUseDefTol)
-/// @param[in] excess Nr. of uSeconds. (Def: kMarkExcess)
+/// @param[in] excess Nr. of uSeconds. (Def: kUseDefExcess)
 /// @param[in] MSBfirst Bit order to save the data in. (Def: true)
 ///   true is Most Significant Bit First Order, false is Least Significant First
+/// @param[in] checksum The type of checksum in the last byte, if any.
+///   If it doesn't match, then neither does the section. (Def: kNoChecksum)
 /// @return If successful, how many buffer entries were used. Otherwise 0.
-uint16_t IRrecv::matchGeneric(volatile uint16_t *data_ptr,
+uint16_t IRrecv::matchGeneric(const uint16_t *data_ptr,
                               uint8_t *result_ptr,
                               const uint16_t remaining,
                               const uint16_t nbits,
@@ -1729,11 +3231,39 @@ uint16_t IRrecv::matchGeneric(volatile uint16_t *data_ptr,
                               const bool atleast,
                               const uint8_t tolerance,
                               const int16_t excess,
-                              const bool MSBfirst) {
-  return _matchGeneric(data_ptr, NULL, result_ptr, false, remaining, nbits,
-                       hdrmark, hdrspace, onemark, onespace,
-                       zeromark, zerospace, footermark, footerspace, atleast,
-                       tolerance, excess, MSBfirst);
+                              const bool MSBfirst,
+                              const section_checksum_t checksum) {
+  const uint16_t used = _matchGeneric(data_ptr, NULL, result_ptr, false,
+                                      remaining, nbits, hdrmark, hdrspace,
+                                      onemark, onespace, zeromark, zerospace,
+                                      footermark, footerspace, atleast,
+                                      tolerance, excess, MSBfirst);
+  if (used && !validSectionChecksum(result_ptr, nbits / 8, checksum)) return 0;
+  return used;
+}
+
+/// Check the last byte of a section of a message is the checksum of the bytes
+/// before it.
+/// @param[in] section A ptr to the bytes of the section.
+/// @param[in] length The nr. of bytes in the section, including the checksum.
+/// @param[in] checksum The type of checksum used.
+/// @return True, if it is valid (or there is no checksum). Otherwise, false.
+bool IRrecv::validSectionChecksum(const uint8_t *section,
+                                  const uint16_t length,
+                                  const section_checksum_t checksum) {
+  if (checksum == kNoChecksum) return true;
+  if (length == 0) return false;
+  const uint8_t expected = section[length - 1];
+  switch (checksum) {
+    case kSumBytesChecksum:
+      return expected == sumBytes(section, length - 1);
+    case kXorBytesChecksum:
+      return expected == xorBytes(section, length - 1);
+    case kSumNibblesChecksum:
+      return expected == irutils::sumNibbles(section, length - 1);
+    default:
+      return true;
+  }
 }
 
 /// Match & decode a generic/typical constant bit time <= 64bit IR message.
@@ -1755,13 +3285,13 @@ uint16_t IRrecv::matchGeneric(volatile uint16_t *data_ptr,
 /// @param[in] atleast Is the match on the footerspace a matchAtLeast or
 ///   matchSpace?
 /// @param[in] tolerance Percentage error margin to allow. (Default: kUseDefTol)
-/// @param[in] excess Nr. of uSeconds. (Def: kMarkExcess)
+/// @param[in] excess Nr. of uSeconds. (Def: kUseDefExcess)
 /// @param[in] MSBfirst Bit order to save the data in. (Def: true)
 ///   true is Most Significant Bit First Order, false is Least Significant First
 /// @return If successful, how many buffer entries were used. Otherwise 0.
 /// @note Parameters one + zero add up to the total time for a bit.
 ///   e.g. mark(one) + space(zero) is a `1`, mark(zero) + space(one) is a `0`.
-uint16_t IRrecv::matchGenericConstBitTime(volatile uint16_t *data_ptr,
+uint16_t IRrecv::matchGenericConstBitTime(const uint16_t *data_ptr,
                                           uint64_t *result_ptr,
                                           const uint16_t remaining,
                                           const uint16_t nbits,
@@ -1809,7 +3339,7 @@ uint16_t IRrecv::matchGenericConstBitTime(volatile uint16_t *data_ptr,
   if (remaining > offset) {
     if (atleast) {
       if (!matchAtLeast(*(data_ptr + offset), expected_space, tolerance,
-                        excess))
+                        excess == kUseDefExcess ? kMarkExcess : excess))
         return false;
     } else {
       if (!matchSpace(*(data_ptr + offset), expected_space, tolerance))
@@ -1848,7 +3378,7 @@ uint16_t IRrecv::matchGenericConstBitTime(volatile uint16_t *data_ptr,
 /// @return If successful, how many buffer entries were used. Otherwise 0.
 /// @see https://en.wikipedia.org/wiki/Manchester_code
 /// @see http://ww1.microchip.com/downloads/en/AppNotes/Atmel-9164-Manchester-Coding-Basics_Application-Note.pdf
-uint16_t IRrecv::matchManchester(volatile const uint16_t *data_ptr,
+uint16_t IRrecv::matchManchester(const uint16_t *data_ptr,
                                  uint64_t *result_ptr,
                                  const uint16_t remaining,
                                  const uint16_t nbits,
@@ -1936,6 +3466,54 @@ uint16_t IRrecv::matchManchester(volatile const uint16_t *data_ptr,
   return offset;
 }
 
+// Classes an interval is quantized into by matchManchesterData().
+// A bit mask of which half-period multiples the interval matched.
+const uint8_t kManchesterInvalid = 0;  // Matches nothing useful.
+const uint8_t kManchesterShort = 1;    // One half-period.
+const uint8_t kManchesterLong = 2;     // Two half-periods.
+// kManchesterShort | kManchesterLong = 3 (Ambiguous. Large tolerances.)
+const uint8_t kManchesterOver = 4;     // At least a half-period. e.g. Footer.
+const uint8_t kManchesterClasses = 5;
+
+// Actions to take for each quantized interval in a given decoder state.
+const uint8_t kManchesterValid = 1;     // The interval is acceptable.
+const uint8_t kManchesterEmit = 2;      // Completes a bit, so store it.
+const uint8_t kManchesterFlip = 4;      // The next bit is the inverse.
+const uint8_t kManchesterMidBit = 8;    // Leaves us half way through a bit.
+const uint8_t kManchesterUnread = 16;   // Interval isn't part of the data.
+
+// Decoder states.
+const uint8_t kManchesterBitStart = 0;  // At the start of a bit.
+const uint8_t kManchesterBitMid = 1;    // Half way through a bit.
+const uint8_t kManchesterLastMid = 2;   // Half way through the last bit.
+
+/// State transition table for matchManchesterData().
+/// Indexed by [decoder state][quantized interval class].
+/// A bit starts with a short half-period, and is completed by either a short
+/// half-period (next bit is the same), or a long one which also supplies the
+/// first half of the next (inverted) bit. Only the very last half-period may be
+/// longer than that, as it can merge with the footer/gap.
+const uint8_t kManchesterTable[3][kManchesterClasses] = {
+  // kManchesterBitStart
+  {0,                                                         // Invalid
+   kManchesterValid | kManchesterMidBit,                      // Short
+   0,                                                         // Long
+   kManchesterValid | kManchesterMidBit,                      // Ambiguous
+   0},                                                        // Over
+  // kManchesterBitMid
+  {0,
+   kManchesterValid | kManchesterEmit,
+   kManchesterValid | kManchesterEmit | kManchesterFlip | kManchesterMidBit,
+   kManchesterValid | kManchesterEmit | kManchesterFlip | kManchesterMidBit,
+   0},
+  // kManchesterLastMid
+  {0,
+   kManchesterValid | kManchesterEmit,
+   kManchesterValid | kManchesterEmit | kManchesterFlip | kManchesterMidBit,
+   kManchesterValid | kManchesterEmit | kManchesterFlip | kManchesterMidBit,
+   kManchesterValid | kManchesterEmit | kManchesterUnread},
+};
+
 /// Match & decode a Manchester Code data (<= 64bits.
 /// @param[in] data_ptr A pointer to where we are at in the capture buffer.
 /// @note `data_ptr` is assumed to be pointing to a "Mark", not a "Space".
@@ -1952,10 +3530,11 @@ uint16_t IRrecv::matchManchester(volatile const uint16_t *data_ptr,
 ///   true is Most Significant Bit First Order, false is Least Significant First
 /// @param[in] GEThomas Use G.E. Thomas (true) or IEEE 802.3 (false) convention?
 /// @return If successful, how many buffer entries were used. Otherwise 0.
+/// @note Each interval is quantized (once) into a nr. of half-periods, and the
+///   bits are then decoded via the `kManchesterTable` state machine.
 /// @see https://en.wikipedia.org/wiki/Manchester_code
 /// @see http://ww1.microchip.com/downloads/en/AppNotes/Atmel-9164-Manchester-Coding-Basics_Application-Note.pdf
-/// @todo Clean up and optimise this. It is just "get it working code" atm.
-uint16_t IRrecv::matchManchesterData(volatile const uint16_t *data_ptr,
+uint16_t IRrecv::matchManchesterData(const uint16_t *data_ptr,
                                      uint64_t *result_ptr,
                                      const uint16_t remaining,
                                      const uint16_t nbits,
@@ -1968,11 +3547,9 @@ uint16_t IRrecv::matchManchesterData(volatile const uint16_t *data_ptr,
   DPRINTLN("DEBUG: Entered matchManchesterData");
   uint16_t offset = 0;
   uint64_t data = 0;
-  uint16_t nr_half_periods = 0;
-  const uint16_t expected_half_periods = nbits * 2;
+  uint16_t nr_bits = 0;
   // Flip the bit if we have a starting balance. ie. Carry over from the header.
   bool currentBit = starting_balance ? !GEThomas : GEThomas;
-  const uint16_t raw_half_period = half_period / kRawTick;
 
   // Calculate how much remaining buffer is required.
   // Shortest case is nbits. Longest case is 2 * nbits.
@@ -1984,87 +3561,65 @@ uint16_t IRrecv::matchManchesterData(volatile const uint16_t *data_ptr,
     return 0;  // Nope, so abort.
   }
 
-  // Convert to ticks. Optimisation: Saves on math/extra instructions later.
-  uint16_t bank = starting_balance / kRawTick;
+  // Pre-calculate the quantization boundaries (in uSeconds) so each interval
+  // only costs a few integer comparisons.
+  const uint32_t short_low = ticksLow(half_period, tolerance, excess);
+  const uint32_t short_high = ticksHigh(half_period, tolerance, excess);
+  const uint32_t long_low = ticksLow(half_period * 2, tolerance, excess);
+  const uint32_t long_high = ticksHigh(half_period * 2, tolerance, excess);
+  const uint32_t over_low = ticksLow(
+      std::min((uint32_t)half_period, (uint32_t)MS_TO_USEC(params.timeout)),
+      tolerance, excess);
+
+  uint8_t state = kManchesterBitStart;
+  // A starting balance is the first half of the first bit.
+  if (starting_balance) {
+    const uint32_t usecs = (starting_balance / kRawTick) * kRawTick;
+    if (usecs < short_low || usecs > short_high) return 0;
+    state = kManchesterBitMid;
+  }
 
   // Data
-  // Loop through the buffer till we run out of buffer, or nr of half periods.
-  // Possible patterns are:
-  // short + short = 1 bit (Add the value of the previous bit again)
-  // short + long + short = 2 bits (Add the previous bit again, then flip & add)
-  // short + long + long + short = 3 bits (add prev, flip & add, flip & add)
-  // We can't start with a long.
-  //
-  // The general approach is thus:
-  //   Check we have a short interval, next or in the bank.
-  //   If the next timing value is long, act according and reset the bank to
-  //     a short balance.
-  //   or
-  //   If it is short, act accordingly and declare the bank empty.
-  //   Repeat.
-  while ((offset < remaining || bank) &&
-         nr_half_periods < expected_half_periods) {
-    // Get the next entry if we haven't anything existing to process.
-    DPRINT("DEBUG: Offset = ");
-    DPRINTLN(offset);
-    if (!bank) bank = *(data_ptr + offset++);
-    DPRINT("DEBUG: Bank = ");
-    DPRINTLN(bank * kRawTick);
-    // Check if we don't have a short interval.
-    DPRINTLN("DEBUG: Checking for short interval");
-    if (!match(bank, half_period, tolerance, excess)) {
-      DPRINTLN("DEBUG: It is. Exiting");
-      return 0;  // Not valid.
-    }
-    // We've succeeded in matching half a period, so count it.
-    nr_half_periods++;
-    DPRINT("DEBUG: Half Periods = ");
-    DPRINTLN(nr_half_periods);
-    // We've now used up our bank, so refill it with the next item, unless we
-    // are at the end of the capture buffer.
-    // If we are assume a single half period of "space".
+  // Loop through the buffer till we run out of buffer, or bits.
+  while (nr_bits < nbits) {
+    uint8_t interval;
     if (offset < remaining) {
-      DPRINT("DEBUG: Offset = ");
-      DPRINTLN(offset);
-      bank = *(data_ptr + offset++);
-    } else if (offset == remaining) {
-      bank = raw_half_period;
+      // Quantize the interval into the nr. of half-periods it could be.
+      const uint32_t usecs = *(data_ptr + offset++) * kRawTick;
+      interval = kManchesterInvalid;
+      if (usecs >= short_low && usecs <= short_high)
+        interval |= kManchesterShort;
+      if (usecs >= long_low && usecs <= long_high)
+        interval |= kManchesterLong;
+      if (!interval && (!usecs || usecs >= over_low))
+        interval = kManchesterOver;
+    } else if (state != kManchesterBitStart) {
+      // At the end of the capture buffer, assume a half period of "space".
+      interval = kManchesterShort;
     } else {
-      return 0;  // We are out of buffer, so abort!
+      break;  // We are out of buffer.
     }
-    DPRINT("DEBUG: Bank = ");
-    DPRINTLN(bank * kRawTick);
-
-    // Shift the data along and add our new bit.
-    DPRINT("DEBUG: Adding bit: ");
-    DPRINTLN((currentBit ? "1" : "0"));
-    data <<= 1;
-    data |= currentBit;
-
-    // Check if we have a long interval.
-    if (match(bank, half_period * 2, tolerance, excess)) {
-      // It is, so flip the bit we need to append, and remove a half_period of
-      // time from the bank.
-      DPRINTLN("DEBUG: long interval detected");
-      currentBit = !currentBit;
-      bank -= raw_half_period;
-    } else if (match(bank, half_period, tolerance, excess)) {
-      // It is a short interval, so eat up all the time and move on.
-      DPRINTLN("DEBUG: short interval detected");
-      bank = 0;
-    } else if (nr_half_periods == expected_half_periods - 1 &&
-               matchAtLeast(bank, half_period, tolerance, excess)) {
-      // We are at the end of the data & it is a short interval, so eat up all
-      // the time and move on.
-      bank = 0;
-      // Reduce the offset as we are at the end of the data doing a
-      // matchAtLeast() because  we could be processing part of a footer.
-      offset--;
-    } else {
-      // The length isn't what we expected (neither long or short), so bail.
-      return 0;
+    if (state == kManchesterBitMid && nr_bits == nbits - 1)
+      state = kManchesterLastMid;
+    const uint8_t action = kManchesterTable[state][interval];
+    DPRINT("DEBUG: State = ");
+    DPRINT(state);
+    DPRINT(", Interval = ");
+    DPRINT(interval);
+    DPRINT(", Action = ");
+    DPRINTLN(action);
+    if (!(action & kManchesterValid)) return 0;  // Not valid.
+    if (action & kManchesterEmit) {
+      // Shift the data along and add our new bit.
+      data <<= 1;
+      data |= currentBit;
+      nr_bits++;
     }
-    nr_half_periods++;
+    if (action & kManchesterFlip) currentBit = !currentBit;
+    // Don't count the interval if it is probably part of a footer.
+    if (action & kManchesterUnread) offset--;
+    state = (action & kManchesterMidBit) ? kManchesterBitMid
+                                         : kManchesterBitStart;
   }
 
   // Clean up and process the data.
@@ -2079,5 +3634,21 @@ uint16_t IRrecv::matchManchesterData(volatile const uint16_t *data_ptr,
 volatile irparams_t *IRrecv::_getParamsPtr(void) {
   return &params;
 }
+
+/// Unit test access to the end of a game mode frame. (See game_frame_end())
+/// @param[in] now The time (micros()) the frame ended.
+void IRrecv::_gameFrameEnd(const uint32_t now) { game_frame_end(now); }
+
+/// Unit test access to the GPIO interrupt handler. (See capture_edge())
+/// @param[in] now The time (micros()) of the edge.
+void IRrecv::_captureEdge(const uint32_t now) { capture_edge(now); }
+
+/// Unit test access to the timeout interrupt handler. (See capture_timeout())
+/// @param[in] now The time (micros()) the timeout happened.
+void IRrecv::_captureTimeout(const uint32_t now) { capture_timeout(now); }
+
+/// Unit test access to the repeater's edge handler. (See repeater_edge())
+/// @param[in] now The time (micros()) of the edge.
+void IRrecv::_repeaterEdge(const uint32_t now) { repeater_edge(now); }
 #endif  // UNIT_TEST
 // End of IRrecv class -------------------
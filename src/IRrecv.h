@@ -8,7 +8,12 @@
 
 #ifndef UNIT_TEST
 #include <Arduino.h>
-#endif
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#endif  // ESP32
+#endif  // UNIT_TEST
 #include <stddef.h>
 #define __STDC_LIMIT_MACROS
 #include <stdint.h>
@@ -26,6 +31,10 @@ const uint16_t kRawBuf = 100;  // Default length of raw capture buffer
 const uint64_t kRepeat = UINT64_MAX;
 // Default min size of reported UNKNOWN messages.
 const uint16_t kUnknownThreshold = 6;
+// Clustering of UNKNOWN messages. (See IRrecv::enableUnknownClustering())
+const uint8_t kUnknownClusters = 8;  // Default nr. of clusters remembered.
+// Default max. nr. of mark & space entries in a clustered UNKNOWN message.
+const uint16_t kUnknownClusterMaxLength = 128;
 
 // receiver states
 const uint8_t kIdleState = 2;
@@ -34,6 +43,13 @@ const uint8_t kSpaceState = 4;
 const uint8_t kStopState = 5;
 const uint8_t kTolerance = 25;   // default percent tolerance in measurements.
 const uint8_t kUseDefTol = 255;  // Indicate to use the class default tolerance.
+// Indicate to use the default (or calibrated) mark excess.
+const int16_t kUseDefExcess = INT16_MIN;
+// Receiver calibration. (See IRrecv::enableCalibration())
+// Max. percentage the calibration may widen the default tolerance to.
+const uint8_t kCalibrationMaxTolerance = 40;
+// Min. nr. of matched marks & spaces a message needs to be learnt from.
+const uint16_t kCalibrationMinSamples = 8;
 const uint16_t kRawTick = 2;     // Capture tick to uSec factor.
 #define RAWTICK kRawTick  // Deprecated. For legacy user code support only.
 // How long (ms) before we give up wait for more data?
@@ -48,10 +64,48 @@ const uint8_t kTimeoutMs = 15;  // In MilliSeconds.
 #define TIMEOUT_MS kTimeoutMs   // For legacy documentation.
 const uint16_t kMaxTimeoutMs = kRawTick * (UINT16_MAX / MS_TO_USEC(1));
 
+// Longest idle threshold (in ticks) an ESP32's RMT peripheral can have.
+// i.e. ~65ms. (See ENABLE_ESP32_RMT_RECV)
+const uint16_t kRmtMaxIdleTicks = (1 << 15) - 1;
+
 // Use FNV hash algorithm: http://isthe.com/chongo/tech/comp/fnv/#FNV-param
 const uint32_t kFnvPrime32 = 16777619UL;
 const uint32_t kFnvBasis32 = 2166136261UL;
 
+// Decode cache. (See IRrecv::enableDecodeCache())
+const uint8_t kDecodeCacheSize = 4;  // Default nr. of cached messages.
+// Max nr. of distinct mark (or space) durations a cacheable message can have.
+const uint8_t kDecodeCacheMaxTimings = 8;
+// Max nr. of marks & spaces a cacheable message can have. The sequence of which
+// distinct duration each one is, is kept at 4 bits per mark or space.
+const uint16_t kDecodeCacheMaxLength = 512;
+// Shortest space (in uSeconds) decodeAll() considers as a possible gap between
+// messages. Longer than nearly all protocol header spaces.
+const uint32_t kDecodeAllMinGap = 5000;
+// Laser-tag game receive profile. (See IRrecv::enableGameMode())
+// MilesTag2 frames are separated by kMilesTag2RptLength (32ms) of silence, and
+// the longest mark or space inside a frame is its 2.4ms header mark. The
+// timeout restarts on every edge, so 4ms of no edges safely ends a shot, even
+// with a sloppy header. Much sooner than the usual kTimeoutMs.
+const uint8_t kGameTimeoutMs = 4;  // In MilliSeconds.
+const uint8_t kGameFrames = 8;     // Default nr. of back-to-back buffers.
+// Entries per game capture buffer. The longest frame is a 24 bit MilesTag2
+// message: Gap + header + mark & space per bit, plus a terminating entry.
+const uint16_t kGameFrameSize = kStartOffset + 2 * (1 + kMilesTag2MsgBits) + 1;
+// Cut-through repeater. (See IRrecv::enableRepeater())
+const uint16_t kRepeaterDelayUs = 2000;  // Received to retransmitted edge.
+// Pulses shorter than this are treated as glitches, and aren't retransmitted.
+const uint16_t kRepeaterMinPulseUs = 100;
+const uint16_t kRepeaterFrequency = 38000;  // In Hz.
+// A received edge up to this long after we sent the same kind of edge could
+// be the receiver seeing our own retransmission. i.e. An echo.
+const uint16_t kRepeaterEchoUs = 500;
+// This many echoes in a row means it is a feedback loop.
+const uint8_t kRepeaterEchoEdges = 4;
+// Longest mark we will send. A longer one means the receiver can't see the end
+// of it, because it is seeing our own (continuous) retransmission of it.
+const uint16_t kRepeaterMaxMarkMs = 50;
+
 #ifdef ESP32
 // Which of the ESP32 timers to use by default.
 // (3 for most ESP32s, 1 for ESP32-C3s)
@@ -60,6 +114,13 @@ const uint8_t kDefaultESP32Timer = SOC_TIMER_GROUP_TOTAL_TIMERS - 1;
 #else  // SOC_TIMER_GROUP_TOTAL_TIMERS
 const uint8_t kDefaultESP32Timer = 3;
 #endif  // SOC_TIMER_GROUP_TOTAL_TIMERS
+#ifndef UNIT_TEST
+// Defaults for the optional decode task. (See IRrecv::startDecodeTask())
+// Arduino runs loop() on core 1 at priority 1, so stay out of its way.
+const BaseType_t kDecodeTaskCore = 0;
+const UBaseType_t kDecodeTaskPriority = 2;
+const uint32_t kDecodeTaskStackSize = 4096;  // Bytes.
+#endif  // UNIT_TEST
 #endif  // ESP32
 
 #if DECODE_AC
@@ -111,12 +172,109 @@ class decode_results {
     uint8_t state[kStateSizeMax];  // Multi-byte results.
   };
   uint16_t bits;              // Number of bits in decoded value
-  volatile uint16_t *rawbuf;  // Raw intervals in .5 us ticks
+  // Raw intervals in .5 us ticks. Not `volatile`, as decode() only hands it
+  // out once the interrupt handler has stopped writing to it.
+  uint16_t *rawbuf;
   uint16_t rawlen;            // Number of records in rawbuf.
   bool overflow;
   bool repeat;  // Is the result a repeat code?
 };
 
+/// A message remembered by the decode cache.
+/// Captures are identified by their length, the sequence of distinct mark &
+/// space durations used, and what those durations were. That is tolerant of
+/// the jitter between repeats of the same message. The decode settings used
+/// are part of the identity too, as they change what a capture decodes as.
+struct decode_cache_entry_t {
+  uint32_t signature;  // Hash of the sequence of distinct durations used.
+  uint32_t last_used;  // For least-recently-used replacement. 0 = Empty.
+  uint16_t rawlen;
+  uint16_t max_skip;  // The `max_skip` it was decoded with.
+  uint8_t tolerance;  // The tolerance (%) it was decoded with.
+  uint8_t nr_timings[2];  // Nr. of distinct mark & space durations.
+  uint16_t timings[2][kDecodeCacheMaxTimings];  // The durations (in ticks).
+  // Which of `timings` each mark & space is. Two per byte, low nibble first.
+  uint8_t sequence[kDecodeCacheMaxLength / 2];
+  decode_results results;
+};
+
+/// How the last byte of a section of a message checks the bytes before it.
+/// Used to reject a bad message as soon as a section of it has been matched.
+/// (See IRrecv::validSectionChecksum())
+enum section_checksum_t {
+  kNoChecksum = 0,      // Nothing to check.
+  kSumBytesChecksum,    // sumBytes()
+  kXorBytesChecksum,    // xorBytes()
+  kSumNibblesChecksum,  // irutils::sumNibbles()
+};
+
+/// What a receiver has learnt about its timing. (See IRrecv::enableCalibration)
+/// Save it & restore it with IRrecv::setCalibration() to keep it over reboots.
+struct ir_calibration_t {
+  int16_t mark_excess;   // How much longer (usecs) marks are than sent.
+  int16_t space_excess;  // How much shorter (usecs) spaces are than sent.
+  uint16_t jitter;       // Avg. timing error after that, in 0.1% units.
+  uint16_t samples;      // Nr. of messages learnt from. (Saturates)
+};
+
+/// Hit-rate counters for the decode cache.
+struct decode_cache_stats_t {
+  uint32_t hits;         // Captures answered from the cache.
+  uint32_t misses;       // Captures that had to be fully decoded.
+  uint32_t rejected;     // Signature matched, but the capture didn't.
+  uint32_t uncacheable;  // Captures too irregular to have a signature.
+};
+
+/// A group of similar UNKNOWN messages. e.g. The same button on a remote
+/// that no decoder recognises.
+struct unknown_cluster_t {
+  uint32_t id;         // The code reported as `value` for all its messages.
+  uint32_t last_used;  // For least-recently-used replacement. 0 = Unused.
+  uint16_t count;      // Nr. of messages seen. (Saturates)
+  uint16_t length;     // Nr. of entries in `timings`.
+  uint32_t lsh[2];     // Locality-sensitive hashes of `timings`.
+  uint16_t *timings;   // Average mark & space durations in uSecs.
+                       // i.e. Suitable for `IRsend::sendRaw()`.
+};
+
+/// One of the messages found in a capture by IRrecv::decodeAll().
+struct decoded_message_t {
+  decode_results results;  // rawbuf & rawlen are for the whole capture.
+  uint16_t start;  // Index in rawbuf of the first mark of the message.
+  uint16_t end;    // Index in rawbuf of the last entry of the message.
+  uint32_t gap;    // Length of the space after the message (uSeconds).
+                   // 0 if it is the end of the capture.
+};
+
+/// A compact record of a laser-tag hit (shot or message).
+/// (See IRrecv::readHits())
+struct ir_hit_t {
+  uint32_t timestamp;  // When the frame ended. (micros())
+  uint32_t data;       // The shot or message. i.e. `decode_results.value`.
+  uint8_t protocol;    // A decode_type_t. e.g. MILESTAG2 or LASERTAG.
+  uint8_t bits;        // Nr. of bits in `data`.
+};
+
+/// Counters for the cut-through repeater. (See IRrecv::enableRepeater())
+struct ir_repeater_stats_t {
+  uint32_t frames;     // Frames retransmitted.
+  uint32_t glitches;   // Pulses filtered out as being too short.
+  uint32_t overflows;  // Edges lost because the delay line was full.
+  uint32_t late;       // Frames we got to late, and sent shifted in time.
+  uint32_t feedback;   // Frames abandoned as a suspected feedback loop.
+};
+
+/// The life cycle of the optional ESP32 decode task.
+/// (See IRrecv::startDecodeTask())
+enum decode_task_state_t {
+  kDecodeTaskStopped = 0,  // There is no task.
+  kDecodeTaskStarting,     // Being created. It waits until it is running.
+  kDecodeTaskRunning,      // Decoding each capture.
+  kDecodeTaskStopping,     // Asked to stop, but not finished yet.
+};
+
+class IRsend;  // Only needed by IRrecv::repeat().
+
 /// Class for receiving IR messages.
 class IRrecv {
  public:
@@ -135,26 +293,77 @@ class IRrecv {
   uint8_t getTolerance(void);
   bool decode(decode_results *results, irparams_t *save = NULL,
               uint8_t max_skip = 0, uint16_t noise_floor = 0);
+  bool decodeCapture(decode_results *results, const uint8_t max_skip = 0,
+                     const uint16_t noise_floor = 0);
+  uint16_t decodeAll(decode_results *results, decoded_message_t *messages,
+                     const uint16_t max_messages, irparams_t *save = NULL,
+                     const uint16_t noise_floor = 0,
+                     const uint32_t min_gap = kDecodeAllMinGap);
   void enableIRIn(const bool pullup = false);
   void disableIRIn(void);
   void pause(void);
   void resume(void);
+  bool available(void);
   uint16_t getBufSize(void);
+#if defined(ESP32) && !defined(UNIT_TEST)
+  /// Function type called by the decode task for each message captured.
+  /// @note `results->rawbuf` is only valid until the callback returns.
+  typedef void (*decode_callback_t)(const decode_results *results, void *arg);
+  bool startDecodeTask(decode_callback_t callback, void *arg = NULL,
+                       const BaseType_t core = kDecodeTaskCore,
+                       const UBaseType_t priority = kDecodeTaskPriority,
+                       const uint32_t stack_size = kDecodeTaskStackSize);
+  bool startDecodeTask(QueueHandle_t output,
+                       const BaseType_t core = kDecodeTaskCore,
+                       const UBaseType_t priority = kDecodeTaskPriority,
+                       const uint32_t stack_size = kDecodeTaskStackSize);
+  bool stopDecodeTask(void);
+#endif  // defined(ESP32) && !defined(UNIT_TEST)
 #if DECODE_HASH
   void setUnknownThreshold(const uint16_t length);
 #endif
+  bool enableDecodeCache(const uint8_t entries = kDecodeCacheSize);
+  void disableDecodeCache(void);
+  void clearDecodeCache(void);
+  decode_cache_stats_t getDecodeCacheStats(void);
+  void enableCalibration(const bool enable = true);
+  ir_calibration_t getCalibration(void);
+  void setCalibration(const ir_calibration_t calibration);
+  bool enableGameMode(const uint8_t frames = kGameFrames);
+  void disableGameMode(void);
+  uint16_t readHits(ir_hit_t *hits, const uint16_t max_hits);
+  uint32_t getGameFramesLost(void);
+  bool enableRepeater(const uint16_t delay = kRepeaterDelayUs,
+                      const uint16_t min_pulse = kRepeaterMinPulseUs,
+                      const uint16_t hz = kRepeaterFrequency);
+  void disableRepeater(void);
+  bool repeat(IRsend *irsend);
+  ir_repeater_stats_t getRepeaterStats(void);
+#if DECODE_HASH
+  bool enableUnknownClustering(
+      const uint8_t clusters = kUnknownClusters,
+      const uint16_t max_length = kUnknownClusterMaxLength);
+  void disableUnknownClustering(void);
+  const unknown_cluster_t *getUnknownCluster(const uint32_t id);
+#endif  // DECODE_HASH
+  static uint16_t rmtIdleThreshold(const uint8_t timeout);
+  static uint16_t rmtToRawbuf(const uint32_t *symbols, const uint16_t nsymbols,
+                              uint16_t *rawbuf, const uint16_t bufsize,
+                              bool *overflow,
+                              const uint32_t tick_ns = kRawTick * 1000,
+                              const bool mark_level = false);
   bool match(const uint32_t measured, const uint32_t desired,
              const uint8_t tolerance = kUseDefTol,
              const uint16_t delta = 0);
   bool matchMark(const uint32_t measured, const uint32_t desired,
                  const uint8_t tolerance = kUseDefTol,
-                 const int16_t excess = kMarkExcess);
+                 const int16_t excess = kUseDefExcess);
   bool matchMarkRange(const uint32_t measured, const uint32_t desired,
                       const uint16_t range = 100,
                       const int16_t excess = kMarkExcess);
   bool matchSpace(const uint32_t measured, const uint32_t desired,
                   const uint8_t tolerance = kUseDefTol,
-                  const int16_t excess = kMarkExcess);
+                  const int16_t excess = kUseDefExcess);
   bool matchSpaceRange(const uint32_t measured, const uint32_t desired,
                        const uint16_t range = 100,
                        const int16_t excess = kMarkExcess);
@@ -163,16 +372,72 @@ class IRrecv {
  private:
 #endif
   irparams_t *irparams_save;
+  uint16_t *_rawbuf;  // The capture buffer this object allocated.
   uint8_t _tolerance;
 #if defined(ESP32)
   uint8_t _timer_num;
+#ifndef UNIT_TEST
+  decode_callback_t _decode_callback;
+  void *_decode_arg;
+  QueueHandle_t _decode_queue;
+  bool _startDecodeTask(const BaseType_t core, const UBaseType_t priority,
+                        const uint32_t stack_size);
+  static void _decodeTask(void *self);
+#endif  // UNIT_TEST
 #endif  // defined(ESP32)
+  static bool _decodeTaskStarting(volatile uint8_t *state);
+  static bool _decodeTaskStopping(volatile uint8_t *state, const void *task,
+                                  const void *caller);
 #if DECODE_HASH
   uint16_t _unknown_threshold;
+  unknown_cluster_t *_unknown_clusters;
+  uint16_t *_unknown_cluster_timings;
+  uint8_t _unknown_clusters_size;
+  uint16_t _unknown_cluster_max_length;
+  uint32_t _unknown_cluster_clock;
+  void _unknownClusterHashes(const uint16_t *timings, const uint16_t length,
+                             uint32_t lsh[2]);
+  bool _unknownClusterMatch(const unknown_cluster_t *cluster,
+                            const decode_results *results,
+                            const uint32_t total);
+  uint32_t _clusterUnknown(const decode_results *results);
 #endif
+  bool _calibrating;
+  bool _calibration_hold;  // Don't collect calibration samples for now.
+  ir_calibration_t _calibration;
+  int32_t _calibration_mark_sum;
+  int32_t _calibration_space_sum;
+  uint32_t _calibration_error_sum;
+  uint16_t _calibration_marks;
+  uint16_t _calibration_spaces;
+  void _calibrationReset(void);
+  void _calibrationSample(const bool mark, const uint32_t measured,
+                          const uint32_t desired, const int16_t excess);
+  void _calibrationUpdate(void);
+  void _calibrated(const bool mark, uint8_t *tolerance, int16_t *excess);
+  bool _decoded(const bool success);
+  uint8_t _calibratedTolerance(void);
+  decode_cache_entry_t *_decode_cache;
+  uint8_t _decode_cache_size;
+  uint32_t _decode_cache_clock;
+  decode_cache_stats_t _decode_cache_stats;
 #ifdef UNIT_TEST
   volatile irparams_t *_getParamsPtr(void);
+  void _gameFrameEnd(const uint32_t now);
+  void _captureEdge(const uint32_t now);
+  void _captureTimeout(const uint32_t now);
+  void _repeaterEdge(const uint32_t now);
 #endif  // UNIT_TEST
+  void _setTimeout(const uint8_t timeout);
+  bool _decodeCacheSignature(const decode_results *results,
+                             const uint16_t max_skip,
+                             decode_cache_entry_t *key);
+  bool _decodeCacheLookup(decode_results *results,
+                          const decode_cache_entry_t *key);
+  void _decodeCacheStore(const decode_results *results,
+                         const decode_cache_entry_t *key);
+  bool _decodeAny(decode_results *results, const uint8_t max_skip);
+  bool _decodeAt(decode_results *results, const uint16_t offset);
   // These are called by decode
   uint8_t _validTolerance(const uint8_t percentage);
   void copyIrParams(volatile irparams_t *src, irparams_t *dst);
@@ -186,7 +451,7 @@ class IRrecv {
   bool matchAtLeast(const uint32_t measured, const uint32_t desired,
                     const uint8_t tolerance = kUseDefTol,
                     const uint16_t delta = 0);
-  uint16_t _matchGeneric(volatile uint16_t *data_ptr,
+  uint16_t _matchGeneric(const uint16_t *data_ptr,
                          uint64_t *result_bits_ptr,
                          uint8_t *result_ptr,
                          const bool use_bits,
@@ -202,24 +467,24 @@ class IRrecv {
                          const uint32_t footerspace,
                          const bool atleast = false,
                          const uint8_t tolerance = kUseDefTol,
-                         const int16_t excess = kMarkExcess,
+                         const int16_t excess = kUseDefExcess,
                          const bool MSBfirst = true);
-  match_result_t matchData(volatile uint16_t *data_ptr, const uint16_t nbits,
+  match_result_t matchData(const uint16_t *data_ptr, const uint16_t nbits,
                            const uint16_t onemark, const uint32_t onespace,
                            const uint16_t zeromark, const uint32_t zerospace,
                            const uint8_t tolerance = kUseDefTol,
-                           const int16_t excess = kMarkExcess,
+                           const int16_t excess = kUseDefExcess,
                            const bool MSBfirst = true,
                            const bool expectlastspace = true);
-  uint16_t matchBytes(volatile uint16_t *data_ptr, uint8_t *result_ptr,
+  uint16_t matchBytes(const uint16_t *data_ptr, uint8_t *result_ptr,
                       const uint16_t remaining, const uint16_t nbytes,
                       const uint16_t onemark, const uint32_t onespace,
                       const uint16_t zeromark, const uint32_t zerospace,
                       const uint8_t tolerance = kUseDefTol,
-                      const int16_t excess = kMarkExcess,
+                      const int16_t excess = kUseDefExcess,
                       const bool MSBfirst = true,
                       const bool expectlastspace = true);
-  uint16_t matchGeneric(volatile uint16_t *data_ptr,
+  uint16_t matchGeneric(const uint16_t *data_ptr,
                         uint64_t *result_ptr,
                         const uint16_t remaining, const uint16_t nbits,
                         const uint16_t hdrmark, const uint32_t hdrspace,
@@ -228,9 +493,9 @@ class IRrecv {
                         const uint16_t footermark, const uint32_t footerspace,
                         const bool atleast = false,
                         const uint8_t tolerance = kUseDefTol,
-                        const int16_t excess = kMarkExcess,
+                        const int16_t excess = kUseDefExcess,
                         const bool MSBfirst = true);
-  uint16_t matchGeneric(volatile uint16_t *data_ptr, uint8_t *result_ptr,
+  uint16_t matchGeneric(const uint16_t *data_ptr, uint8_t *result_ptr,
                         const uint16_t remaining, const uint16_t nbits,
                         const uint16_t hdrmark, const uint32_t hdrspace,
                         const uint16_t onemark, const uint32_t onespace,
@@ -239,9 +504,13 @@ class IRrecv {
                         const uint32_t footerspace,
                         const bool atleast = false,
                         const uint8_t tolerance = kUseDefTol,
-                        const int16_t excess = kMarkExcess,
-                        const bool MSBfirst = true);
-  uint16_t matchGenericConstBitTime(volatile uint16_t *data_ptr,
+                        const int16_t excess = kUseDefExcess,
+                        const bool MSBfirst = true,
+                        const section_checksum_t checksum = kNoChecksum);
+  static bool validSectionChecksum(const uint8_t *section,
+                                   const uint16_t length,
+                                   const section_checksum_t checksum);
+  uint16_t matchGenericConstBitTime(const uint16_t *data_ptr,
                                     uint64_t *result_ptr,
                                     const uint16_t remaining,
                                     const uint16_t nbits,
@@ -253,9 +522,9 @@ class IRrecv {
                                     const uint32_t footerspace,
                                     const bool atleast = false,
                                     const uint8_t tolerance = kUseDefTol,
-                                    const int16_t excess = kMarkExcess,
+                                    const int16_t excess = kUseDefExcess,
                                     const bool MSBfirst = true);
-  uint16_t matchManchesterData(volatile const uint16_t *data_ptr,
+  uint16_t matchManchesterData(const uint16_t *data_ptr,
                                uint64_t *result_ptr,
                                const uint16_t remaining,
                                const uint16_t nbits,
@@ -265,7 +534,7 @@ class IRrecv {
                                const int16_t excess = kMarkExcess,
                                const bool MSBfirst = true,
                                const bool GEThomas = true);
-  uint16_t matchManchester(volatile const uint16_t *data_ptr,
+  uint16_t matchManchester(const uint16_t *data_ptr,
                            uint64_t *result_ptr,
                            const uint16_t remaining,
                            const uint16_t nbits,
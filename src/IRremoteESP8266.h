@@ -1011,6 +1011,18 @@
 #define ENABLE_NOISE_FILTER_OPTION true
 #endif  // ENABLE_NOISE_FILTER_OPTION
 
+// On ESP32s, capture IR messages with the RMT peripheral rather than a GPIO
+// interrupt on every edge plus a hardware timer for the timeout.
+// The RMT hardware timestamps the edges itself & detects the end of a message,
+// so the cpu is only involved once per message. This makes capturing immune
+// to interrupt latency/jitter caused by WiFi etc.
+// Note: Requires a v2.x ESP32 Arduino core. (v3.x dropped the RMT driver used)
+//       A message can't be longer than the RMT's receive memory. See IRrecv.cpp
+//       Timeouts longer than ~65ms are limited to that. (See kRmtMaxIdleTicks)
+#ifndef ENABLE_ESP32_RMT_RECV
+#define ENABLE_ESP32_RMT_RECV false
+#endif  // ENABLE_ESP32_RMT_RECV
+
 /// Enumerator for defining and numbering of supported IR protocol.
 /// @note Always add to the end of the list and should never remove entries
 ///  or change order. Projects may save the type number for later usage
@@ -5,16 +5,132 @@
 #include "IRsend.h"
 #ifndef UNIT_TEST
 #include <Arduino.h>
+#if defined(ESP32)
+#include <soc/gpio_reg.h>
+#endif  // ESP32
 #else
 #define __STDC_LIMIT_MACROS
 #include <stdint.h>
 #endif
 #include <algorithm>
+#include <cstring>
 #ifdef UNIT_TEST
 #include <cmath>
 #endif
 #include "IRtimer.h"
 
+#if _IRSEND_TIMER_ENGINE
+#ifndef IRAM_ATTR
+#define IRAM_ATTR ICACHE_RAM_ATTR
+#endif  // IRAM_ATTR
+
+// Nr. of timer ticks before the first edge of a newly started timeline.
+const uint32_t kTimelineStartTicks = 10;
+
+namespace _IRsend {
+/// The queue of timeline steps waiting to be sent by the timer engine.
+static ir_timeline_step_t queue[kTimelineQueueSize];
+static volatile uint8_t queue_head = 0;  // Where the next step is queued.
+static volatile uint8_t queue_tail = 0;  // The step being sent.
+static volatile uint32_t pulses_done = 0;  // Nr. of repeats of it sent.
+static volatile bool in_off = false;  // Is it in the "off" part of the step?
+static volatile bool running = false;  // Is the timer interrupt active?
+static uint32_t gpio_mask = 0;  // The GPIOs (0-15) the engine drives.
+static bool on_is_high = true;  // Is "on" a HIGH output level?
+
+/// Set the engine's GPIOs to the "on" or "off" output level.
+/// @param[in] on The level to set.
+static inline void IRAM_ATTR write_output(const bool on) {
+  if (on == on_is_high)
+    GPOS = gpio_mask;
+  else
+    GPOC = gpio_mask;
+}
+
+/// Timer1 interrupt handler. Sends the queued timeline, an edge at a time, and
+/// sets the timer for when the next edge is due.
+static void IRAM_ATTR timer_isr(void) {
+  while (queue_tail != queue_head) {
+    const ir_timeline_step_t *step = &queue[queue_tail];
+    if (!in_off) {  // Start of a pulse.
+      in_off = true;
+      if (step->on) {
+        write_output(true);
+        timer1_write(step->on);
+        return;
+      }
+    }
+    // Grab what we need from the step before it can be reused.
+    const uint32_t off = step->off;
+    in_off = false;
+    pulses_done = pulses_done + 1;
+    if (pulses_done >= step->count) {  // Finished with the step.
+      pulses_done = 0;
+      queue_tail = (queue_tail + 1) % kTimelineQueueSize;
+    }
+    write_output(false);
+    if (off) {
+      timer1_write(off);
+      return;
+    }
+  }
+  // Nothing left to send. Stop until more is queued.
+  write_output(false);
+  timer1_disable();
+  running = false;
+}
+}  // namespace _IRsend
+#endif  // _IRSEND_TIMER_ENGINE
+
+namespace _IRsend {
+// Transmit timing stats. They are shared by all IRsend objects, as IRac etc.
+// make their own. (See IRsend::enableTxStats())
+static ir_tx_stats_t *tx_stats = NULL;  // NULL means the stats are off.
+static uint8_t tx_stats_used = 0;  // Nr. of `tx_stats` entries in use.
+static uint8_t tx_slot = 0;  // The `tx_stats` entry of the current message.
+static decode_type_t tx_protocol = decode_type_t::UNKNOWN;
+static bool tx_in_send = false;  // Are we inside a send()/txStatsBegin()?
+static bool tx_new_send = true;  // Does the next interval start a message?
+static uint16_t tx_overrun = kTxStatsOverrunDefault;
+static ir_tx_interval_t *tx_log = NULL;  // The intervals of the last message.
+static uint16_t tx_log_size = 0;
+static uint16_t tx_log_len = 0;
+
+/// Add a sent mark or space to the transmit stats.
+/// @param[in] requested How long it was asked to be. (uSeconds)
+/// @param[in] measured How long it actually took. (uSeconds)
+/// @param[in] mark Was it a mark?
+static void record_tx(const uint32_t requested, const uint32_t measured,
+                      const bool mark) {
+  if (tx_new_send) {  // Find (or make) the entry for this message's protocol.
+    tx_slot = 0;  // Entry 0 is for UNKNOWN, and anything we can't fit in.
+    for (uint8_t i = 1; i < tx_stats_used && !tx_slot; i++)
+      if (tx_stats[i].protocol == tx_protocol) tx_slot = i;
+    if (!tx_slot && tx_protocol != decode_type_t::UNKNOWN &&
+        tx_stats_used < kTxStatsMaxProtocols) {
+      tx_slot = tx_stats_used++;
+      tx_stats[tx_slot].protocol = tx_protocol;
+    }
+    tx_stats[tx_slot].sends++;
+    tx_log_len = 0;
+    tx_new_send = false;
+  }
+  ir_tx_stats_t *stats = &tx_stats[tx_slot];
+  const uint32_t error = (measured > requested) ? measured - requested
+                                                : requested - measured;
+  stats->intervals++;
+  stats->total_error += error;
+  stats->max_error = std::max(stats->max_error, error);
+  if (measured > requested + tx_overrun) stats->overruns++;
+  if (tx_log_len < tx_log_size) {
+    tx_log[tx_log_len].requested = requested;
+    tx_log[tx_log_len].measured = measured;
+    tx_log[tx_log_len].mark = mark;
+    tx_log_len++;
+  }
+}
+}  // namespace _IRsend
+
 /// Constructor for an IRsend object.
 /// @param[in] IRsendPin Which GPIO pin to use when sending an IR command.
 /// @param[in] inverted Optional flag to invert the output. (default = false)
@@ -39,6 +155,12 @@ IRsend::IRsend(uint16_t IRsendPin, bool inverted, bool use_modulation)
     _dutycycle = kDutyDefault;
   else
     _dutycycle = kDutyMax;
+  _outputMask = 0;  // Default to driving just `IRpin`.
+#if _IRSEND_TIMER_ENGINE
+  _timer_engine = false;
+  _timeline_period = 1;
+  _timeline_on = 1;
+#endif  // _IRSEND_TIMER_ENGINE
 }
 
 /// Enable the pin for output.
@@ -51,6 +173,10 @@ void IRsend::begin() {
 
 /// Turn off the IR LED.
 void IRsend::ledOff() {
+  if (_outputMask) {
+    _writeOutputMask(outputOff);
+    return;
+  }
 #ifndef UNIT_TEST
   digitalWrite(IRpin, outputOff);
 #endif
@@ -58,11 +184,40 @@ void IRsend::ledOff() {
 
 /// Turn on the IR LED.
 void IRsend::ledOn() {
+  if (_outputMask) {
+    _writeOutputMask(outputOn);
+    return;
+  }
 #ifndef UNIT_TEST
   digitalWrite(IRpin, outputOn);
 #endif
 }
 
+/// Set every GPIO in the output mask to the given level.
+/// Where possible, it is done with a single GPIO register write so all the
+/// outputs change at the same instant.
+/// @param[in] level The level (HIGH or LOW) to set the GPIOs to.
+void IRsend::_writeOutputMask(const uint8_t level) {
+#ifndef UNIT_TEST
+#if defined(ESP8266)
+  // GPIO0-15 share a register. GPIO16 lives in the RTC block.
+  if (level == HIGH)
+    GPOS = _outputMask & 0xFFFF;
+  else
+    GPOC = _outputMask & 0xFFFF;
+  if (_outputMask & (1UL << 16)) digitalWrite(16, level);
+#elif defined(ESP32)
+  REG_WRITE((level == HIGH) ? GPIO_OUT_W1TS_REG : GPIO_OUT_W1TC_REG,
+            _outputMask);
+#else  // ESP32
+  for (uint8_t pin = 0; pin <= kIRsendMultiMaxGpio; pin++)
+    if (_outputMask & (1UL << pin)) digitalWrite(pin, level);
+#endif  // ESP8266
+#else  // UNIT_TEST
+  (void)level;
+#endif  // UNIT_TEST
+}
+
 /// Calculate the period for a given frequency.
 /// @param[in] hz Frequency in Hz.
 /// @param[in] use_offset Should we use the calculated offset or not?
@@ -106,6 +261,13 @@ void IRsend::enableIROut(uint32_t freq, uint8_t duty) {
   onTimePeriod = (period * _dutycycle) / kDutyMax;
   // Nr. of uSeconds the LED will be off per pulse.
   offTimePeriod = period - onTimePeriod;
+  // Outside of send(), each message (we can see) starts by setting the carrier.
+  if (!_IRsend::tx_in_send) _IRsend::tx_new_send = true;
+#if _IRSEND_TIMER_ENGINE
+  // The timer engine works in finer ticks, and needs no offset.
+  _timeline_period = timelinePeriod(freq);
+  _timeline_on = (_timeline_period * _dutycycle) / kDutyMax;
+#endif  // _IRSEND_TIMER_ENGINE
 }
 
 #if ALLOW_DELAY_CALLS
@@ -155,17 +317,30 @@ void IRsend::_delayMicroseconds(uint32_t usec) {
 /// Ref:
 ///   https://www.analysir.com/blog/2017/01/29/updated-esp8266-nodemcu-backdoor-upwm-hack-for-ir-signals/
 uint16_t IRsend::mark(uint16_t usec) {
+#if _IRSEND_TIMER_ENGINE
+  if (_timer_engine) {
+    ir_timeline_step_t steps[2];
+    const uint8_t nsteps = timelineMark(usec, _timeline_period, _timeline_on,
+                                        steps);
+    _queueTimeline(steps, nsteps);
+    uint16_t pulses = 0;
+    for (uint8_t i = 0; i < nsteps; i++) pulses += steps[i].count;
+    return pulses;
+  }
+#endif  // _IRSEND_TIMER_ENGINE
+  IRtimer usecTimer = IRtimer();
   // Handle the simple case of no required frequency modulation.
   if (!modulation || _dutycycle >= 100) {
     ledOn();
     _delayMicroseconds(usec);
     ledOff();
+    if (_IRsend::tx_stats != NULL)
+      _IRsend::record_tx(usec, usecTimer.elapsed(), true);
     return 1;
   }
 
   // Not simple, so do it assuming frequency modulation.
   uint16_t counter = 0;
-  IRtimer usecTimer = IRtimer();
   // Cache the time taken so far. This saves us calling time, and we can be
   // assured that we can't have odd math problems. i.e. unsigned under/overflow.
   uint32_t elapsed = usecTimer.elapsed();
@@ -178,12 +353,14 @@ uint16_t IRsend::mark(uint16_t usec) {
     ledOff();
     counter++;
     if (elapsed + onTimePeriod >= usec)
-      return counter;  // LED is now off & we've passed our allotted time.
+      break;  // LED is now off & we've passed our allotted time.
     // Wait for the lesser of the rest of the duty cycle, or the time remaining.
     _delayMicroseconds(
         std::min(usec - elapsed - onTimePeriod, (uint32_t)offTimePeriod));
     elapsed = usecTimer.elapsed();  // Update & recache the actual elapsed time.
   }
+  if (_IRsend::tx_stats != NULL)
+    _IRsend::record_tx(usec, usecTimer.elapsed(), true);
   return counter;
 }
 
@@ -192,9 +369,22 @@ uint16_t IRsend::mark(uint16_t usec) {
 /// A space is no output, so the PWM output is disabled.
 /// @param[in] time Time in microseconds (us).
 void IRsend::space(uint32_t time) {
+#if _IRSEND_TIMER_ENGINE
+  if (_timer_engine) {
+    ir_timeline_step_t steps[2];
+    _queueTimeline(steps, timelineSpace(time, steps));
+    return;
+  }
+#endif  // _IRSEND_TIMER_ENGINE
   ledOff();
   if (time == 0) return;
+  if (_IRsend::tx_stats == NULL) {
+    _delayMicroseconds(time);
+    return;
+  }
+  IRtimer usecTimer = IRtimer();
   _delayMicroseconds(time);
+  _IRsend::record_tx(time, usecTimer.elapsed(), false);
 }
 
 /// Calculate & set any offsets to account for execution times during sending.
@@ -205,6 +395,9 @@ void IRsend::space(uint32_t time) {
 /// @note This will generate an 65535us mark() IR LED signal.
 ///  This only needs to be called once, if at all.
 int8_t IRsend::calibrate(uint16_t hz) {
+#if _IRSEND_TIMER_ENGINE
+  if (_timer_engine) return 0;  // The timer engine doesn't need an offset.
+#endif  // _IRSEND_TIMER_ENGINE
   if (hz < 1000)  // Were we given kHz? Supports the old call usage.
     hz *= 1000;
   periodOffset = 0;  // Turn off any existing offset while we calibrate.
@@ -232,6 +425,269 @@ int8_t IRsend::calibrate(uint16_t hz) {
   return periodOffset;
 }
 
+/// Turn on (or off) the transmit timing stats.
+/// When on, every mark & space sent (by any IRsend object) is timed, and how
+/// far it was from what was requested is recorded, per protocol. e.g. To see
+/// if interrupts (WiFi etc) are stretching the timings of what we send.
+/// @param[in] enable Turn them on or off. Turning them on resets them.
+/// @param[in] overrun How many uSeconds an interval can run over what was
+///   requested before it is counted as an overrun.
+/// @param[in] log_size How many intervals of the last message sent to keep.
+///   (See `getTxLog()`) 0 means don't keep any.
+/// @return True if the stats are now on.
+/// @note Messages sent via send() or IRac are recorded against their
+///   protocol. Anything else is recorded as UNKNOWN, and a new message is
+///   assumed to start with each call to `enableIROut()`.
+/// @note Intervals sent via the timer engine aren't timed.
+bool IRsend::enableTxStats(const bool enable, const uint16_t overrun,
+                           const uint16_t log_size) {
+  delete[] _IRsend::tx_stats;
+  delete[] _IRsend::tx_log;
+  _IRsend::tx_stats = NULL;
+  _IRsend::tx_log = NULL;
+  _IRsend::tx_log_size = 0;
+  if (!enable) return false;
+  _IRsend::tx_overrun = overrun;
+  if (log_size) {
+    _IRsend::tx_log = new ir_tx_interval_t[log_size];
+    _IRsend::tx_log_size = log_size;
+  }
+  _IRsend::tx_stats = new ir_tx_stats_t[kTxStatsMaxProtocols];
+  resetTxStats();
+  return true;
+}
+
+/// Reset the transmit timing stats.
+void IRsend::resetTxStats(void) {
+  if (_IRsend::tx_stats == NULL) return;
+  memset(_IRsend::tx_stats, 0, sizeof(ir_tx_stats_t) * kTxStatsMaxProtocols);
+  _IRsend::tx_stats[0].protocol = decode_type_t::UNKNOWN;
+  _IRsend::tx_stats_used = 1;
+  _IRsend::tx_log_len = 0;
+  _IRsend::tx_new_send = true;
+}
+
+/// Get a copy of the transmit timing stats.
+/// @param[out] stats Where to store the stats for each protocol seen.
+///   The first entry is always for UNKNOWN.
+/// @param[in] max The max. nr. of entries `stats` can hold.
+/// @return The nr. of entries stored. 0 if the stats are off.
+uint8_t IRsend::getTxStats(ir_tx_stats_t stats[], const uint8_t max) {
+  if (_IRsend::tx_stats == NULL) return 0;
+  const uint8_t count = std::min(max, _IRsend::tx_stats_used);
+  memcpy(stats, _IRsend::tx_stats, sizeof(ir_tx_stats_t) * count);
+  return count;
+}
+
+/// Get a copy of the intervals of the last message sent.
+/// @param[out] log Where to store the intervals.
+/// @param[in] max The max. nr. of entries `log` can hold.
+/// @return The nr. of entries stored.
+uint16_t IRsend::getTxLog(ir_tx_interval_t log[], const uint16_t max) {
+  const uint16_t count = std::min(max, _IRsend::tx_log_len);
+  memcpy(log, _IRsend::tx_log, sizeof(ir_tx_interval_t) * count);
+  return count;
+}
+
+/// Mark the start of a message, for the transmit timing stats.
+/// @param[in] protocol The protocol of the message about to be sent.
+/// @note Must be paired with `txStatsEnd()`. send() & IRac do it for you.
+void IRsend::txStatsBegin(const decode_type_t protocol) {
+  _IRsend::tx_protocol = protocol;
+  _IRsend::tx_in_send = true;
+  _IRsend::tx_new_send = true;
+}
+
+/// Mark the end of a message started with `txStatsBegin()`.
+void IRsend::txStatsEnd(void) {
+  _IRsend::tx_protocol = decode_type_t::UNKNOWN;
+  _IRsend::tx_in_send = false;
+  _IRsend::tx_new_send = true;
+}
+
+/// Calculate the period of a carrier frequency in transmit timeline ticks.
+/// @param[in] hz The carrier frequency. Assumes < 1000 means kHz else Hz.
+/// @return Nr. of ticks. (At least 1)
+uint32_t IRsend::timelinePeriod(uint32_t hz) {
+  if (hz < 1000)  // Were we given kHz? Supports the old call usage.
+    hz *= 1000;
+  if (hz == 0) hz = 1;  // Avoid Zero hz. Divide by Zero is nasty.
+  return std::max((uint32_t)1, (uint32_t)(
+      (kTimelineTicksPerUsec * 1000000UL + hz / 2) / hz));
+}
+
+/// Convert a mark into transmit timeline steps.
+/// The same pulses as the software PWM in `mark()`, but with no allowance for
+/// code execution time. i.e. Whole carrier periods, then a final partial one.
+/// @param[in] usec The length of the mark in uSeconds.
+/// @param[in] period The carrier period in ticks. (See `timelinePeriod()`)
+/// @param[in] on How many ticks of each period the output is on for.
+///   `on` >= `period` means no modulation. i.e. On for the whole mark.
+/// @param[out] steps Where to store the steps.
+/// @return The nr. of steps used. (0-2)
+/// @note No part of the final partial pulse is shorter than
+///   `kTimelineMinTicks`. Too short a pulse is added to the off part of the
+///   last whole one, and too short an off part is added to its pulse. A mark
+///   shorter than that is lengthened to it.
+uint8_t IRsend::timelineMark(const uint32_t usec, const uint32_t period,
+                             const uint32_t on, ir_timeline_step_t steps[2]) {
+  const uint32_t ticks = usec * kTimelineTicksPerUsec;
+  if (ticks == 0) return 0;
+  if (on >= period) {  // No modulation.
+    steps[0].on = std::max(ticks, kTimelineMinTicks);
+    steps[0].off = 0;
+    steps[0].count = 1;
+    return 1;
+  }
+  uint32_t pulses = ticks / period;
+  const uint32_t remainder = ticks % period;
+  // The final partial pulse.
+  uint32_t last_on = std::min(on, remainder);
+  uint32_t last_off = remainder - last_on;
+  if (last_off && last_off < kTimelineMinTicks) {  // Stay on for it instead.
+    last_on = remainder;
+    last_off = 0;
+  }
+  if (last_on && last_on < kTimelineMinTicks) {
+    if (pulses) {  // Make the last whole pulse's off part longer instead.
+      pulses--;
+      last_on = on;
+      last_off = period - on + remainder;
+    } else {  // The whole mark is that short.
+      last_on = kTimelineMinTicks;
+    }
+  }
+  uint8_t nsteps = 0;
+  if (pulses) {
+    steps[nsteps].on = on;
+    steps[nsteps].off = period - on;
+    steps[nsteps].count = pulses;
+    nsteps++;
+  }
+  if (last_on) {
+    steps[nsteps].on = last_on;
+    steps[nsteps].off = last_off;
+    steps[nsteps].count = 1;
+    nsteps++;
+  }
+  return nsteps;
+}
+
+/// Convert a space into transmit timeline steps.
+/// Long spaces are split into repeats of `kTimelineMaxStepUsec`, so no step is
+/// too long for the timer.
+/// @param[in] usec The length of the space in uSeconds.
+/// @param[out] steps Where to store the steps.
+/// @return The nr. of steps used. (0-2)
+/// @note No step is shorter than `kTimelineMinTicks`. A space that would
+///   leave one shorter is lengthened, or added to the previous step.
+uint8_t IRsend::timelineSpace(const uint32_t usec,
+                              ir_timeline_step_t steps[2]) {
+  uint8_t nsteps = 0;
+  uint32_t repeats = usec / kTimelineMaxStepUsec;
+  uint32_t remainder = (usec % kTimelineMaxStepUsec) * kTimelineTicksPerUsec;
+  if (remainder && remainder < kTimelineMinTicks) {
+    if (repeats) {  // Add it to the last of the repeats.
+      repeats--;
+      remainder += kTimelineMaxStepUsec * kTimelineTicksPerUsec;
+    } else {
+      remainder = kTimelineMinTicks;
+    }
+  }
+  if (repeats) {
+    steps[nsteps].on = 0;
+    steps[nsteps].off = kTimelineMaxStepUsec * kTimelineTicksPerUsec;
+    steps[nsteps].count = repeats;
+    nsteps++;
+  }
+  if (remainder) {
+    steps[nsteps].on = 0;
+    steps[nsteps].off = remainder;
+    steps[nsteps].count = 1;
+    nsteps++;
+  }
+  return nsteps;
+}
+
+#if _IRSEND_TIMER_ENGINE
+/// Send marks & spaces using the ESP8266's timer1 interrupt, rather than
+/// busy-waiting in software. `mark()` & `space()` queue up the timeline and
+/// return as soon as there is room for it, and the interrupt sends it.
+/// i.e. The carrier accuracy doesn't depend on the CPU speed or `calibrate()`,
+/// and the CPU (e.g. WiFi) is free to run between the edges.
+/// `send()`, `sendGeneric()` & `sendRaw()` etc. wait until it has all been
+/// sent before they return. Call `waitUntilSent()` after any of your own
+/// `mark()` & `space()` calls.
+/// @param[in] enable Use the timer engine (true), or software PWM (false).
+/// @return True, if the timer engine is now in use. Otherwise, false.
+/// @note The interrupt fires for every edge. i.e. Twice per carrier period,
+///   or every ~13 uSeconds at 38kHz. No edge of a partial pulse or a space is
+///   closer than `kTimelineMinTicks` to the one before it.
+///   timer1 is also used by other libraries. e.g. Servo & tone().
+///   Only one IRsend object can use the timer engine at a time.
+///   Only GPIOs 0-15 are supported. Call it again if the GPIOs change.
+///   e.g. After `IRsendMulti::setActivePins()`.
+bool IRsend::enableTimerEngine(const bool enable) {
+  waitUntilSent();
+  _timer_engine = false;
+  timer1_detachInterrupt();
+  if (!enable) return false;
+  if (!_outputMask && IRpin > 15) return false;
+  const uint32_t mask = _outputMask ? _outputMask : (1UL << IRpin);
+  if (mask >> 16) return false;  // GPIO16 isn't in the GPIO register.
+  _IRsend::gpio_mask = mask;
+  _IRsend::on_is_high = (outputOn == HIGH);
+  _IRsend::write_output(false);
+  timer1_attachInterrupt(_IRsend::timer_isr);
+  _timer_engine = true;
+  return true;
+}
+
+
+/// Queue up timeline steps for the timer engine to send, and start it if it
+/// isn't already running. Waits (if it must) for room in the queue.
+/// @param[in] steps The steps to send.
+/// @param[in] nsteps The nr. of steps.
+void IRsend::_queueTimeline(const ir_timeline_step_t *steps,
+                            const uint8_t nsteps) {
+  for (uint8_t i = 0; i < nsteps; i++) {
+    const uint8_t next = (_IRsend::queue_head + 1) % kTimelineQueueSize;
+    while (next == _IRsend::queue_tail) {  // Full, so let other things run.
+#if ALLOW_DELAY_CALLS
+      yield();
+#endif  // ALLOW_DELAY_CALLS
+    }
+    _IRsend::queue[_IRsend::queue_head] = steps[i];
+    __sync_synchronize();  // The step must be stored before it is queued.
+    noInterrupts();
+    _IRsend::queue_head = next;
+    if (!_IRsend::running) {
+      _IRsend::running = true;
+      _IRsend::in_off = false;
+      _IRsend::pulses_done = 0;
+      timer1_enable(TIM_DIV16, TIM_EDGE, TIM_SINGLE);
+      timer1_write(kTimelineStartTicks);
+    }
+    interrupts();
+  }
+}
+#endif  // _IRSEND_TIMER_ENGINE
+
+/// Wait until the timer engine has sent everything queued up.
+/// `mark()` & `space()` return before the timer engine has sent them, so this
+/// is needed before timing anything from what has been sent, and before
+/// anything else is done with the output. Does nothing if the timer engine
+/// isn't in use.
+void IRsend::waitUntilSent(void) {
+#if _IRSEND_TIMER_ENGINE
+  while (_IRsend::running) {
+#if ALLOW_DELAY_CALLS
+    yield();
+#endif  // ALLOW_DELAY_CALLS
+  }
+#endif  // _IRSEND_TIMER_ENGINE
+}
+
 /// Generic method for sending data that is common to most protocols.
 /// Will send leading or trailing 0's if the nbits is larger than the number
 /// of bits in data.
@@ -371,12 +827,14 @@ void IRsend::sendGeneric(const uint16_t headermark, const uint32_t headerspace,
 
     // Footer
     if (footermark) mark(footermark);
+    waitUntilSent();  // So the time taken is what has really been sent.
     uint32_t elapsed = usecs.elapsed();
     // Avoid potential unsigned integer underflow. e.g. when mesgtime is 0.
     if (elapsed >= mesgtime)
       space(gap);
     else
       space(std::max(gap, mesgtime - elapsed));
+    waitUntilSent();
   }
 }
 
@@ -430,6 +888,7 @@ void IRsend::sendGeneric(const uint16_t headermark, const uint32_t headerspace,
     if (footermark) mark(footermark);
     space(gap);
   }
+  waitUntilSent();
 }
 
 /// Generic method for sending Manchester code data.
@@ -547,10 +1006,226 @@ void IRsend::sendRaw(const uint16_t buf[], const uint16_t len,
       mark(buf[i]);
     }
   }
+  waitUntilSent();
   ledOff();  // We potentially have ended with a mark(), so turn of the LED.
 }
+
+/// Get a symbol from a packed array of them.
+/// @param[in] symbols The packed symbols. LSB first.
+/// @param[in] index Which symbol to get.
+/// @param[in] bits Nr. of bits per symbol. (1-8)
+/// @return The symbol.
+static uint8_t getSymbol(const uint8_t *symbols, const uint16_t index,
+                         const uint8_t bits) {
+  const uint32_t bitpos = (uint32_t)index * bits;
+  const uint8_t shift = bitpos % 8;
+  uint16_t window = symbols[bitpos / 8] >> shift;
+  if (shift + bits > 8) window |= symbols[bitpos / 8 + 1] << (8 - shift);
+  return window & ((1 << bits) - 1);
+}
+
+/// Set a symbol in a packed array of them.
+/// @param[in,out] symbols The packed symbols. LSB first.
+/// @param[in] index Which symbol to set.
+/// @param[in] bits Nr. of bits per symbol. (1-8)
+/// @param[in] symbol The value to set it to.
+static void setSymbol(uint8_t *symbols, const uint16_t index,
+                      const uint8_t bits, const uint8_t symbol) {
+  const uint32_t bitpos = (uint32_t)index * bits;
+  const uint8_t shift = bitpos % 8;
+  const uint16_t mask = ((1 << bits) - 1) << shift;
+  const uint16_t value = (uint16_t)symbol << shift;
+  symbols[bitpos / 8] = (symbols[bitpos / 8] & ~mask) | (value & mask);
+  if (shift + bits > 8)
+    symbols[bitpos / 8 + 1] = (symbols[bitpos / 8 + 1] & ~(mask >> 8)) |
+                              ((value & mask) >> 8);
+}
+
+/// Find which of a set of durations a duration is like.
+/// @param[in] usecs The duration to look for.
+/// @param[in] durations The durations to look in.
+/// @param[in] nr_durations Nr. of entries in `durations`.
+/// @param[in] tolerance Percentage `usecs` may differ from them by.
+/// @return The index of the first one it is like. `nr_durations` if none.
+static uint8_t findSymbol(const uint16_t usecs, const uint16_t *durations,
+                          const uint8_t nr_durations, const uint8_t tolerance) {
+  uint8_t index = 0;
+  for (; index < nr_durations; index++) {
+    const uint32_t margin = (uint32_t)durations[index] * tolerance / 100;
+    const uint16_t diff = (usecs > durations[index]) ? usecs - durations[index]
+                                                     : durations[index] - usecs;
+    if (diff <= margin) break;
+  }
+  return index;
+}
+
+/// Send a symbol encoded raw IR frame.
+/// The durations are looked up as it is sent. i.e. No memory is allocated.
+/// @param[in] frame The frame to send.
+/// @note A symbol with no matching duration ends the frame early.
+void IRsend::sendSymbols(const ir_symbol_frame_t *frame) {
+  if (frame->bits == 0 || frame->bits > 4) return;  // Not a valid frame.
+  enableIROut(frame->hz);
+  for (uint16_t i = 0; i < frame->length; i++) {
+    const uint8_t symbol = getSymbol(frame->symbols, i, frame->bits);
+    if (symbol >= frame->nr_durations) break;  // Corrupt. Stop here.
+    if (i & 1)  // Odd bit.
+      space(frame->durations[symbol]);
+    else  // Even bit.
+      mark(frame->durations[symbol]);
+  }
+  waitUntilSent();
+  ledOff();  // We potentially have ended with a mark(), so turn of the LED.
+}
+
+/// Calculate how many bytes a packed array of symbols needs.
+/// @param[in] length Nr. of symbols.
+/// @param[in] bits Nr. of bits per symbol.
+/// @return Nr. of bytes.
+uint16_t IRsend::symbolsSize(const uint16_t length, const uint8_t bits) {
+  return ((uint32_t)length * bits + 7) / 8;
+}
+
+/// Convert a raw IR message (as per `sendRaw()`) into a compact, symbol
+/// encoded, frame. (See `sendSymbols()`)
+/// @param[in] buf An array of uint16_t's that has microseconds elements.
+/// @param[in] len Nr. of elements in the buf[] array.
+/// @param[in] hz Frequency to send the message at. (kHz < 1000; Hz >= 1000)
+/// @param[out] frame The frame to set up. It refers to `durations` & `symbols`.
+/// @param[out] durations Where to store the table of distinct durations.
+/// @param[out] symbols Where to store the packed symbols.
+/// @param[in] symbols_size Nr. of bytes available in `symbols`.
+/// @param[in] tolerance Percentage by which a duration may differ from the
+///   first one like it & still share a table entry. The entry is the average.
+///   0 (Default) means only exactly the same durations share an entry.
+///   e.g. 25 (like kTolerance) suits captured messages.
+/// @return True, if it fitted. False, if there were more than
+///   kSymbolsMaxDurations distinct durations, or `symbols` is too small.
+bool IRsend::encodeSymbols(const uint16_t buf[], const uint16_t len,
+                           const uint16_t hz, ir_symbol_frame_t *frame,
+                           uint16_t durations[kSymbolsMaxDurations],
+                           uint8_t *symbols, const uint16_t symbols_size,
+                           const uint8_t tolerance) {
+  // The first duration of each group of similar ones identifies the group.
+  uint16_t firsts[kSymbolsMaxDurations];
+  uint32_t sums[kSymbolsMaxDurations];
+  uint16_t counts[kSymbolsMaxDurations];
+  uint8_t nr_durations = 0;
+  // Find the groups, and the average duration of each.
+  for (uint16_t i = 0; i < len; i++) {
+    const uint8_t group = findSymbol(buf[i], firsts, nr_durations, tolerance);
+    if (group == nr_durations) {  // A new one.
+      if (nr_durations == kSymbolsMaxDurations) return false;  // Too many.
+      firsts[group] = buf[i];
+      sums[group] = 0;
+      counts[group] = 0;
+      nr_durations++;
+    }
+    sums[group] += buf[i];
+    counts[group]++;
+  }
+  // Use as few bits per symbol as we can.
+  uint8_t bits = 1;
+  while ((1 << bits) < nr_durations) bits++;
+  if (symbolsSize(len, bits) > symbols_size) return false;  // Won't fit.
+  for (uint8_t group = 0; group < nr_durations; group++)
+    durations[group] = (sums[group] + counts[group] / 2) / counts[group];
+  // Store which group each duration is in. (Matched the same way as before.)
+  for (uint16_t i = 0; i < len; i++)
+    setSymbol(symbols, i, bits,
+              findSymbol(buf[i], firsts, nr_durations, tolerance));
+  frame->hz = hz;
+  frame->length = len;
+  frame->bits = bits;
+  frame->nr_durations = nr_durations;
+  frame->durations = durations;
+  frame->symbols = symbols;
+  return true;
+}
+
+/// Add a duration to the end of a symbol encoded frame, as it is built.
+/// e.g. When the durations are parsed from text one at a time, so the whole
+/// raw message never needs to be stored.
+/// @param[in,out] frame The frame to add to. It must refer to `durations` &
+///   `symbols`, and have its `bits` set. e.g. 4, if it isn't known how many
+///   distinct durations there will be.
+/// @param[in,out] durations The frame's table of distinct durations.
+/// @param[in,out] symbols The frame's packed symbols.
+/// @param[in] symbols_size Nr. of bytes available in `symbols`.
+/// @param[in] usecs The duration to add.
+/// @param[in] tolerance Percentage by which a duration may differ from a table
+///   entry & still share it. (See `encodeSymbols()`)
+///   0 (Default) means only exactly the same durations share an entry.
+/// @param[in,out] totals Running totals of the durations sharing each table
+///   entry. If given, each entry is kept as the average of the durations
+///   sharing it. NULL (Default) keeps the first duration of each entry.
+/// @return True, if it fitted. False, if it needed too many distinct durations
+///   for `bits`, or `symbols` is full. The frame is unchanged if so.
+/// @note Unlike `encodeSymbols()`, a duration is matched against the average
+///   of an entry so far, rather than the first duration in it, as the average
+///   is all that is kept.
+bool IRsend::appendSymbol(ir_symbol_frame_t *frame,
+                          uint16_t durations[kSymbolsMaxDurations],
+                          uint8_t *symbols, const uint16_t symbols_size,
+                          const uint16_t usecs, const uint8_t tolerance,
+                          ir_symbol_totals_t *totals) {
+  if (frame->bits == 0 || frame->bits > 4) return false;
+  if (symbolsSize(frame->length + 1, frame->bits) > symbols_size) return false;
+  const uint8_t symbol = findSymbol(usecs, durations, frame->nr_durations,
+                                    tolerance);
+  if (symbol == frame->nr_durations) {  // A new duration.
+    if (symbol == (1 << frame->bits)) return false;  // Too many.
+    durations[frame->nr_durations++] = usecs;
+    if (totals != NULL) {
+      totals->sums[symbol] = usecs;
+      totals->counts[symbol] = 1;
+    }
+  } else if (totals != NULL) {  // Fold it into the entry's average.
+    totals->sums[symbol] += usecs;
+    totals->counts[symbol]++;
+    durations[symbol] = (totals->sums[symbol] + totals->counts[symbol] / 2) /
+        totals->counts[symbol];
+  }
+  setSymbol(symbols, frame->length++, frame->bits, symbol);
+  return true;
+}
 #endif  // SEND_RAW
 
+#if (SEND_PRONTO || SEND_GLOBALCACHE)
+/// Send a compiled Pronto or GlobalCache code, as many times as it asks for.
+/// @param[in] code The code. (See `compilePronto()` & `compileGC()`)
+/// @return True if there was something to send, false if not.
+bool IRsend::send(const ir_compiled_t *code) {
+  return code != NULL && send(code, code->repeat);
+}
+
+/// Send a compiled Pronto or GlobalCache code.
+/// The first sequence is sent once, followed by the repeat sequence `repeat`
+/// times.
+/// @param[in] code The code. (See `compilePronto()` & `compileGC()`)
+/// @param[in] repeat Nr. of times to send the repeat sequence.
+/// @return True if there was something to send, false if not.
+bool IRsend::send(const ir_compiled_t *code, const uint16_t repeat) {
+  if (code == NULL || code->timings == NULL || !code->length) return false;
+  enableIROut(code->hz);
+  for (uint16_t i = 0; i < code->first_len; i++)
+    if (i & 1)
+      space(code->timings[i]);
+    else
+      mark(code->timings[i]);
+  for (uint16_t r = 0; r < repeat; r++)
+    for (uint16_t i = code->repeat_start; i < code->length; i++)
+      if (i & 1)
+        space(code->timings[i]);
+      else
+        mark(code->timings[i]);
+  waitUntilSent();
+  // It's possible that we've ended on a mark(), thus ensure the LED is off.
+  ledOff();
+  return true;
+}
+#endif  // (SEND_PRONTO || SEND_GLOBALCACHE)
+
 /// Get the minimum number of repeats for a given protocol.
 /// @param[in] protocol Protocol number/type of the message you want to send.
 /// @return The number of repeats required.
@@ -819,6 +1494,7 @@ bool IRsend::send(const decode_type_t type, const uint64_t data,
                   const uint16_t nbits, const uint16_t repeat) {
   uint16_t min_repeat __attribute__((unused)) =
       std::max(IRsend::minRepeats(type), repeat);
+  txStatsBegin(type);
   switch (type) {
 #if SEND_AIRTON
     case AIRTON:
@@ -1144,8 +1820,11 @@ bool IRsend::send(const decode_type_t type, const uint64_t data,
       break;
 #endif  // SEND_ZEPEAL
     default:
+      txStatsEnd();
       return false;
   }
+  waitUntilSent();
+  txStatsEnd();
   return true;
 }
 
@@ -1157,6 +1836,7 @@ bool IRsend::send(const decode_type_t type, const uint64_t data,
 /// @return True if it is a type we can attempt to send, false if not.
 bool IRsend::send(const decode_type_t type, const uint8_t *state,
                   const uint16_t nbytes) {
+  txStatsBegin(type);
   switch (type) {
 #if SEND_VOLTAS
     case VOLTAS:
@@ -1442,7 +2122,135 @@ bool IRsend::send(const decode_type_t type, const uint8_t *state,
       break;
 #endif  // SEND_BLUESTARHEAVY
     default:
+      txStatsEnd();
       return false;
   }
+  waitUntilSent();
+  txStatsEnd();
   return true;
 }
+
+// Start of IRsendMulti class -------------------
+
+/// Constructor for an IRsendMulti object.
+/// @param[in] pins An array of the GPIO pins to use when sending.
+/// @param[in] npins Nr. of entries in the `pins` array.
+///   Only the first kIRsendMultiMaxPins valid GPIOs are used.
+/// @param[in] inverted Optional flag to invert the output. (default = false)
+///  e.g. LEDs are illuminated when GPIO is LOW rather than HIGH.
+/// @param[in] use_modulation Do we do frequency modulation during transmission?
+///  i.e. If not, assume a 100% duty cycle.
+/// @note GPIOs above kIRsendMultiMaxGpio are ignored.
+IRsendMulti::IRsendMulti(const uint16_t pins[], const uint8_t npins,
+                         bool inverted, bool use_modulation)
+    : IRsend(npins ? pins[0] : 0, inverted, use_modulation) {
+  _npins = 0;
+  for (uint8_t i = 0; i < npins && _npins < kIRsendMultiMaxPins; i++)
+    if (pins[i] <= kIRsendMultiMaxGpio) _pins[_npins++] = pins[i];
+  setActivePins(UINT8_MAX);  // Use all of them by default.
+}
+
+/// Enable all the pins for output.
+void IRsendMulti::begin() {
+#ifndef UNIT_TEST
+  for (uint8_t i = 0; i < _npins; i++) pinMode(_pins[i], OUTPUT);
+#endif
+  ledOff();  // Ensure the LEDs are in a known safe state when we start.
+}
+
+/// Get the nr. of GPIOs this object can drive.
+/// @return The nr. of usable pins.
+uint8_t IRsendMulti::getPinCount(void) { return _npins; }
+
+/// Choose which of the pins will be used by subsequent sends.
+/// @param[in] pinmask A bitmask of indexes into the array of pins given to the
+///   constructor. e.g. 0b101 is the first and third pins.
+void IRsendMulti::setActivePins(const uint8_t pinmask) {
+  _active = pinmask;
+  if (_npins < 8) _active &= (1U << _npins) - 1;
+  _outputMask = pinsToOutputMask(_active);
+}
+
+/// Get which of the pins will be used by subsequent sends.
+/// @return A bitmask of indexes into the array of pins.
+uint8_t IRsendMulti::getActivePins(void) { return _active; }
+
+/// Get the GPIO bitmask that will currently be driven by a mark.
+/// @return A bitmask where bit N represents GPIO N.
+uint32_t IRsendMulti::getOutputMask(void) { return _outputMask; }
+
+/// Convert a bitmask of pin indexes into a bitmask of GPIOs.
+/// @param[in] pinmask A bitmask of indexes into the array of pins.
+/// @return A bitmask where bit N represents GPIO N.
+uint32_t IRsendMulti::pinsToOutputMask(const uint8_t pinmask) {
+  uint32_t mask = 0;
+  for (uint8_t i = 0; i < _npins; i++)
+    if (pinmask & (1U << i)) mask |= 1UL << _pins[i];
+  return mask;
+}
+
+#if SEND_RAW
+/// Send a different raw message out of each pin, all at the same time.
+/// The messages are merged into a single mark/space timeline. Each edge in
+/// that timeline only drives the pins that are in a mark at that moment.
+/// @param[in] bufs An array of raw (uSec) timing arrays. One per pin.
+///   i.e. `bufs[0]` is sent out of the first pin, and so on.
+///   Even elements are marks, odd elements are spaces. As per `sendRaw()`.
+/// @param[in] lens Nr. of elements in each of the `bufs[]` arrays.
+/// @param[in] count Nr. of entries in `bufs[]` & `lens[]`.
+/// @param[in] hz Frequency to send the messages at. (kHz < 1000; Hz >= 1000)
+/// @note Pins that are not active (see `setActivePins()`) are not driven.
+/// @note A mark that is split by an edge on another pin restarts its carrier
+///   cycle. Receivers tolerate this fine in practice.
+void IRsendMulti::sendRawMulti(const uint16_t *bufs[], const uint16_t lens[],
+                               const uint8_t count, const uint16_t hz) {
+  const uint8_t channels = std::min(count, _npins);
+  uint16_t pos[kIRsendMultiMaxPins];
+  uint16_t left[kIRsendMultiMaxPins];
+  for (uint8_t i = 0; i < channels; i++) {
+    pos[i] = 0;
+    left[i] = lens[i] ? bufs[i][0] : 0;
+  }
+  const uint8_t active = _active;
+  // The segment we have yet to send. Merged with the next if it is the same.
+  uint8_t pending_mask = 0;
+  uint32_t pending_time = 0;
+  enableIROut(hz);
+  while (true) {
+    // Find the shortest time until an edge on any channel, and who is marking.
+    uint16_t step = UINT16_MAX;
+    uint8_t marking = 0;
+    bool more = false;
+    for (uint8_t i = 0; i < channels; i++) {
+      if (pos[i] >= lens[i]) continue;  // This channel has finished.
+      more = true;
+      step = std::min(step, left[i]);
+      if (!(pos[i] & 1)) marking |= 1U << i;  // Even entries are marks.
+    }
+    marking &= active;
+    // Send what we have pending if this segment is different, or we are done.
+    if (!more || marking != pending_mask ||
+        (marking && pending_time + step > UINT16_MAX)) {
+      if (pending_mask) {
+        _outputMask = pinsToOutputMask(pending_mask);
+        mark(pending_time);
+      } else if (pending_time) {
+        space(pending_time);
+      }
+      pending_mask = marking;
+      pending_time = 0;
+    }
+    if (!more) break;
+    pending_time += step;
+    // Advance every channel by the time we just spent.
+    for (uint8_t i = 0; i < channels; i++) {
+      if (pos[i] >= lens[i]) continue;
+      left[i] -= step;
+      while (!left[i] && ++pos[i] < lens[i]) left[i] = bufs[i][pos[i]];
+    }
+  }
+  _outputMask = pinsToOutputMask(active);
+  ledOff();  // We potentially have ended with a mark(), so turn off the LEDs.
+}
+#endif  // SEND_RAW
+// End of IRsendMulti class -------------------
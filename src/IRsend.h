@@ -18,6 +18,13 @@
 #define VIRTUAL
 #endif
 
+// The timer interrupt driven transmit engine. (See IRsend::enableTimerEngine())
+#if defined(ESP8266) && !defined(UNIT_TEST)
+#define _IRSEND_TIMER_ENGINE true
+#else  // defined(ESP8266) && !defined(UNIT_TEST)
+#define _IRSEND_TIMER_ENGINE false
+#endif  // defined(ESP8266) && !defined(UNIT_TEST)
+
 // Constants
 // Offset (in microseconds) to use in Period time calculations to account for
 // code excution time in producing the software PWM signal.
@@ -39,6 +46,27 @@ const uint8_t kDutyMax = 100;     // Percentage
 const uint16_t kMaxAccurateUsecDelay = 16383;
 //  Usecs to wait between messages we don't know the proper gap time.
 const uint32_t kDefaultMessageGap = 100000;
+// Max. nr. of GPIOs an IRsendMulti object can drive at once.
+const uint8_t kIRsendMultiMaxPins = 8;
+// GPIOs above this can't be represented in an IRsendMulti output mask.
+const uint8_t kIRsendMultiMaxGpio = 31;
+// Transmit timelines are in ESP8266 timer1 ticks. i.e. 80MHz / 16 = 5MHz
+const uint8_t kTimelineTicksPerUsec = 5;
+// Max. uSeconds in a single timeline step. timer1 only has a 23 bit counter.
+// i.e. ~1.67 seconds at 5MHz.
+const uint32_t kTimelineMaxStepUsec = 1000000;
+// Fewest ticks the timer engine allows between two edges of a partial pulse,
+// or a space. Any closer, and the next edge would be due before the interrupt
+// for the previous one has even returned. i.e. 2 uSeconds.
+const uint32_t kTimelineMinTicks = 10;
+// Nr. of timeline steps the timer engine can have queued up to send.
+const uint8_t kTimelineQueueSize = 32;
+// Max. nr. of distinct durations in a symbol encoded frame. i.e. 4 bit symbols
+const uint8_t kSymbolsMaxDurations = 16;
+// Max. nr. of protocols the transmit stats track. (Incl. UNKNOWN)
+const uint8_t kTxStatsMaxProtocols = 8;
+// uSecs an interval can run over what was requested before it's an overrun.
+const uint16_t kTxStatsOverrunDefault = 50;
 /// Placeholder for missing sensor temp value
 /// @note Not using "-1" as it may be a valid external temp
 const float kNoTempValue = -100.0;
@@ -235,6 +263,69 @@ enum toshiba_ac_remote_model_t {
   // many remote models such as WA-TH03A, WA-TH04A etc.
 };
 
+/// A step of a transmit timeline. (See IRsend::timelineMark())
+/// The output is turned on for `on` ticks, then off for `off` ticks, and that
+/// is repeated `count` times. i.e. Carrier pulses, or a space if `on` is 0.
+struct ir_timeline_step_t {
+  uint32_t on;     // Nr. of ticks the output is on for.
+  uint32_t off;    // Nr. of ticks the output is off for.
+  uint32_t count;  // Nr. of times to repeat the on & off periods.
+};
+
+/// A compact, symbol encoded, raw IR frame. Each mark & space is stored as a
+/// 1-4 bit index into a small table of the distinct durations it uses.
+/// e.g. A 300 entry A/C frame using 6 distinct durations takes 113 bytes of
+/// symbols plus a 12 byte table, rather than the 600 bytes `sendRaw()` needs.
+/// (See IRsend::encodeSymbols() & IRsend::sendSymbols())
+struct ir_symbol_frame_t {
+  uint16_t hz;                // Carrier frequency. (kHz < 1000; Hz >= 1000)
+  uint16_t length;            // Nr. of marks & spaces. (Starting with a mark)
+  uint8_t bits;               // Nr. of bits per symbol. (1-4)
+  uint8_t nr_durations;       // Nr. of entries in `durations`.
+  const uint16_t *durations;  // The distinct durations. (uSeconds)
+  const uint8_t *symbols;     // Packed `durations` indexes. LSB first.
+};
+
+/// Running totals for averaging the durations of a symbol encoded frame as it
+/// is built. (See IRsend::appendSymbol())
+struct ir_symbol_totals_t {
+  uint32_t sums[kSymbolsMaxDurations];    // Sum of the durations of each entry.
+  uint16_t counts[kSymbolsMaxDurations];  // Nr. of durations in each entry.
+};
+
+/// Transmit timing statistics for a protocol. (See IRsend::enableTxStats())
+/// Errors are the difference between the requested & measured durations of
+/// each mark & space, in uSeconds.
+struct ir_tx_stats_t {
+  decode_type_t protocol;  // UNKNOWN = Not sent via send() or IRac.
+  uint32_t sends;          // Nr. of messages sent.
+  uint32_t intervals;      // Nr. of marks & spaces measured.
+  uint32_t overruns;       // Nr. of intervals that ran over by too much.
+  uint32_t max_error;      // The largest error seen.
+  uint32_t total_error;    // Sum of the errors. i.e. Mean = total/intervals
+};
+
+/// The requested & measured duration (uSeconds) of a sent mark or space.
+struct ir_tx_interval_t {
+  uint32_t requested;
+  uint32_t measured;
+  bool mark;
+};
+
+/// A Pronto or GlobalCache code, converted into uSeconds once, so it can be
+/// sent many times without redoing the maths.
+/// `timings` holds the first sequence, then any of the repeat sequence that
+/// isn't already part of it. Even entries are marks, odd ones are spaces.
+/// (See IRsend::compilePronto(), IRsend::compileGC() & IRsend::send())
+struct ir_compiled_t {
+  uint16_t hz;              // Carrier frequency. (Hz)
+  uint16_t length;          // Nr. of entries in `timings`.
+  uint16_t first_len;       // Nr. of entries in the first sequence.
+  uint16_t repeat_start;    // Where the repeat sequence starts in `timings`.
+  uint16_t repeat;          // Nr. of repeats the code itself asks for.
+  const uint32_t *timings;  // uSeconds.
+};
+
 // Classes
 
 /// Class for sending all basic IR protocols.
@@ -251,7 +342,36 @@ class IRsend {
   VIRTUAL uint16_t mark(uint16_t usec);
   VIRTUAL void space(uint32_t usec);
   int8_t calibrate(uint16_t hz = 38000U);
+#if _IRSEND_TIMER_ENGINE
+  bool enableTimerEngine(const bool enable = true);
+#endif  // _IRSEND_TIMER_ENGINE
+  void waitUntilSent(void);
+  static uint32_t timelinePeriod(const uint32_t hz);
+  static uint8_t timelineMark(const uint32_t usec, const uint32_t period,
+                              const uint32_t on, ir_timeline_step_t steps[2]);
+  static uint8_t timelineSpace(const uint32_t usec,
+                               ir_timeline_step_t steps[2]);
   void sendRaw(const uint16_t buf[], const uint16_t len, const uint16_t hz);
+  void sendSymbols(const ir_symbol_frame_t *frame);
+  static bool encodeSymbols(const uint16_t buf[], const uint16_t len,
+                            const uint16_t hz, ir_symbol_frame_t *frame,
+                            uint16_t durations[kSymbolsMaxDurations],
+                            uint8_t *symbols, const uint16_t symbols_size,
+                            const uint8_t tolerance = 0);
+  static bool appendSymbol(ir_symbol_frame_t *frame,
+                           uint16_t durations[kSymbolsMaxDurations],
+                           uint8_t *symbols, const uint16_t symbols_size,
+                           const uint16_t usecs, const uint8_t tolerance = 0,
+                           ir_symbol_totals_t *totals = NULL);
+  static uint16_t symbolsSize(const uint16_t length, const uint8_t bits);
+  static bool enableTxStats(const bool enable = true,
+                            const uint16_t overrun = kTxStatsOverrunDefault,
+                            const uint16_t log_size = 0);
+  static void resetTxStats(void);
+  static uint8_t getTxStats(ir_tx_stats_t stats[], const uint8_t max);
+  static uint16_t getTxLog(ir_tx_interval_t log[], const uint16_t max);
+  static void txStatsBegin(const decode_type_t protocol);
+  static void txStatsEnd(void);
   void sendData(uint16_t onemark, uint32_t onespace, uint16_t zeromark,
                 uint32_t zerospace, uint64_t data, uint16_t nbits,
                 bool MSBfirst = true);
@@ -294,6 +414,10 @@ class IRsend {
             const uint16_t nbits, const uint16_t repeat = kNoRepeat);
   bool send(const decode_type_t type, const uint8_t *state,
             const uint16_t nbytes);
+#if (SEND_PRONTO || SEND_GLOBALCACHE)
+  bool send(const ir_compiled_t *code);
+  bool send(const ir_compiled_t *code, const uint16_t repeat);
+#endif  // (SEND_PRONTO || SEND_GLOBALCACHE)
 #if (SEND_NEC || SEND_SHERWOOD || SEND_AIWA_RC_T501 || SEND_SANYO || \
      SEND_MIDEA24)
   void sendNEC(uint64_t data, uint16_t nbits = kNECBits,
@@ -482,6 +606,9 @@ class IRsend {
 #endif  // SEND_INAX
 #if SEND_GLOBALCACHE
   void sendGC(uint16_t buf[], uint16_t len);
+  bool compileGC(const uint16_t buf[], const uint16_t len,
+                 ir_compiled_t *code, uint32_t timings[],
+                 const uint16_t size);
 #endif
 #if SEND_KELVINATOR
   void sendKelvinator(const unsigned char data[],
@@ -558,6 +685,9 @@ class IRsend {
 #endif  // SEND_GORENJE
 #if SEND_PRONTO
   void sendPronto(uint16_t data[], uint16_t len, uint16_t repeat = kNoRepeat);
+  bool compilePronto(const uint16_t data[], const uint16_t len,
+                     ir_compiled_t *code, uint32_t timings[],
+                     const uint16_t size);
 #endif
 #if SEND_ARGO
   void sendArgo(const unsigned char data[],
@@ -909,8 +1039,10 @@ class IRsend {
 #endif  // UNIT_TEST
   uint8_t outputOn;
   uint8_t outputOff;
+  uint32_t _outputMask;  ///< GPIO bitmask to drive instead of IRpin. 0 = Off.
   VIRTUAL void ledOff();
   VIRTUAL void ledOn();
+  void _writeOutputMask(const uint8_t level);
 #ifndef UNIT_TEST
 
  private:
@@ -923,6 +1055,12 @@ class IRsend {
   int8_t periodOffset;
   uint8_t _dutycycle;
   bool modulation;
+#if _IRSEND_TIMER_ENGINE
+  bool _timer_engine;  ///< Are mark() & space() sent by the timer engine?
+  uint32_t _timeline_period;  ///< Carrier period in timeline ticks.
+  uint32_t _timeline_on;  ///< Carrier on time in timeline ticks.
+  void _queueTimeline(const ir_timeline_step_t *steps, const uint8_t nsteps);
+#endif  // _IRSEND_TIMER_ENGINE
   uint32_t calcUSecPeriod(uint32_t hz, bool use_offset = true);
 #if SEND_SONY
   void _sendSony(const uint64_t data, const uint16_t nbits,
@@ -930,4 +1068,33 @@ class IRsend {
 #endif  // SEND_SONY
 };
 
+/// Class for sending the same IR timeline out of several GPIOs at once.
+/// Every mark/space edge is written to all the active GPIOs together, using a
+/// single port register write where the platform allows it.
+/// i.e. N emitters are driven in the time it takes to send one message.
+/// @note All the normal `send*()` methods work as usual, but drive every
+///   active GPIO. Use `sendRawMulti()` to send different messages out of
+///   different GPIOs at the same time.
+/// @note Only GPIOs 0-31 are supported.
+class IRsendMulti : public IRsend {
+ public:
+  IRsendMulti(const uint16_t pins[], const uint8_t npins,
+              bool inverted = false, bool use_modulation = true);
+  void begin();
+  uint8_t getPinCount(void);
+  void setActivePins(const uint8_t pinmask);
+  uint8_t getActivePins(void);
+  uint32_t getOutputMask(void);
+#if SEND_RAW
+  void sendRawMulti(const uint16_t *bufs[], const uint16_t lens[],
+                    const uint8_t count, const uint16_t hz);
+#endif  // SEND_RAW
+
+ protected:
+  uint16_t _pins[kIRsendMultiMaxPins];  ///< The GPIOs we can drive.
+  uint8_t _npins;  ///< Nr. of valid entries in `_pins`.
+  uint8_t _active;  ///< Bitmask of the `_pins` indexes currently in use.
+  uint32_t pinsToOutputMask(const uint8_t pinmask);
+};
+
 #endif  // IRSEND_H_
@@ -12,6 +12,7 @@
 #include "i18n.h"
 
 #include "IRmacros.h"
+#include "IRutils.h"
 
 #ifndef PROGMEM
 #define PROGMEM  // Pretend we have the PROGMEM macro even if we really don't.
@@ -25,7 +26,7 @@
     NAME ## Blob
 
 #define IRTEXT_CONST_BLOB_DECL(NAME)\
-    const char IRTEXT_CONST_BLOB_NAME(NAME) [] PROGMEM
+    constexpr char IRTEXT_CONST_BLOB_NAME(NAME) [] PROGMEM
 
 #define IRTEXT_CONST_BLOB_PTR(NAME)\
     IRTEXT_CONST_PTR(NAME) {\
@@ -565,3 +566,112 @@ IRTEXT_CONST_BLOB_DECL(kAllProtocolNamesStr) {
     "\x0"  ///< This string requires double null termination.
 };
 IRTEXT_CONST_BLOB_PTR(kAllProtocolNamesStr);
+
+/// @cond IGNORE
+// Compile-time indexing of kAllProtocolNamesStr.
+// Everything below is evaluated by the compiler, so only the resulting tables
+// end up in the binary (in flash). They let typeToString() & strToDecodeType()
+// avoid walking & comparing every name in the blob.
+namespace {
+constexpr uint16_t kProtocolNameCount = kLastDecodeType + 1;
+
+// Offset of the null terminating the protocol name starting at `pos`.
+constexpr uint16_t protocolNameEnd(const uint16_t pos) {
+  return IRTEXT_CONST_BLOB_NAME(kAllProtocolNamesStr)[pos] ?
+      protocolNameEnd(pos + 1) : pos;
+}
+
+// Offset of the name of protocol nr. `type` in the blob.
+constexpr uint16_t protocolNameOffset(const uint16_t type) {
+  return type ? protocolNameEnd(protocolNameOffset(type - 1)) + 1 : 0;
+}
+
+// Nr. of names in the blob. i.e. Up until the double null termination.
+constexpr uint16_t protocolNameCount(const uint16_t type = 0) {
+  return IRTEXT_CONST_BLOB_NAME(kAllProtocolNamesStr)[
+      protocolNameOffset(type)] ? protocolNameCount(type + 1) : type;
+}
+
+static_assert(protocolNameCount() == kProtocolNameCount,
+              "kAllProtocolNamesStr must have a name for every decode_type_t");
+
+// A C++11 compatible compile-time integer sequence: 0, 1, ... N-1
+template <uint16_t... Is> struct IndexSeq {};
+template <uint16_t N, uint16_t... Is>
+struct MakeIndexSeq : MakeIndexSeq<N - 1, N - 1, Is...> {};
+template <uint16_t... Is>
+struct MakeIndexSeq<0, Is...> { typedef IndexSeq<Is...> type; };
+typedef MakeIndexSeq<kProtocolNameCount>::type ProtocolNameSeq;
+
+// The table is built in stages, each one a lookup table for the next, so the
+// compiler never has to recalculate anything.
+// Stage 1: Where each name is, and its sort key.
+//   Key: The name hash, then the protocol nr. to break any ties.
+struct ProtocolNameKeys {
+  uint16_t offset[kProtocolNameCount];
+  uint32_t key[kProtocolNameCount];
+};
+
+template <uint16_t... Is>
+constexpr ProtocolNameKeys buildProtocolNameKeys(IndexSeq<Is...>) {
+  return {{protocolNameOffset(Is)...},
+          {((uint32_t)irutils::textHashConst(
+              IRTEXT_CONST_BLOB_NAME(kAllProtocolNamesStr) +
+              protocolNameOffset(Is)) << 16 | Is)...}};
+}
+
+constexpr ProtocolNameKeys kProtocolNameKeys = buildProtocolNameKeys(
+    ProtocolNameSeq());
+
+// Stage 2: The position of each protocol nr. when sorted by key.
+constexpr uint16_t protocolNameRank(const uint16_t type,
+                                    const uint16_t other = 0) {
+  return (other < kProtocolNameCount) ?
+      (kProtocolNameKeys.key[other] < kProtocolNameKeys.key[type]) +
+          protocolNameRank(type, other + 1) : 0;
+}
+
+struct ProtocolNameRanks { uint16_t rank[kProtocolNameCount]; };
+
+template <uint16_t... Is>
+constexpr ProtocolNameRanks buildProtocolNameRanks(IndexSeq<Is...>) {
+  return {{protocolNameRank(Is)...}};
+}
+
+constexpr ProtocolNameRanks kProtocolNameRanks = buildProtocolNameRanks(
+    ProtocolNameSeq());
+
+// Stage 3: The protocol nr. at each position when sorted by key.
+constexpr uint16_t protocolNameAtRank(const uint16_t rank,
+                                      const uint16_t type = 0) {
+  return (kProtocolNameRanks.rank[type] == rank) ?
+      type : protocolNameAtRank(rank, type + 1);
+}
+
+struct ProtocolNameIndex {
+  uint16_t offset[kProtocolNameCount];  // Indexed by protocol nr.
+  uint16_t hash[kProtocolNameCount];    // Sorted.
+  uint16_t type[kProtocolNameCount];    // Protocol nr. of each `hash` entry.
+};
+
+template <uint16_t... Is>
+constexpr ProtocolNameIndex buildProtocolNameIndex(IndexSeq<Is...>) {
+  return {{kProtocolNameKeys.offset[Is]...},
+          {(uint16_t)(kProtocolNameKeys.key[protocolNameAtRank(Is)] >> 16)...},
+          {protocolNameAtRank(Is)...}};
+}
+
+const ProtocolNameIndex kProtocolNameIndex PROGMEM = buildProtocolNameIndex(
+    ProtocolNameSeq());
+}  // namespace
+/// @endcond
+
+/// Offset of each protocol name in kAllProtocolNamesStr, by decode_type_t.
+const uint16_t* const kAllProtocolNamesOffsets PROGMEM =
+    kProtocolNameIndex.offset;
+/// textHash() of every protocol name in kAllProtocolNamesStr, sorted.
+const uint16_t* const kAllProtocolNamesHashes PROGMEM =
+    kProtocolNameIndex.hash;
+/// The decode_type_t of each entry in kAllProtocolNamesHashes.
+const uint16_t* const kAllProtocolNamesByHash PROGMEM =
+    kProtocolNameIndex.type;
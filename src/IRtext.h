@@ -23,6 +23,9 @@ class __FlashStringHelper;
 #endif  // ESP8266
 
 extern const char kTimeSep;
+extern const uint16_t* const kAllProtocolNamesByHash;
+extern const uint16_t* const kAllProtocolNamesHashes;
+extern const uint16_t* const kAllProtocolNamesOffsets;
 extern IRTEXT_CONST_PTR(k0Str);
 extern IRTEXT_CONST_PTR(k10CHeatStr);
 extern IRTEXT_CONST_PTR(k122lzfStr);
@@ -38,6 +38,9 @@
 #ifndef FPSTR
 #define FPSTR(X) X
 #endif  // FPSTR
+#ifndef pgm_read_word
+#define pgm_read_word(ADDR) (*(ADDR))
+#endif  // pgm_read_word
 
 /// Reverse the order of the requested least significant nr. of bits.
 /// @param[in] input Bit pattern/integer to reverse.
@@ -117,19 +120,35 @@ void serialPrintUint64(uint64_t input, uint8_t base) {
 /// Convert a C-style string to a decode_type_t.
 /// @param[in] str A C-style string containing a protocol name or number.
 /// @return A decode_type_t enum. (decode_type_t::UNKNOWN if no match.)
+/// @note Uses a binary search of the pre-computed & sorted hashes of the
+///   protocol names. Only the names with a matching hash are compared.
 decode_type_t strToDecodeType(const char * const str) {
-  auto *ptr = reinterpret_cast<const char*>(kAllProtocolNamesStr);
-  uint16_t length = STRLEN(ptr);
-  for (uint16_t i = 0; length; i++) {
-    if (!STRCASECMP(str, ptr)) return (decode_type_t)i;
-    ptr += length + 1;
-    length = STRLEN(ptr);
+  auto *names = reinterpret_cast<const char*>(kAllProtocolNamesStr);
+  const uint16_t hash = irutils::textHash(str);
+  // Find the first entry with a matching hash.
+  uint16_t low = 0;
+  uint16_t high = kLastDecodeType + 1;
+  while (low < high) {
+    const uint16_t mid = low + (high - low) / 2;
+    if (pgm_read_word(kAllProtocolNamesHashes + mid) < hash)
+      low = mid + 1;
+    else
+      high = mid;
   }
-  // Handle integer values of the type by converting to a string and back again.
-  decode_type_t result = strToDecodeType(
-      typeToString((decode_type_t)atoi(str)).c_str());
-  if (result > 0)
-    return result;
+  // Entries with the same hash are sorted by protocol nr. so the first
+  // name that matches wins, like a linear search of the names would.
+  for (; low <= kLastDecodeType &&
+         pgm_read_word(kAllProtocolNamesHashes + low) == hash; low++) {
+    const uint16_t type = pgm_read_word(kAllProtocolNamesByHash + low);
+    if (!STRCASECMP(str,
+                    names + pgm_read_word(kAllProtocolNamesOffsets + type)))
+      return (decode_type_t)type;
+  }
+  // Handle integer values of the type. Parse them wide so that large values
+  // can't be truncated into the range of valid types.
+  const long number = strtol(str, NULL, 10);  // NOLINT(runtime/int)
+  if (number > 0 && number <= kLastDecodeType)
+    return (decode_type_t)number;
 
   return decode_type_t::UNKNOWN;
 }
@@ -145,13 +164,7 @@ String typeToString(const decode_type_t protocol, const bool isRepeat) {
     result = kUnknownStr;
   } else {
     auto *ptr = reinterpret_cast<const char*>(kAllProtocolNamesStr);
-    for (uint16_t i = 0; i <= protocol && STRLEN(ptr); i++) {
-      if (i == protocol) {
-        result = FPSTR(ptr);
-        break;
-      }
-      ptr += STRLEN(ptr) + 1;
-    }
+    result = FPSTR(ptr + pgm_read_word(kAllProtocolNamesOffsets + protocol));
   }
   if (isRepeat) {
     result += kSpaceLBraceStr;
@@ -1445,4 +1458,159 @@ namespace irutils {
       result |= kEndiannessError;
     return result;
   }
+
+  /// Calculate a case-insensitive hash of a string.
+  /// Used to index text lookup tables. e.g. Protocol & A/C setting names.
+  /// @param[in] str A C-style string (in RAM) to be hashed.
+  /// @return The hash of the string. Same value as textHashConst().
+  uint16_t textHash(const char * const str) {
+    uint16_t hash = kTextHashSeed;
+    for (const char *ptr = str; *ptr; ptr++)
+      hash = (hash * 33) ^ textHashUpper(*ptr);
+    return hash;
+  }
+
+  /// Find the timing class a duration belongs to. A timing class is a
+  /// distinct duration. i.e. The first one seen that later ones match.
+  /// A duration matches a class if it is within `tolerance` percent, or
+  /// `delta`, of it. If it matches none, it starts a new class.
+  /// @param[in] duration The duration to classify. (Any units)
+  /// @param[in,out] classes The durations of the classes found so far.
+  /// @param[in,out] count The nr. of classes in `classes`.
+  /// @param[in] max The most classes `classes` can hold.
+  /// @param[in] tolerance Percentage error margin to allow. e.g. 25 = 25%.
+  /// @param[in] delta A non-scaling error margin, in the same units.
+  /// @return The index of its class, or -1 if it needs a new class, but
+  ///   `classes` is full.
+  int32_t timingClass(const uint32_t duration, uint32_t *classes,
+                      uint16_t *count, const uint16_t max,
+                      const uint8_t tolerance, const uint32_t delta) {
+    for (uint16_t i = 0; i < *count; i++) {
+      const uint32_t diff = (duration > classes[i]) ? duration - classes[i]
+                                                    : classes[i] - duration;
+      if (diff <= delta || (uint64_t)diff * 100 <=
+                           (uint64_t)classes[i] * tolerance) return i;
+    }
+    if (*count >= max) return -1;
+    classes[*count] = duration;
+    return (*count)++;
+  }
 }  // namespace irutils
+
+/// Class constructor.
+/// @param[in] base The number base of the values in the text. i.e. 10 or 16.
+/// @param[in] max The largest value to accept. Anything larger is an error.
+IRvalueParser::IRvalueParser(const uint8_t base, const uint32_t max) {
+  _base = base;
+  _max = max;
+  reset();
+}
+
+/// Reset the parser, ready for some new text.
+void IRvalueParser::reset(void) {
+  _value = 0;
+  _digits = false;
+  _zero = false;
+  _prefix = false;
+  _error = false;
+}
+
+/// Feed the next character of the text to the parser.
+/// Values are separated by commas and/or whitespace. Empty fields are ignored.
+/// Base 16 values may have a "0x" prefix. e.g. "0x006D"
+/// @param[in] c The next character.
+/// @return true, if a value has just been completed. See value().
+/// @note Once an error has occurred, all further input is ignored until reset.
+bool IRvalueParser::feed(const char c) {
+  if (_error) return false;
+  uint8_t digit;
+  if ((c == 'x' || c == 'X') && _base == 16 && _zero) {  // A "0x" prefix.
+    _digits = false;
+    _zero = false;
+    _prefix = true;
+    return false;
+  } else if (c >= '0' && c <= '9') {
+    digit = c - '0';
+  } else if (c >= 'A' && c <= 'Z') {
+    digit = c - 'A' + 10;
+  } else if (c >= 'a' && c <= 'z') {
+    digit = c - 'a' + 10;
+  } else if (c == ',' || c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+    if (_prefix) {  // A "0x" with no digits after it.
+      _error = true;
+      return false;
+    }
+    if (!_digits) return false;  // Nothing to complete. e.g. ", "
+    _digits = false;
+    _zero = false;
+    return true;
+  } else {
+    _error = true;
+    return false;
+  }
+  if (digit >= _base) {
+    _error = true;
+    return false;
+  }
+  if (!_digits) _value = 0;  // The start of a new value.
+  _zero = !_digits && !_prefix && digit == 0;
+  _prefix = false;
+  _digits = true;
+  if (_value > (_max - digit) / _base) {  // Would it exceed the maximum?
+    _error = true;
+    return false;
+  }
+  _value = _value * _base + digit;
+  return false;
+}
+
+/// Tell the parser there is no more text.
+/// @return true, if a (final) value has just been completed. See value().
+bool IRvalueParser::end(void) {
+  if (_prefix) _error = true;  // A "0x" with no digits after it.
+  if (_error || !_digits) return false;
+  _digits = false;
+  _zero = false;
+  return true;
+}
+
+/// Feed characters from a C-style string until the next value is completed.
+/// @param[in,out] str A ptr to the position in the string to parse from.
+///   It is advanced past the characters consumed.
+/// @return true, if a value has been completed. See value(). false, if the
+///   end of the string was reached first, or an error occurred. See error().
+bool IRvalueParser::next(const char **str) {
+  while (**str) {
+    const char c = **str;
+    (*str)++;
+    if (feed(c)) return true;
+    if (_error) return false;
+  }
+  return end();
+}
+
+/// Get the most recently completed value.
+/// @return The value.
+uint32_t IRvalueParser::value(void) const { return _value; }
+
+/// Has the text been malformed? e.g. A bad character, or an out of range value.
+/// @return true, if it has. Otherwise, false.
+bool IRvalueParser::error(void) const { return _error; }
+
+/// Parse all the values in a C-style string into a fixed size array.
+/// @param[in] str A C-style string of comma and/or space separated values.
+/// @param[out] values The array to store the values in.
+/// @param[in] size The nr. of elements in the `values` array.
+/// @param[in] base The number base of the values in the text. i.e. 10 or 16.
+/// @return The nr. of values stored, or 0 if the text was malformed or had
+///   more values than will fit in the array.
+uint16_t IRvalueParser::parse(const char *str, uint16_t values[],
+                              const uint16_t size, const uint8_t base) {
+  IRvalueParser parser(base);
+  uint16_t count = 0;
+  while (parser.next(&str)) {
+    if (count >= size) return 0;  // Too many values.
+    values[count++] = parser.value();
+  }
+  return parser.error() ? 0 : count;
+}
@@ -151,5 +151,52 @@ namespace irutils {
   uint8_t * invertBytePairs(uint8_t *ptr, const uint16_t length);
   bool checkInvertedBytePairs(const uint8_t * const ptr, const uint16_t length);
   uint8_t lowLevelSanityCheck(void);
+  const uint16_t kTextHashSeed = 5381;  ///< Initial value of a textHash().
+  /// Convert an ASCII character to upper case, the way `strcasecmp()` does.
+  /// @param[in] c The character to convert.
+  /// @return The upper case equivalent of the character.
+  constexpr char textHashUpper(const char c) {
+    return (c >= 'a' && c <= 'z') ? c - ('a' - 'A') : c;
+  }
+  /// Compile-time equivalent of textHash(). For use on string literals.
+  /// @param[in] str A C-style string literal.
+  /// @param[in] hash The hash value so far.
+  /// @return The case-insensitive hash of the string.
+  constexpr uint16_t textHashConst(const char * const str,
+                                   const uint16_t hash = kTextHashSeed) {
+    return *str ? textHashConst(str + 1, (hash * 33) ^ textHashUpper(*str))
+                : hash;
+  }
+  uint16_t textHash(const char * const str);
+  int32_t timingClass(const uint32_t duration, uint32_t *classes,
+                      uint16_t *count, const uint16_t max,
+                      const uint8_t tolerance, const uint32_t delta = 0);
 }  // namespace irutils
+
+/// Incremental parser for comma and/or whitespace separated numbers in text.
+/// e.g. GlobalCache, Pronto, or raw timing codes such as "38000,1,1,170,170".
+/// Text can be fed in a character at a time (e.g. from a network stream), or
+/// straight from a C-style string, without any heap use or String objects.
+class IRvalueParser {
+ public:
+  explicit IRvalueParser(const uint8_t base = 10,
+                         const uint32_t max = UINT16_MAX);
+  void reset(void);
+  bool feed(const char c);
+  bool end(void);
+  bool next(const char **str);
+  uint32_t value(void) const;
+  bool error(void) const;
+  static uint16_t parse(const char *str, uint16_t values[],
+                        const uint16_t size, const uint8_t base = 10);
+
+ private:
+  uint32_t _max;  ///< The largest value we will accept.
+  uint32_t _value;  ///< The value being parsed, or the last complete value.
+  uint8_t _base;  ///< The number base of the values. i.e. 10 or 16.
+  bool _digits;  ///< Have we seen any digits of the current value yet?
+  bool _zero;  ///< Is the value so far a single '0'? i.e. Maybe a "0x" prefix.
+  bool _prefix;  ///< Has a "0x" prefix just been seen?
+  bool _error;  ///< Has the text been malformed?
+};
 #endif  // IRUTILS_H_
@@ -317,19 +317,31 @@ bool IRAirtonAc::getHealth(void) const { return _.Health; }
 /// Convert the current internal state into its stdAc::state_t equivalent.
 /// @return The stdAc equivalent of the native settings.
 stdAc::state_t IRAirtonAc::toCommon(void) const {
+  return IRAirtonAcView(_.raw).toCommon();
+}
+
+/// Convert the current internal state into a human readable string.
+/// @return A human readable string.
+String IRAirtonAc::toString(void) const {
+  return IRAirtonAcView(_.raw).toString();
+}
+
+/// Convert the viewed state into its stdAc equivalent.
+/// @return The stdAc equivalent of the viewed state.
+stdAc::state_t IRAirtonAcView::toCommon(void) const {
   stdAc::state_t result{};
   result.protocol = decode_type_t::AIRTON;
-  result.power = getPower();
-  result.mode = toCommonMode(getMode());
+  result.power = _.Power;
+  result.mode = IRAirtonAc::toCommonMode(_.Mode);
   result.celsius = true;
-  result.degrees = getTemp();
-  result.fanspeed = toCommonFanSpeed(getFan());
-  result.swingv = getSwingV() ? stdAc::swingv_t::kAuto : stdAc::swingv_t::kOff;
-  result.econo = getEcono();
-  result.turbo = getTurbo();
-  result.filter = getHealth();
-  result.light = getLight();
-  result.sleep = getSleep() ? 0 : -1;
+  result.degrees = _.Temp + kAirtonMinTemp;
+  result.fanspeed = IRAirtonAc::toCommonFanSpeed(_.Fan);
+  result.swingv = _.SwingV ? stdAc::swingv_t::kAuto : stdAc::swingv_t::kOff;
+  result.econo = _.Econo;
+  result.turbo = _.Turbo;
+  result.filter = _.Health;
+  result.light = _.Light;
+  result.sleep = _.Sleep ? 0 : -1;
   // Not supported.
   result.model = -1;
   result.swingh = stdAc::swingh_t::kOff;
@@ -340,23 +352,23 @@ stdAc::state_t IRAirtonAc::toCommon(void) const {
   return result;
 }
 
-/// Convert the current internal state into a human readable string.
+/// Convert the viewed state into a human readable string.
 /// @return A human readable string.
-String IRAirtonAc::toString(void) const {
+String IRAirtonAcView::toString(void) const {
   String result = "";
   result.reserve(135);  // Reserve some heap for the string to reduce fragging.
-  result += addBoolToString(getPower(), kPowerStr, false);
+  result += addBoolToString(_.Power, kPowerStr, false);
   result += addModeToString(_.Mode, kAirtonAuto, kAirtonCool,
                             kAirtonHeat, kAirtonDry, kAirtonFan);
   result += addFanToString(_.Fan, kAirtonFanHigh, kAirtonFanLow,
                            kAirtonFanAuto, kAirtonFanMin, kAirtonFanMed,
                            kAirtonFanMax);
-  result += addTempToString(getTemp());
-  result += addBoolToString(getSwingV(), kSwingVStr);
-  result += addBoolToString(getEcono(), kEconoStr);
-  result += addBoolToString(getTurbo(), kTurboStr);
-  result += addBoolToString(getLight(), kLightStr);
-  result += addBoolToString(getHealth(), kHealthStr);
-  result += addBoolToString(getSleep(), kSleepStr);
+  result += addTempToString(_.Temp + kAirtonMinTemp);
+  result += addBoolToString(_.SwingV, kSwingVStr);
+  result += addBoolToString(_.Econo, kEconoStr);
+  result += addBoolToString(_.Turbo, kTurboStr);
+  result += addBoolToString(_.Light, kLightStr);
+  result += addBoolToString(_.Health, kHealthStr);
+  result += addBoolToString(_.Sleep, kSleepStr);
   return result;
 }
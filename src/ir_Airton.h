@@ -131,4 +131,19 @@ class IRAirtonAc {
   AirtonProtocol _;
   void checksum(void);
 };
+
+/// Read-only view of a native Airton 56-bit A/C state.
+/// Converts a state straight into the Common A/C API or text, without having
+/// to construct & reset a full IRAirtonAc object.
+class IRAirtonAcView {
+ public:
+  /// Class constructor.
+  /// @param[in] state A native Airton 56-bit state. e.g. decode_results::value
+  constexpr explicit IRAirtonAcView(const uint64_t state) : _{state} {}
+  stdAc::state_t toCommon(void) const;
+  String toString(void) const;
+
+ private:
+  const AirtonProtocol _;  ///< The state being viewed.
+};
 #endif  // IR_AIRTON_H_
@@ -314,13 +314,31 @@ stdAc::fanspeed_t IRAmcorAc::toCommonFanSpeed(const uint8_t speed) {
 /// Convert the current internal state into its stdAc::state_t equivalent.
 /// @return The stdAc equivalent of the native settings.
 stdAc::state_t IRAmcorAc::toCommon(void) const {
+  return IRAmcorAcView(_.raw).toCommon();
+}
+
+/// Convert the current internal state into a human readable string.
+/// @return A human readable string.
+String IRAmcorAc::toString(void) const {
+  return IRAmcorAcView(_.raw).toString();
+}
+
+/// Class constructor.
+/// @param[in] state A native Amcor state. It is copied, as it is tiny.
+IRAmcorAcView::IRAmcorAcView(const uint8_t state[]) {
+  std::memcpy(_.raw, state, kAmcorStateLength);
+}
+
+/// Convert the viewed state into its stdAc equivalent.
+/// @return The stdAc equivalent of the viewed state.
+stdAc::state_t IRAmcorAcView::toCommon(void) const {
   stdAc::state_t result{};
   result.protocol = decode_type_t::AMCOR;
-  result.power = getPower();
-  result.mode = toCommonMode(_.Mode);
+  result.power = _.Power == kAmcorPowerOn;
+  result.mode = IRAmcorAc::toCommonMode(_.Mode);
   result.celsius = true;
   result.degrees = _.Temp;
-  result.fanspeed = toCommonFanSpeed(_.Fan);
+  result.fanspeed = IRAmcorAc::toCommonFanSpeed(_.Fan);
   // Not supported.
   result.model = -1;
   result.turbo = false;
@@ -337,18 +355,18 @@ stdAc::state_t IRAmcorAc::toCommon(void) const {
   return result;
 }
 
-/// Convert the current internal state into a human readable string.
+/// Convert the viewed state into a human readable string.
 /// @return A human readable string.
-String IRAmcorAc::toString(void) const {
+String IRAmcorAcView::toString(void) const {
   String result = "";
   result.reserve(70);  // Reserve some heap for the string to reduce fragging.
-  result += addBoolToString(getPower(), kPowerStr, false);
+  result += addBoolToString(_.Power == kAmcorPowerOn, kPowerStr, false);
   result += addModeToString(_.Mode, kAmcorAuto, kAmcorCool,
                             kAmcorHeat, kAmcorDry, kAmcorFan);
   result += addFanToString(_.Fan, kAmcorFanMax, kAmcorFanMin,
                            kAmcorFanAuto, kAmcorFanAuto,
                            kAmcorFanMed);
   result += addTempToString(_.Temp);
-  result += addBoolToString(getMax(), kMaxStr);
+  result += addBoolToString(_.Max == kAmcorMax, kMaxStr);
   return result;
 }
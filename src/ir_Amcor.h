@@ -138,4 +138,17 @@ class IRAmcorAc {
   AmcorProtocol _;
   void checksum(void);
 };
+
+/// Read-only view of a native Amcor A/C state.
+/// Converts a state straight into the Common A/C API or text, without having
+/// to construct & reset a full IRAmcorAc object.
+class IRAmcorAcView {
+ public:
+  explicit IRAmcorAcView(const uint8_t state[]);
+  stdAc::state_t toCommon(void) const;
+  String toString(void) const;
+
+ private:
+  AmcorProtocol _;  ///< A copy of the state being viewed.
+};
 #endif  // IR_AMCOR_H_
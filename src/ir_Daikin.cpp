@@ -230,7 +230,9 @@ void IRDaikinESP::setTemp(const float temp) {
 
 /// Get the current temperature setting.
 /// @return The current setting for temp. in degrees celsius.
-float IRDaikinESP::getTemp(void) const { return _.Temp / 2.0f; }
+float IRDaikinESP::getTemp(void) const {
+  return IRDaikinESPView(_.raw).getTemp();
+}
 
 /// Set the speed of the fan.
 /// @param[in] fan The desired setting.
@@ -250,9 +252,7 @@ void IRDaikinESP::setFan(const uint8_t fan) {
 /// Get the current fan speed setting.
 /// @return The current fan speed.
 uint8_t IRDaikinESP::getFan(void) const {
-  uint8_t fan = _.Fan;
-  if (fan != kDaikinFanQuiet && fan != kDaikinFanAuto) fan -= 2;
-  return fan;
+  return IRDaikinESPView(_.raw).getFan();
 }
 
 /// Get the operating mode setting of the A/C.
@@ -531,14 +531,44 @@ stdAc::fanspeed_t IRDaikinESP::toCommonFanSpeed(const uint8_t speed) {
 /// Convert the current internal state into its stdAc::state_t equivalent.
 /// @return The stdAc equivalent of the native settings.
 stdAc::state_t IRDaikinESP::toCommon(void) const {
+  return IRDaikinESPView(_.raw).toCommon();
+}
+
+/// Convert the current internal state into a human readable string.
+/// @return A human readable string.
+String IRDaikinESP::toString(void) const {
+  return IRDaikinESPView(_.raw).toString();
+}
+
+/// Class constructor.
+/// @param[in] state A native Daikin 280-bit state. It is copied.
+IRDaikinESPView::IRDaikinESPView(const uint8_t state[]) {
+  std::memcpy(_.raw, state, kDaikinStateLength);
+}
+
+/// Get the current temperature setting.
+/// @return The current setting for temp. in degrees celsius.
+float IRDaikinESPView::getTemp(void) const { return _.Temp / 2.0f; }
+
+/// Get the current fan speed setting.
+/// @return The current fan speed.
+uint8_t IRDaikinESPView::getFan(void) const {
+  uint8_t fan = _.Fan;
+  if (fan != kDaikinFanQuiet && fan != kDaikinFanAuto) fan -= 2;
+  return fan;
+}
+
+/// Convert the viewed state into its stdAc equivalent.
+/// @return The stdAc equivalent of the viewed state.
+stdAc::state_t IRDaikinESPView::toCommon(void) const {
   stdAc::state_t result{};
   result.protocol = decode_type_t::DAIKIN;
   result.model = -1;  // No models used.
   result.power = _.Power;
-  result.mode = toCommonMode(_.Mode);
+  result.mode = IRDaikinESP::toCommonMode(_.Mode);
   result.celsius = true;
   result.degrees = getTemp();
-  result.fanspeed = toCommonFanSpeed(getFan());
+  result.fanspeed = IRDaikinESP::toCommonFanSpeed(getFan());
   result.swingv = _.SwingV ? stdAc::swingv_t::kAuto :
                                              stdAc::swingv_t::kOff;
   result.swingh = _.SwingH ? stdAc::swingh_t::kAuto :
@@ -556,9 +586,9 @@ stdAc::state_t IRDaikinESP::toCommon(void) const {
   return result;
 }
 
-/// Convert the current internal state into a human readable string.
+/// Convert the viewed state into a human readable string.
 /// @return A human readable string.
-String IRDaikinESP::toString(void) const {
+String IRDaikinESPView::toString(void) const {
   String result = "";
   result.reserve(230);  // Reserve some heap for the string to reduce fragging.
   result += addBoolToString(_.Power, kPowerStr, false);
@@ -569,7 +599,7 @@ String IRDaikinESP::toString(void) const {
                            kDaikinFanAuto, kDaikinFanQuiet, kDaikinFanMed);
   result += addBoolToString(_.Powerful, kPowerfulStr);
   result += addBoolToString(_.Quiet, kQuietStr);
-  result += addBoolToString(getSensor(), kSensorStr);
+  result += addBoolToString(_.Sensor, kSensorStr);
   result += addBoolToString(_.Mold, kMouldStr);
   result += addBoolToString(_.Comfort, kComfortStr);
   result += addBoolToString(_.SwingH, kSwingHStr);
@@ -582,7 +612,7 @@ String IRDaikinESP::toString(void) const {
   result += addLabeledString(_.OffTimer
                              ? minsToString(_.OffTime) : kOffStr,
                              kOffTimerStr);
-  result += addBoolToString(getWeeklyTimerEnable(), kWeeklyTimerStr);
+  result += addBoolToString(!_.WeeklyTimer, kWeeklyTimerStr);
   return result;
 }
 
@@ -637,7 +667,8 @@ bool IRrecv::decodeDaikin(decode_results *results, uint16_t offset,
                         kDaikinBitMark, kDaikinZeroSpace,
                         kDaikinBitMark, kDaikinZeroSpace + kDaikinGap,
                         section >= kDaikinSections - 1,
-                        kDaikinTolerance, kDaikinMarkExcess, false);
+                        kDaikinTolerance, kDaikinMarkExcess, false,
+                        strict ? kSumBytesChecksum : kNoChecksum);
     if (used == 0) return false;
     offset += used;
     pos += ksectionSize[section];
@@ -645,9 +676,8 @@ bool IRrecv::decodeDaikin(decode_results *results, uint16_t offset,
   // Compliance
   if (strict) {
     // Re-check we got the correct size/length due to the way we read the data.
+    // The checksums were validated as each section was matched.
     if (pos * 8 != kDaikinBits) return false;
-    // Validate the checksum.
-    if (!IRDaikinESP::validChecksum(results->state)) return false;
   }
 
   // Success
@@ -1361,7 +1391,7 @@ bool IRrecv::decodeDaikin2(decode_results *results, uint16_t offset,
                         kDaikin2BitMark, kDaikin2Gap,
                         section >= kDaikin2Sections - 1,
                         _tolerance + kDaikin2Tolerance, kDaikinMarkExcess,
-                        false);
+                        false, strict ? kSumBytesChecksum : kNoChecksum);
     if (used == 0) return false;
     offset += used;
     pos += ksectionSize[section];
@@ -1369,9 +1399,8 @@ bool IRrecv::decodeDaikin2(decode_results *results, uint16_t offset,
   // Compliance
   if (strict) {
     // Re-check we got the correct size/length due to the way we read the data.
+    // The checksums were validated as each section was matched.
     if (pos * 8 != kDaikin2Bits) return false;
-    // Validate the checksum.
-    if (!IRDaikin2::validChecksum(results->state)) return false;
   }
 
   // Success
@@ -1700,16 +1729,16 @@ bool IRrecv::decodeDaikin216(decode_results *results, uint16_t offset,
                         kDaikin216BitMark, kDaikin216ZeroSpace,
                         kDaikin216BitMark, kDaikin216Gap,
                         section >= kDaikin216Sections - 1,
-                        kDaikinTolerance, kDaikinMarkExcess, false);
+                        kDaikinTolerance, kDaikinMarkExcess, false,
+                        strict ? kSumBytesChecksum : kNoChecksum);
     if (used == 0) return false;
     offset += used;
     pos += ksectionSize[section];
   }
   // Compliance
   if (strict) {
+    // The checksums were validated as each section was matched.
     if (pos * 8 != kDaikin216Bits) return false;
-    // Validate the checksum.
-    if (!IRDaikin216::validChecksum(results->state)) return false;
   }
 
   // Success
@@ -2056,17 +2085,12 @@ bool IRrecv::decodeDaikin160(decode_results *results, uint16_t offset,
                         kDaikin160BitMark, kDaikin160ZeroSpace,
                         kDaikin160BitMark, kDaikin160Gap,
                         section >= kDaikin160Sections - 1,
-                        kDaikinTolerance, kDaikinMarkExcess, false);
+                        kDaikinTolerance, kDaikinMarkExcess, false,
+                        strict ? kSumBytesChecksum : kNoChecksum);
     if (used == 0) return false;
     offset += used;
     pos += ksectionSize[section];
   }
-  // Compliance
-  if (strict) {
-    // Validate the checksum.
-    if (!IRDaikin160::validChecksum(results->state)) return false;
-  }
-
   // Success
   results->decode_type = decode_type_t::DAIKIN160;
   results->bits = nbits;
@@ -2449,17 +2473,12 @@ bool IRrecv::decodeDaikin176(decode_results *results, uint16_t offset,
                         kDaikin176BitMark, kDaikin176ZeroSpace,
                         kDaikin176BitMark, kDaikin176Gap,
                         section >= kDaikin176Sections - 1,
-                        kDaikinTolerance, kDaikinMarkExcess, false);
+                        kDaikinTolerance, kDaikinMarkExcess, false,
+                        strict ? kSumBytesChecksum : kNoChecksum);
     if (used == 0) return false;
     offset += used;
     pos += ksectionSize[section];
   }
-  // Compliance
-  if (strict) {
-    // Validate the checksum.
-    if (!IRDaikin176::validChecksum(results->state)) return false;
-  }
-
   // Success
   results->decode_type = decode_type_t::DAIKIN176;
   results->bits = nbits;
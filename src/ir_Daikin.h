@@ -799,6 +799,21 @@ class IRDaikinESP {
   void checksum(void);
 };
 
+/// Read-only view of a native Daikin 280-bit A/C state.
+/// Converts a state straight into the Common A/C API or text, without having
+/// to construct & reset a full IRDaikinESP object.
+class IRDaikinESPView {
+ public:
+  explicit IRDaikinESPView(const uint8_t state[]);
+  float getTemp(void) const;
+  uint8_t getFan(void) const;
+  stdAc::state_t toCommon(void) const;
+  String toString(void) const;
+
+ private:
+  DaikinESPProtocol _;  ///< A copy of the state being viewed.
+};
+
 /// Class for handling detailed Daikin 312-bit A/C messages.
 /// @note Code by crankyoldgit, Reverse engineering analysis by sheppy99
 class IRDaikin2 {
@@ -27,7 +27,8 @@ const uint8_t kGlobalCacheStartIndex = kGlobalCacheRptStartIndex + 1;
 /// @param[in] len Nr. of entries in the buf[] array.
 /// @note Global Cache format without the emitter ID or request ID.
 ///  Starts at the frequency (Hertz), followed by nr. of times to emit (count),
-///  then the offset for repeats (where a repeat will start from),
+///  then the offset for repeats (where a repeat will start from. 1 is the
+///  start of the message, and 0 is treated the same as 1),
 ///  then the rest of entries are the actual IR message as units of periodic
 ///  time.
 ///  e.g. sendir,1:1,1,38000,1,1,9,70,9,30,9,... -> 38000,1,1,9,70,9,30,9,...
@@ -43,7 +44,8 @@ void IRsend::sendGC(uint16_t buf[], uint16_t len) {
     // First time through, start at the beginning (kGlobalCacheStartIndex),
     // otherwise for repeats, we start a specified offset from that.
     uint16_t offset = kGlobalCacheStartIndex;
-    if (repeat) offset += buf[kGlobalCacheRptStartIndex] - 1;
+    if (repeat && buf[kGlobalCacheRptStartIndex])
+      offset += buf[kGlobalCacheRptStartIndex] - 1;
     // Data
     for (; offset < len; offset++) {
       // Convert periodic units to microseconds.
@@ -57,7 +59,45 @@ void IRsend::sendGC(uint16_t buf[], uint16_t len) {
         space(microseconds);
     }
   }
+  waitUntilSent();
   // It's possible that we've ended on a mark(), thus ensure the LED is off.
   ledOff();
 }
+
+/// Convert a shortened GlobalCache (GC) code into a form that is quicker to
+/// send repeatedly.
+/// @param[in] buf Array of uint16_t containing the shortened GlobalCache data.
+/// @param[in] len Nr. of entries in the buf[] array.
+/// @param[out] code Where to store the result.
+/// @param[out] timings Storage for the converted timings. `code` uses it.
+/// @param[in] size Nr. of entries `timings` can hold.
+/// @return True if it worked, false if the code is bad, or `timings` is too
+///   small.
+/// @note `send(&code)` then sends the same as `sendGC(buf, len)` does.
+bool IRsend::compileGC(const uint16_t buf[], const uint16_t len,
+                       ir_compiled_t *code, uint32_t timings[],
+                       const uint16_t size) {
+  if (len < kGlobalCacheStartIndex || len - kGlobalCacheStartIndex > size)
+    return false;
+  code->hz = buf[kGlobalCacheFreqIndex];  // GC frequency is in Hz.
+  const uint32_t periodic_time = calcUSecPeriod(code->hz, false);
+  const uint8_t emits =
+      std::min(buf[kGlobalCacheRptIndex], (uint16_t)kGlobalCacheMaxRepeat);
+  // A GC code is sent in full the first time, and from the repeat offset for
+  // the repeats. i.e. The repeat sequence is the tail of the first.
+  code->length = emits ? len - kGlobalCacheStartIndex : 0;
+  code->first_len = code->length;
+  const uint16_t repeat_offset = buf[kGlobalCacheRptStartIndex];
+  code->repeat_start = std::min((uint16_t)(repeat_offset ? repeat_offset - 1
+                                                         : 0),
+                                code->length);
+  code->repeat = emits ? emits - 1 : 0;
+  for (uint16_t i = 0; i < code->length; i++)
+    // Convert periodic units to microseconds.
+    // Minimum is kGlobalCacheMinUsec for actual GC units.
+    timings[i] = std::max(buf[kGlobalCacheStartIndex + i] * periodic_time,
+                          kGlobalCacheMinUsec);
+  code->timings = timings;
+  return true;
+}
 #endif
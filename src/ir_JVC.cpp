@@ -65,6 +65,7 @@ void IRsend::sendJVC(uint64_t data, uint16_t nbits, uint16_t repeat) {
     // Avoid potential unsigned integer underflow.
     // e.g. when elapsed > kJvcRptLength.
     if (elapsed < kJvcRptLength) space(kJvcRptLength - elapsed);
+    waitUntilSent();  // So the time taken is what has really been sent.
     usecs.reset();
   }
 }
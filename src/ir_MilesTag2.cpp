@@ -32,6 +32,18 @@ const uint16_t kMilesTag2RptLength = 32000;  /// uSeconds.
 const uint16_t kMilesTag2StdFreq = 38000;    /// Hz.
 const uint16_t kMilesTag2StdDuty = 25;       /// Percentage.
 
+// The game receive profile (See IRrecv::enableGameMode()) needs to end the
+// capture of a frame in the gap between frames, but not inside one. i.e. During
+// the longest (tolerance stretched) mark or space of a frame.
+static_assert(MS_TO_USEC(kGameTimeoutMs) < kMilesTag2RptLength &&
+              MS_TO_USEC(kGameTimeoutMs) >
+                  kMilesTag2HdrMark * (100 + kTolerance) / 100 + kMarkExcess &&
+              MS_TO_USEC(kGameTimeoutMs) >
+                  kMilesTag2OneMark * (100 + kTolerance) / 100 + kMarkExcess &&
+              MS_TO_USEC(kGameTimeoutMs) >
+                  kMilesTag2Space * (100 + kTolerance) / 100 + kMarkExcess,
+              "kGameTimeoutMs doesn't suit the MilesTag2 frame timings.");
+
 #if SEND_MILESTAG2
 /// Send a MilesTag2 formatted Shot/Msg packet.
 /// Status: ALPHA / Probably works but needs testing with a real device.
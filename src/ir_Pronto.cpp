@@ -104,4 +104,41 @@ void IRsend::sendPronto(uint16_t data[], uint16_t len, uint16_t repeat) {
       }
   }
 }
+
+/// Convert a Pronto code into a form that is quicker to send repeatedly.
+/// @param[in] data An array of uint16_t containing the pronto codes.
+/// @param[in] len Nr. of entries in the data[] array.
+/// @param[out] code Where to store the result.
+/// @param[out] timings Storage for the converted timings. `code` uses it.
+/// @param[in] size Nr. of entries `timings` can hold.
+/// @return True if it worked, false if the code is bad, or `timings` is too
+///   small.
+/// @note `send(&code, repeat)` then sends the same as
+///   `sendPronto(data, len, repeat)` does.
+bool IRsend::compilePronto(const uint16_t data[], const uint16_t len,
+                           ir_compiled_t *code, uint32_t timings[],
+                           const uint16_t size) {
+  // Same checks as sendPronto(). Enough data, of the only type we understand.
+  if (len < kProntoMinLength || data[kProntoTypeOffset] != 0) return false;
+  const uint16_t seq_1_len = data[kProntoSeq1LenOffset] * 2;
+  if (kProntoDataOffset + seq_1_len > len) return false;
+  // Like sendPronto(), a truncated repeat sequence isn't sent at all.
+  uint16_t seq_2_len = data[kProntoSeq2LenOffset] * 2;
+  if (kProntoDataOffset + seq_1_len + seq_2_len > len) seq_2_len = 0;
+  if (seq_1_len + seq_2_len == 0 || seq_1_len + seq_2_len > size)
+    return false;
+  code->hz = (uint16_t)(1000000U / (data[kProntoFreqOffset] *
+                                    kProntoFreqFactor));
+  const uint32_t periodic_time_x10 = calcUSecPeriod(code->hz / 10, false);
+  for (uint16_t i = 0; i < seq_1_len + seq_2_len; i++)
+    timings[i] = (data[kProntoDataOffset + i] * periodic_time_x10) / 10;
+  code->length = seq_1_len + seq_2_len;
+  // No first sequence means the repeat sequence is sent an extra time.
+  // i.e. It is the first sequence too.
+  code->first_len = seq_1_len ? seq_1_len : seq_2_len;
+  code->repeat_start = seq_1_len;
+  code->repeat = 0;
+  code->timings = timings;
+  return true;
+}
 #endif  // SEND_PRONTO
@@ -102,7 +102,9 @@ void IRsend::sendRC5(const uint64_t data, uint16_t nbits,
         space(kRc5T1);
       }
     // Footer
+    waitUntilSent();  // So the time taken is what has really been sent.
     space(std::max(kRc5MinGap, kRc5MinCommandLength - usecTimer.elapsed()));
+    waitUntilSent();
   }
 }
 
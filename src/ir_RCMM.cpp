@@ -78,7 +78,9 @@ void IRsend::sendRCMM(uint64_t data, uint16_t nbits, uint16_t repeat) {
     mark(kRcmmBitMark);
     // Protocol requires us to wait at least kRcmmRptLength usecs from the
     // start or kRcmmMinGap usecs.
+    waitUntilSent();  // So the time taken is what has really been sent.
     space(std::max(kRcmmRptLength - usecs.elapsed(), kRcmmMinGap));
+    waitUntilSent();
   }
 }
 #endif  // SEND_RCMM
@@ -1,5 +1,6 @@
 // Copyright 2019-2021 David Conran
 
+#include <cmath>
 #include <string>
 #include "ir_Airton.h"
 #include "ir_Airwell.h"
@@ -2789,6 +2790,80 @@ TEST(TestIRac, strToModel) {
   EXPECT_EQ(-1, IRac::strToModel("0"));
   EXPECT_EQ(-1, IRac::strToModel("FOOBAR"));
   EXPECT_EQ(0, IRac::strToModel("FOOBAR", 0));
+  // Case insensitive, and aliases.
+  EXPECT_EQ(whirlpool_ac_remote_model_t::DG11J13A,
+            IRac::strToModel("dg11j104"));
+  EXPECT_EQ(panasonic_ac_remote_model_t::kPanasonicDke,
+            IRac::strToModel("PanasonicPkr"));
+  EXPECT_EQ(sharp_ac_remote_model_t::A903, IRac::strToModel("a903"));
+  EXPECT_EQ(gree_ac_remote_model_t::YX1FSF, IRac::strToModel("Yx1fsf"));
+}
+
+// Every alias in the text lookup tables must still be found.
+TEST(TestIRac, strToSettingAliases) {
+  EXPECT_EQ(stdAc::opmode_t::kFan, IRac::strToOpmode("fan only"));
+  EXPECT_EQ(stdAc::opmode_t::kFan, IRac::strToOpmode("FanOnly"));
+  EXPECT_EQ(stdAc::opmode_t::kDry, IRac::strToOpmode("Dehumidify"));
+  EXPECT_EQ(stdAc::opmode_t::kOff,
+            IRac::strToOpmode("stop", stdAc::opmode_t::kAuto));
+  EXPECT_EQ(stdAc::fanspeed_t::kMediumHigh,
+            IRac::strToFanspeed("med-high"));
+  EXPECT_EQ(stdAc::fanspeed_t::kMedium, IRac::strToFanspeed("Mid"));
+  EXPECT_EQ(stdAc::fanspeed_t::kMax, IRac::strToFanspeed("highest"));
+  EXPECT_EQ(stdAc::swingv_t::kMiddle, IRac::strToSwingV("Mid"));
+  EXPECT_EQ(stdAc::swingv_t::kHighest, IRac::strToSwingV("max"));
+  EXPECT_EQ(stdAc::swingv_t::kLowest, IRac::strToSwingV("down"));
+  EXPECT_EQ(stdAc::swingv_t::kAuto, IRac::strToSwingV("on"));
+  EXPECT_EQ(stdAc::swingh_t::kLeftMax, IRac::strToSwingH("leftmax"));
+  EXPECT_EQ(stdAc::swingh_t::kRightMax, IRac::strToSwingH("Max Right"));
+  EXPECT_EQ(stdAc::swingh_t::kWide, IRac::strToSwingH("WIDE"));
+  // All the strings we output must convert back.
+  for (int i = 0; i <= (int)stdAc::opmode_t::kLastOpmodeEnum; i++) {
+    const stdAc::opmode_t mode = (stdAc::opmode_t)i;
+    EXPECT_EQ(mode, IRac::strToOpmode(IRac::opmodeToString(mode).c_str(),
+                                      stdAc::opmode_t::kOff));
+  }
+  for (int i = 0; i <= (int)stdAc::swingh_t::kLastSwinghEnum; i++) {
+    const stdAc::swingh_t swingh = (stdAc::swingh_t)i;
+    EXPECT_EQ(swingh, IRac::strToSwingH(IRac::swinghToString(swingh).c_str(),
+                                        stdAc::swingh_t::kOff));
+  }
+}
+
+// Every entry in the text conversion tables must have the hash of its text,
+// and convert to its value. (Unless an earlier entry has the same text.)
+TEST(TestIRac, strToTextMatchTables) {
+  // Convert with a default that isn't a valid value, so a miss always fails.
+  int16_t (* const convert[])(const char *) = {
+    [](const char *str) {
+      return (int16_t)IRac::strToOpmode(str, (stdAc::opmode_t)100); },
+    [](const char *str) {
+      return (int16_t)IRac::strToFanspeed(str, (stdAc::fanspeed_t)100); },
+    [](const char *str) {
+      return (int16_t)IRac::strToSwingV(str, (stdAc::swingv_t)100); },
+    [](const char *str) {
+      return (int16_t)IRac::strToSwingH(str, (stdAc::swingh_t)100); },
+    [](const char *str) { return IRac::strToModel(str, -1); }
+  };
+  const uint8_t kTables = sizeof(convert) / sizeof(convert[0]);
+  uint16_t size;
+  for (uint8_t t = 0; t < kTables; t++) {
+    const IRTextMatch *table = IRac::textMatchTable(t, &size);
+    ASSERT_NE(nullptr, table);
+    ASSERT_LT(0, size);
+    for (uint16_t i = 0; i < size; i++) {
+      const char *text = *table[i].text;
+      EXPECT_EQ(irutils::textHash(text), table[i].hash) << text;
+      bool shadowed = false;
+      for (uint16_t j = 0; j < i; j++)
+        shadowed |= !strcasecmp(text, *table[j].text);
+      if (!shadowed) {
+        EXPECT_EQ(table[i].value, convert[t](text)) << text;
+      }
+    }
+  }
+  EXPECT_EQ(nullptr, IRac::textMatchTable(kTables, &size));
+  EXPECT_EQ(0, size);
 }
 
 TEST(TestIRac, strToCommandType) {
@@ -2862,6 +2937,191 @@ TEST(TestIRac, commandTypeToString) {
             IRac::commandTypeToString(stdAc::ac_command_t::kConfigCommand));
 }
 
+TEST(TestIRac, stateToJson) {
+  stdAc::state_t state;
+  char json[kStateJsonMaxSize];
+  IRac::initState(&state);
+  state.protocol = decode_type_t::DAIKIN;
+  state.power = true;
+  state.mode = stdAc::opmode_t::kFan;
+  state.degrees = 23.5;
+  state.fanspeed = stdAc::fanspeed_t::kMediumHigh;
+  state.swingv = stdAc::swingv_t::kUpperMiddle;
+  state.turbo = true;
+  const char kExpected[] =
+      "{\"protocol\":\"DAIKIN\",\"model\":-1,\"command\":\"Control\","
+      "\"power\":\"On\",\"mode\":\"Fan\",\"use_celsius\":\"On\","
+      "\"temp\":23.5,\"sensortemp\":-100,\"fanspeed\":\"Med-High\","
+      "\"swingv\":\"Upper-Middle\",\"swingh\":\"Off\",\"quiet\":\"Off\","
+      "\"ifeel\":\"Off\",\"turbo\":\"On\",\"econo\":\"Off\","
+      "\"light\":\"Off\",\"filter\":\"Off\",\"clean\":\"Off\","
+      "\"beep\":\"Off\",\"sleep\":-1}";
+  EXPECT_EQ(strlen(kExpected), IRac::stateToJson(state, json, sizeof(json)));
+  EXPECT_STREQ(kExpected, json);
+
+  // Home Assistant mode. Power & mode are tied together.
+  EXPECT_LT(0, IRac::stateToJson(state, json, sizeof(json), true));
+  EXPECT_NE(nullptr, strstr(json, "\"power\":\"On\",\"mode\":\"fan_only\""));
+  state.power = false;
+  EXPECT_LT(0, IRac::stateToJson(state, json, sizeof(json), true));
+  EXPECT_NE(nullptr, strstr(json, "\"power\":\"Off\",\"mode\":\"Off\""));
+
+  // Too small a buffer.
+  EXPECT_EQ(0, IRac::stateToJson(state, json, strlen(kExpected)));
+  EXPECT_STREQ("", json);
+  EXPECT_EQ(0, IRac::stateToJson(state, json, 0));
+  EXPECT_EQ(0, IRac::stateToJson(state, NULL, sizeof(json)));
+
+  // The worst case fits.
+  state.protocol = decode_type_t::MITSUBISHI_HEAVY_152;
+  state.model = INT16_MIN;
+  state.command = stdAc::ac_command_t::kSensorTempReport;
+  state.degrees = -999.9;
+  state.sensorTemperature = -999.9;
+  state.sleep = INT16_MIN;
+  const uint16_t len = IRac::stateToJson(state, json, sizeof(json));
+  EXPECT_TRUE(0 < len && len < kStateJsonMaxSize) << len;
+  EXPECT_EQ(len, strlen(json));
+  // An out of range protocol is "UNKNOWN".
+  state.protocol = (decode_type_t)-2;
+  EXPECT_LT(0, IRac::stateToJson(state, json, sizeof(json)));
+  EXPECT_NE(nullptr, strstr(json, "\"protocol\":\"UNKNOWN\""));
+  // Temperatures we can't represent are null.
+  state.degrees = 1e30;
+  state.sensorTemperature = NAN;
+  EXPECT_LT(0, IRac::stateToJson(state, json, sizeof(json)));
+  EXPECT_NE(nullptr, strstr(json, "\"temp\":null,\"sensortemp\":null,"));
+  state.degrees = -INFINITY;
+  state.sensorTemperature = kJsonTempLimit;
+  EXPECT_LT(0, IRac::stateToJson(state, json, sizeof(json)));
+  EXPECT_NE(nullptr, strstr(json, "\"temp\":null,\"sensortemp\":1000,"));
+}
+
+TEST(TestIRac, jsonToState) {
+  stdAc::state_t state;
+  stdAc::state_t result;
+  char json[kStateJsonMaxSize];
+  IRac::initState(&state);
+  state.protocol = decode_type_t::GREE;
+  state.model = 2;
+  state.power = true;
+  state.mode = stdAc::opmode_t::kHeat;
+  state.degrees = 21.5;
+  state.sensorTemperature = 19;
+  state.swingh = stdAc::swingh_t::kWide;
+  state.light = true;
+  state.sleep = 30;
+  // Round trip.
+  ASSERT_LT(0, IRac::stateToJson(state, json, sizeof(json)));
+  IRac::initState(&result);
+  EXPECT_TRUE(IRac::jsonToState(json, &result));
+  EXPECT_FALSE(IRac::cmpStates(state, result));
+
+  // Only the fields given are changed. Numbers, bools & aliases are allowed.
+  result = state;
+  EXPECT_TRUE(IRac::jsonToState(
+      " { \"mode\" : \"cool\", \"temp\":24, \"quiet\":true,\n"
+      "\"beep\":\"yes\", \"protocol\": 4, \"fanspeed\":\"Max\","
+      "\"unknown\": null, \"other\": -1.5e3, \"name\": \"\\\"x\\\"\"} ",
+      &result));
+  EXPECT_EQ(decode_type_t::SONY, result.protocol);
+  EXPECT_EQ(stdAc::opmode_t::kCool, result.mode);
+  EXPECT_EQ(24, result.degrees);
+  EXPECT_EQ(stdAc::fanspeed_t::kMax, result.fanspeed);
+  EXPECT_TRUE(result.quiet);
+  EXPECT_TRUE(result.beep);
+  EXPECT_EQ(2, result.model);
+  EXPECT_EQ(19, result.sensorTemperature);
+  EXPECT_EQ(stdAc::swingh_t::kWide, result.swingh);
+  EXPECT_TRUE(result.light);
+  EXPECT_EQ(30, result.sleep);
+  // Names as strings.
+  EXPECT_TRUE(IRac::jsonToState(
+      "{\"protocol\":\"Fujitsu_AC\",\"model\":\"ARREW4E\","
+      "\"command\":\"IFeel Report\",\"power\":\"off\"}", &result));
+  EXPECT_EQ(decode_type_t::FUJITSU_AC, result.protocol);
+  EXPECT_EQ(fujitsu_ac_remote_model_t::ARREW4E, result.model);
+  EXPECT_EQ(stdAc::ac_command_t::kSensorTempReport, result.command);
+  EXPECT_FALSE(result.power);
+  // Values of the wrong type are ignored.
+  EXPECT_TRUE(IRac::jsonToState("{\"temp\":\"hot\",\"sleep\":true}",
+                                &result));
+  EXPECT_EQ(24, result.degrees);
+  EXPECT_EQ(30, result.sleep);
+  EXPECT_TRUE(IRac::jsonToState("{}", &result));
+  // Over-long keys, and over-long values for keys we don't use, are skipped.
+  EXPECT_TRUE(IRac::jsonToState(
+      "{\"a_key_that_is_much_too_long\":\"cool\","
+      "\"name\":\"A value that is much too long for us to bother reading\","
+      "\"a_key_that_is_much_too_long_too\":\"A value that is much too long"
+      " for us to bother reading\",\"temp\":25}", &result));
+  EXPECT_EQ(stdAc::opmode_t::kCool, result.mode);
+  EXPECT_EQ(25, result.degrees);
+  // Out of range numbers are ignored.
+  EXPECT_TRUE(IRac::jsonToState(
+      "{\"protocol\":1e9,\"model\":40000,\"command\":-1,"
+      "\"sleep\":-1e300}", &result));
+  EXPECT_EQ(decode_type_t::FUJITSU_AC, result.protocol);
+  EXPECT_EQ(fujitsu_ac_remote_model_t::ARREW4E, result.model);
+  EXPECT_EQ(stdAc::ac_command_t::kSensorTempReport, result.command);
+  EXPECT_EQ(30, result.sleep);
+  EXPECT_TRUE(IRac::jsonToState(
+      "{\"protocol\":-2,\"model\":-32769,\"command\":4,\"sleep\":32768}",
+      &result));
+  EXPECT_EQ(decode_type_t::FUJITSU_AC, result.protocol);
+  EXPECT_EQ(fujitsu_ac_remote_model_t::ARREW4E, result.model);
+  EXPECT_EQ(stdAc::ac_command_t::kSensorTempReport, result.command);
+  EXPECT_EQ(30, result.sleep);
+  // In range edge cases are still used.
+  EXPECT_TRUE(IRac::jsonToState(
+      "{\"protocol\":-1,\"model\":-32768,\"command\":3,\"sleep\":32767}",
+      &result));
+  EXPECT_EQ(decode_type_t::UNKNOWN, result.protocol);
+  EXPECT_EQ(INT16_MIN, result.model);
+  EXPECT_EQ(stdAc::ac_command_t::kConfigCommand, result.command);
+  EXPECT_EQ(INT16_MAX, result.sleep);
+  // Out of range temperatures are ignored too.
+  result.degrees = 24;
+  result.sensorTemperature = 19;
+  EXPECT_TRUE(IRac::jsonToState("{\"temp\":1e30,\"sensortemp\":-1e300}",
+                                &result));
+  EXPECT_EQ(24, result.degrees);
+  EXPECT_EQ(19, result.sensorTemperature);
+  EXPECT_TRUE(IRac::jsonToState("{\"temp\":1000.5,\"sensortemp\":1e999}",
+                                &result));
+  EXPECT_EQ(24, result.degrees);
+  EXPECT_EQ(19, result.sensorTemperature);
+  EXPECT_TRUE(IRac::jsonToState("{\"temp\":-1000,\"sensortemp\":1e3}",
+                                &result));
+  EXPECT_EQ(-1000, result.degrees);
+  EXPECT_EQ(1000, result.sensorTemperature);
+  // Round tripping one we couldn't write leaves it alone.
+  result.degrees = NAN;
+  ASSERT_LT(0, IRac::stateToJson(result, json, sizeof(json)));
+  result.degrees = 21;
+  EXPECT_TRUE(IRac::jsonToState(json, &result));
+  EXPECT_EQ(21, result.degrees);
+
+  // Bad JSON leaves the state untouched.
+  stdAc::state_t before = result;
+  const char* const kBad[] = {
+      "", "[]", "{", "{\"temp\":}", "{\"temp\" 20}", "{\"temp\":20,}",
+      "{\"temp\":20} x", "{\"temp\":{\"a\":1}}", "{\"temp\":20",
+      "{temp:20}", "{\"mode\":\"cool}",
+      "{\"mode\":\"A much too long value for any of the fields we know\"}",
+      "{\"power\":\"\\u0031\",\"temp\":30}",
+      // Not JSON numbers, even though strtod() takes them.
+      "{\"temp\":nan}", "{\"temp\":NaN}", "{\"temp\":inf}",
+      "{\"temp\":-Infinity}", "{\"temp\":0x1F}", "{\"temp\":+20}",
+      "{\"temp\":-nan}"};
+  for (uint8_t i = 0; i < sizeof(kBad) / sizeof(kBad[0]); i++) {
+    EXPECT_FALSE(IRac::jsonToState(kBad[i], &result)) << kBad[i];
+    EXPECT_FALSE(IRac::cmpStates(before, result)) << kBad[i];
+  }
+  EXPECT_FALSE(IRac::jsonToState(NULL, &result));
+  EXPECT_FALSE(IRac::jsonToState("{}", NULL));
+}
+
 // Check that we keep the previous state info if the message is a special
 // state-less command.
 TEST(TestIRac, CoolixDecodeToState) {
@@ -42,6 +42,19 @@ TEST(TestIRrecv, IRrecvDestructor) {
   delete irrecv_ptr;
 }
 
+TEST(TestIRrecv, Available) {
+  IRrecv irrecv(1);
+  volatile irparams_t *params_ptr = irrecv._getParamsPtr();
+  irrecv.resume();
+  EXPECT_FALSE(irrecv.available());
+  params_ptr->rcvstate = kMarkState;  // Capturing.
+  EXPECT_FALSE(irrecv.available());
+  params_ptr->rcvstate = kStopState;  // A capture has completed.
+  EXPECT_TRUE(irrecv.available());
+  irrecv.resume();
+  EXPECT_FALSE(irrecv.available());
+}
+
 TEST(TestIRrecv, DecodeHeapOverflow) {
   // Check that we handle the rawbuf correctly when we fill it. e.g. overflow.
   // Ref: https://github.com/crankyoldgit/IRremoteESP8266/issues/1516
@@ -83,6 +96,36 @@ TEST(TestIRrecv, DecodeHeapOverflow) {
   ASSERT_EQ(100, params_ptr->rawbuf[params_ptr->rawlen - 1]);
   EXPECT_EQ(99, params_ptr->rawbuf[params_ptr->rawlen]);
   EXPECT_EQ(99, params_ptr->rawbuf[params_ptr->rawlen + 1]);
+  delete[] params_ptr->rawbuf;  // It's ours, not the IRrecv object's.
+}
+
+TEST(TestIRrecv, DecodeCapture) {
+  IRsendTest irsend(0);
+  IRrecv first(1);
+  IRrecv *second = new IRrecv(1, 100);
+  volatile irparams_t *params_ptr = second->_getParamsPtr();
+  EXPECT_EQ(100, second->getBufSize());  // The most recent object's buffer.
+  params_ptr->rcvstate = kStopState;  // As if the receiver has a message.
+  irsend.begin();
+  irsend.reset();
+  irsend.sendNEC(0x807F40BF);
+  irsend.makeDecodeResult();
+  // Either object can decode a capture that didn't come from the receiver.
+  ASSERT_TRUE(first.decodeCapture(&irsend.capture));
+  EXPECT_EQ(NEC, irsend.capture.decode_type);
+  EXPECT_EQ(0x807F40BF, irsend.capture.value);
+  ASSERT_TRUE(second->decodeCapture(&irsend.capture));
+  EXPECT_EQ(NEC, irsend.capture.decode_type);
+  // The receiver's message is untouched, & it hasn't been restarted.
+  EXPECT_TRUE(second->available());
+  // A failed decode doesn't restart it either.
+  irsend.capture.rawlen = 1;
+  EXPECT_FALSE(first.decodeCapture(&irsend.capture));
+  EXPECT_EQ(UNKNOWN, irsend.capture.decode_type);
+  EXPECT_TRUE(second->available());
+  // Each object only frees its own buffer.
+  delete second;
+  EXPECT_EQ(NULL, params_ptr->rawbuf);
 }
 
 // Tests for copyIrParams()
@@ -604,6 +647,25 @@ TEST(TestMatchData, ArbitraryEncoded) {
   ASSERT_FALSE(result.success);
 }
 
+// The matchers only need a read-only view of a capture, in ticks.
+TEST(TestMatchData, ReadOnlyCapture) {
+  IRrecv irrecv(1);
+  const uint16_t capture[11] = {250, 250,  250, 750, 250, 250,
+                                250, 750, 250, 750, 250};
+  uint64_t data = 0;
+
+  match_result_t result = irrecv.matchData(capture, 5, 500, 1500, 500, 500);
+  ASSERT_TRUE(result.success);
+  EXPECT_EQ(0b01011, result.data);
+  EXPECT_EQ(10, result.used);
+  EXPECT_EQ(11, irrecv.matchGeneric(capture, &data, 11, 5,
+                                    0, 0,  // No Header
+                                    500, 1500, 500, 500,
+                                    500, 0,  // Footer with no trailing space
+                                    true));
+  EXPECT_EQ(0b01011, data);
+}
+
 TEST(TestMatchGeneric, NormalWithNoAtleast) {
   IRsendTest irsend(0);
   IRrecv irrecv(1);
@@ -1320,6 +1382,43 @@ TEST(TestMatchGeneric, UsingBytes) {
   ASSERT_EQ(0, entries_used);
 }
 
+TEST(TestMatchGeneric, SectionChecksums) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+
+  const uint8_t sum[3] = {0x12, 0x34, 0x46};
+  const uint8_t xored[3] = {0x12, 0x34, 0x26};
+  const uint8_t nibbles[3] = {0x12, 0x34, 0x0A};
+  EXPECT_TRUE(IRrecv::validSectionChecksum(sum, 3, kNoChecksum));
+  EXPECT_TRUE(IRrecv::validSectionChecksum(sum, 3, kSumBytesChecksum));
+  EXPECT_FALSE(IRrecv::validSectionChecksum(sum, 3, kXorBytesChecksum));
+  EXPECT_TRUE(IRrecv::validSectionChecksum(xored, 3, kXorBytesChecksum));
+  EXPECT_FALSE(IRrecv::validSectionChecksum(xored, 3, kSumBytesChecksum));
+  EXPECT_TRUE(IRrecv::validSectionChecksum(nibbles, 3, kSumNibblesChecksum));
+  EXPECT_FALSE(IRrecv::validSectionChecksum(sum, 0, kSumBytesChecksum));
+
+  // A matched section with a bad checksum doesn't match at all.
+  uint8_t result[3] = {};
+  irsend.reset();
+  irsend.sendGeneric(8000, 4000, 500, 1500, 500, 500, 500, 20000,
+                     sum, 3, 38000, true, 0, 50);
+  irsend.makeDecodeResult();
+  EXPECT_EQ(irsend.capture.rawlen - kStartOffset,
+            irrecv.matchGeneric(irsend.capture.rawbuf + kStartOffset, result,
+                                irsend.capture.rawlen - kStartOffset, 24,
+                                8000, 4000, 500, 1500, 500, 500, 500, 20000,
+                                true, kUseDefTol, kMarkExcess, true,
+                                kSumBytesChecksum));
+  EXPECT_EQ(0x46, result[2]);
+  EXPECT_EQ(0,
+            irrecv.matchGeneric(irsend.capture.rawbuf + kStartOffset, result,
+                                irsend.capture.rawlen - kStartOffset, 24,
+                                8000, 4000, 500, 1500, 500, 500, 500, 20000,
+                                true, kUseDefTol, kMarkExcess, true,
+                                kXorBytesChecksum));
+}
+
 TEST(TestIRrecv, Tolerance) {
   IRsendTest irsend(0);
   IRrecv irrecv(1);
@@ -2019,3 +2118,854 @@ TEST(TestMatchManchesterData, SimulateLongFooter) {
   EXPECT_EQ("f38000d50m1000s2000m1000s1000m2000s5000",
             irsend.outputStr());
 }
+
+TEST(TestMatchManchesterData, BadIntervalsAndConventions) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(0);
+  uint16_t offset = 1;
+  uint64_t result = 0;
+  irsend.begin();
+
+  // A long interval can't start a bit.
+  irsend.reset();
+  irsend.mark(2000);
+  irsend.space(1000);
+  irsend.mark(1000);
+  irsend.space(1000);
+  irsend.makeDecodeResult();
+  EXPECT_EQ(0, irrecv.matchManchesterData(irsend.capture.rawbuf + offset,
+                                          &result,
+                                          irsend.capture.rawlen - offset,
+                                          2, 1000));
+
+  // Three half-periods are only acceptable at the very end of the data.
+  irsend.reset();
+  irsend.mark(1000);
+  irsend.space(3000);
+  irsend.mark(1000);
+  irsend.space(1000);
+  irsend.makeDecodeResult();
+  EXPECT_EQ(0, irrecv.matchManchesterData(irsend.capture.rawbuf + offset,
+                                          &result,
+                                          irsend.capture.rawlen - offset,
+                                          2, 1000));
+  EXPECT_EQ(1, irrecv.matchManchesterData(irsend.capture.rawbuf + offset,
+                                          &result,
+                                          irsend.capture.rawlen - offset,
+                                          1, 1000));
+  EXPECT_EQ(0b1, result);
+
+  // The IEEE 802.3 convention is the inverse of G.E. Thomas.
+  irsend.reset();
+  irsend.sendManchesterData(1000, 0b1011, 4);
+  irsend.makeDecodeResult();
+  EXPECT_EQ(6, irrecv.matchManchesterData(irsend.capture.rawbuf + offset,
+                                          &result,
+                                          irsend.capture.rawlen - offset,
+                                          4, 1000, 0, kUseDefTol, kMarkExcess,
+                                          true, false));
+  EXPECT_EQ(0b0100, result);
+
+  // With a very wide tolerance, short & long intervals overlap. It should
+  // still decode correctly.
+  irsend.reset();
+  irsend.mark(1300);
+  irsend.space(1400);
+  irsend.mark(1400);
+  irsend.space(1300);
+  irsend.makeDecodeResult();
+  EXPECT_EQ(4, irrecv.matchManchesterData(irsend.capture.rawbuf + offset,
+                                          &result,
+                                          irsend.capture.rawlen - offset,
+                                          3, 1000, 0, 40));
+  EXPECT_EQ(0b101, result);
+}
+
+// Pack some timings (in usecs, starting with a mark) into ESP32 RMT symbols,
+// splitting any long periods like the RMT hardware does.
+static uint16_t timingsToRmt(const uint32_t *usecs, const uint16_t length,
+                             uint32_t *symbols, const uint32_t tick_ns = 2000,
+                             const bool mark_level = false) {
+  uint16_t halves = 0;
+  for (uint16_t i = 0; i < length; i++) {
+    const uint32_t level = (i % 2) ? !mark_level : mark_level;
+    for (uint32_t ticks = usecs[i] * 1000 / tick_ns; ticks;) {
+      const uint32_t duration = std::min(ticks, (uint32_t)0x7FFF);
+      const uint32_t half = duration | level << 15;
+      if (halves % 2)
+        symbols[halves / 2] |= half << 16;
+      else
+        symbols[halves / 2] = half;
+      halves++;
+      ticks -= duration;
+    }
+  }
+  // Zero duration marks the end of the message.
+  if (halves % 2 == 0) symbols[halves / 2] = 0;
+  halves++;
+  return (halves + 1) / 2;
+}
+
+// Tests for rmtIdleThreshold().
+TEST(TestRmtIdleThreshold, FitsTheHardwareField) {
+  EXPECT_EQ(7500, IRrecv::rmtIdleThreshold(kTimeoutMs));
+  EXPECT_EQ(32500, IRrecv::rmtIdleThreshold(65));
+  // Anything longer than ~65ms would overflow the 15-bit field.
+  EXPECT_EQ(kRmtMaxIdleTicks, IRrecv::rmtIdleThreshold(66));
+  EXPECT_EQ(kRmtMaxIdleTicks, IRrecv::rmtIdleThreshold(kMaxTimeoutMs));
+  EXPECT_EQ(kRmtMaxIdleTicks, IRrecv::rmtIdleThreshold(UINT8_MAX));
+}
+
+// Tests for rmtToRawbuf().
+TEST(TestRmtToRawbuf, DecodeNEC) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+  irsend.reset();
+  irsend.sendNEC(0x807F40BF);
+  uint32_t symbols[100];
+  // The RMT doesn't capture the trailing gap. It ends the message instead.
+  const uint16_t nsymbols = timingsToRmt(irsend.output, irsend.last, symbols);
+  EXPECT_EQ(34, nsymbols);
+
+  uint16_t rawbuf[100];
+  bool overflow = true;
+  decode_results results;
+  results.rawbuf = rawbuf;
+  results.rawlen = IRrecv::rmtToRawbuf(symbols, nsymbols, rawbuf, 100,
+                                       &overflow);
+  EXPECT_FALSE(overflow);
+  // Header, 32 bits, & a footer mark. The trailing gap isn't captured.
+  EXPECT_EQ(1 + 2 + 32 * 2 + 1, results.rawlen);
+  EXPECT_EQ(1, rawbuf[0]);
+  EXPECT_EQ(irsend.output[0] / kRawTick, rawbuf[1]);
+  EXPECT_EQ(irsend.output[1] / kRawTick, rawbuf[2]);
+  results.overflow = overflow;
+  ASSERT_TRUE(irrecv.decode(&results));
+  EXPECT_EQ(decode_type_t::NEC, results.decode_type);
+  EXPECT_EQ(kNECBits, results.bits);
+  EXPECT_EQ(0x807F40BF, results.value);
+}
+
+TEST(TestRmtToRawbuf, SplitsLeadingAndTrailingSpaces) {
+  uint16_t rawbuf[10];
+  bool overflow = true;
+  // Leading idle, a mark split over two symbol halves, a space, a mark longer
+  // than a single half can hold, then the idle timeout.
+  const uint32_t symbols[4] = {
+      (0x8000 | 100) | (uint32_t)(200) << 16,      // idle 100, mark 200
+      (300) | (uint32_t)(0x8000 | 400) << 16,      // mark 300, space 400
+      (0x7FFF) | (uint32_t)(10) << 16,             // mark 32767, mark 10
+      (0x8000 | 5000) | (uint32_t)(0) << 16};      // timeout, end.
+  EXPECT_EQ(4, IRrecv::rmtToRawbuf(symbols, 4, rawbuf, 10, &overflow));
+  EXPECT_FALSE(overflow);
+  EXPECT_EQ(1, rawbuf[0]);
+  EXPECT_EQ(500, rawbuf[1]);
+  EXPECT_EQ(400, rawbuf[2]);
+  EXPECT_EQ(32777, rawbuf[3]);
+
+  // Same again, but with 1uSec ticks & an active high signal.
+  const uint32_t inverted[3] = {
+      (100) | (uint32_t)(0x8000 | 600) << 16,      // idle 100, mark 600
+      (400) | (uint32_t)(0x8000 | 1000) << 16,     // space 400, mark 1000
+      (5000) | (uint32_t)(0) << 16};               // timeout, end.
+  EXPECT_EQ(4, IRrecv::rmtToRawbuf(inverted, 3, rawbuf, 10, &overflow, 1000,
+                                   true));
+  EXPECT_EQ(300, rawbuf[1]);
+  EXPECT_EQ(200, rawbuf[2]);
+  EXPECT_EQ(500, rawbuf[3]);
+
+  // Nothing but idle.
+  const uint32_t idle[1] = {0x8000 | 0x7FFF};
+  EXPECT_EQ(0, IRrecv::rmtToRawbuf(idle, 1, rawbuf, 10, &overflow));
+  EXPECT_EQ(0, IRrecv::rmtToRawbuf(idle, 0, rawbuf, 10, &overflow));
+}
+
+TEST(TestRmtToRawbuf, Overflow) {
+  IRsendTest irsend(0);
+  irsend.begin();
+  irsend.reset();
+  irsend.sendNEC(0x807F40BF);
+  uint32_t symbols[100];
+  const uint16_t nsymbols = timingsToRmt(irsend.output, irsend.last + 1,
+                                         symbols);
+  uint16_t rawbuf[20] = {0};
+  bool overflow = false;
+  EXPECT_EQ(20, IRrecv::rmtToRawbuf(symbols, nsymbols, rawbuf, 20,
+                                    &overflow));
+  EXPECT_TRUE(overflow);
+  EXPECT_EQ(1, rawbuf[0]);
+  EXPECT_EQ(irsend.output[0] / kRawTick, rawbuf[1]);
+  // Just fits.
+  uint16_t exact[68];
+  EXPECT_EQ(68, IRrecv::rmtToRawbuf(symbols, nsymbols, exact, 68, &overflow));
+  EXPECT_FALSE(overflow);
+}
+
+TEST(TestDecodeTask, StartStopStates) {
+  volatile uint8_t state = kDecodeTaskStopped;
+  int task = 0;
+  int other = 0;
+  // Only one start at a time.
+  EXPECT_TRUE(IRrecv::_decodeTaskStarting(&state));
+  EXPECT_EQ(kDecodeTaskStarting, state);
+  EXPECT_FALSE(IRrecv::_decodeTaskStarting(&state));
+  state = kDecodeTaskRunning;  // i.e. It has been created.
+  EXPECT_FALSE(IRrecv::_decodeTaskStarting(&state));
+  // The task can't stop itself. e.g. From a decode callback.
+  EXPECT_FALSE(IRrecv::_decodeTaskStopping(&state, &task, &task));
+  EXPECT_EQ(kDecodeTaskRunning, state);
+  // Anything else can.
+  EXPECT_TRUE(IRrecv::_decodeTaskStopping(&state, &task, &other));
+  EXPECT_EQ(kDecodeTaskStopping, state);
+  EXPECT_FALSE(IRrecv::_decodeTaskStarting(&state));
+  // Stopping twice (e.g. Concurrently) just waits for it too.
+  EXPECT_TRUE(IRrecv::_decodeTaskStopping(&state, &task, &other));
+  EXPECT_EQ(kDecodeTaskStopping, state);
+  state = kDecodeTaskStopped;  // i.e. The task has finished.
+  // Stopping when there is no task does nothing.
+  EXPECT_TRUE(IRrecv::_decodeTaskStopping(&state, NULL, NULL));
+  EXPECT_EQ(kDecodeTaskStopped, state);
+  // It can be started again.
+  EXPECT_TRUE(IRrecv::_decodeTaskStarting(&state));
+  EXPECT_EQ(kDecodeTaskStarting, state);
+}
+
+TEST(TestDecodeCache, RepeatsAreCached) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+  // Disabled by default.
+  irsend.reset();
+  irsend.sendNEC(0x807F40BF);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(0, irrecv.getDecodeCacheStats().misses);
+
+  ASSERT_TRUE(irrecv.enableDecodeCache(2));
+  irsend.reset();
+  irsend.sendNEC(0x807F40BF);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(decode_type_t::NEC, irsend.capture.decode_type);
+  EXPECT_EQ(0x807F40BF, irsend.capture.value);
+  EXPECT_EQ(0, irrecv.getDecodeCacheStats().hits);
+  EXPECT_EQ(1, irrecv.getDecodeCacheStats().misses);
+
+  // Same message again, but with different timing jitter.
+  irsend.reset();
+  irsend.sendNEC(0x807F40BF);
+  irsend.makeDecodeResult();
+  for (uint16_t i = 1; i < irsend.capture.rawlen; i += 3)
+    irsend.capture.rawbuf[i] += irsend.capture.rawbuf[i] / 20;
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(1, irrecv.getDecodeCacheStats().hits);
+  EXPECT_EQ(decode_type_t::NEC, irsend.capture.decode_type);
+  EXPECT_EQ(kNECBits, irsend.capture.bits);
+  EXPECT_EQ(0x807F40BF, irsend.capture.value);
+  EXPECT_EQ(0x1, irsend.capture.address);
+  EXPECT_EQ(0x2, irsend.capture.command);
+  EXPECT_EQ(irsend.rawbuf, irsend.capture.rawbuf);
+
+  // A different message of the same protocol & length isn't a hit.
+  irsend.reset();
+  irsend.sendNEC(0x807F00FF);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(0x807F00FF, irsend.capture.value);
+  EXPECT_EQ(1, irrecv.getDecodeCacheStats().hits);
+  EXPECT_EQ(2, irrecv.getDecodeCacheStats().misses);
+
+  // Same sequence of durations, but all of them too far out. i.e. Rejected.
+  irsend.reset();
+  irsend.sendNEC(0x807F00FF);
+  irsend.makeDecodeResult();
+  for (uint16_t i = 1; i < irsend.capture.rawlen; i++)
+    irsend.capture.rawbuf[i] *= 2;
+  irrecv.decode(&irsend.capture);
+  EXPECT_EQ(1, irrecv.getDecodeCacheStats().rejected);
+  EXPECT_NE(0x807F00FF, irsend.capture.value);
+
+  irrecv.clearDecodeCache();
+  EXPECT_EQ(0, irrecv.getDecodeCacheStats().hits);
+  EXPECT_EQ(0, irrecv.getDecodeCacheStats().misses);
+  EXPECT_EQ(0, irrecv.getDecodeCacheStats().rejected);
+}
+
+TEST(TestDecodeCache, LeastRecentlyUsedIsReplaced) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+  ASSERT_TRUE(irrecv.enableDecodeCache(2));
+  const uint32_t codes[] = {0x807F40BF, 0x807F00FF, 0x807F40BF, 0x807F807F,
+                            0x807F40BF, 0x807F00FF};
+  for (uint8_t i = 0; i < sizeof(codes) / sizeof(codes[0]); i++) {
+    irsend.reset();
+    irsend.sendNEC(codes[i]);
+    irsend.makeDecodeResult();
+    ASSERT_TRUE(irrecv.decode(&irsend.capture));
+    EXPECT_EQ(codes[i], irsend.capture.value);
+  }
+  // Only the 3rd & 5th are hits. The 4th evicts the 2nd.
+  EXPECT_EQ(2, irrecv.getDecodeCacheStats().hits);
+  EXPECT_EQ(4, irrecv.getDecodeCacheStats().misses);
+
+  // Messages with too many different durations can't be cached.
+  uint16_t rawbuf[20] = {1};
+  for (uint16_t i = 1; i < 20; i++) rawbuf[i] = 10 << ((i + 1) / 2);
+  decode_results results;
+  results.rawbuf = rawbuf;
+  results.rawlen = 20;
+  results.overflow = false;
+  irrecv.decode(&results);
+  EXPECT_EQ(1, irrecv.getDecodeCacheStats().uncacheable);
+
+  irrecv.disableDecodeCache();
+  irsend.reset();
+  irsend.sendNEC(codes[0]);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(2, irrecv.getDecodeCacheStats().hits);
+}
+
+TEST(TestDecodeCache, SignatureCollision) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+  ASSERT_TRUE(irrecv.enableDecodeCache(2));
+  // Two NEC messages with the same distinct durations, & different sequences
+  // of them, that have the same signature hash.
+  irsend.reset();
+  irsend.sendNEC(0xD3352971);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(0xD3352971, irsend.capture.value);
+  irsend.reset();
+  irsend.sendNEC(0xCDECB92F);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(0xCDECB92F, irsend.capture.value);
+  EXPECT_EQ(0, irrecv.getDecodeCacheStats().hits);
+  EXPECT_EQ(2, irrecv.getDecodeCacheStats().misses);
+  EXPECT_EQ(1, irrecv.getDecodeCacheStats().rejected);
+}
+
+TEST(TestDecodeCache, DecodeSettingsArePartOfTheKey) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+  ASSERT_TRUE(irrecv.enableDecodeCache(4));
+  irsend.reset();
+  irsend.sendNEC(0x807F40BF);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(1, irrecv.getDecodeCacheStats().hits);
+  // A different max_skip.
+  ASSERT_TRUE(irrecv.decode(&irsend.capture, NULL, 2));
+  EXPECT_EQ(1, irrecv.getDecodeCacheStats().hits);
+  EXPECT_EQ(2, irrecv.getDecodeCacheStats().misses);
+  // A different tolerance.
+  irrecv.setTolerance(kTolerance + 5);
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(1, irrecv.getDecodeCacheStats().hits);
+  EXPECT_EQ(3, irrecv.getDecodeCacheStats().misses);
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(2, irrecv.getDecodeCacheStats().hits);
+  EXPECT_EQ(0, irrecv.getDecodeCacheStats().rejected);
+}
+
+TEST(TestDecodeAll, MessageAndRepeats) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+  irsend.reset();
+  irsend.sendNEC(0x807F40BF, kNECBits, 2);  // A message & two repeat codes.
+  irsend.makeDecodeResult();
+  decoded_message_t messages[4];
+  ASSERT_EQ(3, irrecv.decodeAll(&irsend.capture, messages, 4));
+  // The first one is also left in the usual place.
+  EXPECT_EQ(decode_type_t::NEC, irsend.capture.decode_type);
+  EXPECT_EQ(0x807F40BF, irsend.capture.value);
+
+  EXPECT_EQ(decode_type_t::NEC, messages[0].results.decode_type);
+  EXPECT_EQ(0x807F40BF, messages[0].results.value);
+  EXPECT_FALSE(messages[0].results.repeat);
+  EXPECT_EQ(kStartOffset, messages[0].start);
+  EXPECT_EQ(68, messages[0].end);  // Header, 32 bits, footer mark, & gap.
+  EXPECT_EQ(irsend.output[67], messages[0].gap);
+  for (uint8_t i = 1; i < 3; i++) {
+    EXPECT_EQ(decode_type_t::NEC, messages[i].results.decode_type);
+    EXPECT_TRUE(messages[i].results.repeat);
+    EXPECT_EQ(messages[i - 1].end + 1, messages[i].start);
+    EXPECT_EQ(messages[i].start + 3, messages[i].end);
+  }
+  EXPECT_EQ(irsend.capture.rawlen - 1, messages[2].end);
+  EXPECT_EQ(0, messages[2].gap);
+
+  // Not enough room for them all.
+  irsend.makeDecodeResult();
+  EXPECT_EQ(2, irrecv.decodeAll(&irsend.capture, messages, 2));
+}
+
+TEST(TestDecodeAll, DifferentProtocolsAndJunk) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+  irsend.reset();
+  irsend.sendSAMSUNG(0xE0E09966);
+  // Something undecodable in between.
+  irsend.mark(1000);
+  irsend.space(30000);
+  irsend.sendSony(0x240, kSony12Bits, 0);
+  irsend.sendNEC(0x807F40BF);
+  irsend.makeDecodeResult();
+  decoded_message_t messages[4];
+  ASSERT_EQ(3, irrecv.decodeAll(&irsend.capture, messages, 4));
+  EXPECT_EQ(decode_type_t::SAMSUNG, messages[0].results.decode_type);
+  EXPECT_EQ(0xE0E09966, messages[0].results.value);
+  EXPECT_EQ(decode_type_t::SONY, messages[1].results.decode_type);
+  EXPECT_EQ(0x240, messages[1].results.value);
+  EXPECT_EQ(messages[0].end + 3, messages[1].start);  // Skipped the junk.
+  EXPECT_EQ(decode_type_t::NEC, messages[2].results.decode_type);
+  EXPECT_EQ(0x807F40BF, messages[2].results.value);
+  EXPECT_EQ(messages[1].end + 1, messages[2].start);
+  EXPECT_LT(0, messages[1].gap);
+}
+
+TEST(TestDecodeAll, MultiSectionMessages) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+  const uint8_t state[kDaikinStateLength] = {
+      0x11, 0xDA, 0x27, 0x00, 0xC5, 0x00, 0x00, 0xD7,
+      0x11, 0xDA, 0x27, 0x00, 0x42, 0x3A, 0x05, 0x93,
+      0x11, 0xDA, 0x27, 0x00, 0x00, 0x3F, 0x3A, 0x00, 0xA0, 0x00,
+      0x0A, 0x25, 0x17, 0x01, 0x00, 0xC0, 0x00, 0x00, 0x32};
+  irsend.reset();
+  // Each message has several sections, with gaps between them.
+  irsend.sendDaikin(state, kDaikinStateLength, 1);
+  irsend.makeDecodeResult();
+  decoded_message_t messages[4];
+  ASSERT_EQ(2, irrecv.decodeAll(&irsend.capture, messages, 4));
+  for (uint8_t n = 0; n < 2; n++) {
+    EXPECT_EQ(decode_type_t::DAIKIN, messages[n].results.decode_type);
+    EXPECT_EQ(kDaikinBits, messages[n].results.bits);
+    EXPECT_STATE_EQ(state, messages[n].results.state, kDaikinBits);
+  }
+  EXPECT_EQ(messages[0].end + 1, messages[1].start);
+  EXPECT_EQ(kStartOffset + irsend.capture.rawlen / 2, messages[1].start);
+}
+
+TEST(TestUnknownClustering, SimilarMessagesGetTheSameValue) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+  const uint16_t pattern[15] = {3000, 1100, 450, 650, 540, 1700, 1150, 650,
+                                450, 1700, 450, 650, 1150, 1150, 450};
+  uint16_t jittered[15];
+  memcpy(jittered, pattern, sizeof(pattern));
+  jittered[4] = 580;  // Enough to change the normal hash value.
+  jittered[9] = 1400;
+  uint16_t other[15];
+  memcpy(other, pattern, sizeof(pattern));
+  other[5] = 650;  // A different "button".
+
+  irsend.reset();
+  irsend.sendRaw(pattern, 15, 38);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  ASSERT_EQ(decode_type_t::UNKNOWN, irsend.capture.decode_type);
+  const uint64_t hash = irsend.capture.value;
+  irsend.reset();
+  irsend.sendRaw(jittered, 15, 38);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_NE(hash, irsend.capture.value);  // Normally a different value.
+
+  ASSERT_TRUE(irrecv.enableUnknownClustering(2));
+  irsend.reset();
+  irsend.sendRaw(pattern, 15, 38);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(hash, irsend.capture.value);  // The first one keeps its hash.
+  irsend.reset();
+  irsend.sendRaw(jittered, 15, 38);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(decode_type_t::UNKNOWN, irsend.capture.decode_type);
+  EXPECT_EQ(hash, irsend.capture.value);
+  // A uniformly slower version of it is still the same.
+  irsend.reset();
+  irsend.sendRaw(pattern, 15, 38);
+  irsend.makeDecodeResult();
+  for (uint16_t i = 1; i < irsend.capture.rawlen; i++)
+    irsend.capture.rawbuf[i] += irsend.capture.rawbuf[i] / 10;
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(hash, irsend.capture.value);
+
+  const unknown_cluster_t *cluster = irrecv.getUnknownCluster(hash);
+  ASSERT_NE(nullptr, cluster);
+  EXPECT_EQ(3, cluster->count);
+  EXPECT_EQ(irsend.capture.rawlen - 1, cluster->length);
+  EXPECT_NEAR(3000, cluster->timings[0], 300);
+  EXPECT_NEAR(500, cluster->timings[2], 100);
+
+  // A different message gets its own value.
+  irsend.reset();
+  irsend.sendRaw(other, 15, 38);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(decode_type_t::UNKNOWN, irsend.capture.decode_type);
+  const uint64_t other_id = irsend.capture.value;
+  EXPECT_NE(hash, other_id);
+  ASSERT_NE(nullptr, irrecv.getUnknownCluster(other_id));
+  EXPECT_EQ(1, irrecv.getUnknownCluster(other_id)->count);
+
+  // Only 2 are remembered, so a third replaces the least recently used.
+  irsend.reset();
+  irsend.sendRaw(pattern, 9, 38);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(nullptr, irrecv.getUnknownCluster(hash));
+  EXPECT_NE(nullptr, irrecv.getUnknownCluster(other_id));
+
+  irrecv.disableUnknownClustering();
+  EXPECT_EQ(nullptr, irrecv.getUnknownCluster(other_id));
+}
+
+// Make a capture look like it came from a receiver with a lot of sensor lag.
+static void addSensorLag(decode_results *capture, const uint16_t usecs) {
+  for (uint16_t i = 1; i < capture->rawlen; i++)
+    if (i % 2)  // Mark
+      capture->rawbuf[i] += usecs / kRawTick;
+    else  // Space
+      capture->rawbuf[i] -= usecs / kRawTick;
+}
+
+TEST(TestCalibration, LearnsSensorLag) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+  // Too much lag for the default excess & tolerance.
+  irsend.reset();
+  irsend.sendNEC(0x807F40BF);
+  irsend.makeDecodeResult();
+  addSensorLag(&irsend.capture, 200);
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_NE(decode_type_t::NEC, irsend.capture.decode_type);
+
+  irrecv.enableCalibration();
+  EXPECT_EQ(kMarkExcess, irrecv.getCalibration().mark_excess);
+  EXPECT_EQ(kMarkExcess, irrecv.getCalibration().space_excess);
+  EXPECT_EQ(0, irrecv.getCalibration().samples);
+  // Learn from messages that still (just) decode.
+  for (uint8_t i = 0; i < 10; i++) {
+    irsend.reset();
+    irsend.sendNEC(0x807F40BF);
+    irsend.makeDecodeResult();
+    addSensorLag(&irsend.capture, 150);
+    ASSERT_TRUE(irrecv.decode(&irsend.capture));
+    ASSERT_EQ(decode_type_t::NEC, irsend.capture.decode_type);
+  }
+  EXPECT_EQ(10, irrecv.getCalibration().samples);
+  EXPECT_NEAR(150, irrecv.getCalibration().mark_excess, 20);
+  EXPECT_NEAR(150, irrecv.getCalibration().space_excess, 20);
+  EXPECT_GT(50, irrecv.getCalibration().jitter);  // i.e. < 5%
+
+  // Now the laggier receiver works.
+  irsend.reset();
+  irsend.sendNEC(0x807F40BF);
+  irsend.makeDecodeResult();
+  addSensorLag(&irsend.capture, 200);
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(decode_type_t::NEC, irsend.capture.decode_type);
+  EXPECT_EQ(0x807F40BF, irsend.capture.value);
+
+  // Failed decodes teach it nothing.
+  const ir_calibration_t saved = irrecv.getCalibration();
+  uint16_t junk[8] = {1, 100, 200, 300, 400, 500, 600, 700};
+  decode_results results;
+  results.rawbuf = junk;
+  results.rawlen = 8;
+  results.overflow = false;
+  irrecv.decode(&results);
+  EXPECT_EQ(saved.samples, irrecv.getCalibration().samples);
+
+  // Disabled, it goes back to the usual behaviour, but keeps what it learnt.
+  irrecv.enableCalibration(false);
+  irsend.reset();
+  irsend.sendNEC(0x807F40BF);
+  irsend.makeDecodeResult();
+  addSensorLag(&irsend.capture, 200);
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_NE(decode_type_t::NEC, irsend.capture.decode_type);
+  EXPECT_EQ(saved.mark_excess, irrecv.getCalibration().mark_excess);
+}
+
+// Codes ending in a '0' bit fail to match a '1' bit first. That must not throw
+// away what has been learnt from the rest of the message.
+TEST(TestCalibration, LearnsFromCodesEndingInAZeroBit) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+  irrecv.enableCalibration();
+  const uint64_t codes[2] = {0x807F41BE, 0x20DF01FE};
+  for (uint8_t i = 0; i < 10; i++) {
+    irsend.reset();
+    irsend.sendNEC(codes[i % 2]);
+    irsend.makeDecodeResult();
+    addSensorLag(&irsend.capture, 150);
+    ASSERT_TRUE(irrecv.decode(&irsend.capture));
+    ASSERT_EQ(decode_type_t::NEC, irsend.capture.decode_type);
+    ASSERT_EQ(codes[i % 2], irsend.capture.value);
+  }
+  EXPECT_EQ(10, irrecv.getCalibration().samples);
+  // The excesses are a running average of the starting value (kMarkExcess) &
+  // the 150us of each message. Less a little for the integer maths.
+  const int16_t expected = (kMarkExcess + 10 * 150) / 11;
+  EXPECT_NEAR(expected, irrecv.getCalibration().mark_excess, 3);
+  EXPECT_NEAR(expected, irrecv.getCalibration().space_excess, 3);
+}
+
+// Each mark & space of a bit is sampled once, even when it is tried as both a
+// '1' & a '0' bit.
+TEST(TestCalibration, EachBitIsSampledOnce) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+  irrecv.enableCalibration();
+  irsend.reset();
+  irsend.sendNEC(0x807F41BE);
+  irsend.makeDecodeResult();
+  addSensorLag(&irsend.capture, 150);
+  irrecv._calibrationReset();
+  // NEC's 32 data bits. Marks are 560us. Spaces are 1680us ('1') or 560us.
+  match_result_t result = irrecv.matchData(irsend.capture.rawbuf + 3, 32, 560,
+                                           1680, 560, 560);
+  ASSERT_TRUE(result.success);
+  EXPECT_EQ(0x807F41BE, result.data);
+  EXPECT_EQ(32, irrecv._calibration_marks);
+  EXPECT_EQ(32, irrecv._calibration_spaces);
+  EXPECT_EQ(32 * 150, irrecv._calibration_mark_sum);
+  EXPECT_EQ(32 * 150, irrecv._calibration_space_sum);
+  // A failed match collects nothing from the bit it failed on.
+  irrecv._calibrationReset();
+  irsend.capture.rawbuf[4] = 3000 / kRawTick;  // Neither a '1' nor a '0'.
+  result = irrecv.matchData(irsend.capture.rawbuf + 3, 32, 560, 1680, 560,
+                            560);
+  EXPECT_FALSE(result.success);
+  EXPECT_EQ(0, irrecv._calibration_marks);
+  EXPECT_EQ(0, irrecv._calibration_spaces);
+}
+
+TEST(TestCalibration, ExplicitExcess) {
+  IRrecv irrecv(1);
+  ir_calibration_t saved;
+  saved.mark_excess = 180;
+  saved.space_excess = 180;
+  saved.jitter = 0;
+  saved.samples = 100;
+  irrecv.setCalibration(saved);
+  irrecv.enableCalibration();
+  // A 900us mark (or a 300us space) for a 560us one only matches with the
+  // calibrated excess. Asking for the usual kMarkExcess gets that too.
+  EXPECT_TRUE(irrecv.matchMark(900 / kRawTick, 560));
+  EXPECT_TRUE(irrecv.matchMark(900 / kRawTick, 560, kUseDefTol, kMarkExcess));
+  EXPECT_TRUE(irrecv.matchSpace(300 / kRawTick, 560));
+  EXPECT_TRUE(irrecv.matchSpace(300 / kRawTick, 560, kUseDefTol,
+                                kMarkExcess));
+  // Any other explicit excess isn't replaced.
+  EXPECT_FALSE(irrecv.matchMark(900 / kRawTick, 560, kUseDefTol, 0));
+  EXPECT_FALSE(irrecv.matchSpace(300 / kRawTick, 560, kUseDefTol, 0));
+  // Not calibrating, the default is the usual excess.
+  irrecv.enableCalibration(false);
+  EXPECT_FALSE(irrecv.matchMark(900 / kRawTick, 560));
+  EXPECT_FALSE(irrecv.matchMark(900 / kRawTick, 560, kUseDefTol, kMarkExcess));
+  EXPECT_TRUE(irrecv.matchMark(600 / kRawTick, 560));
+}
+
+TEST(TestCalibration, ExplicitTolerance) {
+  IRrecv irrecv(1);
+  ir_calibration_t saved;
+  saved.mark_excess = 0;
+  saved.space_excess = 0;
+  saved.jitter = 400;  // i.e. Noisy enough for a 40% (max) tolerance.
+  saved.samples = 100;
+  irrecv.setCalibration(saved);
+  // 1350us is 35% over 1000us.
+  EXPECT_FALSE(irrecv.matchMark(1350 / kRawTick, 1000, kTolerance + 5, 0));
+  irrecv.enableCalibration();
+  EXPECT_TRUE(irrecv.matchMark(1350 / kRawTick, 1000, kUseDefTol, 0));
+  // A tolerance widened from the default is widened by as much again.
+  EXPECT_TRUE(irrecv.matchMark(1350 / kRawTick, 1000, kTolerance, 0));
+  EXPECT_TRUE(irrecv.matchMark(1450 / kRawTick, 1000, kTolerance + 5, 0));
+  EXPECT_FALSE(irrecv.matchMark(1500 / kRawTick, 1000, kTolerance + 5, 0));
+  // A tighter one is left alone.
+  EXPECT_FALSE(irrecv.matchMark(1200 / kRawTick, 1000, 10, 0));
+}
+
+TEST(TestCalibration, RestoreSavedValues) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+  ir_calibration_t saved;
+  saved.mark_excess = 180;
+  saved.space_excess = 180;
+  saved.jitter = 0;
+  saved.samples = 100;
+  irrecv.setCalibration(saved);
+  irrecv.enableCalibration();
+  irsend.reset();
+  irsend.sendNEC(0x807F40BF);
+  irsend.makeDecodeResult();
+  addSensorLag(&irsend.capture, 250);
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(decode_type_t::NEC, irsend.capture.decode_type);
+  EXPECT_EQ(0x807F40BF, irsend.capture.value);
+  EXPECT_EQ(101, irrecv.getCalibration().samples);
+  EXPECT_LT(180, irrecv.getCalibration().mark_excess);
+}
+
+// Call repeat() the way loop() would, until it has nothing left to send.
+// Each time it returns, `step` uSeconds pass with the LED off.
+static void runRepeater(IRrecv *irrecv, IRsendTest *irsend,
+                        const uint32_t step = 10) {
+  while (irrecv->repeat(irsend)) irsend->space(step);
+}
+
+// The repeater starts each frame with a space, which leaves the first (mark)
+// slot of the test output unwritten. Give it a known carrier & duty cycle.
+static void primeOutput(IRsendTest *irsend) {
+  irsend->begin();
+  irsend->enableIROut(38000);
+  irsend->mark(0);
+  irsend->reset();
+}
+
+TEST(TestRepeater, CutThrough) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(0);
+  primeOutput(&irsend);
+
+  EXPECT_FALSE(irrecv.repeat(&irsend));  // Not enabled.
+  EXPECT_FALSE(irrecv.enableRepeater(100, 100));  // Delay is too short.
+  ASSERT_TRUE(irrecv.enableRepeater(2000, 100));
+  EXPECT_FALSE(irrecv.repeat(&irsend));  // Nothing received yet.
+
+  // Two 600us marks, 500us apart, are received, with a glitch in each.
+  const uint32_t start = _IRtimer_unittest_now + 10000;
+  irrecv._repeaterEdge(start);
+  irrecv._repeaterEdge(start + 300);  // A 20us space glitch.
+  irrecv._repeaterEdge(start + 320);
+  irrecv._repeaterEdge(start + 600);
+  irrecv._repeaterEdge(start + 1100);
+  irrecv._repeaterEdge(start + 1400);  // A 50us mark glitch.
+  irrecv._repeaterEdge(start + 1450);
+  irrecv._repeaterEdge(start + 1700);
+  _IRtimer_unittest_now = start + 1700;
+  // Nothing is due yet, so it returns straight away, to be called again.
+  EXPECT_TRUE(irrecv.repeat(&irsend));
+  EXPECT_EQ(start + 1700, _IRtimer_unittest_now);
+  EXPECT_EQ(0, irrecv.getRepeaterStats().frames);
+  // They are sent 2ms after they were received, minus the glitches. The frame
+  // is over once the receiver has been quiet for the capture timeout.
+  runRepeater(&irrecv, &irsend);
+  EXPECT_EQ(start + 1700 + kTimeoutMs * 1000, _IRtimer_unittest_now);
+  EXPECT_EQ("f38000d50m0s300m600s500m600s13000", irsend.outputStr());
+  ir_repeater_stats_t stats = irrecv.getRepeaterStats();
+  EXPECT_EQ(1, stats.frames);
+  EXPECT_EQ(2, stats.glitches);
+  EXPECT_EQ(0, stats.late);
+  EXPECT_EQ(0, stats.feedback);
+  EXPECT_FALSE(irrecv.repeat(&irsend));  // Nothing more to send.
+
+  // If we are late getting to it, the whole frame is shifted.
+  irrecv._repeaterEdge(_IRtimer_unittest_now + 1000);
+  irrecv._repeaterEdge(_IRtimer_unittest_now + 1560);
+  irrecv._repeaterEdge(_IRtimer_unittest_now + 2000);
+  irrecv._repeaterEdge(_IRtimer_unittest_now + 2560);
+  _IRtimer_unittest_now += 10000;
+  runRepeater(&irrecv, &irsend);
+  EXPECT_EQ("f38000d50m560s440m560s6000", irsend.outputStr());
+  stats = irrecv.getRepeaterStats();
+  EXPECT_EQ(2, stats.frames);
+  EXPECT_EQ(1, stats.late);
+
+  // Being late for a mark part way through a frame stretches the space before
+  // it, & shifts the rest of the frame.
+  irsend.reset();
+  const uint32_t now = _IRtimer_unittest_now;
+  irrecv._repeaterEdge(now + 1000);
+  irrecv._repeaterEdge(now + 1500);
+  irrecv._repeaterEdge(now + 2000);
+  irrecv._repeaterEdge(now + 2500);
+  runRepeater(&irrecv, &irsend, 300);
+  EXPECT_EQ("f38000d50m0s3000m500s600m500s12900", irsend.outputStr());
+  EXPECT_EQ(3, irrecv.getRepeaterStats().frames);
+  EXPECT_EQ(2, irrecv.getRepeaterStats().late);
+
+  irrecv.disableRepeater();
+  irrecv._repeaterEdge(_IRtimer_unittest_now + 1000);
+  EXPECT_FALSE(irrecv.repeat(&irsend));
+}
+
+TEST(TestRepeater, HeldKeyKeepsRepeating) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(0);
+  primeOutput(&irsend);
+  ASSERT_TRUE(irrecv.enableRepeater());
+  // A held NEC button. i.e. A repeat code every 110ms, for several seconds.
+  for (uint8_t i = 0; i < 30; i++) {
+    const uint32_t now = _IRtimer_unittest_now;
+    irsend.reset();
+    irrecv._repeaterEdge(now);
+    irrecv._repeaterEdge(now + 9000);
+    irrecv._repeaterEdge(now + 11250);
+    irrecv._repeaterEdge(now + 11810);
+    runRepeater(&irrecv, &irsend);
+    EXPECT_EQ("f38000d50m0s2000m9000s2250m560s13000", irsend.outputStr());
+    _IRtimer_unittest_now = now + 110000;
+  }
+  EXPECT_EQ(30, irrecv.getRepeaterStats().frames);
+  EXPECT_EQ(0, irrecv.getRepeaterStats().feedback);
+  irrecv.disableRepeater();
+}
+
+TEST(TestRepeater, FeedbackGuard) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(0);
+  primeOutput(&irsend);
+  ASSERT_TRUE(irrecv.enableRepeater());
+
+  // A real 560us mark, followed by the receiver seeing each edge we send of
+  // it, 100us later. i.e. A feedback loop of echoes.
+  const uint32_t start = _IRtimer_unittest_now;
+  for (uint8_t i = 0; i < 6; i++) {
+    irrecv._repeaterEdge(start + i * 2100);
+    irrecv._repeaterEdge(start + i * 2100 + 560);
+  }
+  runRepeater(&irrecv, &irsend);
+  // The real mark, & the echoes of it, are sent until the 4th echoed edge in a
+  // row. i.e. The end of the 2nd echoed mark.
+  EXPECT_EQ("f38000d50m0s2000m560s1540m560s1540m560s0", irsend.outputStr());
+  EXPECT_EQ(1, irrecv.getRepeaterStats().feedback);
+  EXPECT_EQ(0, irrecv.getRepeaterStats().frames);
+  // Edges are ignored until the receiver has gone quiet.
+  irrecv._repeaterEdge(_IRtimer_unittest_now);
+  EXPECT_FALSE(irrecv.repeat(&irsend));
+
+  // A mark that never ends. e.g. The receiver seeing our own LED continuously.
+  irsend.reset();
+  _IRtimer_unittest_now += kTimeoutMs * 1000;
+  irrecv._repeaterEdge(_IRtimer_unittest_now);
+  runRepeater(&irrecv, &irsend);
+  EXPECT_EQ(2, irrecv.getRepeaterStats().feedback);
+  EXPECT_EQ(0, irrecv.getRepeaterStats().frames);
+  // It gave up on the mark once it was too long to be a real one.
+  EXPECT_EQ(2000, irsend.output[1]);
+  EXPECT_LT(kRepeaterMaxMarkMs * 1000, irsend.output[2]);
+  EXPECT_GE(kRepeaterMaxMarkMs * 1000 + 2000, irsend.output[2]);
+  EXPECT_FALSE(irrecv.repeat(&irsend));
+  irrecv.disableRepeater();
+}
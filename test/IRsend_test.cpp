@@ -379,6 +379,386 @@ TEST(TestLowLevelSend, SpaceNoModulation) {
   EXPECT_EQ("[Off]1000usecs", irsend.low_level_sequence);
 }
 
+// Something (e.g. an interrupt) that stretches any long delay.
+class IRsendStretchedTest : public IRsendLowLevelTest {
+ public:
+  uint32_t stretch;
+
+  explicit IRsendStretchedTest(uint16_t x) : IRsendLowLevelTest(x) {
+    stretch = 0;
+  }
+
+ protected:
+  void _delayMicroseconds(uint32_t usec) {
+    IRsendLowLevelTest::_delayMicroseconds(usec);
+    if (usec > 1000) _IRtimer_unittest_now += stretch;
+  }
+};
+
+TEST(TestTxStats, MeasuredVsRequested) {
+  IRsendStretchedTest irsend(0);
+  ir_tx_stats_t stats[kTxStatsMaxProtocols];
+  ir_tx_interval_t log[8];
+  irsend.begin();
+
+  // Off by default.
+  irsend.send(decode_type_t::NEC, 0x00FF00FF, kNECBits);
+  EXPECT_EQ(0, IRsend::getTxStats(stats, kTxStatsMaxProtocols));
+
+  ASSERT_TRUE(IRsend::enableTxStats(true, 50, 8));
+  irsend.send(decode_type_t::NEC, 0x00FF00FF, kNECBits);
+  ASSERT_EQ(2, IRsend::getTxStats(stats, kTxStatsMaxProtocols));
+  EXPECT_EQ(decode_type_t::UNKNOWN, stats[0].protocol);
+  EXPECT_EQ(0, stats[0].sends);
+  EXPECT_EQ(decode_type_t::NEC, stats[1].protocol);
+  EXPECT_EQ(1, stats[1].sends);
+  // Header, 32 bits & a footer, all with spaces.
+  EXPECT_EQ(2 * (1 + kNECBits + 1), stats[1].intervals);
+  EXPECT_EQ(0, stats[1].overruns);
+  EXPECT_GT(50, stats[1].max_error);
+
+  // Stretch all the long spaces. i.e. The header, the 16 one bits, & the gap.
+  irsend.stretch = 100;
+  irsend.send(decode_type_t::NEC, 0x00FF00FF, kNECBits);
+  ASSERT_EQ(2, IRsend::getTxStats(stats, kTxStatsMaxProtocols));
+  EXPECT_EQ(2, stats[1].sends);
+  EXPECT_EQ(4 * (1 + kNECBits + 1), stats[1].intervals);
+  EXPECT_EQ(1 + 16 + 1, stats[1].overruns);
+  EXPECT_EQ(100, stats[1].max_error);
+  EXPECT_LE(18 * 100, stats[1].total_error);
+  // The log only has the start of the last message.
+  ASSERT_EQ(8, IRsend::getTxLog(log, 8));
+  EXPECT_TRUE(log[0].mark);
+  EXPECT_EQ(8960, log[0].requested);  // i.e. kNecHdrMark
+  EXPECT_FALSE(log[1].mark);
+  EXPECT_EQ(4480, log[1].requested);  // i.e. kNecHdrSpace
+  EXPECT_EQ(4480 + 100, log[1].measured);
+
+  // Not sent via send(), so the protocol is unknown.
+  irsend.stretch = 0;
+  irsend.sendSony(0x123, kSony12Bits, 0);
+  ASSERT_EQ(2, IRsend::getTxStats(stats, kTxStatsMaxProtocols));
+  EXPECT_EQ(1, stats[0].sends);
+  // Header, 12 bits, & the gap after the last bit.
+  EXPECT_EQ(2 * (1 + kSony12Bits) + 1, stats[0].intervals);
+  EXPECT_EQ(2, stats[1].sends);
+
+  IRsend::resetTxStats();
+  ASSERT_EQ(1, IRsend::getTxStats(stats, kTxStatsMaxProtocols));
+  EXPECT_EQ(0, stats[0].sends);
+  EXPECT_EQ(0, IRsend::getTxLog(log, 8));
+
+  IRsend::enableTxStats(false);
+  EXPECT_EQ(0, IRsend::getTxStats(stats, kTxStatsMaxProtocols));
+  EXPECT_EQ(0, IRsend::getTxLog(log, 8));
+}
+
+TEST(TestTimeline, CarrierPeriod) {
+  // 5MHz / 38kHz = 131.58 ticks.
+  EXPECT_EQ(132, IRsend::timelinePeriod(38000));
+  EXPECT_EQ(132, IRsend::timelinePeriod(38));
+  EXPECT_EQ(125, IRsend::timelinePeriod(40000));
+  EXPECT_EQ(5000000, IRsend::timelinePeriod(0));
+}
+
+TEST(TestTimeline, Mark) {
+  ir_timeline_step_t steps[2];
+  const uint32_t period = IRsend::timelinePeriod(38000);
+
+  // 50% duty. 500 ticks is 3 whole periods, and a partial one.
+  ASSERT_EQ(2, IRsend::timelineMark(100, period, period / 2, steps));
+  EXPECT_EQ(66, steps[0].on);
+  EXPECT_EQ(66, steps[0].off);
+  EXPECT_EQ(3, steps[0].count);
+  EXPECT_EQ(66, steps[1].on);
+  EXPECT_EQ(38, steps[1].off);
+  EXPECT_EQ(1, steps[1].count);
+
+  // The last pulse can be cut short.
+  ASSERT_EQ(2, IRsend::timelineMark(110, period, period / 2, steps));
+  EXPECT_EQ(4, steps[0].count);
+  EXPECT_EQ(22, steps[1].on);
+  EXPECT_EQ(0, steps[1].off);
+
+  // Exactly a whole nr. of periods.
+  ASSERT_EQ(1, IRsend::timelineMark(132, 5, 2, steps));
+  EXPECT_EQ(2, steps[0].on);
+  EXPECT_EQ(3, steps[0].off);
+  EXPECT_EQ(132, steps[0].count);
+
+  // No modulation.
+  ASSERT_EQ(1, IRsend::timelineMark(1000, period, period, steps));
+  EXPECT_EQ(5000, steps[0].on);
+  EXPECT_EQ(0, steps[0].off);
+  EXPECT_EQ(1, steps[0].count);
+
+  EXPECT_EQ(0, IRsend::timelineMark(0, period, period / 2, steps));
+
+  // The timeline is always exactly as long as the mark, unless the mark is
+  // shorter than the shortest step.
+  for (uint16_t usec = 1; usec < 2000; usec += 7) {
+    const uint8_t nsteps = IRsend::timelineMark(usec, period, 43, steps);
+    uint32_t total = 0;
+    for (uint8_t n = 0; n < nsteps; n++)
+      total += (steps[n].on + steps[n].off) * steps[n].count;
+    EXPECT_EQ(std::max(usec * kTimelineTicksPerUsec, (int)kTimelineMinTicks),
+              total);
+  }
+}
+
+TEST(TestTimeline, MinimumStep) {
+  ir_timeline_step_t steps[2];
+  const uint32_t period = IRsend::timelinePeriod(38000);  // 132 ticks.
+
+  // A 5 tick partial pulse is added to the off part of the last whole one.
+  // i.e. 665 ticks is 5 whole periods & 5 ticks.
+  ASSERT_EQ(2, IRsend::timelineMark(133, period, period / 2, steps));
+  EXPECT_EQ(66, steps[0].on);
+  EXPECT_EQ(66, steps[0].off);
+  EXPECT_EQ(4, steps[0].count);
+  EXPECT_EQ(66, steps[1].on);
+  EXPECT_EQ(66 + 5, steps[1].off);
+  EXPECT_EQ(1, steps[1].count);
+
+  // A 7 tick off part is added to the pulse before it.
+  // i.e. 205 ticks is 1 whole period, then 66 ticks on & 7 off.
+  ASSERT_EQ(2, IRsend::timelineMark(41, period, period / 2, steps));
+  EXPECT_EQ(1, steps[0].count);
+  EXPECT_EQ(73, steps[1].on);
+  EXPECT_EQ(0, steps[1].off);
+  EXPECT_EQ(1, steps[1].count);
+  ASSERT_EQ(1, IRsend::timelineMark(14, period, period / 2, steps));
+  EXPECT_EQ(70, steps[0].on);
+  EXPECT_EQ(0, steps[0].off);
+
+  // A mark shorter than a step is lengthened.
+  ASSERT_EQ(1, IRsend::timelineMark(1, period, period / 2, steps));
+  EXPECT_EQ(kTimelineMinTicks, steps[0].on);
+  EXPECT_EQ(0, steps[0].off);
+  ASSERT_EQ(1, IRsend::timelineMark(1, period, period, steps));
+  EXPECT_EQ(kTimelineMinTicks, steps[0].on);
+
+  // No part of any partial pulse is ever shorter than the minimum.
+  for (uint32_t hz = 30000; hz <= 58000; hz += 1000) {
+    const uint32_t hz_period = IRsend::timelinePeriod(hz);
+    for (uint8_t duty = 10; duty < kDutyMax; duty += 15) {
+      const uint32_t on = hz_period * duty / kDutyMax;
+      for (uint16_t usec = 1; usec < 1000; usec++) {
+        const uint8_t nsteps = IRsend::timelineMark(usec, hz_period, on, steps);
+        ASSERT_LT(0, nsteps);
+        const ir_timeline_step_t *last = &steps[nsteps - 1];
+        if (last->count != 1 || last->on == on) continue;  // A whole pulse.
+        EXPECT_LE(kTimelineMinTicks, last->on);
+        if (last->off) {
+          EXPECT_LE(kTimelineMinTicks, last->off);
+        }
+      }
+    }
+  }
+
+  // Spaces.
+  ASSERT_EQ(1, IRsend::timelineSpace(1, steps));
+  EXPECT_EQ(kTimelineMinTicks, steps[0].off);
+  ASSERT_EQ(1, IRsend::timelineSpace(kTimelineMaxStepUsec + 1, steps));
+  EXPECT_EQ(kTimelineMaxStepUsec * kTimelineTicksPerUsec + 5, steps[0].off);
+  EXPECT_EQ(1, steps[0].count);
+  EXPECT_GT(1UL << 23, steps[0].off);
+  ASSERT_EQ(2, IRsend::timelineSpace(3 * kTimelineMaxStepUsec + 1, steps));
+  EXPECT_EQ(2, steps[0].count);
+  EXPECT_EQ(kTimelineMaxStepUsec * kTimelineTicksPerUsec + 5, steps[1].off);
+}
+
+TEST(TestTimeline, Space) {
+  ir_timeline_step_t steps[2];
+  ASSERT_EQ(1, IRsend::timelineSpace(100000, steps));
+  EXPECT_EQ(0, steps[0].on);
+  EXPECT_EQ(500000, steps[0].off);
+  EXPECT_EQ(1, steps[0].count);
+  EXPECT_EQ(0, IRsend::timelineSpace(0, steps));
+
+  // Long spaces are split up to fit in the ESP8266's 23 bit timer.
+  ASSERT_EQ(2, IRsend::timelineSpace(3500000, steps));
+  EXPECT_EQ(0, steps[0].on);
+  EXPECT_EQ(kTimelineMaxStepUsec * kTimelineTicksPerUsec, steps[0].off);
+  EXPECT_GT(1UL << 23, steps[0].off);
+  EXPECT_EQ(3, steps[0].count);
+  EXPECT_EQ(0, steps[1].on);
+  EXPECT_EQ(2500000, steps[1].off);
+  EXPECT_EQ(1, steps[1].count);
+  ASSERT_EQ(1, IRsend::timelineSpace(2 * kTimelineMaxStepUsec, steps));
+  EXPECT_EQ(2, steps[0].count);
+  // Even the longest space doesn't overflow.
+  ASSERT_EQ(2, IRsend::timelineSpace(UINT32_MAX, steps));
+  EXPECT_EQ(UINT32_MAX / kTimelineMaxStepUsec, steps[0].count);
+  EXPECT_EQ((UINT32_MAX % kTimelineMaxStepUsec) * kTimelineTicksPerUsec,
+            steps[1].off);
+}
+
+TEST(TestSendSymbols, EncodeAndSend) {
+  IRsendTest irsend(0);
+  irsend.begin();
+  // An NEC message.
+  const uint16_t raw[67] = {
+      9000, 4500, 560, 560, 560, 560, 560, 1690, 560, 560, 560, 560, 560, 560,
+      560, 560, 560, 560, 560, 1690, 560, 1690, 560, 560, 560, 1690, 560, 1690,
+      560, 1690, 560, 1690, 560, 1690, 560, 560, 560, 1690, 560, 560, 560, 560,
+      560, 560, 560, 560, 560, 560, 560, 560, 560, 1690, 560, 560, 560, 1690,
+      560, 1690, 560, 1690, 560, 1690, 560, 1690, 560, 1690, 560};
+  ir_symbol_frame_t frame;
+  uint16_t durations[kSymbolsMaxDurations];
+  uint8_t symbols[20];
+
+  // Not enough room.
+  EXPECT_FALSE(IRsend::encodeSymbols(raw, 67, 38000, &frame, durations,
+                                     symbols, 16));
+  ASSERT_TRUE(IRsend::encodeSymbols(raw, 67, 38000, &frame, durations,
+                                    symbols, sizeof(symbols)));
+  EXPECT_EQ(38000, frame.hz);
+  EXPECT_EQ(67, frame.length);
+  EXPECT_EQ(4, frame.nr_durations);
+  EXPECT_EQ(2, frame.bits);
+  EXPECT_EQ(17, IRsend::symbolsSize(frame.length, frame.bits));
+  EXPECT_EQ(9000, frame.durations[0]);
+  EXPECT_EQ(4500, frame.durations[1]);
+  EXPECT_EQ(560, frame.durations[2]);
+  EXPECT_EQ(1690, frame.durations[3]);
+
+  irsend.reset();
+  irsend.sendRaw(raw, 67, 38000);
+  const std::string expected = irsend.outputStr();
+  irsend.reset();
+  irsend.sendSymbols(&frame);
+  EXPECT_EQ(expected, irsend.outputStr());
+}
+
+TEST(TestSendSymbols, Tolerance) {
+  IRsendTest irsend(0);
+  irsend.begin();
+  // A captured message, with some jitter.
+  const uint16_t raw[11] = {3010, 2990, 480, 1510, 520, 490, 505, 1495, 500,
+                            3000, 495};
+  ir_symbol_frame_t frame;
+  uint16_t durations[kSymbolsMaxDurations];
+  uint8_t symbols[8];
+
+  ASSERT_TRUE(IRsend::encodeSymbols(raw, 11, 38, &frame, durations, symbols,
+                                    sizeof(symbols)));
+  EXPECT_EQ(11, frame.nr_durations);
+  EXPECT_EQ(4, frame.bits);
+
+  ASSERT_TRUE(IRsend::encodeSymbols(raw, 11, 38, &frame, durations, symbols,
+                                    sizeof(symbols), 10));
+  EXPECT_EQ(3, frame.nr_durations);
+  EXPECT_EQ(2, frame.bits);
+  irsend.reset();
+  irsend.sendSymbols(&frame);
+  EXPECT_EQ(
+      "f38000d50"
+      "m3000s3000m498s1503m498s498m498s1503m498s3000m498",
+      irsend.outputStr());
+
+  // Too many distinct durations.
+  uint16_t many[kSymbolsMaxDurations + 1];
+  for (uint16_t n = 0; n <= kSymbolsMaxDurations; n++) many[n] = 100 * (n + 1);
+  EXPECT_FALSE(IRsend::encodeSymbols(many, kSymbolsMaxDurations + 1, 38,
+                                     &frame, durations, symbols,
+                                     sizeof(symbols)));
+}
+
+TEST(TestSendSymbols, AppendSymbol) {
+  IRsendTest irsend(0);
+  irsend.begin();
+  const uint16_t raw[11] = {3000, 3000, 500, 1500, 500, 500, 500, 1500, 500,
+                            3000, 500};
+  ir_symbol_frame_t frame;
+  uint16_t durations[kSymbolsMaxDurations];
+  uint8_t symbols[6];
+  frame.hz = 38;
+  frame.length = 0;
+  frame.bits = 4;
+  frame.nr_durations = 0;
+  frame.durations = durations;
+  frame.symbols = symbols;
+  for (uint16_t i = 0; i < 11; i++)
+    ASSERT_TRUE(IRsend::appendSymbol(&frame, durations, symbols,
+                                     sizeof(symbols), raw[i]));
+  EXPECT_EQ(11, frame.length);
+  EXPECT_EQ(3, frame.nr_durations);
+  irsend.reset();
+  irsend.sendRaw(raw, 11, 38);
+  const std::string expected = irsend.outputStr();
+  irsend.reset();
+  irsend.sendSymbols(&frame);
+  EXPECT_EQ(expected, irsend.outputStr());
+
+  // Full. i.e. 12 x 4 bit symbols fit in 6 bytes.
+  EXPECT_FALSE(IRsend::appendSymbol(&frame, durations, symbols, 5, 1500));
+  EXPECT_EQ(11, frame.length);
+  ASSERT_TRUE(IRsend::appendSymbol(&frame, durations, symbols, 6, 1500));
+  EXPECT_FALSE(IRsend::appendSymbol(&frame, durations, symbols, 6, 500));
+  EXPECT_EQ(12, frame.length);
+
+  // Too many distinct durations for the nr. of bits.
+  frame.length = 0;
+  frame.bits = 1;
+  frame.nr_durations = 0;
+  EXPECT_TRUE(IRsend::appendSymbol(&frame, durations, symbols, 6, 100));
+  EXPECT_TRUE(IRsend::appendSymbol(&frame, durations, symbols, 6, 200));
+  EXPECT_TRUE(IRsend::appendSymbol(&frame, durations, symbols, 6, 100));
+  EXPECT_FALSE(IRsend::appendSymbol(&frame, durations, symbols, 6, 300));
+  EXPECT_EQ(3, frame.length);
+  EXPECT_EQ(2, frame.nr_durations);
+}
+
+TEST(TestSendSymbols, AppendSymbolWithTolerance) {
+  // A captured message. i.e. No duration is repeated exactly.
+  const uint16_t raw[11] = {2990, 3012, 510, 1490, 498, 502, 520, 1512, 494,
+                            2980, 506};
+  ir_symbol_frame_t frame;
+  uint16_t durations[kSymbolsMaxDurations];
+  ir_symbol_totals_t totals;
+  uint8_t symbols[6];
+  frame.hz = 38;
+  frame.length = 0;
+  frame.bits = 4;
+  frame.nr_durations = 0;
+  frame.durations = durations;
+  frame.symbols = symbols;
+  // Exact matching needs an entry for every duration.
+  for (uint16_t i = 0; i < 11; i++)
+    ASSERT_TRUE(IRsend::appendSymbol(&frame, durations, symbols,
+                                     sizeof(symbols), raw[i]));
+  EXPECT_EQ(11, frame.nr_durations);
+
+  frame.length = 0;
+  frame.nr_durations = 0;
+  for (uint16_t i = 0; i < 11; i++)
+    ASSERT_TRUE(IRsend::appendSymbol(&frame, durations, symbols,
+                                     sizeof(symbols), raw[i], kTolerance,
+                                     &totals));
+  EXPECT_EQ(11, frame.length);
+  ASSERT_EQ(3, frame.nr_durations);
+  // Each entry is the average of the durations sharing it.
+  EXPECT_EQ(2994, durations[0]);  // (2990 + 3012 + 2980) / 3
+  EXPECT_EQ(505, durations[1]);  // (510 + 498 + 502 + 520 + 494 + 506) / 6
+  EXPECT_EQ(1501, durations[2]);  // (1490 + 1512) / 2
+  // The same as building it from the whole message at once.
+  ir_symbol_frame_t whole;
+  uint16_t whole_durations[kSymbolsMaxDurations];
+  uint8_t whole_symbols[6];
+  ASSERT_TRUE(IRsend::encodeSymbols(raw, 11, 38, &whole, whole_durations,
+                                    whole_symbols, sizeof(whole_symbols),
+                                    kTolerance));
+  IRsendTest irsend(0);
+  irsend.begin();
+  irsend.reset();
+  irsend.sendSymbols(&whole);
+  const std::string expected = irsend.outputStr();
+  irsend.reset();
+  irsend.sendSymbols(&frame);
+  EXPECT_EQ(expected, irsend.outputStr());
+}
+
 // Test expected to work/produce a message for simple irsend:send()
 TEST(TestSend, GenericSimpleSendMethod) {
   IRsendTest irsend(0);
@@ -863,3 +1243,88 @@ TEST(TestSendManchester, SendOverLargeData) {
       "m300",
       irsend.outputStr());
 }
+
+// Tests for IRsendMulti.
+
+// Records each mark/space along with the GPIO mask it was sent out of.
+class IRsendMultiTest : public IRsendMulti {
+ public:
+  std::ostringstream log;
+
+  IRsendMultiTest(const uint16_t pins[], const uint8_t npins)
+      : IRsendMulti(pins, npins) {}
+
+  uint16_t mark(uint16_t usec) {
+    log << "m" << usec << "@" << std::hex << getOutputMask() << std::dec;
+    return 0;
+  }
+
+  void space(uint32_t usec) { log << "s" << usec; }
+
+  std::string outputStr() {
+    std::string result = log.str();
+    log.str("");
+    return result;
+  }
+};
+
+TEST(TestIRsendMulti, PinHandling) {
+  const uint16_t pins[3] = {4, 40, 14};  // 40 is out of range.
+  IRsendMultiTest irsend(pins, 3);
+  irsend.begin();
+  EXPECT_EQ(2, irsend.getPinCount());
+  EXPECT_EQ(0b11, irsend.getActivePins());
+  EXPECT_EQ((1UL << 4) | (1UL << 14), irsend.getOutputMask());
+  irsend.setActivePins(0b10);
+  EXPECT_EQ(0b10, irsend.getActivePins());
+  EXPECT_EQ(1UL << 14, irsend.getOutputMask());
+  irsend.setActivePins(0xFF);  // Can't enable pins we don't have.
+  EXPECT_EQ(0b11, irsend.getActivePins());
+}
+
+TEST(TestIRsendMulti, SameMessageToAllPins) {
+  const uint16_t pins[2] = {4, 5};
+  IRsendMultiTest irsend(pins, 2);
+  irsend.begin();
+  irsend.sendData(1, 2, 3, 4, 0b10, 2, true);
+  EXPECT_EQ("m1@30s2m3@30s4", irsend.outputStr());
+}
+
+TEST(TestIRsendMulti, InterleavedRawMessages) {
+  const uint16_t pins[2] = {0, 1};
+  IRsendMultiTest irsend(pins, 2);
+  irsend.begin();
+  const uint16_t a[3] = {100, 50, 100};
+  const uint16_t b[5] = {150, 50, 30, 20, 20};
+  const uint16_t *bufs[2] = {a, b};
+  const uint16_t lens[2] = {3, 5};
+  irsend.sendRawMulti(bufs, lens, 2, 38000);
+  EXPECT_EQ(
+      "m100@3"  // Both marking.
+      "m50@2"   // Only the second.
+      "m50@1"   // Only the first.
+      "m30@3"   // Both again.
+      "m20@1"   // Only the first.
+      "m20@2",  // Only the second to finish.
+      irsend.outputStr());
+  // Restrict to just the second pin.
+  irsend.setActivePins(0b10);
+  irsend.sendRawMulti(bufs, lens, 2, 38000);
+  EXPECT_EQ("m150@2s50m30@2s20m20@2", irsend.outputStr());
+  EXPECT_EQ(0b10, irsend.getActivePins());
+  EXPECT_EQ(0b10UL, irsend.getOutputMask());
+}
+
+TEST(TestIRsendMulti, UnevenLengths) {
+  const uint16_t pins[2] = {0, 1};
+  IRsendMultiTest irsend(pins, 2);
+  const uint16_t a[2] = {10, 1000};
+  const uint16_t b[1] = {20};
+  const uint16_t *bufs[2] = {a, b};
+  const uint16_t lens[2] = {2, 1};
+  irsend.sendRawMulti(bufs, lens, 2, 38000);
+  EXPECT_EQ("m10@3m10@2s990", irsend.outputStr());
+  const uint16_t no_lens[2] = {0, 0};
+  irsend.sendRawMulti(bufs, no_lens, 2, 38000);
+  EXPECT_EQ("", irsend.outputStr());
+}
@@ -401,6 +401,61 @@ TEST(TestStrToDecodeType, strToDecodeType) {
   EXPECT_EQ(decode_type_t::NEC, strToDecodeType("NEC"));
   EXPECT_EQ(decode_type_t::KELVINATOR, strToDecodeType("KELVINATOR"));
   EXPECT_EQ(decode_type_t::UNKNOWN, strToDecodeType("foo"));
+  // Case insensitive.
+  EXPECT_EQ(decode_type_t::NEC, strToDecodeType("nec"));
+  EXPECT_EQ(decode_type_t::MITSUBISHI_HEAVY_152,
+            strToDecodeType("Mitsubishi_Heavy_152"));
+  // Numbers.
+  EXPECT_EQ(decode_type_t::NEC, strToDecodeType("3"));
+  EXPECT_EQ(kLastDecodeType,
+            strToDecodeType(uint64ToString(kLastDecodeType).c_str()));
+  EXPECT_EQ(decode_type_t::UNKNOWN, strToDecodeType("0"));
+  EXPECT_EQ(decode_type_t::UNKNOWN, strToDecodeType("-1"));
+  EXPECT_EQ(decode_type_t::UNKNOWN,
+            strToDecodeType(uint64ToString(kLastDecodeType + 1).c_str()));
+  // Big numbers must not wrap/truncate into a valid type.
+  EXPECT_EQ(decode_type_t::UNKNOWN, strToDecodeType("65539"));  // 0x10003
+  EXPECT_EQ(decode_type_t::UNKNOWN, strToDecodeType("4294967299"));
+  EXPECT_EQ(decode_type_t::UNKNOWN, strToDecodeType(""));
+}
+
+TEST(TestUtils, textHash) {
+  EXPECT_EQ(irutils::kTextHashSeed, irutils::textHash(""));
+  EXPECT_EQ(irutils::textHashConst("NEC"), irutils::textHash("NEC"));
+  EXPECT_EQ(irutils::textHash("NEC"), irutils::textHash("nEc"));
+  EXPECT_NE(irutils::textHash("NEC"), irutils::textHash("NEC2"));
+  EXPECT_EQ(irutils::textHashConst("Fan Only"),
+            irutils::textHash("fan only"));
+  // Evaluated at compile time.
+  static_assert(irutils::textHashConst("Auto") ==
+                irutils::textHashConst("AUTO"), "textHashConst() failed");
+}
+
+TEST(TestUtils, timingClass) {
+  uint32_t classes[3];
+  uint16_t count = 0;
+  // A percentage tolerance.
+  EXPECT_EQ(0, irutils::timingClass(560, classes, &count, 3, 25));
+  EXPECT_EQ(1, irutils::timingClass(1690, classes, &count, 3, 25));
+  EXPECT_EQ(0, irutils::timingClass(700, classes, &count, 3, 25));
+  EXPECT_EQ(1, irutils::timingClass(1300, classes, &count, 3, 25));
+  EXPECT_EQ(2, irutils::timingClass(701, classes, &count, 3, 25));
+  EXPECT_EQ(3, count);
+  EXPECT_EQ(560, classes[0]);  // The first one seen defines the class.
+  EXPECT_EQ(1690, classes[1]);
+  EXPECT_EQ(701, classes[2]);
+  // No room for a new class.
+  EXPECT_EQ(-1, irutils::timingClass(9000, classes, &count, 3, 25));
+  EXPECT_EQ(3, count);
+  // A fixed delta.
+  count = 0;
+  EXPECT_EQ(0, irutils::timingClass(4500, classes, &count, 3, 0, 200));
+  EXPECT_EQ(0, irutils::timingClass(4300, classes, &count, 3, 0, 200));
+  EXPECT_EQ(1, irutils::timingClass(4299, classes, &count, 3, 0, 200));
+  EXPECT_EQ(0, irutils::timingClass(4700, classes, &count, 3, 0, 200));
+  // Nothing but an exact match.
+  EXPECT_EQ(2, irutils::timingClass(4501, classes, &count, 3, 0));
+  EXPECT_EQ(2, irutils::timingClass(4501, classes, &count, 3, 0));
 }
 
 TEST(TestUtils, htmlEscape) {
@@ -794,3 +849,94 @@ TEST(TestUtils, VersionDefines) {
                          _IRREMOTEESP8266_VERSION_PATCH;
   ASSERT_EQ(_IRREMOTEESP8266_VERSION, version_int);
 }
+
+TEST(TestIRvalueParser, ParseIntoFixedBuffer) {
+  uint16_t values[8];
+  ASSERT_EQ(5, IRvalueParser::parse("38000,1,1,170,170", values, 8));
+  EXPECT_EQ(38000, values[0]);
+  EXPECT_EQ(1, values[1]);
+  EXPECT_EQ(170, values[4]);
+  // Whitespace & empty fields are just separators.
+  ASSERT_EQ(3, IRvalueParser::parse(" 1, 2\r\n,,3 ", values, 8));
+  EXPECT_EQ(1, values[0]);
+  EXPECT_EQ(2, values[1]);
+  EXPECT_EQ(3, values[2]);
+  // Hexadecimal. e.g. Pronto codes.
+  ASSERT_EQ(4, IRvalueParser::parse("0000 006C 0022 0002", values, 8, 16));
+  EXPECT_EQ(0x0000, values[0]);
+  EXPECT_EQ(0x006C, values[1]);
+  EXPECT_EQ(0x0022, values[2]);
+  ASSERT_EQ(1, IRvalueParser::parse("ffff", values, 8, 16));
+  EXPECT_EQ(0xFFFF, values[0]);
+  // With "0x" prefixes.
+  ASSERT_EQ(4, IRvalueParser::parse("0x0000,0x006D 0X0022,0", values, 8, 16));
+  EXPECT_EQ(0x0000, values[0]);
+  EXPECT_EQ(0x006D, values[1]);
+  EXPECT_EQ(0x0022, values[2]);
+  EXPECT_EQ(0x0000, values[3]);
+  EXPECT_EQ(0, IRvalueParser::parse("0x", values, 8, 16));
+  EXPECT_EQ(0, IRvalueParser::parse("0x,1", values, 8, 16));
+  EXPECT_EQ(0, IRvalueParser::parse("00x1", values, 8, 16));
+  EXPECT_EQ(0, IRvalueParser::parse("0x0x1", values, 8, 16));
+  EXPECT_EQ(0, IRvalueParser::parse("0x1", values, 8));  // Only for base 16.
+  // Nothing to parse.
+  EXPECT_EQ(0, IRvalueParser::parse("", values, 8));
+  EXPECT_EQ(0, IRvalueParser::parse(" , ", values, 8));
+  // Malformed text.
+  EXPECT_EQ(0, IRvalueParser::parse("1,2,x", values, 8));
+  EXPECT_EQ(0, IRvalueParser::parse("1,-2", values, 8));
+  EXPECT_EQ(0, IRvalueParser::parse("12A", values, 8));
+  // Values too large.
+  ASSERT_EQ(1, IRvalueParser::parse("65535", values, 8));
+  EXPECT_EQ(65535, values[0]);
+  EXPECT_EQ(0, IRvalueParser::parse("65536", values, 8));
+  EXPECT_EQ(0, IRvalueParser::parse("10000000000000000000000", values, 8));
+  // Too many values for the buffer.
+  EXPECT_EQ(0, IRvalueParser::parse("1,2,3", values, 2));
+  EXPECT_EQ(2, IRvalueParser::parse("1,2", values, 2));
+}
+
+TEST(TestIRvalueParser, Incremental) {
+  IRvalueParser parser;
+  const char *text = "12,345 6";
+  // Fed a character at a time. e.g. From a network stream.
+  EXPECT_FALSE(parser.feed('1'));
+  EXPECT_FALSE(parser.feed('2'));
+  EXPECT_TRUE(parser.feed(','));
+  EXPECT_EQ(12, parser.value());
+  EXPECT_FALSE(parser.feed('3'));
+  EXPECT_TRUE(parser.feed('\n'));
+  EXPECT_EQ(3, parser.value());
+  EXPECT_FALSE(parser.feed('\n'));
+  EXPECT_FALSE(parser.feed('4'));
+  EXPECT_TRUE(parser.end());
+  EXPECT_EQ(4, parser.value());
+  EXPECT_FALSE(parser.end());
+  EXPECT_FALSE(parser.error());
+  // Errors are sticky until a reset.
+  EXPECT_FALSE(parser.feed('!'));
+  EXPECT_TRUE(parser.error());
+  EXPECT_FALSE(parser.feed('5'));
+  EXPECT_FALSE(parser.feed(','));
+  EXPECT_FALSE(parser.end());
+  parser.reset();
+  EXPECT_FALSE(parser.error());
+  // Pulled from a C-style string.
+  ASSERT_TRUE(parser.next(&text));
+  EXPECT_EQ(12, parser.value());
+  EXPECT_STREQ("345 6", text);
+  ASSERT_TRUE(parser.next(&text));
+  EXPECT_EQ(345, parser.value());
+  ASSERT_TRUE(parser.next(&text));
+  EXPECT_EQ(6, parser.value());
+  EXPECT_STREQ("", text);
+  EXPECT_FALSE(parser.next(&text));
+  EXPECT_FALSE(parser.error());
+  // A larger maximum value.
+  IRvalueParser big(10, UINT32_MAX);
+  const char *large = "4294967295,4294967296";
+  ASSERT_TRUE(big.next(&large));
+  EXPECT_EQ(UINT32_MAX, big.value());
+  EXPECT_FALSE(big.next(&large));
+  EXPECT_TRUE(big.error());
+}
@@ -326,3 +326,37 @@ TEST(TestIRAirtonAcClass, Econo) {
   ac.setRaw(0xE5C900000911D3);
   EXPECT_TRUE(ac.getEcono());
 }
+
+// Tests for IRAirtonAcView.
+
+TEST(TestIRAirtonAcView, KnownState) {
+  const char expected[] =
+      "Power: On, Mode: 4 (Heat), Fan: 0 (Auto), Temp: 25C, "
+      "Swing(V): Off, Econo: Off, Turbo: Off, Light: Off, "
+      "Health: Off, Sleep: Off";
+  const IRAirtonAcView view(0x5E1400090C11D3);
+  EXPECT_EQ(expected, view.toString());
+  stdAc::state_t r = view.toCommon();
+  EXPECT_EQ(decode_type_t::AIRTON, r.protocol);
+  EXPECT_TRUE(r.power);
+  EXPECT_EQ(stdAc::opmode_t::kHeat, r.mode);
+  EXPECT_TRUE(r.celsius);
+  EXPECT_EQ(25, r.degrees);
+  EXPECT_EQ(stdAc::fanspeed_t::kAuto, r.fanspeed);
+  EXPECT_EQ(stdAc::swingv_t::kOff, r.swingv);
+  EXPECT_FALSE(r.econo);
+  EXPECT_FALSE(r.turbo);
+  EXPECT_FALSE(r.filter);
+  EXPECT_FALSE(r.light);
+  EXPECT_EQ(-1, r.sleep);
+
+  // IRAcUtils uses the view on a decode's value.
+  decode_results decode;
+  decode.decode_type = decode_type_t::AIRTON;
+  decode.bits = kAirtonBits;
+  decode.value = 0x5E1400090C11D3;
+  EXPECT_EQ(expected, IRAcUtils::resultAcToString(&decode));
+  ASSERT_TRUE(IRAcUtils::decodeToState(&decode, &r));
+  EXPECT_EQ(stdAc::opmode_t::kHeat, r.mode);
+  EXPECT_EQ(25, r.degrees);
+}
@@ -349,3 +349,32 @@ TEST(TestAmcorAcClass, Max) {
   EXPECT_EQ("Power: On, Mode: 2 (Heat), Fan: 1 (Low), Temp: 32C, Max: On",
             ac.toString());
 }
+
+// Tests for IRAmcorAcView.
+
+TEST(TestAmcorAcView, KnownState) {
+  const char expected[] =
+      "Power: On, Mode: 2 (Heat), Fan: 1 (Low), Temp: 32C, Max: On";
+  // Real data, deliberately not aligned, as the view has no such needs.
+  const uint8_t buffer[kAmcorStateLength + 1] = {
+      0x00, 0x01, 0x12, 0x40, 0x00, 0x00, 0x30, 0x03, 0x0E};
+  const IRAmcorAcView view(buffer + 1);
+  EXPECT_EQ(expected, view.toString());
+  stdAc::state_t r = view.toCommon();
+  EXPECT_EQ(decode_type_t::AMCOR, r.protocol);
+  EXPECT_TRUE(r.power);
+  EXPECT_EQ(stdAc::opmode_t::kHeat, r.mode);
+  EXPECT_TRUE(r.celsius);
+  EXPECT_EQ(32, r.degrees);
+  EXPECT_EQ(stdAc::fanspeed_t::kMin, r.fanspeed);
+
+  // IRAcUtils uses the view on a decode's state.
+  decode_results decode;
+  decode.decode_type = decode_type_t::AMCOR;
+  decode.bits = kAmcorBits;
+  std::memcpy(decode.state, buffer + 1, kAmcorStateLength);
+  EXPECT_EQ(expected, IRAcUtils::resultAcToString(&decode));
+  ASSERT_TRUE(IRAcUtils::decodeToState(&decode, &r));
+  EXPECT_EQ(stdAc::opmode_t::kHeat, r.mode);
+  EXPECT_EQ(32, r.degrees);
+}
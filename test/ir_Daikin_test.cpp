@@ -935,6 +935,33 @@ TEST(TestDecodeDaikin, LongSyntheticExample) {
       "On Timer: 21:30, Off Timer: 06:10, Weekly Timer: On", ac.toString());
 }
 
+// A bad checksum in the first section should stop a strict decode there.
+TEST(TestDecodeDaikin, BadSectionChecksum) {
+  IRsendTest irsend(kGpioUnused);
+  IRrecv irrecv(kGpioUnused);
+  irsend.begin();
+
+  uint8_t state[kDaikinStateLength] = {
+      0x11, 0xDA, 0x27, 0x00, 0xC5, 0x00, 0x00, 0xD7,
+      0x11, 0xDA, 0x27, 0x00, 0x42, 0x3A, 0x05, 0x93,
+      0x11, 0xDA, 0x27, 0x00, 0x00, 0x3F, 0x3A, 0x00, 0xA0, 0x00,
+      0x0A, 0x25, 0x17, 0x01, 0x00, 0xC0, 0x00, 0x00, 0x32};
+  for (uint8_t section = 0; section < 3; section++) {
+    // Corrupt each section's checksum byte in turn.
+    const uint8_t byte[3] = {kDaikinByteChecksum1, kDaikinByteChecksum2,
+                             kDaikinStateLength - 1};
+    state[byte[section]]++;
+    irsend.reset();
+    irsend.sendDaikin(state);
+    irsend.makeDecodeResult();
+    EXPECT_FALSE(irrecv.decodeDaikin(&irsend.capture));
+    EXPECT_TRUE(irrecv.decodeDaikin(&irsend.capture, kStartOffset,
+                                    kDaikinBits, false));
+    EXPECT_EQ(DAIKIN, irsend.capture.decode_type);
+    state[byte[section]]--;
+  }
+}
+
 // Test decoding a message captured from a real IR remote.
 TEST(TestDecodeDaikin2, RealExample) {
   IRsendTest irsend(kGpioUnused);
@@ -1999,6 +2026,53 @@ TEST(TestDaikinClass, toCommon) {
   ASSERT_EQ(-1, ac.toCommon().clock);
 }
 
+// Tests for IRDaikinESPView.
+
+TEST(TestDaikinView, KnownState) {
+  const char expected[] =
+      "Power: On, Mode: 3 (Cool), Temp: 29C, Fan: 10 (Auto), Powerful: On, "
+      "Quiet: Off, Sensor: Off, Mould: Off, Comfort: Off, "
+      "Swing(H): Off, Swing(V): Off, "
+      "Clock: 22:18, Day: 0 (UNKNOWN), "
+      "On Timer: 21:30, Off Timer: 06:10, Weekly Timer: On";
+  // Real data (Captured by @sillyfrog), deliberately not aligned, as the view
+  // has no such needs.
+  const uint8_t buffer[kDaikinStateLength + 1] = {
+      0x00,
+      0x11, 0xDA, 0x27, 0x00, 0xC5, 0x00, 0x00, 0xD7,
+      0x11, 0xDA, 0x27, 0x00, 0x42, 0x3A, 0x05, 0x93, 0x11,
+      0xDA, 0x27, 0x00, 0x00, 0x3F, 0x3A, 0x00, 0xA0, 0x00,
+      0x0A, 0x25, 0x17, 0x01, 0x00, 0xC0, 0x00, 0x00, 0x32};
+  const IRDaikinESPView view(buffer + 1);
+  EXPECT_EQ(expected, view.toString());
+  EXPECT_EQ(29, view.getTemp());
+  EXPECT_EQ(kDaikinFanAuto, view.getFan());
+  stdAc::state_t r = view.toCommon();
+  EXPECT_EQ(decode_type_t::DAIKIN, r.protocol);
+  EXPECT_TRUE(r.power);
+  EXPECT_EQ(stdAc::opmode_t::kCool, r.mode);
+  EXPECT_TRUE(r.celsius);
+  EXPECT_EQ(29, r.degrees);
+  EXPECT_EQ(stdAc::fanspeed_t::kAuto, r.fanspeed);
+  EXPECT_EQ(stdAc::swingv_t::kOff, r.swingv);
+  EXPECT_EQ(stdAc::swingh_t::kOff, r.swingh);
+  EXPECT_TRUE(r.turbo);
+  EXPECT_FALSE(r.quiet);
+  EXPECT_FALSE(r.clean);
+  EXPECT_FALSE(r.econo);
+
+  // IRAcUtils uses the view on a decode's state.
+  decode_results decode;
+  decode.decode_type = decode_type_t::DAIKIN;
+  decode.bits = kDaikinBits;
+  std::memcpy(decode.state, buffer + 1, kDaikinStateLength);
+  EXPECT_EQ(expected, IRAcUtils::resultAcToString(&decode));
+  ASSERT_TRUE(IRAcUtils::decodeToState(&decode, &r));
+  EXPECT_EQ(stdAc::opmode_t::kCool, r.mode);
+  EXPECT_EQ(29, r.degrees);
+  EXPECT_TRUE(r.turbo);
+}
+
 TEST(TestDaikin2Class, toCommon) {
   IRDaikin2 ac(kGpioUnused);
   ac.setPower(true);
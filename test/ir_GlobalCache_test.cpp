@@ -71,3 +71,61 @@ TEST(TestSendGlobalCache, RepeatCode) {
       "m8866s2210m546s94822",
       irsend.outputStr());
 }
+
+// Test compileGC() & send(compiled) send the same as sendGC().
+TEST(TestCompileGlobalCache, SendsTheSameAsSendGC) {
+  IRsendTest irsend(4);
+  irsend.begin();
+
+  // Sherwood (NEC-like) "Power On" from Global Cache with 2 repeats
+  uint16_t gc_test[75] = {
+      38000, 2,  69, 341, 171, 21, 64, 21, 64, 21, 21,   21,  21, 21, 21,
+      21,    21, 21, 21,  21,  64, 21, 64, 21, 21, 21,   64,  21, 21, 21,
+      21,    21, 21, 21,  64,  21, 21, 21, 64, 21, 21,   21,  21, 21, 21,
+      21,    64, 21, 21,  21,  21, 21, 21, 21, 21, 21,   64,  21, 64, 21,
+      64,    21, 21, 21,  64,  21, 64, 21, 64, 21, 1600, 341, 85, 21, 3647};
+  irsend.reset();
+  irsend.sendGC(gc_test, 75);
+  const std::string expected = irsend.outputStr();
+
+  ir_compiled_t code;
+  uint32_t timings[72];
+  EXPECT_FALSE(irsend.compileGC(gc_test, 75, &code, timings, 71));
+  ASSERT_TRUE(irsend.compileGC(gc_test, 75, &code, timings, 72));
+  EXPECT_EQ(38000, code.hz);
+  EXPECT_EQ(72, code.length);
+  EXPECT_EQ(72, code.first_len);
+  EXPECT_EQ(68, code.repeat_start);
+  EXPECT_EQ(1, code.repeat);
+  for (uint8_t i = 0; i < 3; i++) {  // Over & over again.
+    irsend.reset();
+    EXPECT_TRUE(irsend.send(&code));
+    EXPECT_EQ(expected, irsend.outputStr());
+  }
+  // A different nr. of repeats. The first sequence includes the repeat one.
+  irsend.reset();
+  EXPECT_TRUE(irsend.send(&code, 0));
+  EXPECT_EQ(
+      "f38000d50"
+      "m8866s4446m546s1664m546s1664m546s546m546s546m546s546m546s546"
+      "m546s546m546s1664m546s1664m546s546m546s1664m546s546m546s546"
+      "m546s546m546s1664m546s546m546s1664m546s546m546s546m546s546"
+      "m546s1664m546s546m546s546m546s546m546s546m546s1664m546s1664"
+      "m546s1664m546s546m546s1664m546s1664m546s1664m546s41600"
+      "m8866s2210m546s94822",
+      irsend.outputStr());
+
+  // Too short to be a GC code.
+  EXPECT_FALSE(irsend.compileGC(gc_test, 2, &code, timings, 72));
+
+  // A repeat offset of 0 is treated as 1. i.e. The whole code is repeated.
+  uint16_t gc_zero[7] = {38000, 2, 0, 20, 10, 20, 100};
+  irsend.reset();
+  irsend.sendGC(gc_zero, 7);
+  EXPECT_EQ("f38000d50m520s260m520s2600m520s260m520s2600", irsend.outputStr());
+  ASSERT_TRUE(irsend.compileGC(gc_zero, 7, &code, timings, 72));
+  EXPECT_EQ(0, code.repeat_start);
+  irsend.reset();
+  EXPECT_TRUE(irsend.send(&code));
+  EXPECT_EQ("f38000d50m520s260m520s2600m520s260m520s2600", irsend.outputStr());
+}
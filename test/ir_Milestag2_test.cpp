@@ -127,3 +127,133 @@ TEST(TestDecodeMilestag2, RealSelfDecodeExample) {
   EXPECT_EQ(0xD, irsend.capture.address);
   EXPECT_EQ(0x39, irsend.capture.command);
 }
+
+// Mock the interrupt handler capturing what was sent (minus the trailing gap)
+// into the current game mode buffer, then the frame timing out.
+static void gameCapture(IRrecv *irrecv, IRsendTest *irsend,
+                        const uint32_t now) {
+  volatile irparams_t *params_ptr = irrecv->_getParamsPtr();
+  params_ptr->rawbuf[0] = 1;
+  uint16_t rawlen = 1;
+  for (uint16_t n = 0; n < irsend->last; n++) {
+    if (rawlen >= params_ptr->bufsize) {
+      params_ptr->overflow = true;
+      break;
+    }
+    params_ptr->rawbuf[rawlen++] = irsend->output[n] / kRawTick;
+  }
+  params_ptr->rawlen = rawlen;
+  irsend->reset();
+  irrecv->_gameFrameEnd(now);
+}
+
+// Mock the receiver seeing what was sent, edge by edge, via the same code as
+// the interrupt handlers. The capture timer fires if there are no edges for
+// the capture timeout, as it restarts on every edge.
+// Returns the time after the trailing gap.
+static uint32_t gameEdges(IRrecv *irrecv, IRsendTest *irsend, uint32_t now) {
+  const uint32_t timeout = MS_TO_USEC(irrecv->_getParamsPtr()->timeout);
+  for (uint16_t n = 0; n <= irsend->last; n++) {
+    irrecv->_captureEdge(now);
+    if (irsend->output[n] >= timeout) irrecv->_captureTimeout(now + timeout);
+    now += irsend->output[n];
+  }
+  irsend->reset();
+  return now;
+}
+
+TEST(TestDecodeMilestag2, GameModeTimeout) {
+  IRsendTest irsend(kGpioUnused);
+  IRrecv irrecv(kGpioUnused);
+  irsend.begin();
+  ASSERT_TRUE(irrecv.enableGameMode(4));
+  ir_hit_t hits[8];
+
+  // Real back-to-back shots & a message. Each is captured whole, even though
+  // the header mark is longer than a couple of ms.
+  uint32_t now = 1000;
+  irsend.sendMilestag2(0x379, kMilesTag2ShotBits, 1);
+  now = gameEdges(&irrecv, &irsend, now);
+  irsend.sendMilestag2(0x8106E8, kMilesTag2MsgBits, 0);
+  now = gameEdges(&irrecv, &irsend, now);
+  EXPECT_EQ(0, irrecv.getGameFramesLost());
+  ASSERT_EQ(3, irrecv.readHits(hits, 8));
+  EXPECT_EQ(decode_type_t::MILESTAG2, hits[0].protocol);
+  EXPECT_EQ(0x379, hits[0].data);
+  EXPECT_EQ(kMilesTag2ShotBits, hits[0].bits);
+  EXPECT_EQ(decode_type_t::MILESTAG2, hits[1].protocol);
+  EXPECT_EQ(0x379, hits[1].data);
+  EXPECT_LT(hits[0].timestamp + 16000, hits[1].timestamp);  // A repeat.
+  EXPECT_EQ(decode_type_t::MILESTAG2, hits[2].protocol);
+  EXPECT_EQ(0x8106E8, hits[2].data);
+  EXPECT_EQ(kMilesTag2MsgBits, hits[2].bits);
+
+  // A timeout shorter than the header mark splits every shot into junk.
+  irrecv._getParamsPtr()->timeout = 2;
+  irsend.sendMilestag2(0x379, kMilesTag2ShotBits, 0);
+  now = gameEdges(&irrecv, &irsend, now);
+  EXPECT_EQ(0, irrecv.readHits(hits, 8));
+  irrecv.disableGameMode();
+}
+
+TEST(TestDecodeMilestag2, GameMode) {
+  IRsendTest irsend(kGpioUnused);
+  IRrecv irrecv(kGpioUnused);
+  irsend.begin();
+  volatile irparams_t *params_ptr = irrecv._getParamsPtr();
+  uint16_t *rawbuf = params_ptr->rawbuf;
+
+  ASSERT_TRUE(irrecv.enableGameMode(4));
+  EXPECT_EQ(kGameTimeoutMs, params_ptr->timeout);
+  EXPECT_EQ(kGameFrameSize - 1, irrecv.getBufSize());
+  ir_hit_t hits[8];
+  EXPECT_EQ(0, irrecv.readHits(hits, 8));
+
+  // Back-to-back frames: A shot, a message, and some junk.
+  irsend.sendMilestag2(0x379);
+  gameCapture(&irrecv, &irsend, 1000);
+  irsend.sendMilestag2(0x8106E8, kMilesTag2MsgBits);
+  gameCapture(&irrecv, &irsend, 2000);
+  irsend.sendNEC(0x12345678);  // Too long to be a laser-tag frame.
+  gameCapture(&irrecv, &irsend, 3000);
+  EXPECT_EQ(1, irrecv.getGameFramesLost());
+  irsend.sendSony(0x123, kSony12Bits, 0);  // Not a laser-tag message.
+  gameCapture(&irrecv, &irsend, 4000);
+  // All the buffers are in use, so this shot is lost.
+  irsend.sendMilestag2(0x12);
+  gameCapture(&irrecv, &irsend, 5000);
+  EXPECT_EQ(2, irrecv.getGameFramesLost());
+
+  // The hits are collected in bulk, oldest first, skipping the junk.
+  ASSERT_EQ(2, irrecv.readHits(hits, 8));
+  EXPECT_EQ(1000, hits[0].timestamp);
+  EXPECT_EQ(decode_type_t::MILESTAG2, hits[0].protocol);
+  EXPECT_EQ(0x379, hits[0].data);
+  EXPECT_EQ(kMilesTag2ShotBits, hits[0].bits);
+  EXPECT_EQ(2000, hits[1].timestamp);
+  EXPECT_EQ(decode_type_t::MILESTAG2, hits[1].protocol);
+  EXPECT_EQ(0x8106E8, hits[1].data);
+  EXPECT_EQ(kMilesTag2MsgBits, hits[1].bits);
+  EXPECT_EQ(0, irrecv.readHits(hits, 8));
+
+  // Hits can be collected a few at a time.
+  irsend.sendMilestag2(0x1);
+  gameCapture(&irrecv, &irsend, 6000);
+  irsend.sendLasertag(0x1);
+  gameCapture(&irrecv, &irsend, 7000);
+  ASSERT_EQ(1, irrecv.readHits(hits, 1));
+  EXPECT_EQ(0x1, hits[0].data);
+  EXPECT_EQ(decode_type_t::MILESTAG2, hits[0].protocol);
+  ASSERT_EQ(1, irrecv.readHits(hits, 1));
+  EXPECT_EQ(7000, hits[0].timestamp);
+  EXPECT_EQ(decode_type_t::LASERTAG, hits[0].protocol);
+  EXPECT_EQ(0x1, hits[0].data);
+  EXPECT_EQ(kLasertagBits, hits[0].bits);
+
+  // Back to normal.
+  irrecv.disableGameMode();
+  EXPECT_EQ(kTimeoutMs, params_ptr->timeout);
+  EXPECT_EQ(kRawBuf, irrecv.getBufSize());
+  EXPECT_EQ(rawbuf, params_ptr->rawbuf);
+  EXPECT_EQ(0, irrecv.readHits(hits, 8));
+}
@@ -435,3 +435,97 @@ TEST(TestSendPronto, Issue1103) {
       "f38028d50m20066s20435m15069s30665m20066s20435m15069s29982",
       irsend.outputStr());
 }
+
+// Tests for compilePronto() & send(compiled).
+
+TEST(TestCompilePronto, SendsTheSameAsSendPronto) {
+  IRsendTest irsend(4);
+  irsend.begin();
+
+  // NEC 32 bit power on command. A normal & a repeat sequence.
+  uint16_t pronto_test[76] = {
+      0x0000, 0x006D, 0x0022, 0x0002, 0x0156, 0x00AB, 0x0015, 0x0015, 0x0015,
+      0x0015, 0x0015, 0x0015, 0x0015, 0x0040, 0x0015, 0x0040, 0x0015, 0x0015,
+      0x0015, 0x0015, 0x0015, 0x0015, 0x0015, 0x0040, 0x0015, 0x0040, 0x0015,
+      0x0040, 0x0015, 0x0015, 0x0015, 0x0015, 0x0015, 0x0040, 0x0015, 0x0040,
+      0x0015, 0x0040, 0x0015, 0x0015, 0x0015, 0x0015, 0x0015, 0x0015, 0x0015,
+      0x0040, 0x0015, 0x0015, 0x0015, 0x0015, 0x0015, 0x0015, 0x0015, 0x0015,
+      0x0015, 0x0040, 0x0015, 0x0040, 0x0015, 0x0040, 0x0015, 0x0015, 0x0015,
+      0x0040, 0x0015, 0x0040, 0x0015, 0x0040, 0x0015, 0x0040, 0x0015, 0x05FD,
+      0x0156, 0x0055, 0x0015, 0x0E4E};
+  ir_compiled_t code;
+  uint32_t timings[72];
+  ASSERT_TRUE(irsend.compilePronto(pronto_test, 76, &code, timings, 72));
+  EXPECT_EQ(38028, code.hz);
+  EXPECT_EQ(72, code.length);
+  EXPECT_EQ(68, code.first_len);
+  EXPECT_EQ(68, code.repeat_start);
+  EXPECT_EQ(0, code.repeat);
+
+  for (uint16_t repeat = 0; repeat < 3; repeat++) {
+    irsend.reset();
+    irsend.sendPronto(pronto_test, 76, repeat);
+    const std::string expected = irsend.outputStr();
+    irsend.reset();
+    EXPECT_TRUE(irsend.send(&code, repeat));
+    EXPECT_EQ(expected, irsend.outputStr());
+  }
+
+  // Only a repeat sequence. It's sent at least once.
+  uint16_t pronto_test_using_repeat[12] = {
+      0x0000, 0x006D, 0x0000, 0x0004, 0x02fb, 0x0309, 0x023d, 0x048e, 0x02fb,
+      0x0309, 0x023d, 0x0474};
+  ASSERT_TRUE(irsend.compilePronto(pronto_test_using_repeat, 12, &code, timings,
+                                   72));
+  irsend.reset();
+  EXPECT_TRUE(irsend.send(&code));
+  EXPECT_EQ(
+      "f38028d50m20066s20435m15069s30665m20066s20435m15069s29982",
+      irsend.outputStr());
+  irsend.reset();
+  irsend.sendPronto(pronto_test_using_repeat, 12, 1);
+  const std::string expected = irsend.outputStr();
+  irsend.reset();
+  EXPECT_TRUE(irsend.send(&code, 1));
+  EXPECT_EQ(expected, irsend.outputStr());
+}
+
+TEST(TestCompilePronto, BadCodes) {
+  IRsendTest irsend(4);
+  irsend.begin();
+  ir_compiled_t code;
+  uint32_t timings[8];
+
+  uint16_t too_short[5] = {0x0000, 0x0067, 0x0034, 0x0000, 0x0000};
+  EXPECT_FALSE(irsend.compilePronto(too_short, 5, &code, timings, 8));
+  uint16_t not_raw[6] = {0x0100, 0x0067, 0x0001, 0x0000, 0x0001, 0x0002};
+  EXPECT_FALSE(irsend.compilePronto(not_raw, 6, &code, timings, 8));
+  uint16_t too_long[6] = {0x0000, 0x0067, 0x0000, 0x0010, 0x0000, 0x0000};
+  EXPECT_FALSE(irsend.compilePronto(too_long, 6, &code, timings, 8));
+  // A truncated repeat sequence is ignored, as sendPronto() does.
+  uint16_t truncated[8] = {0x0000, 0x006D, 0x0001, 0x0002,
+                           0x02FB, 0x0309, 0x023D, 0x048E};
+  ASSERT_TRUE(irsend.compilePronto(truncated, 8, &code, timings, 8));
+  EXPECT_EQ(2, code.length);
+  EXPECT_EQ(2, code.first_len);
+  irsend.reset();
+  irsend.sendPronto(truncated, 8, 2);
+  const std::string expected = irsend.outputStr();
+  irsend.reset();
+  EXPECT_TRUE(irsend.send(&code, 2));
+  EXPECT_EQ(expected, irsend.outputStr());
+  EXPECT_EQ("f38028d50m20066s20435", expected);
+
+  // Not enough room for the timings.
+  uint16_t ok[8] = {0x0000, 0x006D, 0x0002, 0x0000,
+                    0x02FB, 0x0309, 0x023D, 0x048E};
+  EXPECT_FALSE(irsend.compilePronto(ok, 8, &code, timings, 3));
+  EXPECT_TRUE(irsend.compilePronto(ok, 8, &code, timings, 4));
+
+  // Nothing to send.
+  EXPECT_FALSE(irsend.send(NULL));
+  code.length = 0;
+  irsend.reset();
+  EXPECT_FALSE(irsend.send(&code));
+  EXPECT_EQ("", irsend.outputStr());
+}
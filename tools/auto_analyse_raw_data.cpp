@@ -0,0 +1,1161 @@
+// Attempt an automatic analysis of IRremoteESP8266's Raw data output.
+// Makes suggestions on key values and tries to break down the message
+// into likely chunks.
+//
+// A native version of auto_analyse_raw_data.py. It produces the same report
+// & code outline for a single message, but can also work through large
+// collections of captures in parallel and emit the results as JSON lines.
+//
+// Copyright 2018-2021 David Conran
+// Copyright 2026 IRremoteESP8266 project
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "IRrecv.h"
+#include "IRremoteESP8266.h"
+#include "IRutils.h"
+
+const char kSafe64Note[] = "--safe64note--";
+const char kCodeGen[] = "--codegen--";
+const uint32_t kDefaultMargin = 200;  // uSeconds.
+const int32_t kNone = -1;  // Marker for a timing value we don't have.
+
+// Helpers for arbitrary length binary strings.  e.g. "0101..."
+
+// Convert a binary string into (upper case) hex, zero padded to `width`.
+std::string binToHex(const std::string &bin, const size_t width = 0) {
+  std::string result;
+  for (size_t end = bin.size(); end > 0; end = (end > 4) ? end - 4 : 0) {
+    const size_t start = (end > 4) ? end - 4 : 0;
+    uint8_t nibble = 0;
+    for (size_t i = start; i < end; i++) nibble = (nibble << 1) | (bin[i] & 1);
+    result.insert(result.begin(), "0123456789ABCDEF"[nibble]);
+  }
+  // Strip the leading zeros, then pad to the requested width.
+  const size_t first = result.find_first_not_of('0');
+  result = (first == std::string::npos) ? "0" : result.substr(first);
+  if (result.size() < width) result.insert(0, width - result.size(), '0');
+  return result;
+}
+
+// Convert a binary string into decimal.
+std::string binToDec(const std::string &bin) {
+  std::vector<uint8_t> digits(1, 0);  // Least significant digit first.
+  for (const char bit : bin) {
+    uint8_t carry = bit & 1;
+    for (uint8_t &digit : digits) {
+      const uint8_t value = digit * 2 + carry;
+      digit = value % 10;
+      carry = value / 10;
+    }
+    if (carry) digits.push_back(carry);
+  }
+  std::string result;
+  for (auto it = digits.rbegin(); it != digits.rend(); ++it)
+    result += static_cast<char>('0' + *it);
+  return result;
+}
+
+// Display a list of numbers the way Python does. e.g. "[1, 2, 3]"
+std::string listToString(const std::vector<uint32_t> &items) {
+  std::string result = "[";
+  for (size_t i = 0; i < items.size(); i++) {
+    if (i) result += ", ";
+    result += std::to_string(items[i]);
+  }
+  return result + "]";
+}
+
+// Average of a list of numbers.
+uint32_t avgList(const std::vector<uint32_t> &items) {
+  if (items.empty()) return 0;
+  uint64_t sum = 0;
+  for (const uint32_t item : items) sum += item;
+  return sum / items.size();
+}
+
+// Named code fragments (send/recv etc) plus any per-message state used when
+// generating them.
+typedef std::map<std::string, std::vector<std::string>> CodeMap;
+typedef std::map<std::string, std::string> CodeInfo;
+
+// Basic analyse functions & structure for raw IR messages.
+class RawIRMessage {
+ public:
+  RawIRMessage(const uint32_t margin, const std::vector<uint32_t> &timings,
+               std::ostream *output, const bool verbose = true);
+  bool isSpaceEncoded(void) const { return spaces.size() > marks.size(); }
+  bool isLdrMark(const uint32_t usec) const {
+    return usecCompare(usec, ldr_mark);
+  }
+  bool isHdrMark(const uint32_t usec) const {
+    return usecCompare(usec, hdr_mark);
+  }
+  bool isHdrSpace(const uint32_t usec) const {
+    return usecCompare(usec, hdr_space);
+  }
+  bool isBitMark(const uint32_t usec) const {
+    return usecCompare(usec, bit_mark);
+  }
+  bool isOneSpace(const uint32_t usec) const {
+    return usecCompare(usec, one_space);
+  }
+  bool isZeroSpace(const uint32_t usec) const {
+    return usecCompare(usec, zero_space);
+  }
+  bool isGap(const uint32_t usec) const;
+  void displayBinary(const std::string &bin) const;
+  std::vector<std::string> addDataCode(const std::string &bin,
+                                       const std::string &name,
+                                       const bool footer = true) const;
+  std::vector<std::string> addDataDecodeCode(const std::string &bin,
+                                             const std::string &name,
+                                             const bool footer = true) const;
+  std::vector<std::string> addDataByteCode(const std::string &bin,
+                                           const std::string &name,
+                                           const CodeInfo &ambles) const;
+  std::vector<std::string> addDataByteDecodeCode(const std::string &bin,
+                                                 const std::string &name,
+                                                 const CodeInfo &ambles) const;
+
+  int32_t ldr_mark = kNone;
+  int32_t hdr_mark = kNone;
+  int32_t hdr_space = kNone;
+  int32_t bit_mark = kNone;
+  int32_t zero_space = kNone;
+  int32_t one_space = kNone;
+  std::vector<uint32_t> gaps;
+  uint32_t margin;
+  std::vector<uint32_t> marks;
+  std::map<uint32_t, std::vector<uint32_t>> mark_buckets;
+  std::vector<uint32_t> spaces;
+  std::map<uint32_t, std::vector<uint32_t>> space_buckets;
+  std::ostream *output;
+  bool verbose;
+  uint16_t section_count = 1;
+  std::vector<uint32_t> timings;
+
+ private:
+  void reduceList(const std::vector<uint32_t> &items,
+                  std::vector<uint32_t> *result,
+                  std::map<uint32_t, std::vector<uint32_t>> *buckets) const;
+  bool usecCompare(const uint32_t seen, const int32_t expected) const;
+  void calcValues(void);
+};
+
+RawIRMessage::RawIRMessage(const uint32_t margin,
+                           const std::vector<uint32_t> &timings,
+                           std::ostream *output, const bool verbose)
+    : margin(margin), output(output), verbose(verbose), timings(timings) {
+  if (timings.size() <= 3)
+    throw std::invalid_argument("Too few message timings supplied.");
+  // Determine the likely values from the given data.
+  std::vector<uint32_t> all_marks, all_spaces;
+  for (size_t i = 0; i < timings.size(); i++)
+    (i % 2 ? all_spaces : all_marks).push_back(timings[i]);
+  reduceList(all_marks, &marks, &mark_buckets);
+  reduceList(all_spaces, &spaces, &space_buckets);
+  calcValues();
+}
+
+// Reduce a list of numbers into buckets that are at least margin apart.
+// i.e. The library's timing classes, with a fixed margin instead of a
+// percentage. Working from the largest down, each class is the largest value
+// in its bucket, just like auto_analyse_raw_data.py.
+void RawIRMessage::reduceList(
+    const std::vector<uint32_t> &items, std::vector<uint32_t> *result,
+    std::map<uint32_t, std::vector<uint32_t>> *buckets) const {
+  std::vector<uint32_t> sorted(items);
+  std::sort(sorted.rbegin(), sorted.rend());
+  const uint16_t max = std::min(sorted.size(), (size_t)UINT16_MAX);
+  std::vector<uint32_t> classes(max);
+  uint16_t count = 0;
+  for (const uint32_t item : sorted) {
+    const uint16_t before = count;
+    const int32_t index = irutils::timingClass(item, classes.data(), &count,
+                                               max, 0, margin);
+    if (index < 0) throw std::length_error("Too many distinct timings.");
+    if (count > before) result->push_back(item);  // A new class.
+    (*buckets)[classes[index]].push_back(item);
+  }
+}
+
+// Compare two usec values and see if they match within a subtractive margin.
+bool RawIRMessage::usecCompare(const uint32_t seen,
+                               const int32_t expected) const {
+  if (expected == kNone) return false;
+  return (int64_t)expected - margin < seen && seen <= (uint32_t)expected;
+}
+
+bool RawIRMessage::isGap(const uint32_t usec) const {
+  for (const uint32_t gap : gaps)
+    if (usecCompare(usec, gap)) return true;
+  return false;
+}
+
+// Calculate the values which describe the standard timings for the protocol.
+void RawIRMessage::calcValues(void) {
+  if (verbose)
+    *output << "Potential Mark Candidates:\n" << listToString(marks) << "\n"
+            << "Potential Space Candidates:\n" << listToString(spaces) << "\n";
+  // The bit mark is likely to be the smallest mark.
+  bit_mark = marks.back();
+  if (marks.size() > 2) {  // Possible leader mark?
+    ldr_mark = marks[0];
+    hdr_mark = marks[1];
+  } else if (marks.size() > 1) {  // At least two marks
+    // Largest mark is likely the kHdrMark
+    hdr_mark = marks[0];
+  } else {
+    // Probably no header mark.
+    hdr_mark = 0;
+  }
+
+  if (isSpaceEncoded() && spaces.size() >= 2) {
+    if (verbose && marks.size() > 2)
+      *output << "DANGER: Unusual number of mark timings!";
+    // We should have 3 space candidates at least.
+    // They should be: zero_space (smallest), one_space, & hdr_space (largest)
+    std::vector<uint32_t> candidates(spaces);
+    if (!candidates.empty()) {
+      zero_space = candidates.back();
+      candidates.pop_back();
+    }
+    if (!candidates.empty()) {
+      one_space = candidates.back();
+      candidates.pop_back();
+    }
+    if (!candidates.empty()) {
+      hdr_space = candidates.back();
+      candidates.pop_back();
+    }
+    // Rest are probably message gaps
+    gaps = candidates;
+  }
+}
+
+// Display common representations of the supplied binary string.
+void RawIRMessage::displayBinary(const std::string &bin) const {
+  const std::string rev(bin.rbegin(), bin.rend());
+  const size_t width = bin.size() / 4;
+  *output << "\n  Bits: " << bin.size() << "\n"
+          << "  Hex:  0x" << binToHex(bin, width) << " (MSB first)\n"
+          << "        0x" << binToHex(rev, width) << " (LSB first)\n"
+          << "  Dec:  " << binToDec(bin) << " (MSB first)\n"
+          << "        " << binToDec(rev) << " (LSB first)\n"
+          << "  Bin:  0b" << bin << " (MSB first)\n"
+          << "        0b" << rev << " (LSB first)\n";
+}
+
+// Add the common "data" sequence of code to send the bulk of a message.
+std::vector<std::string> RawIRMessage::addDataCode(const std::string &bin,
+                                                   const std::string &name,
+                                                   const bool footer) const {
+  const std::string nbits = std::to_string(bin.size());
+  std::vector<std::string> code = {
+      "    // Data Section #" + std::to_string(section_count),
+      "    // e.g. data = 0x" + binToHex(bin) + ", nbits = " + nbits,
+      "    sendData(k" + name + "BitMark, k" + name + "OneSpace, k" + name +
+          "BitMark, k" + name + "ZeroSpace, send_data, " + nbits + ", true);",
+      "    send_data >>= " + nbits + ";"};
+  if (footer) {
+    code.push_back("    // Footer");
+    code.push_back("    mark(k" + name + "BitMark);");
+  }
+  return code;
+}
+
+// Add the common "data" sequence code to decode the bulk of a message.
+std::vector<std::string> RawIRMessage::addDataDecodeCode(
+    const std::string &bin, const std::string &name,
+    const bool footer) const {
+  const std::string nbits = std::to_string(bin.size());
+  std::vector<std::string> code = {
+      "",
+      "  // Data Section #" + std::to_string(section_count),
+      "  // e.g. data_result.data = 0x" + binToHex(bin) + ", nbits = " + nbits,
+      "  data_result = matchData(&(results->rawbuf[offset]), " + nbits + ",",
+      "                          k" + name + "BitMark, k" + name + "OneSpace,",
+      "                          k" + name + "BitMark, k" + name +
+          "ZeroSpace);",
+      "  offset += data_result.used;",
+      "  if (data_result.success == false) return false;  // Fail",
+      "  data <<= " + nbits + ";  // Make room for the new bits of data.",
+      "  data |= data_result.data;"};
+  if (footer) {
+    code.push_back("");
+    code.push_back("  // Footer");
+    code.push_back("  if (!matchMark(results->rawbuf[offset++], k" + name +
+                   "BitMark))");
+    code.push_back("    return false;");
+  }
+  return code;
+}
+
+// Display a binary string as a list of hex bytes. e.g. "0x12, 0x34"
+static std::string binToByteList(const std::string &bin) {
+  std::string result;
+  for (size_t i = 0; i < bin.size(); i += 8) {
+    if (i) result += ", ";
+    result += "0x" + binToHex(bin.substr(i, 8), 2);
+  }
+  return result;
+}
+
+// Look up a value in the ambles, or use the default if it isn't there.
+static std::string getAmble(const CodeInfo &ambles, const std::string &key,
+                            const std::string &def) {
+  auto it = ambles.find(key);
+  return (it == ambles.end()) ? def : it->second;
+}
+
+// Add the code to send the data from an array.
+std::vector<std::string> RawIRMessage::addDataByteCode(
+    const std::string &bin, const std::string &name,
+    const CodeInfo &ambles) const {
+  std::vector<std::string> code;
+  const size_t nbits = bin.size();
+  const std::string nbytes = std::to_string(nbits / 8);
+  const std::string firstmark = getAmble(ambles, "firstmark", "0");
+  const std::string firstspace = getAmble(ambles, "firstspace", "0");
+  const std::string lastmark = getAmble(ambles, "lastmark",
+                                        "k" + name + "BitMark");
+  const std::string lastspace = getAmble(ambles, "lastspace",
+                                         "kDefaultMessageGap");
+  code.push_back("    // Data Section #" + std::to_string(section_count));
+  if (nbits % 8)
+    code.push_back("    // DANGER: Nr. of bits is not a multiple of 8. "
+                   "This section won't work!");
+  const std::vector<std::string> rest = {
+      "    // e.g.",
+      "    //   bits = " + std::to_string(nbits) + "; bytes = " + nbytes + ";",
+      "    //   *(data + pos) = {" + binToByteList(bin) + "};",
+      "    sendGeneric(" + firstmark + ", " + firstspace + ",",
+      "                k" + name + "BitMark, k" + name + "OneSpace,",
+      "                k" + name + "BitMark, k" + name + "ZeroSpace,",
+      "                " + lastmark + ", " + lastspace + ",",
+      "                data + pos, " + nbytes + ",  // Bytes",
+      "                k" + name + "Freq, true, kNoRepeat, kDutyDefault);",
+      "    pos += " + nbytes +
+          ";  // Adjust by how many bytes of data we sent"};
+  code.insert(code.end(), rest.begin(), rest.end());
+  return code;
+}
+
+// Add the common byte-wise "data" sequence decode code.
+std::vector<std::string> RawIRMessage::addDataByteDecodeCode(
+    const std::string &bin, const std::string &name,
+    const CodeInfo &ambles) const {
+  std::vector<std::string> code;
+  const size_t nbits = bin.size();
+  const std::string nbytes = std::to_string(nbits / 8);
+  if (nbits % 8)
+    code.push_back("  // WARNING: Nr. of bits is not a multiple of 8. "
+                   "This section won't work!");
+  const std::string firstmark = getAmble(ambles, "firstmark", "0");
+  const std::string firstspace = getAmble(ambles, "firstspace", "0");
+  const std::string lastmark = getAmble(ambles, "lastmark",
+                                        "k" + name + "BitMark");
+  const std::string lastspace = getAmble(ambles, "lastspace",
+                                         "kDefaultMessageGap");
+  const std::vector<std::string> rest = {
+      "",
+      "  // Data Section #" + std::to_string(section_count),
+      "  // e.g.",
+      "  //   bits = " + std::to_string(nbits) + "; bytes = " + nbytes + ";",
+      "  //   *(results->state + pos) = {" + binToByteList(bin) + "};",
+      "  used = matchGeneric(results->rawbuf + offset, results->state + pos,",
+      "                      results->rawlen - offset, " +
+          std::to_string(nbits) + ",",
+      "                      " + firstmark + ", " + firstspace + ",",
+      "                      k" + name + "BitMark, k" + name + "OneSpace,",
+      "                      k" + name + "BitMark, k" + name + "ZeroSpace,",
+      "                      " + lastmark + ", " + lastspace + ", true);",
+      "  if (used == 0) return false;  // We failed to find any data.",
+      "  offset += used;  // Adjust for how much of the message we read.",
+      "  pos += " + nbytes + ";  // Adjust by how many bytes of data we read"};
+  code.insert(code.end(), rest.begin(), rest.end());
+  return code;
+}
+
+// The machine-readable results of analysing a message.
+struct Analysis {
+  bool space_encoded = false;
+  uint32_t ldr_mark = 0;
+  uint32_t hdr_mark = 0;
+  uint32_t hdr_space = 0;
+  uint32_t bit_mark = 0;
+  uint32_t one_space = 0;
+  uint32_t zero_space = 0;
+  std::vector<uint32_t> gaps;
+  std::vector<std::string> sections;  // The bits of each data section.
+  std::string bits;  // All of the data bits.
+  int32_t overhead = 0;  // Nr. of timings that aren't data bits.
+};
+
+// Parse a C++ rawdata declaration into a list of values.
+std::vector<uint32_t> convertRawData(const std::string &data_str) {
+  size_t start = data_str.find('{');
+  size_t end = data_str.find('}');
+  if (end == std::string::npos) end = data_str.size();
+  if (start != std::string::npos && start > end)
+    throw std::invalid_argument(
+        "Raw Data not parsible due to parentheses placement.");
+  start = (start == std::string::npos) ? 0 : start + 1;
+  std::vector<uint32_t> results;
+  const std::string body = data_str.substr(start, end - start);
+  std::stringstream values(body);
+  std::string timing;
+  while (std::getline(values, timing, ',')) {
+    const size_t first = timing.find_first_not_of(" \t\r\n");
+    const size_t last = timing.find_last_not_of(" \t\r\n");
+    timing = (first == std::string::npos) ?
+        "" : timing.substr(first, last - first + 1);
+    char *endptr;
+    const uint64_t value = strtoull(timing.c_str(), &endptr, 10);
+    if (timing.empty() || *endptr || !isdigit(timing[0]) ||
+        value > UINT32_MAX)
+      throw std::invalid_argument("Raw Data contains a non-numeric value of '"
+                                  + timing + "'.");
+    results.push_back(value);
+  }
+  // A trailing comma is an empty entry too.
+  const size_t last = body.find_last_not_of(" \t\r\n");
+  if (last != std::string::npos && body[last] == ',')
+    throw std::invalid_argument("Raw Data contains a non-numeric value of ''.");
+  return results;
+}
+
+// Dump the key constants and generate the C++ #defines.
+void dumpConstants(const RawIRMessage &message,
+                   std::vector<std::string> *defines, const std::string &name,
+                   std::ostream *output, Analysis *analysis) {
+  uint32_t ldr_mark = 0;
+  uint32_t hdr_mark = 0;
+  uint32_t hdr_space = 0;
+  if (message.ldr_mark != kNone)
+    ldr_mark = avgList(message.mark_buckets.at(message.ldr_mark));
+  if (message.hdr_mark != 0)
+    hdr_mark = avgList(message.mark_buckets.at(message.hdr_mark));
+  const uint32_t bit_mark = avgList(
+      message.mark_buckets.at(message.bit_mark));
+  if (message.hdr_space != kNone)
+    hdr_space = avgList(message.space_buckets.at(message.hdr_space));
+  const uint32_t one_space = avgList(
+      message.space_buckets.at(message.one_space));
+  const uint32_t zero_space = avgList(
+      message.space_buckets.at(message.zero_space));
+
+  *output << "Guessing key value:\n"
+          << "k" << name << "HdrMark   = " << hdr_mark << "\n"
+          << "k" << name << "HdrSpace  = " << hdr_space << "\n"
+          << "k" << name << "BitMark   = " << bit_mark << "\n"
+          << "k" << name << "OneSpace  = " << one_space << "\n"
+          << "k" << name << "ZeroSpace = " << zero_space << "\n";
+  const std::string prefix = "const uint16_t k" + name;
+  defines->push_back(prefix + "HdrMark = " + std::to_string(hdr_mark) + ";");
+  defines->push_back(prefix + "BitMark = " + std::to_string(bit_mark) + ";");
+  defines->push_back(prefix + "HdrSpace = " + std::to_string(hdr_space) + ";");
+  defines->push_back(prefix + "OneSpace = " + std::to_string(one_space) + ";");
+  defines->push_back(prefix + "ZeroSpace = " + std::to_string(zero_space) +
+                     ";");
+  if (ldr_mark) {
+    *output << "k" << name << "LdrMark   = " << ldr_mark << "\n";
+    defines->push_back(prefix + "LdrMark = " + std::to_string(ldr_mark) + ";");
+  }
+
+  std::vector<uint32_t> avg_gaps;
+  for (const uint32_t gap : message.gaps)
+    avg_gaps.push_back(avgList(message.space_buckets.at(gap)));
+  if (avg_gaps.size() == 1) {
+    *output << "k" << name << "SpaceGap = " << avg_gaps[0] << "\n";
+    defines->push_back(prefix + "SpaceGap = " + std::to_string(avg_gaps[0]) +
+                       ";");
+  } else {
+    for (size_t count = 1; count <= avg_gaps.size(); count++) {
+      // We probably (still) have a gap in the protocol.
+      *output << "k" << name << "SpaceGap" << count << " = "
+              << avg_gaps[count - 1] << "\n";
+      defines->push_back(prefix + "SpaceGap" + std::to_string(count) + " = " +
+                         std::to_string(avg_gaps[count - 1]) + ";");
+    }
+  }
+  defines->push_back(prefix + "Freq = 38000;  "
+                     "// Hz. (Guessing the most common frequency.)");
+
+  analysis->ldr_mark = ldr_mark;
+  analysis->hdr_mark = hdr_mark;
+  analysis->hdr_space = hdr_space;
+  analysis->bit_mark = bit_mark;
+  analysis->one_space = one_space;
+  analysis->zero_space = zero_space;
+  analysis->gaps = avg_gaps;
+}
+
+// Add a line, or lines, to the end of a section of code.
+static void append(CodeMap *code, const std::string &section,
+                   const std::vector<std::string> &lines) {
+  std::vector<std::string> &dest = (*code)[section];
+  dest.insert(dest.end(), lines.begin(), lines.end());
+}
+
+// Convert a string to upper case.
+static std::string upper(std::string str) {
+  for (char &c : str) c = toupper(c);
+  return str;
+}
+
+// Decode the data sequence with the given values in mind.
+std::string decodeData(RawIRMessage *message,
+                       std::vector<std::string> *defines, CodeMap *code,
+                       const std::string &name, std::ostream *output,
+                       Analysis *analysis) {
+  // Now we have likely candidates for the key values, go through the original
+  // sequence and break it up and indicate accordingly.
+  *output << "\nDecoding protocol based on analysis so far:\n\n";
+  std::string state = "";
+  CodeInfo code_info;
+  uint32_t count = 1;
+  std::string total_bits = "";
+  std::string binary_value = "";
+  std::string binary64_value = "";
+  const std::string def_name = name.empty() ? "TBD" : name;
+  const std::string k = "k" + name;
+
+  // Record & display a completed data section.
+  auto displaySection = [&](const std::string &bits) {
+    message->displayBinary(bits);
+    analysis->sections.push_back(bits);
+  };
+
+  append(code, "sendcomhead", {
+      "",
+      "#if SEND_" + upper(def_name),
+      kSafe64Note,
+      "/// Send a " + name + " formatted message.",
+      "/// Status: ALPHA / Untested."});
+  append(code, "send", {
+      "/// @param[in] data containing the IR command.",
+      "/// @param[in] nbits Nr. of bits to send. usually " + k + "Bits",
+      "/// @param[in] repeat Nr. of times the message is to be repeated.",
+      "void IRsend::send" + def_name + "(const uint64_t data, const uint16_t"
+      " nbits, const uint16_t repeat) {",
+      "  enableIROut(" + k + "Freq);",
+      "  for (uint16_t r = 0; r <= repeat; r++) {",
+      "    uint64_t send_data = data;"});
+  append(code, "send64+", {
+      "/// @param[in] data An array of bytes containing the IR command.",
+      "///                 It is assumed to be in MSB order for this code.",
+      "/// e.g.",
+      "/// @code",
+      kCodeGen,
+      "/// @endcode",
+      "/// @param[in] nbytes Nr. of bytes of data in the array."
+      " (>=" + k + "StateLength)",
+      "/// @param[in] repeat Nr. of times the message is to be repeated.",
+      "void IRsend::send" + def_name + "(const uint8_t data[],"
+      " const uint16_t nbytes, const uint16_t repeat) {",
+      "  for (uint16_t r = 0; r <= repeat; r++) {",
+      "    uint16_t pos = 0;"});
+  append(code, "sendcomfoot", {
+      "  }",
+      "}",
+      "#endif  // SEND_" + upper(def_name)});
+  append(code, "recvcomhead", {
+      "",
+      "#if DECODE_" + upper(def_name),
+      kSafe64Note,
+      "/// Decode the supplied " + name + " message.",
+      "/// Status: ALPHA / Untested.",
+      "/// @param[in,out] results Ptr to the data to decode &"
+      " where to store the decode",
+      "/// @param[in] offset The starting index to use when"
+      " attempting to decode the",
+      "///   raw data. Typically/Defaults to kStartOffset.",
+      "/// @param[in] nbits The number of data bits to expect.",
+      "/// @param[in] strict Flag indicating if we should perform strict"
+      " matching.",
+      "/// @return A boolean. True if it can decode it, false if it can't.",
+      "bool IRrecv::decode" + def_name + "(decode_results *results, uint16_t"
+      " offset, const uint16_t nbits, const bool strict) {",
+      "  if (results->rawlen < 2 * nbits + " + k + "Overhead - offset)",
+      "    return false;  // Too short a message to match.",
+      "  if (strict && nbits != " + k + "Bits)",
+      "    return false;",
+      ""});
+  append(code, "recv", {
+      "  uint64_t data = 0;",
+      "  match_result_t data_result;"});
+  append(code, "recv64+", {
+      "  uint16_t pos = 0;",
+      "  uint16_t used = 0;"});
+  append(code, "recvcomfoot", {
+      "  return true;",
+      "}",
+      "#endif  // DECODE_" + upper(def_name)});
+
+  // states are:
+  //  HM:  Header/Leader mark
+  //  HS:  Header space
+  //  BM:  Bit mark
+  //  BS:  Bit space
+  //  GS:  Gap space
+  //  UNK: Unknown state.
+  for (const uint32_t usec : message->timings) {
+    if ((message->isHdrMark(usec) || message->isLdrMark(usec)) &&
+        count % 2 && !message->isBitMark(usec)) {
+      // Handle header/leader marks.
+      state = "HM";
+      // Header or Leader
+      const std::string mark_type = message->isHdrMark(usec) ? "H" : "L";
+      if (!binary_value.empty()) {
+        displaySection(binary_value);
+        append(code, "send", message->addDataCode(binary_value, name, false));
+        append(code, "recv", message->addDataDecodeCode(binary_value, name,
+                                                        false));
+        message->section_count++;
+        code_info["lastmark"] = k + mark_type + "drMark";
+        total_bits += binary_value;
+      }
+      code_info["firstmark"] = k + mark_type + "drMark";
+      binary_value = "";
+      *output << k << mark_type << "drMark+";
+      append(code, "send", {"    // " + mark_type + "eader",
+                            "    mark(" + k + mark_type + "drMark);"});
+      append(code, "recv", {
+          "",
+          "  // " + mark_type + "eader",
+          "  if (!matchMark(results->rawbuf[offset++], " + k + mark_type +
+              "drMark))",
+          "    return false;"});
+    } else if (message->isHdrSpace(usec) && !message->isOneSpace(usec)) {
+      // Handle header spaces.
+      if (!binary64_value.empty()) {
+        code_info["lastspace"] = k + "HdrSpace";
+        message->section_count--;
+        append(code, "send64+", message->addDataByteCode(binary64_value, name,
+                                                         code_info));
+        append(code, "recv64+", message->addDataByteDecodeCode(
+            binary64_value, name, code_info));
+        code_info.clear();
+        binary64_value = binary_value;
+        message->section_count++;
+      }
+      if (state != "HM") {
+        if (!binary_value.empty()) {  // In a header & have data, so add it.
+          displaySection(binary_value);
+          total_bits += binary_value;
+          append(code, "send", message->addDataCode(binary_value, name));
+          append(code, "recv", message->addDataDecodeCode(binary_value, name));
+          code_info["lastspace"] = k + "HdrSpace";
+          message->section_count++;
+        }
+        binary_value = binary64_value = "";
+        *output << "UNEXPECTED->";
+      }
+      state = "HS";
+      *output << k << "HdrSpace+";
+      append(code, "send", {"    space(" + k + "HdrSpace);"});
+      append(code, "recv", {
+          "  if (!matchSpace(results->rawbuf[offset++], " + k + "HdrSpace))",
+          "    return false;"});
+      code_info["firstspace"] = k + "HdrSpace";
+    } else if (message->isBitMark(usec) && count % 2) {
+      // Handle bit marks.
+      if (state != "HS" && state != "BS")
+        *output << k << "BitMark(UNEXPECTED)";
+      state = "BM";
+    } else if (message->isZeroSpace(usec)) {
+      // Handle "zero" spaces
+      if (state != "BM") *output << k << "ZeroSpace(UNEXPECTED)";
+      state = "BS";
+      *output << '0';  // This effectively displays in LSB first order.
+      binary_value += '0';  // Storing it in MSB first order.
+      binary64_value = binary_value;
+    } else if (message->isOneSpace(usec)) {
+      // Handle "one" spaces
+      if (state != "BM") *output << k << "OneSpace(UNEXPECTED)";
+      state = "BS";
+      *output << '1';  // This effectively displays in LSB first order.
+      binary_value += '1';  // Storing it in MSB first order.
+      binary64_value = binary_value;
+    } else if (message->isGap(usec)) {
+      if (state != "BM") *output << "UNEXPECTED->";
+      *output << "GAP(" << usec << ")";
+      code_info["lastspace"] = k + "SpaceGap";
+      if (!binary64_value.empty()) {
+        append(code, "send64+", message->addDataByteCode(binary64_value, name,
+                                                         code_info));
+        append(code, "recv64+", message->addDataByteDecodeCode(
+            binary64_value, name, code_info));
+        code_info.clear();
+      }
+      if (!binary_value.empty()) {
+        displaySection(binary_value);
+        append(code, "send", message->addDataCode(binary_value, name));
+        append(code, "recv", message->addDataDecodeCode(binary_value, name));
+        message->section_count++;
+      } else {
+        append(code, "recv", {"", "  // Gap"});
+        append(code, "send", {"    // Gap"});
+        if (state == "BM") {
+          append(code, "send", {"    mark(" + k + "BitMark);"});
+          append(code, "recv", {
+              "  if (!matchMark(results->rawbuf[offset++], " + k +
+                  "BitMark))",
+              "    return false;"});
+        }
+      }
+      append(code, "send", {"    space(" + k + "SpaceGap);"});
+      append(code, "recv", {
+          "  if (!matchSpace(results->rawbuf[offset++], " + k + "SpaceGap))",
+          "    return false;"});
+      total_bits += binary_value;
+      binary_value = binary64_value = "";
+      state = "GS";
+    } else {
+      *output << "UNKNOWN(" << usec << ")";
+      state = "UNK";
+    }
+    count++;
+  }
+  if (!binary64_value.empty()) {
+    append(code, "send64+", message->addDataByteCode(binary64_value, name,
+                                                     code_info));
+    append(code, "recv64+", message->addDataByteDecodeCode(binary64_value,
+                                                           name, code_info));
+    code_info.clear();
+  }
+  if (!binary_value.empty()) {
+    displaySection(binary_value);
+    append(code, "send", message->addDataCode(binary_value, name));
+    append(code, "recv", message->addDataDecodeCode(binary_value, name));
+    message->section_count++;
+  }
+  append(code, "send", {
+      "    space(kDefaultMessageGap);  // A 100% made up guess of the gap"
+      " between messages."});
+  append(code, "recv", {
+      "",
+      "  // Success",
+      "  results->decode_type = decode_type_t::" + upper(def_name) + ";",
+      "  results->bits = nbits;",
+      "  results->value = data;",
+      "  results->command = 0;",
+      "  results->address = 0;"});
+  append(code, "recv64+", {
+      "",
+      "  // Success",
+      "  results->decode_type = decode_type_t::" + upper(def_name) + ";",
+      "  results->bits = nbits;"});
+
+  total_bits += binary_value;
+  const int32_t overhead = message->timings.size() - 2 * total_bits.size();
+  *output << "\nTotal Nr. of suspected bits: " << total_bits.size() << "\n";
+  defines->push_back("const uint16_t " + k + "Bits = " +
+                     std::to_string(total_bits.size()) +
+                     ";  // Move to IRremoteESP8266.h");
+  if (total_bits.size() > 64)
+    defines->push_back("const uint16_t " + k + "StateLength = " +
+                       std::to_string(total_bits.size() / 8) +
+                       ";  // Move to IRremoteESP8266.h");
+  defines->push_back("const uint16_t " + k + "Overhead = " +
+                     std::to_string(overhead) + ";");
+  analysis->bits = total_bits;
+  analysis->overhead = overhead;
+  return total_bits;
+}
+
+// Output the estimated C++ code to reproduce & decode the IR message.
+void generateCode(const std::vector<std::string> &defines,
+                  const CodeMap &code, const std::string &bits_str,
+                  const std::string &name, std::ostream *output) {
+  const std::string def_name = name.empty() ? "TBD" : name;
+  *output << "\nGenerating a VERY rough code outline:\n\n"
+             "// Copyright 2020 David Conran (crankyoldgit)\n"
+             "/// @file\n"
+             "/// @brief Support for " << def_name << " protocol\n\n"
+             "// Supports:\n"
+             "//   Brand: " << def_name << ",  Model: TODO add device and "
+             "remote\n\n"
+             "#include \"IRrecv.h\"\n"
+             "#include \"IRsend.h\"\n"
+             "#include \"IRutils.h\"\n\n"
+             "// WARNING: This probably isn't directly usable."
+             " It's a guide only.\n\n"
+             "// See https://github.com/crankyoldgit/IRremoteESP8266/wiki/"
+             "Adding-support-for-a-new-IR-protocol\n"
+             "// for details of how to include this in the library."
+             "\n";
+  for (const std::string &line : defines) *output << line << "\n";
+
+  const bool big = bits_str.size() > 64;  // Will it fit in a uint64_t?
+  auto section = [&code](const std::string &head, const std::string &body,
+                         const std::string &foot) {
+    std::vector<std::string> lines(code.at(head));
+    lines.insert(lines.end(), code.at(body).begin(), code.at(body).end());
+    lines.insert(lines.end(), code.at(foot).begin(), code.at(foot).end());
+    return lines;
+  };
+  if (big)
+    *output << "// DANGER: More than 64 bits detected. A uint64_t for "
+               "'data' won't work!\n";
+  // Display the "normal" version's send code incase there are some
+  // oddities in it.
+  for (const std::string &line : section("sendcomhead", "send",
+                                         "sendcomfoot")) {
+    if (line == kSafe64Note)
+      *output << "// Function should be safe up to 64 bits.\n";
+    else
+      *output << line << "\n";
+  }
+  if (big) {
+    for (const std::string &line : section("sendcomhead", "send64+",
+                                           "sendcomfoot")) {
+      if (line == kSafe64Note)
+        *output << "// Alternative >64bit function to send "
+                << upper(def_name) << " messages\n"
+                << "// Function should be safe over 64 bits.\n";
+      else if (line == kCodeGen)
+        *output << "///   uint8_t data[k" << name << "StateLength] = {"
+                << binToByteList(bits_str) << "};\n";
+      else
+        *output << line << "\n";
+    }
+    *output << "\n// DANGER: More than 64 bits detected. A uint64_t for "
+               "'data' won't work!";
+  }
+  // Display the "normal" version's decode code incase there are some
+  // oddities in it.
+  for (const std::string &line : section("recvcomhead", "recv",
+                                         "recvcomfoot")) {
+    if (line == kSafe64Note)
+      *output << "// Function should be safe up to 64 bits.\n";
+    else
+      *output << line << "\n";
+  }
+  // Display the > 64bit version's decode code
+  if (big) {
+    if (bits_str.size() % 8)
+      *output << "\n// WARNING: Data is not a multiple of bytes. "
+                 "This won't work!\n";
+    for (const std::string &line : section("recvcomhead", "recv64+",
+                                           "recvcomfoot")) {
+      if (line == kSafe64Note)
+        *output << "// Function should be safe over 64 bits.\n";
+      else
+        *output << line << "\n";
+    }
+  }
+}
+
+// Analyse a message & report on it.
+// Returns false if it can't be analysed. i.e. It isn't space encoded.
+bool parseAndReport(const std::vector<uint32_t> &rawdata,
+                    const uint32_t margin, const bool gen_code,
+                    const std::string &name, std::ostream *output,
+                    Analysis *analysis) {
+  std::vector<std::string> defines;
+  CodeMap code;
+  for (const char *section : {"sendcomhead", "send", "send64+", "sendcomfoot",
+                              "recvcomhead", "recv", "recv64+", "recvcomfoot"})
+    code[section] = {};
+
+  *output << "Found " << rawdata.size() << " timing entries.\n";
+  RawIRMessage message(margin, rawdata, output);
+  *output << "\nGuessing encoding type:\n";
+  analysis->space_encoded = message.isSpaceEncoded();
+  if (!analysis->space_encoded) {
+    *output << "Sorry, it looks like it is Mark encoded. "
+               "I can't do that yet. Exiting.\n";
+    return false;
+  }
+  *output << "Looks like it uses space encoding. Yay!\n\n";
+  dumpConstants(message, &defines, name, output, analysis);
+  const std::string total_bits = decodeData(&message, &defines, &code, name,
+                                            output, analysis);
+  if (gen_code) generateCode(defines, code, total_bits, name, output);
+  return true;
+}
+
+// Escape a string for use in JSON output.
+std::string jsonEscape(const std::string &str) {
+  std::string result;
+  for (const char c : str) {
+    switch (c) {
+      case '"': result += "\\\""; break;
+      case '\\': result += "\\\\"; break;
+      case '\n': result += "\\n"; break;
+      case '\t': result += "\\t"; break;
+      default:
+        if ((uint8_t)c < 0x20) {
+          char buf[8];
+          snprintf(buf, sizeof(buf), "\\u%04x", c);
+          result += buf;
+        } else {
+          result += c;
+        }
+    }
+  }
+  return result;
+}
+
+// Try the library's own decoders on a message, so known protocols can be
+// spotted. Each thread needs its own `irrecv` to do this.
+decode_type_t knownProtocol(IRrecv *irrecv,
+                            const std::vector<uint32_t> &timings) {
+  std::vector<uint16_t> rawbuf(timings.size() + 2, 0);
+  for (size_t i = 0; i < timings.size(); i++)
+    rawbuf[i + 1] = std::min(timings[i] / kRawTick, (uint32_t)UINT16_MAX);
+  decode_results results;
+  results.rawbuf = rawbuf.data();
+  results.rawlen = std::min(rawbuf.size() - 1, (size_t)UINT16_MAX);
+  results.overflow = false;
+  if (irrecv->decodeCapture(&results)) return results.decode_type;
+  return decode_type_t::UNKNOWN;
+}
+
+// Analyse a message & describe the results as a single line of JSON.
+std::string analyseToJson(IRrecv *irrecv, const std::string &source,
+                          const size_t index, const std::string &rawdata_str,
+                          const uint32_t margin) {
+  std::ostringstream json;
+  json << "{\"source\":\"" << jsonEscape(source) << "\",\"index\":" << index;
+  try {
+    const std::vector<uint32_t> rawdata = convertRawData(rawdata_str);
+    json << ",\"entries\":" << rawdata.size();
+    const decode_type_t known = knownProtocol(irrecv, rawdata);
+    json << ",\"known\":\"" << typeToString(known).c_str() << "\"";
+    std::ostringstream ignored;
+    Analysis analysis;
+    const bool analysed = parseAndReport(rawdata, margin, false, "", &ignored,
+                                         &analysis);
+    json << ",\"encoding\":\"" << (analysed ? "space" : "mark") << "\"";
+    if (analysed) {
+      json << ",\"timing\":{\"ldr_mark\":" << analysis.ldr_mark
+           << ",\"hdr_mark\":" << analysis.hdr_mark
+           << ",\"hdr_space\":" << analysis.hdr_space
+           << ",\"bit_mark\":" << analysis.bit_mark
+           << ",\"one_space\":" << analysis.one_space
+           << ",\"zero_space\":" << analysis.zero_space << ",\"gaps\":[";
+      for (size_t i = 0; i < analysis.gaps.size(); i++)
+        json << (i ? "," : "") << analysis.gaps[i];
+      json << "]},\"nbits\":" << analysis.bits.size()
+           << ",\"overhead\":" << analysis.overhead
+           << ",\"bits\":\"" << analysis.bits << "\",\"sections\":[";
+      for (size_t i = 0; i < analysis.sections.size(); i++)
+        json << (i ? "," : "") << "\"" << analysis.sections[i] << "\"";
+      json << "]";
+    }
+  } catch (const std::exception &e) {
+    json << ",\"error\":\"" << jsonEscape(e.what()) << "\"";
+  }
+  json << "}";
+  return json.str();
+}
+
+// Split the contents of a file into the rawData declarations it contains.
+// Each `{...}` block is a message. If there are none, it is a single message.
+std::vector<std::string> splitRawData(const std::string &contents) {
+  std::vector<std::string> messages;
+  size_t pos = 0;
+  while ((pos = contents.find('{', pos)) != std::string::npos) {
+    size_t end = contents.find('}', pos);
+    if (end == std::string::npos) end = contents.size();
+    messages.push_back(contents.substr(pos, end - pos + 1));
+    pos = end;
+  }
+  if (messages.empty()) messages.push_back(contents);
+  return messages;
+}
+
+// Read the entire contents of a file (or "-" for stdin) into a string.
+bool readFile(const std::string &filename, std::string *contents) {
+  if (filename == "-") {
+    std::stringstream buffer;
+    buffer << std::cin.rdbuf();
+    *contents = buffer.str();
+    return true;
+  }
+  std::ifstream file(filename);
+  if (!file) return false;
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  *contents = buffer.str();
+  return true;
+}
+
+// Analyse all the messages in the given files using `jobs` threads.
+// Each message produces a JSON line on stdout, in the order of the input.
+int batchAnalyse(const std::vector<std::string> &files, const uint32_t margin,
+                 const unsigned int jobs) {
+  std::vector<std::string> results(files.size());
+  std::vector<bool> done(files.size(), false);
+  std::atomic<size_t> next(0);
+  std::mutex lock;
+  std::condition_variable ready;
+  int status = 0;
+
+  auto worker = [&](IRrecv *irrecv) {
+    for (size_t i = next++; i < files.size(); i = next++) {
+      std::string contents;
+      std::string output;
+      if (readFile(files[i], &contents)) {
+        const std::vector<std::string> messages = splitRawData(contents);
+        for (size_t m = 0; m < messages.size(); m++)
+          output += analyseToJson(irrecv, files[i], m, messages[m], margin) +
+              "\n";
+      } else {
+        output = "{\"source\":\"" + jsonEscape(files[i]) +
+            "\",\"error\":\"Can't read file.\"}\n";
+      }
+      std::lock_guard<std::mutex> guard(lock);
+      if (output.find("\"error\"") != std::string::npos) status = 1;
+      results[i] = output;
+      done[i] = true;
+      ready.notify_one();
+    }
+  };
+
+  // Each thread gets its own IRrecv. They are all made before any thread
+  // starts, as making one sets up the (shared) capture state.
+  std::vector<std::unique_ptr<IRrecv>> receivers;
+  for (unsigned int t = 0; t < std::max(jobs, 1U); t++)
+    receivers.emplace_back(new IRrecv(0));
+  std::vector<std::thread> threads;
+  for (std::unique_ptr<IRrecv> &irrecv : receivers)
+    threads.emplace_back(worker, irrecv.get());
+  // Output the results in order, as soon as they are ready.
+  for (size_t i = 0; i < files.size(); i++) {
+    std::unique_lock<std::mutex> guard(lock);
+    ready.wait(guard, [&] { return done[i]; });
+    std::cout << results[i];
+    results[i].clear();
+    results[i].shrink_to_fit();
+  }
+  for (std::thread &thread : threads) thread.join();
+  return status;
+}
+
+void usage_error(char *name) {
+  std::cerr << "Usage: " << name
+            << " [-g] [-n name] [-r margin] [--json] "
+               "(<rawdata> | -f file | --stdin)" << std::endl
+            << "Usage: " << name
+            << " --batch [-j jobs] [-r margin] file [file ...]" << std::endl
+            << std::endl
+            << "  -g, --code     Generate a C++ code outline to aid making an "
+               "IRsend function." << std::endl
+            << "  -n, --name     Name of the protocol/device to use in code "
+               "generation. E.g. Onkyo" << std::endl
+            << "  -r, --range    Max number of micro-seconds difference "
+               "between values to" << std::endl
+            << "                 consider it the same value. (Default: "
+            << kDefaultMargin << ")" << std::endl
+            << "  --json         Output the analysis as a line of JSON."
+            << std::endl
+            << "  --batch        Analyse every rawData declaration in the "
+               "files, in parallel," << std::endl
+            << "                 producing a line of JSON for each. "
+               "Use '-' for stdin." << std::endl
+            << "  -j, --jobs     Nr. of files to analyse at once. "
+               "(Default: Nr. of CPUs)" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  bool gen_code = false;
+  bool json = false;
+  bool batch = false;
+  bool use_stdin = false;
+  std::string name = "";
+  std::string filename = "";
+  uint32_t margin = kDefaultMargin;
+  unsigned int jobs = std::thread::hardware_concurrency();
+  std::vector<std::string> args;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (arg == "-g" || arg == "--code") {
+      gen_code = true;
+    } else if (arg == "--json") {
+      json = true;
+    } else if (arg == "--batch") {
+      batch = true;
+    } else if (arg == "--stdin") {
+      use_stdin = true;
+    } else if ((arg == "-n" || arg == "--name") && has_value) {
+      name = argv[++i];
+    } else if ((arg == "-f" || arg == "--file") && has_value) {
+      filename = argv[++i];
+    } else if ((arg == "-r" || arg == "--range") && has_value) {
+      margin = strtoul(argv[++i], NULL, 10);
+    } else if ((arg == "-j" || arg == "--jobs") && has_value) {
+      jobs = strtoul(argv[++i], NULL, 10);
+    } else if (arg.size() > 1 && arg[0] == '-' && !isdigit(arg[1])) {
+      usage_error(argv[0]);
+      return 1;
+    } else {
+      args.push_back(arg);
+    }
+  }
+
+  if (batch) {
+    if (args.empty()) {
+      usage_error(argv[0]);
+      return 1;
+    }
+    return batchAnalyse(args, margin, jobs);
+  }
+
+  // Exactly one source of rawdata.
+  if ((args.size() == 1) + !filename.empty() + use_stdin != 1 ||
+      args.size() > 1) {
+    usage_error(argv[0]);
+    return 1;
+  }
+  std::string raw_data;
+  if (!args.empty()) {
+    raw_data = args[0];
+  } else if (!readFile(use_stdin ? "-" : filename, &raw_data)) {
+    std::cerr << "error: Can't read file '" << filename << "'" << std::endl;
+    return 1;
+  }
+  if (raw_data.find_first_not_of(" \t\r\n") == std::string::npos) {
+    usage_error(argv[0]);
+    std::cerr << "error: no rawdata content" << std::endl;
+    return 1;
+  }
+
+  if (json) {
+    IRrecv irrecv(0);
+    const std::string result = analyseToJson(
+        &irrecv, filename.empty() ? "-" : filename, 0, raw_data, margin);
+    std::cout << result << std::endl;
+    return result.find("\"error\"") == std::string::npos ? 0 : 1;
+  }
+  try {
+    Analysis analysis;
+    if (!parseAndReport(convertRawData(raw_data), margin, gen_code, name,
+                        &std::cout, &analysis))
+      return 1;
+  } catch (const std::exception &e) {
+    std::cerr << "error: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,127 @@
+#! /bin/bash
+# Unit tests for the native auto_analyse_raw_data tool.
+# Where python3 is available, the output is also checked against the
+# reference implementation in auto_analyse_raw_data.py.
+AUTO_ANALYSE=./auto_analyse_raw_data
+if [[ ! -x ${AUTO_ANALYSE} ]]; then
+  echo "'auto_analyse_raw_data' failed to compile and produce an executable."
+  exit 1
+fi
+
+FAILED=0
+
+function unittest_success()
+{
+  COMMAND=$1
+  EXPECTED="$2"
+  echo -n "Testing: \"${COMMAND:0:70}...\" ..."
+  OUTPUT="$(eval ${COMMAND})"
+  STATUS=$?
+  FAILURE=""
+  if [[ ${STATUS} -ne 0 ]]; then
+    FAILURE="Non-Zero Exit status: ${STATUS}. "
+  fi
+  if [[ "${OUTPUT}" != "${EXPECTED}" ]]; then
+    FAILURE="${FAILURE} Unexpected Output: \"${OUTPUT}\" != \"${EXPECTED}\""
+  fi
+  if [[ -z ${FAILURE} ]]; then
+    echo " ok!"
+    return 0
+  else
+    echo
+    echo "FAILED: ${FAILURE}"
+    FAILED=1
+    return 1
+  fi
+}
+
+RAW="{8950, 4450, 600, 1650, 600, 550, 600, 1650, 600, 550, 600, 550, \
+600, 1650, 600, 550, 600, 1650, 600, 40000, 8950, 4450, 600, 550, 600, 1650, \
+600, 550, 600, 1650, 600}"
+
+read -r -d '' OUT << EOM
+Found 31 timing entries.
+Potential Mark Candidates:
+[8950, 600]
+Potential Space Candidates:
+[40000, 4450, 1650, 550]
+
+Guessing encoding type:
+Looks like it uses space encoding. Yay!
+
+Guessing key value:
+kHdrMark   = 8950
+kHdrSpace  = 4450
+kBitMark   = 600
+kOneSpace  = 1650
+kZeroSpace = 550
+kSpaceGap = 40000
+
+Decoding protocol based on analysis so far:
+
+kHdrMark+kHdrSpace+10100101GAP(40000)
+  Bits: 8
+  Hex:  0xA5 (MSB first)
+        0xA5 (LSB first)
+  Dec:  165 (MSB first)
+        165 (LSB first)
+  Bin:  0b10100101 (MSB first)
+        0b10100101 (LSB first)
+kHdrMark+kHdrSpace+0101
+  Bits: 4
+  Hex:  0x5 (MSB first)
+        0xA (LSB first)
+  Dec:  5 (MSB first)
+        10 (LSB first)
+  Bin:  0b0101 (MSB first)
+        0b1010 (LSB first)
+
+Total Nr. of suspected bits: 12
+EOM
+
+unittest_success "${AUTO_ANALYSE} \"${RAW}\"" "${OUT}"
+
+read -r -d '' OUT << EOM
+{"source":"-","index":0,"entries":31,"known":"UNKNOWN","encoding":"space",\
+"timing":{"ldr_mark":0,"hdr_mark":8950,"hdr_space":4450,"bit_mark":600,\
+"one_space":1650,"zero_space":550,"gaps":[40000]},"nbits":12,"overhead":7,\
+"bits":"101001010101","sections":["10100101","0101"]}
+EOM
+
+unittest_success "${AUTO_ANALYSE} --json \"${RAW}\"" "${OUT}"
+
+# Batch mode: Several messages per file, several files, results in order.
+TMPDIR=$(mktemp -d)
+trap 'rm -rf "${TMPDIR}"' EXIT
+echo "uint16_t rawData[31] = ${RAW};" > "${TMPDIR}/one.txt"
+echo "${RAW} {1, 2, 3} ${RAW}" > "${TMPDIR}/two.txt"
+EXPECTED_ROWS="${TMPDIR}/one.txt 0 space
+${TMPDIR}/two.txt 0 space
+${TMPDIR}/two.txt 1 error
+${TMPDIR}/two.txt 2 space"
+unittest_success "${AUTO_ANALYSE} --batch -j 3 ${TMPDIR}/one.txt \
+${TMPDIR}/two.txt | sed -E 's/^\{\"source\":\"([^\"]*)\",\"index\":([0-9]+)\
+.*(\"encoding\":\"(space)\"|\"(error)\").*/\1 \2 \4\5/'" "${EXPECTED_ROWS}"
+
+# Compare against the reference python implementation.
+# A >64 bit message with a gap, to cover the byte-array code generation.
+BIG_RAW="{ 9008, 4496, 644, 1660, 676, 530, 648, 558, 672, 1636, 646, 1660, 644, \
+556, 650, 584, 626, 560, 644, 580, 628, 1680, 624, 560, 648, 1662, 644, \
+582, 648, 536, 674, 530, 646, 580, 628, 560, 670, 532, 646, 562, 644, 556, \
+672, 536, 648, 1662, 646, 1660, 652, 554, 644, 558, 672, 538, 644, 560, \
+668, 560, 648, 1638, 668, 536, 644, 1660, 668, 532, 648, 560, 648, 1660, \
+674, 554, 622, 19990, 646, 580, 624, 1660, 648, 556, 648, 558, 674, 556, \
+622, 560, 644, 564, 668, 536, 646, 1662, 646, 1658, 672, 534, 648, 558, \
+644, 562, 648, 1662, 644, 584, 622, 558, 648, 562, 668, 534, 670, 536, 670, \
+532, 672, 536, 646, 560, 646, 558, 648, 558, 670, 534, 650, 558, 646, 560, \
+646, 560, 668, 1638, 646, 1662, 646, 1660, 646, 1660, 648}"
+if command -v python3 > /dev/null; then
+  for OPTS in "" "-g" "-g -n Foo" "-r 100 -g -n Bar"; do
+    for TEST_RAW in "${RAW}" "${BIG_RAW}"; do
+      EXPECTED="$(python3 ./auto_analyse_raw_data.py ${OPTS} "${TEST_RAW}")"
+      unittest_success "${AUTO_ANALYSE} ${OPTS} \"${TEST_RAW}\"" "${EXPECTED}"
+    done
+  done
+fi
+
+exit ${FAILED}
@@ -39,6 +39,8 @@ EOF
 # Parse and output contents of INPUT file.
 sed 's/ PROGMEM//' ${INPUT} | egrep "^(const )?char" | cut -f1 -d= |
     sed 's/ $/;/;s/^/extern /' | sort -u >> ${OUTPUT}
+sed 's/ PROGMEM//' ${INPUT} | egrep "^const uint16_t\* const " | cut -f1 -d= |
+    sed 's/ $/;/;s/^/extern /' | sort -u >> ${OUTPUT}
 egrep '^\s{,10}IRTEXT_CONST_STRING\(' ${INPUT} | cut -f2 -d\( | cut -f1 -d, |
     sed 's/^/extern IRTEXT_CONST_PTR\(/;s/$/\);/' | sort -u >> ${OUTPUT}
 egrep '^\s{,10}IRTEXT_CONST_BLOB_DECL\(' ${INPUT} |
@@ -0,0 +1,572 @@
+// Generate a synthetic stream of IR traffic for load & robustness testing of
+// receivers & decoders.
+// Copyright 2026 David Conran
+//
+// Messages are produced by the library's own IRsend::send() routines, with a
+// configurable protocol mix & rate, then optionally impaired with timing
+// jitter, IR demodulator skew (the kMarkExcess effect), leading noise pulses,
+// truncation, & collisions with other messages. The result is written as a
+// LIRC mode2 (or signed raw) stream, with a CSV ground-truth file describing
+// every message in it.
+//
+// With --report, the stream is then cut into captures the way IRrecv would
+// (at spaces longer than the timeout), decoded, and compared against the
+// ground truth to give throughput & accuracy figures.
+//
+// Usage example:
+//   ./traffic_gen --count 1000 --rate 20 --jitter 60 --noise 0.1
+//                 --truth truth.csv --report > traffic.mode2
+//   ./mode2_decode < traffic.mode2
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "IRrecv.h"
+#include "IRsend.h"
+#include "IRsend_test.h"
+#include "IRutils.h"
+
+const char kDefaultMix[] = "NEC:4,SONY:2,SAMSUNG:2,RC5,RC6,PANASONIC,JVC,LG";
+const uint16_t kMaxValidateTries = 64;  // Attempts to find a decodable code.
+const uint32_t kLeadIn = 100000;  // uSecs of silence at the start of a stream.
+const uint16_t kMaxCaptureSize = 4000;  // Max nr. of entries in a capture.
+// Min. uSecs between (non-colliding) messages. Long enough for both IRrecv's
+// default timeout & mode2_decode to split the stream on.
+const uint32_t kMinMessageGap = 25000;
+
+// Impairments that can be applied to a message.
+const uint8_t kImpairJitter = 1 << 0;
+const uint8_t kImpairSkew = 1 << 1;
+const uint8_t kImpairNoise = 1 << 2;
+const uint8_t kImpairTruncated = 1 << 3;
+const uint8_t kImpairCollision = 1 << 4;
+const char *const kImpairNames[] = {"jitter", "skew", "noise", "truncated",
+                                    "collision"};
+const uint8_t kImpairCount = sizeof(kImpairNames) / sizeof(kImpairNames[0]);
+
+// An entry in the protocol mix.
+struct MixEntry {
+  decode_type_t type;
+  uint32_t weight;
+  uint16_t nbits;
+  bool fixed;  // Always send `state` rather than a random code.
+  uint8_t state[kStateSizeMax];
+  uint8_t example[kStateSizeMax];  // A code known to decode correctly.
+};
+
+// What we sent. i.e. The ground truth.
+struct Message {
+  decode_type_t type;
+  uint16_t nbits;
+  uint64_t value;
+  uint8_t state[kStateSizeMax];
+  uint64_t start;  // uSecs from the start of the stream.
+  uint64_t end;
+  uint8_t impairments;
+};
+
+// A period where the IR led is on. i.e. A mark.
+struct Interval {
+  uint64_t start;
+  uint64_t end;
+  bool operator<(const Interval &other) const { return start < other.start; }
+};
+
+struct Options {
+  uint32_t count = 100;
+  double rate = 10.0;  // Messages per second.
+  uint32_t seed = 1;
+  uint16_t jitter = 0;  // +/- uSecs applied to every timing.
+  int16_t skew = 0;  // uSecs added to marks & removed from spaces.
+  double noise = 0.0;  // Probabilities of the various impairments.
+  double truncate = 0.0;
+  double collide = 0.0;
+  bool raw = false;  // Output format.
+  std::string mix = kDefaultMix;
+  std::string truth = "";
+  bool report = false;
+  uint64_t timeout = kTimeoutMs;  // Used to split the stream for decoding.
+  uint8_t max_skip = 0;
+};
+
+// Does a decode result match what we sent?
+bool matches(const decode_results &result, const Message &msg) {
+  if (result.decode_type != msg.type || result.bits != msg.nbits) return false;
+  if (hasACState(msg.type))
+    return memcmp(result.state, msg.state, msg.nbits / 8) == 0;
+  return result.value == msg.value;
+}
+
+// Convert a list of timings into a capture & decode it.
+bool decodeTimings(IRrecv *irrecv, const std::vector<uint32_t> &timings,
+                   const uint8_t max_skip, decode_results *result) {
+  static uint16_t rawbuf[kMaxCaptureSize + 2];
+  const uint16_t entries = std::min(timings.size(), (size_t)kMaxCaptureSize);
+  rawbuf[0] = 0;
+  for (uint16_t i = 0; i < entries; i++)
+    rawbuf[i + 1] = std::min(timings[i] / kRawTick, (uint32_t)UINT16_MAX);
+  result->rawbuf = rawbuf;
+  result->rawlen = entries + 1;
+  result->overflow = entries < timings.size();
+  result->decode_type = decode_type_t::UNKNOWN;
+  return irrecv->decode(result, NULL, max_skip);
+}
+
+// Produce the (unimpaired) timings for a message.
+std::vector<uint32_t> sendMessage(IRsendTest *irsend, const Message &msg) {
+  irsend->reset();
+  if (hasACState(msg.type))
+    irsend->send(msg.type, msg.state, msg.nbits / 8);
+  else
+    irsend->send(msg.type, msg.value, msg.nbits);
+  // Drop the trailing gap. We control the spacing between messages.
+  uint16_t entries = irsend->last + 1;
+  if (entries % 2 == 0) entries--;
+  return std::vector<uint32_t>(irsend->output, irsend->output + entries);
+}
+
+// Pick a code for a protocol that the library can both send & decode.
+// Many simple protocols insist on some structure in their data, so as well as
+// purely random codes, try the common inverted (e.g. NEC) & repeated-then-
+// inverted (e.g. Samsung) byte pair patterns.
+bool makeMessage(IRsendTest *irsend, IRrecv *irrecv, const MixEntry &entry,
+                 std::mt19937 *rng, Message *msg) {
+  msg->type = entry.type;
+  msg->nbits = entry.nbits;
+  // Where the code's bytes live in `state`. Simple values are right aligned.
+  const uint16_t nbytes = (entry.nbits + 7) / 8;
+  const uint16_t first = hasACState(entry.type) ? 0 : 8 - std::min(nbytes,
+                                                                   (uint16_t)8);
+  for (uint16_t tries = 0; tries < kMaxValidateTries; tries++) {
+    msg->value = 0;
+    if (entry.fixed) {
+      memcpy(msg->state, entry.state, sizeof(msg->state));
+    } else {
+      uint8_t *code = msg->state + first;
+      for (uint16_t i = 0; i < kStateSizeMax; i++) msg->state[i] = (*rng)();
+      for (uint16_t i = 0; i + 1 < nbytes && first + i + 1 < kStateSizeMax;
+           i += 2) {
+        switch (tries % 3) {
+          case 1: code[i + 1] = ~code[i]; break;
+          case 2: code[i + 1] = (i % 4) ? ~code[i] : code[i]; break;
+          default: break;
+        }
+      }
+    }
+    for (uint16_t i = 0; i < 8; i++)
+      msg->value = (msg->value << 8) | msg->state[i];
+    if (entry.nbits < 64) msg->value &= (1ULL << entry.nbits) - 1;
+    decode_results result;
+    if (decodeTimings(irrecv, sendMessage(irsend, *msg), 0, &result) &&
+        matches(result, *msg))
+      return true;
+    if (entry.fixed) break;
+  }
+  return false;
+}
+
+// Parse a protocol mix. e.g. "NEC:3,SONY,DAIKIN=0x11DA2700C5...:2"
+bool parseMix(const std::string &spec, IRsendTest *irsend, IRrecv *irrecv,
+              std::vector<MixEntry> *mix) {
+  std::stringstream items(spec);
+  std::string item;
+  while (std::getline(items, item, ',')) {
+    MixEntry entry;
+    entry.weight = 1;
+    entry.fixed = false;
+    memset(entry.state, 0, sizeof(entry.state));
+    size_t pos = item.find(':');
+    if (pos != std::string::npos) {
+      entry.weight = strtoul(item.substr(pos + 1).c_str(), NULL, 10);
+      item = item.substr(0, pos);
+    }
+    std::string code = "";
+    pos = item.find('=');
+    if (pos != std::string::npos) {
+      code = item.substr(pos + 1);
+      item = item.substr(0, pos);
+    }
+    entry.type = strToDecodeType(item.c_str());
+    entry.nbits = IRsend::defaultBits(entry.type);
+    if (entry.type == decode_type_t::UNKNOWN || !entry.nbits) {
+      std::cerr << "Unsupported protocol in mix: '" << item << "'" << std::endl;
+      return false;
+    }
+    if (!code.empty()) {
+      // Right align the hex code into the state/value.
+      if (code.rfind("0x", 0) == 0 || code.rfind("0X", 0) == 0)
+        code = code.substr(2);
+      const uint16_t nbytes = hasACState(entry.type) ? entry.nbits / 8 : 8;
+      for (uint16_t i = 0; i < code.size() && i / 2 < nbytes; i++) {
+        const char c = code[code.size() - i - 1];
+        if (!isxdigit(c)) {
+          std::cerr << "Invalid code for " << item << ": '" << code << "'"
+                    << std::endl;
+          return false;
+        }
+        const uint8_t nibble = isdigit(c) ? c - '0' : tolower(c) - 'a' + 10;
+        entry.state[nbytes - i / 2 - 1] |= nibble << (4 * (i % 2));
+      }
+      entry.fixed = true;
+    }
+    Message check;
+    std::mt19937 rng(0);
+    const bool found = makeMessage(irsend, irrecv, entry, &rng, &check);
+    memcpy(entry.example, check.state, sizeof(entry.example));
+    if (!found) {
+      std::cerr << "Can't find a " << item << " message that decodes. "
+                << "Supply a known good one with " << item << "=0x..."
+                << std::endl;
+      return false;
+    }
+    if (entry.weight) mix->push_back(entry);
+  }
+  if (mix->empty()) {
+    std::cerr << "The mix has no protocols with a non-zero weight: '" << spec
+              << "'" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Display a message's code as hex.
+std::string codeToString(const Message &msg) {
+  if (!hasACState(msg.type))
+    return "0x" + std::string(uint64ToString(msg.value, 16).c_str());
+  std::string result = "0x";
+  for (uint16_t i = 0; i < msg.nbits / 8; i++) {
+    char hex[3];
+    snprintf(hex, sizeof(hex), "%02X", msg.state[i]);
+    result += hex;
+  }
+  return result;
+}
+
+// Display a set of impairments. e.g. "jitter|noise"
+std::string impairmentsToString(const uint8_t impairments) {
+  std::string result = "";
+  for (uint8_t i = 0; i < kImpairCount; i++)
+    if (impairments & (1 << i)) {
+      if (!result.empty()) result += "|";
+      result += kImpairNames[i];
+    }
+  return result.empty() ? "none" : result;
+}
+
+// Apply the requested timing impairments, and convert to marks on a timeline.
+void addToTimeline(const std::vector<uint32_t> &timings, const uint64_t start,
+                   const Options &opts, std::mt19937 *rng,
+                   std::vector<Interval> *marks, Message *msg) {
+  std::uniform_int_distribution<int32_t> jitter(-opts.jitter, opts.jitter);
+  std::uniform_real_distribution<double> chance(0.0, 1.0);
+  uint64_t now = start;
+
+  if (opts.noise > 0.0 && chance(*rng) < opts.noise) {
+    // A few short, random, pulses ahead of the message.
+    std::uniform_int_distribution<uint32_t> pulses(1, 3);
+    std::uniform_int_distribution<uint32_t> pulse(50, 300);
+    std::uniform_int_distribution<uint32_t> pause(300, 3000);
+    for (uint32_t n = pulses(*rng); n; n--) {
+      const uint32_t width = pulse(*rng);
+      marks->push_back({now, now + width});
+      now += width + pause(*rng);
+    }
+    msg->impairments |= kImpairNoise;
+  }
+  size_t entries = timings.size();
+  if (opts.truncate > 0.0 && entries > 3 && chance(*rng) < opts.truncate) {
+    // Cut it short somewhere after the first mark, ending on a mark.
+    std::uniform_int_distribution<size_t> cut(1, entries / 2 - 1);
+    entries = cut(*rng) * 2 + 1;
+    msg->impairments |= kImpairTruncated;
+  }
+  if (opts.jitter) msg->impairments |= kImpairJitter;
+  if (opts.skew) msg->impairments |= kImpairSkew;
+  msg->start = now;
+  for (size_t i = 0; i < entries; i++) {
+    int64_t usecs = timings[i] + (opts.jitter ? jitter(*rng) : 0);
+    usecs += (i % 2) ? -opts.skew : opts.skew;  // Even entries are marks.
+    usecs = std::max(usecs, (int64_t)1);
+    if (i % 2 == 0) marks->push_back({now, now + usecs});
+    now += usecs;
+  }
+  msg->end = now;
+}
+
+// Merge overlapping marks & write them out as a stream of timings.
+// Returns the list of alternating space/mark timings, starting with a space.
+std::vector<uint32_t> flatten(std::vector<Interval> *marks) {
+  std::sort(marks->begin(), marks->end());
+  std::vector<uint32_t> stream;
+  uint64_t now = 0;
+  for (size_t i = 0; i < marks->size();) {
+    uint64_t end = (*marks)[i].end;
+    const uint64_t start = (*marks)[i].start;
+    for (i++; i < marks->size() && (*marks)[i].start <= end; i++)
+      end = std::max(end, (*marks)[i].end);
+    stream.push_back(std::min(start - now, (uint64_t)UINT32_MAX));
+    stream.push_back(std::min(end - start, (uint64_t)UINT32_MAX));
+    now = end;
+  }
+  return stream;
+}
+
+// Cut the stream up into captures like IRrecv would, decode them, and compare
+// the results to the ground truth.
+void report(const std::vector<uint32_t> &stream,
+            const std::vector<Message> &messages, const Options &opts,
+            IRrecv *irrecv) {
+  const uint32_t timeout = MS_TO_USEC(opts.timeout);
+  std::vector<bool> found(messages.size(), false);
+  uint32_t captures = 0, decoded = 0, wrong = 0;
+  uint64_t entries = 0;
+  std::map<decode_type_t, uint32_t> false_types;
+
+  const auto started = std::chrono::steady_clock::now();
+  uint64_t now = 0;
+  size_t first = 0;  // Index into `messages` of the earliest candidate.
+  for (size_t i = 1; i < stream.size();) {
+    // stream[i] is a mark. Gather everything until a long enough space.
+    const uint64_t start = now + stream[i - 1];
+    std::vector<uint32_t> capture;
+    now = start;
+    for (; i < stream.size(); i += 2) {
+      capture.push_back(stream[i]);
+      now += stream[i];
+      if (i + 1 >= stream.size() || stream[i + 1] >= timeout) {
+        i += 2;
+        break;
+      }
+      capture.push_back(stream[i + 1]);
+      now += stream[i + 1];
+    }
+    captures++;
+    entries += capture.size();
+    decode_results result;
+    if (!decodeTimings(irrecv, capture, opts.max_skip, &result) ||
+        result.decode_type == decode_type_t::UNKNOWN)
+      continue;
+    decoded++;
+    // Which messages overlap this capture, & is it one of them?
+    while (first < messages.size() && messages[first].end < start) first++;
+    bool correct = false;
+    for (size_t m = first; m < messages.size() && messages[m].start <= now;
+         m++)
+      if (matches(result, messages[m])) {
+        found[m] = true;
+        correct = true;
+      }
+    if (!correct) {
+      wrong++;
+      false_types[result.decode_type]++;
+    }
+  }
+  const double elapsed = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - started).count();
+
+  // Accuracy, overall & by protocol & by impairment.
+  std::map<std::string, std::pair<uint32_t, uint32_t>> by_protocol;
+  std::map<std::string, std::pair<uint32_t, uint32_t>> by_impairment;
+  uint32_t detected = 0;
+  for (size_t m = 0; m < messages.size(); m++) {
+    auto &protocol = by_protocol[typeToString(messages[m].type).c_str()];
+    auto &impairment = by_impairment[impairmentsToString(
+        messages[m].impairments)];
+    protocol.first++;
+    impairment.first++;
+    if (found[m]) {
+      detected++;
+      protocol.second++;
+      impairment.second++;
+    }
+  }
+  const double stream_secs = now / 1e6;
+  std::cerr << "Stream:       " << messages.size() << " messages, "
+            << stream.size() << " timings, " << stream_secs << " seconds"
+            << std::endl
+            << "Captures:     " << captures << " (" << entries
+            << " timings), " << decoded << " decoded, " << wrong
+            << " incorrect" << std::endl
+            << "Throughput:   " << elapsed * 1000 << " ms to decode, "
+            << (elapsed ? captures / elapsed : 0) << " captures/s, "
+            << (elapsed ? entries / elapsed : 0) << " timings/s, "
+            << (elapsed ? stream_secs / elapsed : 0) << "x real-time"
+            << std::endl
+            << "Accuracy:     " << detected << "/" << messages.size() << " ("
+            << (messages.size() ? 100.0 * detected / messages.size() : 0)
+            << "%)" << std::endl;
+  for (const auto &item : by_protocol)
+    std::cerr << "  Protocol  " << item.first << ": " << item.second.second
+              << "/" << item.second.first << std::endl;
+  for (const auto &item : by_impairment)
+    std::cerr << "  Impaired  " << item.first << ": " << item.second.second
+              << "/" << item.second.first << std::endl;
+  for (const auto &item : false_types)
+    std::cerr << "  Incorrect " << typeToString(item.first).c_str() << ": "
+              << item.second << std::endl;
+}
+
+void usage_error(char *name) {
+  std::cerr << "Usage: " << name << " [options]" << std::endl
+            << std::endl
+            << "  --count N        Nr. of messages to generate. (Default: 100)"
+            << std::endl
+            << "  --rate N         Average messages per second. (Default: 10)"
+            << std::endl
+            << "  --mix LIST       Protocols to use, with optional weights & "
+               "codes." << std::endl
+            << "                   e.g. NEC:3,SONY,DAIKIN=0x11DA...:2"
+            << std::endl
+            << "                   (Default: " << kDefaultMix << ")"
+            << std::endl
+            << "  --seed N         Random seed. (Default: 1)" << std::endl
+            << "  --jitter USECS   Max random error added to each timing."
+            << std::endl
+            << "  --skew USECS     Added to marks & removed from spaces. "
+               "i.e. Sensor skew." << std::endl
+            << "  --noise P        Probability of noise pulses before a "
+               "message." << std::endl
+            << "  --truncate P     Probability of a message being cut short."
+            << std::endl
+            << "  --collide P      Probability of a message overlapping the "
+               "previous one." << std::endl
+            << "  --raw            Output signed raw timings (+mark -space) "
+               "instead of mode2." << std::endl
+            << "  --truth FILE     Write the ground truth as CSV to FILE."
+            << std::endl
+            << "  --report         Decode the stream & report throughput & "
+               "accuracy to stderr." << std::endl
+            << "  --timeout MS     Capture timeout used by --report. (Default: "
+            << (uint16_t)kTimeoutMs << ")" << std::endl
+            << "  --max-skip N     Leading entries the decoders may skip. "
+               "(Default: 0)" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  Options opts;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+    if (arg == "--raw") {
+      opts.raw = true;
+    } else if (arg == "--report") {
+      opts.report = true;
+    } else if (value == NULL) {
+      usage_error(argv[0]);
+      return 1;
+    } else {
+      i++;
+      if (arg == "--count") opts.count = strtoul(value, NULL, 10);
+      else if (arg == "--rate") opts.rate = strtod(value, NULL);
+      else if (arg == "--mix") opts.mix = value;
+      else if (arg == "--seed") opts.seed = strtoul(value, NULL, 10);
+      else if (arg == "--jitter") opts.jitter = strtoul(value, NULL, 10);
+      else if (arg == "--skew") opts.skew = strtol(value, NULL, 10);
+      else if (arg == "--noise") opts.noise = strtod(value, NULL);
+      else if (arg == "--truncate") opts.truncate = strtod(value, NULL);
+      else if (arg == "--collide") opts.collide = strtod(value, NULL);
+      else if (arg == "--truth") opts.truth = value;
+      else if (arg == "--timeout") opts.timeout = strtoull(value, NULL, 10);
+      else if (arg == "--max-skip") opts.max_skip = strtoul(value, NULL, 10);
+      else {
+        usage_error(argv[0]);
+        return 1;
+      }
+    }
+  }
+  if (opts.rate <= 0.0) {
+    usage_error(argv[0]);
+    return 1;
+  }
+  // Note: kMaxTimeoutMs also fits in IRrecv's uint8_t timeout.
+  if (!opts.timeout || opts.timeout > kMaxTimeoutMs) {
+    std::cerr << "--timeout must be between 1 and " << kMaxTimeoutMs << " ms."
+              << std::endl;
+    return 1;
+  }
+
+  IRsendTest irsend(0);
+  IRrecv irrecv(0, kRawBuf, (uint8_t)opts.timeout);
+  irsend.begin();
+  std::vector<MixEntry> mix;
+  if (!parseMix(opts.mix, &irsend, &irrecv, &mix)) return 1;
+  std::vector<uint32_t> weights;
+  for (const MixEntry &entry : mix) weights.push_back(entry.weight);
+
+  std::mt19937 rng(opts.seed);
+  std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+  // Messages arrive randomly (Poisson), at the requested average rate.
+  std::exponential_distribution<double> interval(opts.rate / 1e6);
+  std::uniform_real_distribution<double> chance(0.0, 1.0);
+  std::vector<Message> messages;
+  std::vector<Interval> marks;
+  uint64_t next = kLeadIn;
+  for (uint32_t n = 0; n < opts.count; n++) {
+    Message msg;
+    const MixEntry &entry = mix[pick(rng)];
+    if (!makeMessage(&irsend, &irrecv, entry, &rng, &msg)) {
+      // Out of luck with a random code. Fall back to one we know works.
+      MixEntry known = entry;
+      known.fixed = true;
+      memcpy(known.state, entry.example, sizeof(known.state));
+      makeMessage(&irsend, &irrecv, known, &rng, &msg);
+    }
+    msg.impairments = 0;
+    uint64_t start = next;
+    if (!messages.empty()) {
+      const Message &prev = messages.back();
+      if (opts.collide > 0.0 && chance(rng) < opts.collide) {
+        // Start somewhere inside the previous message.
+        start = prev.start + chance(rng) * (prev.end - prev.start);
+        msg.impairments |= kImpairCollision;
+        messages.back().impairments |= kImpairCollision;
+      } else {
+        // Leave at least a capture timeout's worth of silence between them.
+        start = std::max(start, prev.end + std::max(
+            kMinMessageGap, (uint32_t)MS_TO_USEC(opts.timeout) + 1));
+      }
+    }
+    addToTimeline(sendMessage(&irsend, msg), start, opts, &rng, &marks, &msg);
+    messages.push_back(msg);
+    next = start + interval(rng);
+  }
+  std::vector<uint32_t> stream = flatten(&marks);
+
+  // The stream itself.
+  std::ostringstream out;
+  for (size_t i = 0; i < stream.size(); i++) {
+    if (opts.raw)
+      out << ((i % 2) ? "+" : "-") << stream[i] << "\n";
+    else
+      out << ((i % 2) ? "pulse " : "space ") << stream[i] << "\n";
+  }
+  if (!opts.raw) out << "space " << kLeadIn << "\n";  // Flush mode2 readers.
+  std::cout << out.str();
+
+  // The ground truth.
+  if (!opts.truth.empty()) {
+    std::ofstream truth(opts.truth);
+    if (!truth) {
+      std::cerr << "Can't write to '" << opts.truth << "'" << std::endl;
+      return 1;
+    }
+    truth << "index,start,end,protocol,bits,code,impairments\n";
+    for (size_t m = 0; m < messages.size(); m++)
+      truth << m << "," << messages[m].start << "," << messages[m].end << ","
+            << typeToString(messages[m].type).c_str() << ","
+            << messages[m].nbits << "," << codeToString(messages[m]) << ","
+            << impairmentsToString(messages[m].impairments) << "\n";
+  }
+  if (opts.report) report(stream, messages, opts, &irrecv);
+  return 0;
+}
@@ -0,0 +1,94 @@
+#! /bin/bash
+# Unit tests for the traffic_gen tool.
+TRAFFIC_GEN=./traffic_gen
+MODE2_DECODE=./mode2_decode
+if [[ ! -x ${TRAFFIC_GEN} ]]; then
+  echo "'traffic_gen' failed to compile and produce an executable."
+  exit 1
+fi
+
+FAILED=0
+TMPDIR=$(mktemp -d)
+trap 'rm -rf "${TMPDIR}"' EXIT
+
+function unittest_success()
+{
+  COMMAND=$1
+  EXPECTED="$2"
+  echo -n "Testing: \"${COMMAND}\" ..."
+  OUTPUT="$(eval ${COMMAND})"
+  STATUS=$?
+  FAILURE=""
+  if [[ ${STATUS} -ne 0 ]]; then
+    FAILURE="Non-Zero Exit status: ${STATUS}. "
+  fi
+  if [[ "${OUTPUT}" != "${EXPECTED}" ]]; then
+    FAILURE="${FAILURE} Unexpected Output: \"${OUTPUT}\" != \"${EXPECTED}\""
+  fi
+  if [[ -z ${FAILURE} ]]; then
+    echo " ok!"
+    return 0
+  else
+    echo
+    echo "FAILED: ${FAILURE}"
+    FAILED=1
+    return 1
+  fi
+}
+
+# The ground truth describes every message.
+${TRAFFIC_GEN} --count 20 --truth ${TMPDIR}/truth.csv > ${TMPDIR}/stream
+unittest_success "head -1 ${TMPDIR}/truth.csv" \
+    "index,start,end,protocol,bits,code,impairments"
+unittest_success "tail -n +2 ${TMPDIR}/truth.csv | wc -l" "20"
+unittest_success "cut -d, -f7 ${TMPDIR}/truth.csv | sort -u | tail -1" "none"
+
+# The same seed produces the same stream, a different one doesn't.
+unittest_success "${TRAFFIC_GEN} --count 20 | cmp - ${TMPDIR}/stream && \
+echo same" "same"
+unittest_success "${TRAFFIC_GEN} --count 20 --seed 2 | \
+cmp -s - ${TMPDIR}/stream || echo differs" "differs"
+
+# The mode2 stream can be decoded by mode2_decode, message for message.
+if [[ -x ${MODE2_DECODE} ]]; then
+  unittest_success "${MODE2_DECODE} < ${TMPDIR}/stream | \
+grep 'Code type' | sed -E 's/.*\((.*)\)/\1/' | tr '\n' ' '" \
+      "$(tail -n +2 ${TMPDIR}/truth.csv | cut -d, -f4 | tr '\n' ' ')"
+fi
+
+# Fixed codes & impairments are recorded in the ground truth.
+${TRAFFIC_GEN} --count 3 --mix SAMSUNG=0xE0E09966 --jitter 50 \
+    --truth ${TMPDIR}/fixed.csv > /dev/null
+unittest_success "tail -n +2 ${TMPDIR}/fixed.csv | cut -d, -f4-" \
+"SAMSUNG,32,0xE0E09966,jitter
+SAMSUNG,32,0xE0E09966,jitter
+SAMSUNG,32,0xE0E09966,jitter"
+
+# Raw output alternates between spaces & marks.
+unittest_success "${TRAFFIC_GEN} --count 5 --raw | cut -c1 | uniq -c | \
+awk '\$1 != 1' | wc -l" "0"
+
+# A clean stream should decode perfectly.
+unittest_success "${TRAFFIC_GEN} --count 200 --report 2>&1 > /dev/null | \
+grep Accuracy" "Accuracy:     200/200 (100%)"
+
+# Impairments hurt, but are counted.
+unittest_success "${TRAFFIC_GEN} --count 200 --truncate 1 --report \
+2>&1 > /dev/null | grep -E 'Impaired.*truncated' | sed 's/:.*//'" \
+"  Impaired  truncated"
+
+# Bad protocols in the mix are an error.
+unittest_success "${TRAFFIC_GEN} --mix FOOBAR 2>&1 > /dev/null; echo \$?" \
+"Unsupported protocol in mix: 'FOOBAR'
+1"
+unittest_success "${TRAFFIC_GEN} --mix NEC:0,SONY:0 2>&1 > /dev/null; \
+echo \$?" \
+"The mix has no protocols with a non-zero weight: 'NEC:0,SONY:0'
+1"
+
+# Out of range timeouts are an error, rather than wrapping around.
+unittest_success "${TRAFFIC_GEN} --timeout 271 2>&1 > /dev/null; echo \$?" \
+"--timeout must be between 1 and 130 ms.
+1"
+
+exit ${FAILED}
@@ -0,0 +1,429 @@
+// Simulate & benchmark the transmit timing accuracy of IRsend::mark()/space().
+// Copyright 2026 David Conran
+//
+// The software PWM in IRsend::mark() runs against the IRtimer clock. In a
+// UNIT_TEST build that clock only moves when we say so (IRtimer::add()), so we
+// can run the real send code on the host, charge each LED write & delay call
+// the execution time it would take on a given platform, and record exactly
+// when every edge would hit the IR LED.
+//
+// For every protocol the library can send, the recorded edges are compared to
+// what was asked for, and we report:
+//   Carrier  The mean error of the carrier period (%). -ve = freq. too high.
+//   Duty     The mean error of the duty cycle (percentage points).
+//   Mark     The worst error in the length of any mark (uSecs).
+//   Space    The worst error in the length of any space (uSecs).
+//   Drift    How far the end of the message is from where it should be (uSecs).
+//
+// calibrate() is also run on each platform model, and the offset it finds is
+// compared with the platform's kPeriodOffset.
+//
+// NOTE: The platform models are not measurements. Their costs were chosen so
+// their per-carrier-period overhead matches each platform's kPeriodOffset.
+// So calibrate() agreeing with kPeriodOffset here only shows the model,
+// calibrate() & kPeriodOffset are consistent with each other. It does NOT show
+// kPeriodOffset is correct for real hardware. Only measuring on the device can
+// do that. e.g. calibrate() on the device itself, or an oscilloscope.
+// Use --model to see how sensitive the results are to the costs.
+//
+// Usage example:
+//   ./tx_timing_sim --platform esp8266 --protocol NEC
+//   ./tx_timing_sim --platform all --summary
+//   ./tx_timing_sim --model 800,1200,-4  # Try a different overhead model.
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "IRremoteESP8266.h"
+#include "IRsend.h"
+#include "IRtimer.h"
+#include "IRutils.h"
+
+const uint16_t kCalibrateHz = 38000;
+const uint8_t kCalibrateTolerance = 1;  // uSecs.
+const uint64_t kPattern = 0xA5C3A5C3A5C3A5C3;  // Code used for all messages.
+
+// A model of how long the code in mark()/space() takes to run on a platform.
+// The costs are a rough split of the per-carrier-period overhead implied by
+// each platform's kPeriodOffset. i.e. They are derived from it, not measured.
+// Use --model to try other values without changing kPlatforms.
+struct Platform {
+  const char *name;
+  const char *description;
+  uint32_t gpio_ns;  // Cost of each ledOn()/ledOff() call.
+  uint32_t delay_ns;  // Fixed cost of each _delayMicroseconds() call.
+  int8_t offset;  // kPeriodOffset for the platform.
+};
+
+const Platform kPlatforms[] = {
+    {"ideal", "No execution overheads", 0, 0, 0},
+    {"esp8266", "ESP8266 @ 80MHz", 1000, 1500, -5},
+    {"esp8266-160", "ESP8266 @ 160MHz", 500, 750, -2},
+    {"esp32", "ESP32 @ 240MHz", 300, 700, -2},
+};
+const uint8_t kNrPlatforms = sizeof(kPlatforms) / sizeof(kPlatforms[0]);
+
+// A change of the IR LED's state.
+struct Edge {
+  uint64_t time;  // nSecs.
+  bool on;
+};
+
+// A call to mark() or space().
+struct Request {
+  bool mark;
+  uint32_t usecs;
+  uint64_t time;  // nSecs. When the call was made.
+  size_t first_edge;  // Index of the first edge produced by the call.
+  uint32_t freq;
+  uint8_t duty;
+};
+
+// The timing accuracy of a single message.
+struct Result {
+  std::string protocol;
+  uint32_t periods;  // Nr. of whole carrier periods measured.
+  double carrier;  // %
+  double duty;  // Percentage points.
+  double mark;  // uSecs.
+  double space;  // uSecs.
+  double drift;  // uSecs.
+};
+
+// IRsend with a simulated clock & LED.
+class IRsendSim : public IRsend {
+ public:
+  std::vector<Edge> edges;
+  std::vector<Request> requests;
+
+  explicit IRsendSim(const Platform &platform)
+      : IRsend(0), platform_(platform), now_(0), reported_(0), led_(false) {}
+
+  void reset() {
+    edges.clear();
+    requests.clear();
+  }
+
+  uint64_t now() const { return now_; }
+  int8_t getOffset() const { return periodOffset; }
+  void setOffset(const int8_t offset) { periodOffset = offset; }
+
+  uint16_t mark(uint16_t usec) {
+    requests.push_back({true, usec, now_, edges.size(), _freq_unittest,
+                        _dutycycle});
+    return IRsend::mark(usec);
+  }
+
+  void space(uint32_t time) {
+    requests.push_back({false, time, now_, edges.size(), _freq_unittest,
+                        _dutycycle});
+    IRsend::space(time);
+  }
+
+ protected:
+  void ledOn() { setLed(true); }
+  void ledOff() { setLed(false); }
+
+  void _delayMicroseconds(uint32_t usec) {
+    advance(platform_.delay_ns + usec * 1000ULL);
+  }
+
+ private:
+  const Platform &platform_;
+  uint64_t now_;  // nSecs since we started.
+  uint64_t reported_;  // uSecs of `now_` given to IRtimer so far.
+  bool led_;
+
+  void setLed(const bool on) {
+    if (on != led_) edges.push_back({now_, on});
+    led_ = on;
+    advance(platform_.gpio_ns);
+  }
+
+  // Move time forward. IRtimer (i.e. micros()) only sees whole uSecs.
+  void advance(const uint64_t nsecs) {
+    now_ += nsecs;
+    IRtimer::add(now_ / 1000 - reported_);
+    reported_ = now_ / 1000;
+  }
+};
+
+struct Options {
+  std::string platform = "esp8266";
+  bool custom = false;  // Simulate `model` rather than `platform`.
+  Platform model = {"custom", "User supplied model", 0, 0, 0};
+  std::string protocol = "";
+  bool calibrate = false;  // Use the offset calibrate() finds.
+  bool summary = false;  // Only show the per-platform summary.
+  bool csv = false;
+};
+
+// Send a protocol's message & record its timings.
+bool sendMessage(IRsendSim *irsend, const decode_type_t type) {
+  const uint16_t nbits = IRsend::defaultBits(type);
+  if (!nbits) return false;
+  irsend->reset();
+  if (hasACState(type)) {
+    uint8_t state[kStateSizeMax];
+    for (uint16_t i = 0; i < kStateSizeMax; i++) state[i] = kPattern >> i % 8;
+    return irsend->send(type, state, nbits / 8);
+  }
+  return irsend->send(type,
+                      nbits < 64 ? kPattern & ((1ULL << nbits) - 1) : kPattern,
+                      nbits);
+}
+
+// Compare what was sent with what was asked for.
+Result analyse(const IRsendSim &irsend, const decode_type_t type) {
+  Result result = {typeToString(type).c_str(), 0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  const std::vector<Request> &requests = irsend.requests;
+  const std::vector<Edge> &edges = irsend.edges;
+  if (requests.empty()) return result;
+  const uint64_t start = requests.front().time;
+  uint64_t ideal = 0;  // When the current mark/space should start. (nSecs)
+  uint64_t actual = 0;  // When the last mark actually ended. (nSecs)
+  uint64_t space = 0;  // The length of the current space. (nSecs)
+  double carrier = 0.0;
+  double duty = 0.0;
+  for (size_t i = 0; i < requests.size(); i++) {
+    const Request &request = requests[i];
+    if (!request.mark) {
+      space += request.usecs * 1000ULL;
+      continue;
+    }
+    // Consecutive marks are a single mark as far as a receiver is concerned.
+    uint64_t length = request.usecs * 1000ULL;
+    size_t last = i;
+    while (last + 1 < requests.size() && requests[last + 1].mark)
+      length += requests[++last].usecs * 1000ULL;
+    const size_t end_edge = last + 1 < requests.size()
+                                ? requests[last + 1].first_edge
+                                : edges.size();
+    if (request.first_edge >= end_edge) continue;  // Zero length mark.
+    const uint64_t mark_start = edges[request.first_edge].time - start;
+    const uint64_t mark_end = edges[end_edge - 1].time - start;
+    if (ideal || space)  // Skip any leading space.
+      result.space = std::max(result.space, std::fabs(
+          ((double)mark_start - actual - space) / 1000.0));
+    ideal += space;
+    result.mark = std::max(result.mark, std::fabs(
+        ((double)mark_end - mark_start - length) / 1000.0));
+    // The carrier. Only whole periods count. i.e. Not the final pulse.
+    for (size_t j = i; j <= last; j++) {
+      const Request &part = requests[j];
+      if (part.duty >= kDutyMax || !part.freq) continue;
+      const size_t end = j < last ? requests[j + 1].first_edge : end_edge;
+      const double period = 1e9 / part.freq;
+      for (size_t e = part.first_edge; e + 2 < end; e += 2) {
+        const double actual_period = edges[e + 2].time - edges[e].time;
+        carrier += (actual_period - period) / period * 100.0;
+        duty += (edges[e + 1].time - edges[e].time) / actual_period * 100.0 -
+                part.duty;
+        result.periods++;
+      }
+    }
+    ideal += length;
+    actual = mark_end;
+    space = 0;
+    i = last;
+  }
+  // The trailing space lasts until the last call returns.
+  ideal += space;
+  result.drift = ((double)irsend.now() - start - ideal) / 1000.0;
+  if (result.periods) {
+    result.carrier = carrier / result.periods;
+    result.duty = duty / result.periods;
+  }
+  return result;
+}
+
+// Run calibrate() on a platform model & see if it is consistent with the
+// platform's kPeriodOffset. See the NOTE at the top of the file.
+bool checkCalibration(const Platform &platform, int8_t *offset) {
+  IRsendSim irsend(platform);
+  *offset = irsend.calibrate(kCalibrateHz);
+  return *offset >= platform.offset - kCalibrateTolerance &&
+         *offset <= platform.offset + kCalibrateTolerance;
+}
+
+void printResult(const Result &result, const bool csv) {
+  if (csv) {
+    std::cout << result.protocol << "," << result.periods << ","
+              << result.carrier << "," << result.duty << "," << result.mark
+              << "," << result.space << "," << result.drift << std::endl;
+    return;
+  }
+  std::cout << std::left << std::setw(24) << result.protocol << std::right
+            << std::showpos << std::fixed << std::setprecision(2)
+            << std::setw(10) << result.carrier << std::setw(9) << result.duty
+            << std::noshowpos << std::setprecision(1) << std::setw(10)
+            << result.mark << std::setw(10) << result.space << std::showpos
+            << std::setw(11) << result.drift << std::noshowpos << std::endl;
+}
+
+// Simulate all the requested protocols on a platform.
+// Returns false if calibrate() is inconsistent with the platform's
+// kPeriodOffset.
+bool simulate(const Platform &platform, const Options &opts,
+              const decode_type_t only) {
+  int8_t calibrated;
+  const bool calibration_ok = checkCalibration(platform, &calibrated);
+  IRsendSim irsend(platform);
+  irsend.setOffset(opts.calibrate ? calibrated : platform.offset);
+  if (!opts.csv) {
+    std::cout << "Platform: " << platform.name << " (" << platform.description
+              << ", ledOn/Off() " << platform.gpio_ns << "ns, "
+              << "_delayMicroseconds() " << platform.delay_ns << "ns)"
+              << std::endl
+              << "calibrate(" << kCalibrateHz << ") = " << (int)calibrated
+              << ", kPeriodOffset = " << (int)platform.offset << ": "
+              << (calibration_ok ? "consistent" : "INCONSISTENT") << std::endl
+              << "Period offset in use: " << (int)irsend.getOffset()
+              << std::endl;
+    if (!opts.summary)
+      std::cout << std::endl
+                << "Protocol                 Carrier(%)  Duty(%)  Mark(us) "
+                   "Space(us)  Drift(us)" << std::endl;
+  }
+  std::vector<Result> results;
+  for (int i = 1; i <= kLastDecodeType; i++) {
+    const decode_type_t type = (decode_type_t)i;
+    if (only != decode_type_t::UNKNOWN && type != only) continue;
+    if (!sendMessage(&irsend, type)) continue;
+    results.push_back(analyse(irsend, type));
+    if (!opts.summary) printResult(results.back(), opts.csv);
+  }
+  if (!opts.csv && !results.empty()) {
+    double carrier = 0.0;
+    const Result *worst_carrier = &results[0];
+    const Result *worst_drift = &results[0];
+    for (const Result &result : results) {
+      carrier += std::fabs(result.carrier);
+      if (std::fabs(result.carrier) > std::fabs(worst_carrier->carrier))
+        worst_carrier = &result;
+      if (std::fabs(result.drift) > std::fabs(worst_drift->drift))
+        worst_drift = &result;
+    }
+    std::cout << std::noshowpos << std::fixed << std::setprecision(2)
+              << std::endl
+              << "Protocols:      " << results.size() << std::endl
+              << "Carrier error:  mean " << carrier / results.size()
+              << "%, worst " << worst_carrier->carrier << "% ("
+              << worst_carrier->protocol << ")" << std::endl
+              << "Envelope drift: worst " << std::setprecision(1)
+              << worst_drift->drift << "us (" << worst_drift->protocol << ")"
+              << std::endl;
+  }
+  return calibration_ok;
+}
+
+void usage_error(char *name) {
+  std::cerr << "Usage: " << name << " [options]" << std::endl
+            << std::endl
+            << "  --platform NAME  Platform model to simulate, or 'all'. "
+               "(Default: esp8266)" << std::endl
+            << "                   One of:";
+  for (uint8_t i = 0; i < kNrPlatforms; i++)
+    std::cerr << " " << kPlatforms[i].name;
+  std::cerr << std::endl
+            << "  --model GPIO_NS,DELAY_NS,OFFSET" << std::endl
+            << "                   Simulate this overhead model instead of a "
+               "platform. i.e. nSecs" << std::endl
+            << "                   per ledOn/Off() & _delayMicroseconds() "
+               "call, & kPeriodOffset." << std::endl
+            << "  --protocol NAME  Only simulate this protocol." << std::endl
+            << "  --calibrate      Use the offset calibrate() finds, rather "
+               "than kPeriodOffset." << std::endl
+            << "  --summary        Only report the summary for each platform."
+            << std::endl
+            << "  --csv            Output the per-protocol results as CSV."
+            << std::endl;
+}
+
+// Parse a --model value. e.g. "1000,1500,-5"
+bool parseModel(const char *str, Platform *model) {
+  char *end;
+  const unsigned long gpio_ns = strtoul(str, &end, 10);  // NOLINT(runtime/int)
+  if (end == str || *end != ',') return false;
+  str = end + 1;
+  const unsigned long delay_ns = strtoul(str, &end, 10);  // NOLINT(runtime/int)
+  if (end == str || *end != ',') return false;
+  str = end + 1;
+  const long offset = strtol(str, &end, 10);  // NOLINT(runtime/int)
+  if (end == str || *end != '\0') return false;
+  if (gpio_ns > 1000000 || delay_ns > 1000000 || offset < INT8_MIN ||
+      offset > INT8_MAX)
+    return false;
+  model->gpio_ns = gpio_ns;
+  model->delay_ns = delay_ns;
+  model->offset = offset;
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  Options opts;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+    if (arg == "--calibrate") {
+      opts.calibrate = true;
+    } else if (arg == "--summary") {
+      opts.summary = true;
+    } else if (arg == "--csv") {
+      opts.csv = true;
+    } else if (value == NULL) {
+      usage_error(argv[0]);
+      return 1;
+    } else {
+      i++;
+      if (arg == "--platform") {
+        opts.platform = value;
+      } else if (arg == "--protocol") {
+        opts.protocol = value;
+      } else if (arg == "--model") {
+        if (!parseModel(value, &opts.model)) {
+          std::cerr << "Invalid model: '" << value << "'" << std::endl;
+          return 1;
+        }
+        opts.custom = true;
+      } else {
+        usage_error(argv[0]);
+        return 1;
+      }
+    }
+  }
+  decode_type_t only = decode_type_t::UNKNOWN;
+  if (!opts.protocol.empty()) {
+    only = strToDecodeType(opts.protocol.c_str());
+    if (only == decode_type_t::UNKNOWN || !IRsend::defaultBits(only)) {
+      std::cerr << "Unsupported protocol: '" << opts.protocol << "'"
+                << std::endl;
+      return 1;
+    }
+  }
+  if (opts.csv)
+    std::cout << "protocol,periods,carrier_pct,duty_pct,mark_us,space_us,"
+                 "drift_us" << std::endl;
+  if (opts.custom) return simulate(opts.model, opts, only) ? 0 : 2;
+  bool found = false;
+  bool calibration_ok = true;
+  for (uint8_t i = 0; i < kNrPlatforms; i++) {
+    if (opts.platform != "all" && opts.platform != kPlatforms[i].name)
+      continue;
+    if (found && !opts.csv) std::cout << std::endl;
+    found = true;
+    calibration_ok &= simulate(kPlatforms[i], opts, only);
+  }
+  if (!found) {
+    usage_error(argv[0]);
+    return 1;
+  }
+  return calibration_ok ? 0 : 2;
+}
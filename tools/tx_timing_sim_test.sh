@@ -0,0 +1,86 @@
+#! /bin/bash
+# Unit tests for the tx_timing_sim tool.
+TX_TIMING_SIM=./tx_timing_sim
+if [[ ! -x ${TX_TIMING_SIM} ]]; then
+  echo "'tx_timing_sim' failed to compile and produce an executable."
+  exit 1
+fi
+
+FAILED=0
+
+function unittest_success()
+{
+  COMMAND=$1
+  EXPECTED="$2"
+  echo -n "Testing: \"${COMMAND}\" ..."
+  OUTPUT="$(eval ${COMMAND})"
+  STATUS=$?
+  FAILURE=""
+  if [[ ${STATUS} -ne 0 ]]; then
+    FAILURE="Non-Zero Exit status: ${STATUS}. "
+  fi
+  if [[ "${OUTPUT}" != "${EXPECTED}" ]]; then
+    FAILURE="${FAILURE} Unexpected Output: \"${OUTPUT}\" != \"${EXPECTED}\""
+  fi
+  if [[ -z ${FAILURE} ]]; then
+    echo " ok!"
+    return 0
+  else
+    echo
+    echo "FAILED: ${FAILURE}"
+    FAILED=1
+    return 1
+  fi
+}
+
+# calibrate() is consistent with kPeriodOffset on every platform model.
+# The models are derived from kPeriodOffset, so this isn't a check of the
+# offsets on real hardware.
+unittest_success "${TX_TIMING_SIM} --platform all --summary | \
+grep '^calibrate'" \
+"calibrate(38000) = 0, kPeriodOffset = 0: consistent
+calibrate(38000) = -4, kPeriodOffset = -5: consistent
+calibrate(38000) = -2, kPeriodOffset = -2: consistent
+calibrate(38000) = -1, kPeriodOffset = -2: consistent"
+
+# With no execution overheads, no message drifts at all.
+unittest_success "${TX_TIMING_SIM} --platform ideal --csv | \
+awk -F, 'NR > 1 && \$7 != 0' | wc -l" "0"
+
+# Every protocol we can send is simulated.
+unittest_success "${TX_TIMING_SIM} --csv | tail -n +2 | wc -l" \
+"$(${TX_TIMING_SIM} --summary | grep Protocols | awk '{print $2}')"
+
+# A known result. The ESP8266's per-call overheads add up over a message.
+unittest_success "${TX_TIMING_SIM} --platform esp8266 --protocol NEC --csv" \
+"protocol,periods,carrier_pct,duty_pct,mark_us,space_us,drift_us
+NEC,1037,-1.2,-0.307692,7.5,15,255"
+
+# Using the calibrated offset changes the carrier.
+unittest_success "${TX_TIMING_SIM} --platform esp32 --calibrate \
+--protocol SONY | grep -E '^(Period|SONY)' | tr -s ' '" \
+"Period offset in use: -1
+SONY +4.00 -2.23 1.0 3.0 +150.0"
+
+# A user supplied overhead model is simulated just like a built-in one.
+unittest_success "${TX_TIMING_SIM} --model 1000,1500,-5 --protocol NEC --csv" \
+"$(${TX_TIMING_SIM} --platform esp8266 --protocol NEC --csv)"
+unittest_success "${TX_TIMING_SIM} --model 0,0,0 --summary | sed -n 1,2p" \
+"Platform: custom (User supplied model, ledOn/Off() 0ns, \
+_delayMicroseconds() 0ns)
+calibrate(38000) = 0, kPeriodOffset = 0: consistent"
+
+# Bad arguments are an error.
+unittest_success "${TX_TIMING_SIM} --model 1000,1500 2>&1; echo \$?" \
+"Invalid model: '1000,1500'
+1"
+unittest_success "${TX_TIMING_SIM} --protocol FOOBAR 2>&1 > /dev/null; \
+echo \$?" \
+"Unsupported protocol: 'FOOBAR'
+1"
+unittest_success "${TX_TIMING_SIM} --platform z80 2>&1 | sed -n 1p; \
+echo \${PIPESTATUS[0]}" \
+"Usage: ${TX_TIMING_SIM} [options]
+1"
+
+exit ${FAILED}